@@ -273,6 +273,7 @@ void                            _clutter_actor_attach_clone
                                                                                          ClutterActor *clone);
 void                            _clutter_actor_detach_clone                             (ClutterActor *actor,
                                                                                          ClutterActor *clone);
+unsigned int                    _clutter_actor_get_clones_redraw_serial                 (ClutterActor *actor);
 void                            _clutter_actor_queue_only_relayout                      (ClutterActor *actor);
 void                            clutter_actor_clear_stage_views_recursive               (ClutterActor *actor,
                                                                                          gboolean      stop_transitions);
@@ -521,6 +521,7 @@
 #include "clutter/clutter-property-transition.h"
 #include "clutter/clutter-stage-private.h"
 #include "clutter/clutter-stage-view-private.h"
+#include "clutter/clutter-texture-content.h"
 #include "clutter/clutter-timeline.h"
 #include "clutter/clutter-transition.h"
 #include "glib-object.h"
@@ -675,12 +676,24 @@ struct _ClutterActorPrivate
 
   CoglColor bg_color;
 
+  /* The paint nodes built for the background and content of the actor
+   * during the last paint, and the paint opacity they were built with.
+   * They don't depend on the framebuffer or view being painted, and are
+   * reused until a redraw is queued on the actor or its allocation
+   * changes.
+   */
+  GPtrArray *retained_paint_nodes;
+  uint8_t retained_paint_opacity;
+
   /* a string used for debugging messages */
   char *debug_name;
 
   /* a set of clones of the actor */
   GHashTable *clones;
 
+  /* incremented every time a redraw is queued on the clones */
+  unsigned int clones_redraw_serial;
+
   /* whether the actor is inside a cloned branch; this
    * value is propagated to all the actor's children
    */
@@ -994,6 +1007,8 @@ static void clutter_actor_update_devices (ClutterActor *self);
 static void clutter_actor_set_color_state_internal (ClutterActor      *self,
                                                     ClutterColorState *color_state);
 
+static void clutter_actor_clear_retained_paint_nodes (ClutterActor *actor);
+
 static GQuark quark_actor_layout_info = 0;
 static GQuark quark_actor_transform_info = 0;
 static GQuark quark_actor_animation_info = 0;
@@ -1593,6 +1608,8 @@ clutter_actor_real_unmap (ClutterActor *self)
 
   self->flags &= ~CLUTTER_ACTOR_MAPPED;
 
+  clutter_actor_clear_retained_paint_nodes (self);
+
   if (priv->unmapped_paint_branch_counter == 0)
     {
       if (priv->parent && !CLUTTER_ACTOR_IN_DESTRUCTION (priv->parent))
@@ -2448,7 +2465,10 @@ clutter_actor_set_allocation_internal (ClutterActor           *self,
       transform_changed (self);
 
       if (size_changed)
-        queue_update_paint_volume (self);
+        {
+          queue_update_paint_volume (self);
+          clutter_actor_clear_retained_paint_nodes (self);
+        }
 
       g_object_notify_by_pspec (obj, obj_props[PROP_ALLOCATION]);
 
@@ -2520,6 +2540,8 @@ _clutter_actor_queue_redraw_on_clones (ClutterActor *self)
   if (priv->clones == NULL)
     return;
 
+  priv->clones_redraw_serial++;
+
   g_hash_table_iter_init (&iter, priv->clones);
   while (g_hash_table_iter_next (&iter, &key, NULL))
     clutter_actor_queue_redraw (key);
@@ -3440,9 +3462,84 @@ clutter_actor_real_paint (ClutterActor        *actor,
 }
 
 static gboolean
-clutter_actor_paint_node (ClutterActor        *actor,
-                          ClutterPaintNode    *root,
-                          ClutterPaintContext *paint_context)
+clutter_actor_can_retain_paint_nodes (ClutterActor *actor)
+{
+  ClutterActorPrivate *priv = actor->priv;
+
+  /* Subclasses and most content implementations can build their paint
+   * nodes from state that changes without a redraw being queued on the
+   * actor, e.g. clip regions set up while culling, so only the nodes of
+   * plain actors are retained.
+   */
+  if (CLUTTER_ACTOR_GET_CLASS (actor)->paint_node != NULL)
+    return FALSE;
+
+  if (priv->content != NULL && !CLUTTER_IS_TEXTURE_CONTENT (priv->content))
+    return FALSE;
+
+  return TRUE;
+}
+
+static void
+clutter_actor_clear_retained_paint_nodes (ClutterActor *actor)
+{
+  g_clear_pointer (&actor->priv->retained_paint_nodes, g_ptr_array_unref);
+}
+
+static GPtrArray *
+clutter_actor_get_retained_paint_nodes (ClutterActor *actor,
+                                        uint8_t       paint_opacity)
+{
+  ClutterActorPrivate *priv = actor->priv;
+  unsigned int i;
+
+  if (priv->retained_paint_nodes == NULL)
+    return NULL;
+
+  if (priv->retained_paint_opacity != paint_opacity)
+    {
+      clutter_actor_clear_retained_paint_nodes (actor);
+      return NULL;
+    }
+
+  /* The nodes are only attached to the root built for each paint, which
+   * is expected to be gone by the next one */
+  for (i = 0; i < priv->retained_paint_nodes->len; i++)
+    {
+      ClutterPaintNode *node = g_ptr_array_index (priv->retained_paint_nodes, i);
+
+      if (node->parent != NULL)
+        {
+          clutter_actor_clear_retained_paint_nodes (actor);
+          return NULL;
+        }
+    }
+
+  return priv->retained_paint_nodes;
+}
+
+static void
+clutter_actor_retain_paint_nodes (ClutterActor     *actor,
+                                  ClutterPaintNode *root,
+                                  uint8_t           paint_opacity)
+{
+  ClutterActorPrivate *priv = actor->priv;
+  ClutterPaintNode *node;
+
+  priv->retained_paint_nodes =
+    g_ptr_array_new_full (clutter_paint_node_get_n_children (root),
+                          (GDestroyNotify) clutter_paint_node_unref);
+
+  for (node = root->first_child; node != NULL; node = node->next_sibling)
+    g_ptr_array_add (priv->retained_paint_nodes, clutter_paint_node_ref (node));
+
+  priv->retained_paint_opacity = paint_opacity;
+}
+
+static void
+clutter_actor_build_paint_node (ClutterActor        *actor,
+                                ClutterPaintNode    *root,
+                                ClutterPaintContext *paint_context)
 {
   ClutterActorPrivate *priv = actor->priv;
   ClutterActorBox box;
@@ -3476,6 +3573,45 @@ clutter_actor_paint_node (ClutterActor        *actor,
 
   if (CLUTTER_ACTOR_GET_CLASS (actor)->paint_node != NULL)
     CLUTTER_ACTOR_GET_CLASS (actor)->paint_node (actor, root, paint_context);
+}
+
+static gboolean
+clutter_actor_paint_node (ClutterActor        *actor,
+                          ClutterPaintContext *paint_context)
+{
+  g_autoptr (ClutterPaintNode) root = NULL;
+  CoglFramebuffer *framebuffer;
+  GPtrArray *retained_nodes;
+  uint8_t paint_opacity;
+
+  framebuffer = clutter_paint_context_get_base_framebuffer (paint_context);
+  paint_opacity = clutter_actor_get_paint_opacity_internal (actor);
+
+  /* XXX - this will go away in 2.0, when we can get rid of this
+   * stuff and switch to a pure retained render tree of PaintNodes
+   * for the entire frame, starting from the Stage; the paint()
+   * virtual function can then be called directly.
+   */
+  root = _clutter_dummy_node_new (actor, framebuffer);
+  clutter_paint_node_set_static_name (root, "Root");
+
+  retained_nodes = clutter_actor_get_retained_paint_nodes (actor, paint_opacity);
+  if (retained_nodes != NULL)
+    {
+      unsigned int i;
+
+      for (i = 0; i < retained_nodes->len; i++)
+        clutter_paint_node_add_child (root, g_ptr_array_index (retained_nodes, i));
+    }
+  else
+    {
+      clutter_actor_build_paint_node (actor, root, paint_context);
+
+      /* Actors without background or content have nothing to retain */
+      if (clutter_paint_node_get_n_children (root) > 0 &&
+          clutter_actor_can_retain_paint_nodes (actor))
+        clutter_actor_retain_paint_nodes (actor, root, paint_opacity);
+    }
 
   if (clutter_paint_node_get_n_children (root) == 0)
     return FALSE;
@@ -3712,22 +3848,10 @@ clutter_actor_continue_paint (ClutterActor        *self,
      actual actor */
   if (priv->next_effect_to_paint == NULL)
     {
-      CoglFramebuffer *framebuffer;
-      g_autoptr (ClutterPaintNode) dummy = NULL;
-
-      /* XXX - this will go away in 2.0, when we can get rid of this
-       * stuff and switch to a pure retained render tree of PaintNodes
-       * for the entire frame, starting from the Stage; the paint()
-       * virtual function can then be called directly.
-       */
-      framebuffer = clutter_paint_context_get_base_framebuffer (paint_context);
-      dummy = _clutter_dummy_node_new (self, framebuffer);
-      clutter_paint_node_set_static_name (dummy, "Root");
-
       /* XXX - for 1.12, we use the return value of paint_node() to
        * decide whether we should call the paint() vfunc.
        */
-      clutter_actor_paint_node (self, dummy, paint_context);
+      clutter_actor_paint_node (self, paint_context);
 
       CLUTTER_ACTOR_GET_CLASS (self)->paint (self, paint_context);
     }
@@ -5452,6 +5576,8 @@ clutter_actor_dispose (GObject *object)
       g_clear_object (&priv->content);
     }
 
+  clutter_actor_clear_retained_paint_nodes (self);
+
   g_clear_pointer (&priv->clones, g_hash_table_unref);
   g_clear_pointer (&priv->stage_views, g_list_free);
   g_clear_pointer (&priv->next_redraw_clips, g_array_unref);
@@ -7707,6 +7833,8 @@ _clutter_actor_queue_redraw_full (ClutterActor             *self,
   ClutterActorPrivate *priv = self->priv;
   ClutterActor *stage;
 
+  clutter_actor_clear_retained_paint_nodes (self);
+
   /* ignore queueing a redraw for actors being destroyed */
   if (CLUTTER_ACTOR_IN_DESTRUCTION (self))
     return;
@@ -13185,42 +13313,6 @@ clutter_actor_grab_key_focus (ClutterActor *self)
 }
 
 #ifdef HAVE_FONTS
-static void
-update_pango_context (ClutterBackend *backend,
-                      PangoContext   *context)
-{
-  ClutterSettings *settings;
-  PangoFontDescription *font_desc;
-  ClutterTextDirection dir;
-  PangoDirection pango_dir;
-  g_autofree char *font_name = NULL;
-  gdouble resolution;
-
-  settings = clutter_context_get_settings (backend->context);
-
-  /* update the text direction */
-  dir = clutter_get_default_text_direction ();
-  pango_dir = clutter_text_direction_to_pango_direction (dir);
-
-  pango_context_set_base_dir (context, pango_dir);
-
-  g_object_get (settings, "font-name", &font_name, NULL);
-
-  /* get the configuration for the PangoContext from the backend */
-  resolution = clutter_backend_get_resolution (backend);
-
-  font_desc = pango_font_description_from_string (font_name);
-
-  if (resolution < 0)
-    resolution = 96.0; /* fall back */
-
-  pango_context_set_font_description (context, font_desc);
-  pango_cairo_context_set_font_options (context, backend->font_options);
-  pango_cairo_context_set_resolution (context, resolution);
-
-  pango_font_description_free (font_desc);
-}
-
 /**
  * clutter_actor_get_pango_context:
  * @self: a #ClutterActor
@@ -13258,13 +13350,15 @@ clutter_actor_get_pango_context (ClutterActor *self)
 
       priv->resolution_changed_id =
         g_signal_connect (backend, "resolution-changed",
-                          G_CALLBACK (update_pango_context), priv->pango_context);
+                          G_CALLBACK (clutter_backend_update_pango_context),
+                          priv->pango_context);
       priv->font_changed_id =
         g_signal_connect (backend, "font-changed",
-                          G_CALLBACK (update_pango_context), priv->pango_context);
+                          G_CALLBACK (clutter_backend_update_pango_context),
+                          priv->pango_context);
     }
   else
-    update_pango_context (backend, priv->pango_context);
+    clutter_backend_update_pango_context (backend, priv->pango_context);
 
   return priv->pango_context;
 }
@@ -13293,7 +13387,8 @@ clutter_actor_create_pango_context (ClutterActor *self)
   font_map = clutter_context_get_pango_fontmap (context);
 
   pango_context = pango_font_map_create_context (font_map);
-  update_pango_context (clutter_context_get_backend (context), pango_context);
+  clutter_backend_update_pango_context (clutter_context_get_backend (context),
+                                        pango_context);
   pango_context_set_language (pango_context, pango_language_get_default ());
 
   return pango_context;
@@ -18234,6 +18329,22 @@ _clutter_actor_detach_clone (ClutterActor *actor,
   g_signal_emit (actor, actor_signals[DECLONED], 0, clone);
 }
 
+/*< private >
+ * _clutter_actor_get_clones_redraw_serial:
+ * @actor: a #ClutterActor
+ *
+ * Retrieves a counter that changes every time the appearance of @actor,
+ * or of any of its children, changed in a way that requires its clones
+ * to be redrawn.
+ *
+ * Return value: the redraw serial of the clones of @actor
+ */
+unsigned int
+_clutter_actor_get_clones_redraw_serial (ClutterActor *actor)
+{
+  return actor->priv->clones_redraw_serial;
+}
+
 /**
  * clutter_actor_has_mapped_clones:
  * @self: a #ClutterActor
@@ -23,6 +23,7 @@
 
 #ifdef HAVE_FONTS
 #include <cairo.h>
+#include <pango/pango.h>
 #endif
 
 #include "clutter/clutter-backend.h"
@@ -139,4 +140,9 @@ gboolean clutter_backend_foreach_sprite (ClutterBackend               *backend,
 CLUTTER_EXPORT
 void clutter_backend_destroy (ClutterBackend *backend);
 
+#ifdef HAVE_FONTS
+void clutter_backend_update_pango_context (ClutterBackend *backend,
+                                           PangoContext   *context);
+#endif
+
 G_END_DECLS
@@ -55,6 +55,10 @@
 #include "clutter/clutter-stage-private.h"
 #include "clutter/clutter-stage-window.h"
 
+#ifdef HAVE_FONTS
+#include "clutter/pango/clutter-pango-private.h"
+#endif
+
 #include "cogl/cogl.h"
 
 enum
@@ -158,6 +162,42 @@ clutter_backend_real_resolution_changed (ClutterBackend *backend)
     pango_cairo_font_map_set_resolution (PANGO_CAIRO_FONT_MAP (context->font_map),
                                          resolution);
 }
+
+void
+clutter_backend_update_pango_context (ClutterBackend *backend,
+                                      PangoContext   *context)
+{
+  ClutterSettings *settings;
+  PangoFontDescription *font_desc;
+  ClutterTextDirection dir;
+  PangoDirection pango_dir;
+  g_autofree char *font_name = NULL;
+  gdouble resolution;
+
+  settings = clutter_context_get_settings (backend->context);
+
+  /* update the text direction */
+  dir = clutter_get_default_text_direction ();
+  pango_dir = clutter_text_direction_to_pango_direction (dir);
+
+  pango_context_set_base_dir (context, pango_dir);
+
+  g_object_get (settings, "font-name", &font_name, NULL);
+
+  /* get the configuration for the PangoContext from the backend */
+  resolution = clutter_backend_get_resolution (backend);
+
+  font_desc = pango_font_description_from_string (font_name);
+
+  if (resolution < 0)
+    resolution = 96.0; /* fall back */
+
+  pango_context_set_font_description (context, font_desc);
+  pango_cairo_context_set_font_options (context, backend->font_options);
+  pango_cairo_context_set_resolution (context, resolution);
+
+  pango_font_description_free (font_desc);
+}
 #endif
 
 static gboolean
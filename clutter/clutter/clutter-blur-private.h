@@ -19,19 +19,26 @@
 
 #include <glib-object.h>
 
+#include "clutter/clutter-macros.h"
 #include "cogl/cogl.h"
 
 G_BEGIN_DECLS
 
 typedef struct _ClutterBlur ClutterBlur;
 
+CLUTTER_EXPORT
 ClutterBlur * clutter_blur_new (CoglTexture *texture,
                                 float        radius);
 
+CLUTTER_EXPORT
 void clutter_blur_apply (ClutterBlur *blur);
 
+CLUTTER_EXPORT
 CoglTexture * clutter_blur_get_texture (ClutterBlur *blur);
 
+CLUTTER_EXPORT
 void clutter_blur_free (ClutterBlur *blur);
 
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (ClutterBlur, clutter_blur_free)
+
 G_END_DECLS
@@ -32,25 +32,59 @@
  * #ClutterClone can be used to efficiently clone any other actor.
  *
  * #ClutterClone does not require the presence of support for FBOs
- * in the underlying GL or GLES implementation.
+ * in the underlying GL or GLES implementation, unless
+ * [property@Clutter.Clone:use-snapshot] is set.
  */
 
 #include "config.h"
 
+#include <math.h>
+
 #include "clutter/clutter-actor-private.h"
 #include "clutter/clutter-clone.h"
 #include "clutter/clutter-debug.h"
 #include "clutter/clutter-main.h"
+#include "clutter/clutter-paint-nodes.h"
 #include "clutter/clutter-paint-volume-private.h"
 #include "clutter/clutter-private.h"
 
 #include "cogl/cogl.h"
 
+/* An image of a source actor, shared by all the clones of the source
+ * that use a snapshot. It is repainted when the source queued a redraw
+ * on its clones, and its resolution is the power of two scale of the
+ * source that is closest to, but not smaller than, the largest one the
+ * clones were painted at when it was last repainted. It is only
+ * repainted at a larger scale when a clone needs more detail than it
+ * holds.
+ */
+typedef struct _ClutterCloneSnapshot
+{
+  ClutterActor *source;
+  GList *clones;
+
+  CoglTexture *texture;
+  CoglFramebuffer *framebuffer;
+  ClutterColorState *color_state;
+
+  ClutterActorBox box;
+  float scale;
+  unsigned int redraw_serial;
+  gboolean valid;
+
+  /* The size of the last framebuffer that could not be allocated */
+  int failed_width;
+  int failed_height;
+} ClutterCloneSnapshot;
+
 typedef struct _ClutterClonePrivate
 {
   ClutterActor *clone_source;
   float x_scale, y_scale;
 
+  gboolean use_snapshot;
+  ClutterCloneSnapshot *snapshot;
+
   gulong source_destroy_id;
 } ClutterClonePrivate;
 
@@ -61,12 +95,15 @@ enum
   PROP_0,
 
   PROP_SOURCE,
+  PROP_USE_SNAPSHOT,
 
   PROP_LAST
 };
 
 static GParamSpec *obj_props[PROP_LAST];
 
+static GQuark quark_clone_snapshot = 0;
+
 static void clutter_clone_set_source_internal (ClutterClone *clone,
 					       ClutterActor *source);
 static void
@@ -119,6 +156,244 @@ clutter_clone_get_preferred_height (ClutterActor *self,
                                         natural_height_p);
 }
 
+static float
+clutter_clone_get_snapshot_scale (ClutterClone *self)
+{
+  ClutterClonePrivate *priv = clutter_clone_get_instance_private (self);
+  ClutterActor *actor = CLUTTER_ACTOR (self);
+  float width, height;
+  float source_width, source_height;
+  float scale = 1.f;
+
+  if (!clutter_actor_is_mapped (actor))
+    return 0.f;
+
+  clutter_actor_get_transformed_size (actor, &width, &height);
+  clutter_actor_get_size (priv->clone_source, &source_width, &source_height);
+
+  if (source_width > 0.f)
+    scale = width / source_width;
+  if (source_height > 0.f)
+    scale = MAX (scale, height / source_height);
+
+  return scale * clutter_actor_get_resource_scale (actor);
+}
+
+static void
+clutter_clone_snapshot_free (ClutterCloneSnapshot *snapshot)
+{
+  g_clear_object (&snapshot->framebuffer);
+  g_clear_object (&snapshot->texture);
+  g_clear_object (&snapshot->color_state);
+  g_list_free (snapshot->clones);
+  g_free (snapshot);
+}
+
+static gboolean
+clutter_clone_snapshot_ensure_framebuffer (ClutterCloneSnapshot *snapshot,
+                                           int                   width,
+                                           int                   height)
+{
+  ClutterContext *context;
+  ClutterBackend *backend;
+  CoglContext *cogl_context;
+  g_autoptr (CoglOffscreen) offscreen = NULL;
+  g_autoptr (CoglTexture) texture = NULL;
+  g_autoptr (GError) error = NULL;
+
+  if (snapshot->texture != NULL &&
+      cogl_texture_get_width (snapshot->texture) == width &&
+      cogl_texture_get_height (snapshot->texture) == height)
+    return TRUE;
+
+  /* Don't try again every frame, a larger framebuffer won't fit either */
+  if (snapshot->failed_width > 0 &&
+      width >= snapshot->failed_width &&
+      height >= snapshot->failed_height)
+    return FALSE;
+
+  g_clear_object (&snapshot->framebuffer);
+  g_clear_object (&snapshot->texture);
+
+  context = clutter_actor_get_context (snapshot->source);
+  backend = clutter_context_get_backend (context);
+  cogl_context = clutter_backend_get_cogl_context (backend);
+
+  texture = cogl_texture_2d_new_with_size (cogl_context, width, height);
+  offscreen = cogl_offscreen_new_with_texture (texture);
+  if (!cogl_framebuffer_allocate (COGL_FRAMEBUFFER (offscreen), &error))
+    {
+      CLUTTER_NOTE (PAINT, "Failed to allocate a %dx%d clone snapshot: %s",
+                    width, height, error->message);
+      snapshot->failed_width = width;
+      snapshot->failed_height = height;
+      return FALSE;
+    }
+
+  snapshot->failed_width = 0;
+  snapshot->failed_height = 0;
+
+  snapshot->texture = g_steal_pointer (&texture);
+  snapshot->framebuffer = COGL_FRAMEBUFFER (g_steal_pointer (&offscreen));
+
+  return TRUE;
+}
+
+static void
+clutter_clone_snapshot_paint_source (ClutterCloneSnapshot *snapshot)
+{
+  ClutterActor *source = snapshot->source;
+  ClutterPaintContext *paint_context;
+  CoglColor clear_color;
+  int opacity_override;
+
+  cogl_color_init_from_4f (&clear_color, 0.0f, 0.0f, 0.0f, 0.0f);
+  cogl_framebuffer_clear (snapshot->framebuffer, COGL_BUFFER_BIT_COLOR,
+                          &clear_color);
+  cogl_framebuffer_orthographic (snapshot->framebuffer,
+                                 snapshot->box.x1, snapshot->box.y1,
+                                 snapshot->box.x2, snapshot->box.y2,
+                                 -1.0f, 1.0f);
+
+  /* The source is set up for a clone paint by the clone painting the
+   * snapshot, but the opacity of the clones is applied when painting
+   * the snapshot itself.
+   */
+  opacity_override = clutter_actor_get_opacity_override (source);
+  clutter_actor_set_opacity_override (source, 255);
+
+  paint_context =
+    clutter_paint_context_new_for_framebuffer (snapshot->framebuffer, NULL,
+                                               CLUTTER_PAINT_FLAG_NONE,
+                                               snapshot->color_state);
+
+  _clutter_actor_push_clone_paint ();
+  clutter_actor_paint (source, paint_context);
+  _clutter_actor_pop_clone_paint ();
+
+  clutter_paint_context_destroy (paint_context);
+
+  clutter_actor_set_opacity_override (source, opacity_override);
+}
+
+static float
+round_snapshot_scale (float scale)
+{
+  if (scale <= 0.f)
+    return 1.f;
+
+  return exp2f (ceilf (log2f (scale)));
+}
+
+static gboolean
+clutter_clone_snapshot_update (ClutterCloneSnapshot *snapshot,
+                               ClutterClone         *clone)
+{
+  ClutterActor *source = snapshot->source;
+  const ClutterPaintVolume *volume;
+  ClutterColorState *color_state;
+  graphene_point3d_t origin;
+  ClutterActorBox box;
+  unsigned int redraw_serial;
+  float scale;
+  int width, height;
+  GList *l;
+
+  volume = clutter_actor_get_paint_volume (source);
+  if (volume == NULL)
+    return FALSE;
+
+  clutter_paint_volume_get_origin (volume, &origin);
+
+  /* The snapshot is painted with an orthographic projection, so children
+   * with a depth would lose the perspective they get from the stage */
+  if (!volume->is_2d || origin.z != 0.f)
+    return FALSE;
+
+  box.x1 = floorf (origin.x);
+  box.y1 = floorf (origin.y);
+  box.x2 = ceilf (origin.x + clutter_paint_volume_get_width (volume));
+  box.y2 = ceilf (origin.y + clutter_paint_volume_get_height (volume));
+
+  color_state = clutter_actor_get_color_state (source);
+  redraw_serial = _clutter_actor_get_clones_redraw_serial (source);
+  scale = round_snapshot_scale (clutter_clone_get_snapshot_scale (clone));
+
+  if (snapshot->valid &&
+      snapshot->redraw_serial == redraw_serial &&
+      snapshot->scale >= scale &&
+      snapshot->color_state == color_state &&
+      clutter_actor_box_equal (&snapshot->box, &box))
+    return TRUE;
+
+  /* Size the new snapshot for all the clones at once, so that the other
+   * clones painted in this frame can reuse it */
+  for (l = snapshot->clones; l != NULL; l = l->next)
+    {
+      if (l->data != clone)
+        scale = MAX (scale, clutter_clone_get_snapshot_scale (l->data));
+    }
+
+  scale = round_snapshot_scale (scale);
+
+  width = (int) ceilf ((box.x2 - box.x1) * scale);
+  height = (int) ceilf ((box.y2 - box.y1) * scale);
+  if (width <= 0 || height <= 0)
+    return FALSE;
+
+  snapshot->valid = FALSE;
+
+  if (!clutter_clone_snapshot_ensure_framebuffer (snapshot, width, height))
+    return FALSE;
+
+  snapshot->box = box;
+  snapshot->scale = scale;
+  snapshot->redraw_serial = redraw_serial;
+  g_set_object (&snapshot->color_state, color_state);
+
+  clutter_clone_snapshot_paint_source (snapshot);
+
+  snapshot->valid = TRUE;
+
+  return TRUE;
+}
+
+static gboolean
+clutter_clone_paint_snapshot (ClutterClone        *self,
+                              ClutterPaintContext *paint_context)
+{
+  ClutterClonePrivate *priv = clutter_clone_get_instance_private (self);
+  ClutterCloneSnapshot *snapshot = priv->snapshot;
+  g_autoptr (ClutterPaintNode) node = NULL;
+  ClutterActorBox box;
+  CoglColor color;
+
+  if (!clutter_clone_snapshot_update (snapshot, self))
+    return FALSE;
+
+  /* ClutterTextureNode will premultiply the blend color */
+  cogl_color_init_from_4f (&color, 1.0f, 1.0f, 1.0f,
+                           clutter_actor_get_paint_opacity (CLUTTER_ACTOR (self)) / 255.0f);
+
+  box.x1 = snapshot->box.x1 * priv->x_scale;
+  box.y1 = snapshot->box.y1 * priv->y_scale;
+  box.x2 = snapshot->box.x2 * priv->x_scale;
+  box.y2 = snapshot->box.y2 * priv->y_scale;
+
+  node = clutter_texture_node_new (snapshot->texture, &color,
+                                   CLUTTER_SCALING_FILTER_TRILINEAR,
+                                   CLUTTER_SCALING_FILTER_LINEAR);
+  clutter_paint_node_set_static_name (node, "Clone Snapshot");
+  clutter_paint_node_add_rectangle (node, &box);
+
+  clutter_paint_context_push_color_state (paint_context,
+                                          snapshot->color_state);
+  clutter_paint_node_paint (node, paint_context);
+  clutter_paint_context_pop_color_state (paint_context);
+
+  return TRUE;
+}
+
 static void
 clutter_clone_paint (ClutterActor        *actor,
                      ClutterPaintContext *paint_context)
@@ -153,9 +428,12 @@ clutter_clone_paint (ClutterActor        *actor,
     }
 
   /* If the source isn't ultimately parented to a toplevel, it can't be
-   * realized or painted.
+   * realized or painted. If no snapshot could be made, fall back to
+   * painting the source directly.
    */
-  if (clutter_actor_is_realized (priv->clone_source))
+  if (clutter_actor_is_realized (priv->clone_source) &&
+      (priv->snapshot == NULL ||
+       !clutter_clone_paint_snapshot (self, paint_context)))
     {
       CoglFramebuffer *fb = NULL;
 
@@ -309,6 +587,10 @@ clutter_clone_set_property (GObject      *gobject,
       clutter_clone_set_source (self, g_value_get_object (value));
       break;
 
+    case PROP_USE_SNAPSHOT:
+      clutter_clone_set_use_snapshot (self, g_value_get_boolean (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
       break;
@@ -330,6 +612,10 @@ clutter_clone_get_property (GObject    *gobject,
       g_value_set_object (value, priv->clone_source);
       break;
 
+    case PROP_USE_SNAPSHOT:
+      g_value_set_boolean (value, priv->use_snapshot);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
       break;
@@ -373,7 +659,32 @@ clutter_clone_class_init (ClutterCloneClass *klass)
                          G_PARAM_READWRITE |
                          G_PARAM_STATIC_STRINGS);
 
+  /**
+   * ClutterClone:use-snapshot:
+   *
+   * Whether the clone paints a snapshot of the source actor instead of
+   * painting the source actor itself.
+   *
+   * The snapshot is shared by all the clones of the same source that
+   * use one, and it is only repainted when the source changes, or when
+   * one of the clones needs more detail than it holds. This makes
+   * having many clones of the same actor cheap, at the cost of an
+   * offscreen buffer and of applying the opacity of the clone to the
+   * source as a whole.
+   *
+   * Sources with children transformed in 3D are still painted directly,
+   * as a flat snapshot could not reproduce their perspective.
+   */
+  obj_props[PROP_USE_SNAPSHOT] =
+    g_param_spec_boolean ("use-snapshot", NULL, NULL,
+                          FALSE,
+                          G_PARAM_READWRITE |
+                          G_PARAM_STATIC_STRINGS |
+                          G_PARAM_EXPLICIT_NOTIFY);
+
   g_object_class_install_properties (gobject_class, PROP_LAST, obj_props);
+
+  quark_clone_snapshot = g_quark_from_static_string ("-clutter-clone-snapshot");
 }
 
 static void
@@ -409,6 +720,43 @@ on_source_destroyed (ClutterActor *source,
   clutter_clone_set_source_internal (self, NULL);
 }
 
+static void
+clutter_clone_attach_snapshot (ClutterClone *self)
+{
+  ClutterClonePrivate *priv = clutter_clone_get_instance_private (self);
+  ClutterCloneSnapshot *snapshot;
+
+  snapshot = g_object_get_qdata (G_OBJECT (priv->clone_source),
+                                 quark_clone_snapshot);
+  if (snapshot == NULL)
+    {
+      snapshot = g_new0 (ClutterCloneSnapshot, 1);
+      snapshot->source = priv->clone_source;
+      g_object_set_qdata_full (G_OBJECT (priv->clone_source),
+                               quark_clone_snapshot,
+                               snapshot,
+                               (GDestroyNotify) clutter_clone_snapshot_free);
+    }
+
+  snapshot->clones = g_list_prepend (snapshot->clones, self);
+  priv->snapshot = snapshot;
+}
+
+static void
+clutter_clone_detach_snapshot (ClutterClone *self)
+{
+  ClutterClonePrivate *priv = clutter_clone_get_instance_private (self);
+  ClutterCloneSnapshot *snapshot = g_steal_pointer (&priv->snapshot);
+
+  if (snapshot == NULL)
+    return;
+
+  snapshot->clones = g_list_remove (snapshot->clones, self);
+  if (snapshot->clones == NULL)
+    g_object_set_qdata (G_OBJECT (priv->clone_source),
+                        quark_clone_snapshot, NULL);
+}
+
 static void
 clutter_clone_set_source_internal (ClutterClone *self,
 				   ClutterActor *source)
@@ -420,6 +768,7 @@ clutter_clone_set_source_internal (ClutterClone *self,
 
   if (priv->clone_source != NULL)
     {
+      clutter_clone_detach_snapshot (self);
       g_clear_signal_handler (&priv->source_destroy_id, priv->clone_source);
       _clutter_actor_detach_clone (priv->clone_source, CLUTTER_ACTOR (self));
 
@@ -432,6 +781,9 @@ clutter_clone_set_source_internal (ClutterClone *self,
       _clutter_actor_attach_clone (priv->clone_source, CLUTTER_ACTOR (self));
       priv->source_destroy_id = g_signal_connect (priv->clone_source, "destroy",
                                                   G_CALLBACK (on_source_destroyed), self);
+
+      if (priv->use_snapshot)
+        clutter_clone_attach_snapshot (self);
     }
 
   g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_SOURCE]);
@@ -475,3 +827,61 @@ clutter_clone_get_source (ClutterClone *self)
   priv = clutter_clone_get_instance_private (self);
   return priv->clone_source;
 }
+
+/**
+ * clutter_clone_set_use_snapshot:
+ * @self: a #ClutterClone
+ * @use_snapshot: whether to paint a snapshot of the source
+ *
+ * Sets whether @self paints a snapshot of its source actor, shared with
+ * the other clones of the source using one, instead of painting the
+ * source itself.
+ *
+ * See [property@Clutter.Clone:use-snapshot].
+ */
+void
+clutter_clone_set_use_snapshot (ClutterClone *self,
+                                gboolean      use_snapshot)
+{
+  ClutterClonePrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_CLONE (self));
+
+  priv = clutter_clone_get_instance_private (self);
+
+  if (priv->use_snapshot == use_snapshot)
+    return;
+
+  priv->use_snapshot = use_snapshot;
+
+  if (priv->clone_source != NULL)
+    {
+      if (use_snapshot)
+        clutter_clone_attach_snapshot (self);
+      else
+        clutter_clone_detach_snapshot (self);
+    }
+
+  clutter_actor_queue_redraw (CLUTTER_ACTOR (self));
+
+  g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_USE_SNAPSHOT]);
+}
+
+/**
+ * clutter_clone_get_use_snapshot:
+ * @self: a #ClutterClone
+ *
+ * Retrieves whether @self paints a snapshot of its source actor.
+ *
+ * Return value: %TRUE if @self paints a snapshot of its source
+ */
+gboolean
+clutter_clone_get_use_snapshot (ClutterClone *self)
+{
+  ClutterClonePrivate *priv;
+
+  g_return_val_if_fail (CLUTTER_IS_CLONE (self), FALSE);
+
+  priv = clutter_clone_get_instance_private (self);
+  return priv->use_snapshot;
+}
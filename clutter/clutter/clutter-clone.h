@@ -57,5 +57,10 @@ void            clutter_clone_set_source        (ClutterClone *self,
                                                  ClutterActor *source);
 CLUTTER_EXPORT
 ClutterActor *  clutter_clone_get_source        (ClutterClone *self);
+CLUTTER_EXPORT
+void            clutter_clone_set_use_snapshot  (ClutterClone *self,
+                                                 gboolean      use_snapshot);
+CLUTTER_EXPORT
+gboolean        clutter_clone_get_use_snapshot  (ClutterClone *self);
 
 G_END_DECLS
@@ -24,8 +24,13 @@
 #endif
 
 #include "clutter/clutter-context.h"
+#include "clutter/clutter-paint-node-private.h"
 #include "clutter-stage-manager-private.h"
 
+#ifdef HAVE_FONTS
+#include "clutter/pango/clutter-text-layout-cache.h"
+#endif
+
 struct _ClutterContext
 {
   GObject parent;
@@ -42,6 +47,7 @@ struct _ClutterContext
 #ifdef HAVE_FONTS
   PangoRenderer *font_renderer;
   PangoFontMap *font_map;
+  ClutterTextLayoutCache *text_layout_cache;
 #endif
 
   GSList *current_event;
@@ -51,6 +57,8 @@ struct _ClutterContext
 
   ClutterSettings *settings;
 
+  ClutterPaintNodePool *paint_node_pool;
+
   gboolean show_fps;
 };
 
@@ -65,4 +73,6 @@ PangoRenderer * clutter_context_get_font_renderer (ClutterContext *context);
  * clutter_context_get_pango_fontmap: (skip)
  */
 PangoFontMap * clutter_context_get_pango_fontmap (ClutterContext *context);
+
+ClutterTextLayoutCache * clutter_context_get_text_layout_cache (ClutterContext *context);
 #endif
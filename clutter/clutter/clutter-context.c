@@ -100,6 +100,7 @@ clutter_context_dispose (GObject *object)
   g_clear_object (&priv->default_color_state);
   g_clear_pointer (&context->events_queue, g_async_queue_unref);
 #ifdef HAVE_FONTS
+  g_clear_pointer (&context->text_layout_cache, clutter_text_layout_cache_free);
   g_clear_object (&context->font_map);
   g_clear_object (&context->font_renderer);
 #endif
@@ -108,6 +109,7 @@ clutter_context_dispose (GObject *object)
   g_clear_pointer (&context->backend, clutter_backend_destroy);
   g_clear_object (&context->stage_manager);
   g_clear_object (&context->settings);
+  g_clear_pointer (&context->paint_node_pool, clutter_paint_node_pool_unref);
 
   G_OBJECT_CLASS (clutter_context_parent_class)->dispose (object);
 }
@@ -281,6 +283,7 @@ clutter_context_new (ClutterBackendConstructor   backend_constructor,
                                  context->backend);
 
   context->stage_manager = g_object_new (CLUTTER_TYPE_STAGE_MANAGER, NULL);
+  context->paint_node_pool = clutter_paint_node_pool_new ();
 
   context->events_queue =
     g_async_queue_new_full ((GDestroyNotify) clutter_event_free);
@@ -340,6 +343,15 @@ clutter_context_get_font_renderer (ClutterContext *context)
 
   return context->font_renderer;
 }
+
+ClutterTextLayoutCache *
+clutter_context_get_text_layout_cache (ClutterContext *context)
+{
+  if (G_UNLIKELY (context->text_layout_cache == NULL))
+    context->text_layout_cache = clutter_text_layout_cache_new (context);
+
+  return context->text_layout_cache;
+}
 #endif
 
 ClutterTextDirection
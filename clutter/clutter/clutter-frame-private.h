@@ -21,6 +21,24 @@
 
 typedef void (* ClutterFrameRelease) (ClutterFrame *frame);
 
+/*
+ * ClutterFramePhase:
+ *
+ * The parts of producing a frame whose CPU time is accounted for on the
+ * #ClutterFrame. The journal flush time is also spent during painting and
+ * swapping, so it overlaps with those phases.
+ */
+typedef enum _ClutterFramePhase
+{
+  CLUTTER_FRAME_PHASE_LAYOUT,
+  CLUTTER_FRAME_PHASE_CULL,
+  CLUTTER_FRAME_PHASE_PAINT,
+  CLUTTER_FRAME_PHASE_FLUSH,
+  CLUTTER_FRAME_PHASE_SWAP,
+
+  CLUTTER_N_FRAME_PHASES
+} ClutterFramePhase;
+
 struct _ClutterFrame
 {
   grefcount ref_count;
@@ -39,6 +57,8 @@ struct _ClutterFrame
   ClutterFrameResult result;
 
   CoglFrameInfo *cogl_frame_info;
+
+  int64_t phase_time_us[CLUTTER_N_FRAME_PHASES];
 };
 
 CLUTTER_EXPORT
@@ -50,3 +70,12 @@ gpointer clutter_frame_new (size_t              size,
 
 CLUTTER_EXPORT
 ClutterFrameResult clutter_frame_get_result (ClutterFrame *frame);
+
+CLUTTER_EXPORT
+void clutter_frame_add_phase_time (ClutterFrame      *frame,
+                                   ClutterFramePhase  phase,
+                                   int64_t            time_us);
+
+CLUTTER_EXPORT
+int64_t clutter_frame_get_phase_time (ClutterFrame      *frame,
+                                      ClutterFramePhase  phase);
@@ -131,3 +131,22 @@ clutter_frame_set_result (ClutterFrame       *frame,
   frame->result = result;
   frame->has_result = TRUE;
 }
+
+void
+clutter_frame_add_phase_time (ClutterFrame      *frame,
+                              ClutterFramePhase  phase,
+                              int64_t            time_us)
+{
+  g_return_if_fail (phase < CLUTTER_N_FRAME_PHASES);
+
+  frame->phase_time_us[phase] += time_us;
+}
+
+int64_t
+clutter_frame_get_phase_time (ClutterFrame      *frame,
+                              ClutterFramePhase  phase)
+{
+  g_return_val_if_fail (phase < CLUTTER_N_FRAME_PHASES, 0);
+
+  return frame->phase_time_us[phase];
+}
@@ -37,6 +37,7 @@ G_BEGIN_DECLS
 #define CLUTTER_PAINT_NODE_GET_CLASS(obj)       (G_TYPE_INSTANCE_GET_CLASS ((obj), CLUTTER_TYPE_PAINT_NODE, ClutterPaintNodeClass))
 
 typedef struct _ClutterPaintOperation   ClutterPaintOperation;
+typedef struct _ClutterPaintNodePool    ClutterPaintNodePool;
 
 struct _ClutterPaintNode
 {
@@ -51,6 +52,8 @@ struct _ClutterPaintNode
 
   GArray *operations;
 
+  ClutterPaintNodePool *pool;
+
   const gchar *name;
 
   guint n_children;
@@ -102,6 +105,16 @@ GType _clutter_dummy_node_get_type (void);
 void                    clutter_paint_node_init_types                   (ClutterBackend *clutter_backend);
 gpointer                _clutter_paint_node_create                      (GType gtype);
 
+ClutterPaintNodePool *  clutter_paint_node_pool_new                     (void);
+
+void                    clutter_paint_node_pool_unref                   (ClutterPaintNodePool *pool);
+
+void                    clutter_paint_node_pool_end_frame               (ClutterContext   *context,
+                                                                         ClutterStageView *view);
+
+CLUTTER_EXPORT_TEST
+unsigned int            clutter_paint_node_get_n_frame_allocations      (void);
+
 ClutterPaintNode *      _clutter_dummy_node_new                         (ClutterActor                *actor,
                                                                          CoglFramebuffer             *framebuffer);
 G_GNUC_INTERNAL
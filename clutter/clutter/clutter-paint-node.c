@@ -53,15 +53,248 @@
 
 #include "cogl/cogl.h"
 #include "clutter/clutter-paint-node-private.h"
+#include "clutter/clutter-context-private.h"
 #include "clutter/clutter-debug.h"
 #include "clutter/clutter-private.h"
 
 
-static inline void      clutter_paint_operation_clear   (ClutterPaintOperation *op);
+static inline void      clutter_paint_operation_clear   (ClutterPaintNodePool  *pool,
+                                                         ClutterPaintOperation *op);
 
 static void clutter_paint_node_remove_child (ClutterPaintNode *node,
                                              ClutterPaintNode *child);
 
+/* Paint nodes are rebuilt every frame, so the operation and coordinate
+ * arrays backing them are recycled instead of being freed and allocated
+ * again. Each ClutterContext has its own pool, referenced by the nodes
+ * created for it, so nodes outliving the context can still release their
+ * arrays.
+ *
+ * Stage views are painted one after the other, each on its own frame
+ * clock, and all of them draw from the same pool. After each view is
+ * painted, the pool is trimmed to the number of arrays used by the last
+ * paint of the busiest view. Arrays that grew past MAX_POOLED_ARRAY_SIZE
+ * bytes are freed rather than pooled, so that neither a transient spike
+ * in the number of nodes nor a single huge node keeps memory around
+ * forever.
+ */
+#define MAX_POOLED_ARRAY_SIZE (16 * 1024)
+
+typedef enum _ArrayPoolType
+{
+  ARRAY_POOL_OPERATIONS,
+  ARRAY_POOL_COORDS,
+
+  N_ARRAY_POOLS
+} ArrayPoolType;
+
+typedef struct _ClutterPaintNodeArrayPool
+{
+  GPtrArray *free_arrays;
+  unsigned int n_frame_acquired;
+} ClutterPaintNodeArrayPool;
+
+/* What the last paint of a view took from the pool */
+typedef struct _ClutterPaintNodeViewUsage
+{
+  unsigned int n_acquired[N_ARRAY_POOLS];
+  unsigned int n_allocations;
+} ClutterPaintNodeViewUsage;
+
+struct _ClutterPaintNodePool
+{
+  grefcount ref_count;
+
+  ClutterPaintNodeArrayPool array_pools[N_ARRAY_POOLS];
+
+  unsigned int n_allocations;
+
+  /* ClutterStageView -> ClutterPaintNodeViewUsage */
+  GHashTable *view_usages;
+};
+
+static GArray *
+array_pool_acquire (ClutterPaintNodePool *pool,
+                    ArrayPoolType         type,
+                    unsigned int          element_size,
+                    unsigned int          reserved_size)
+{
+  ClutterPaintNodeArrayPool *array_pool;
+
+  if (pool == NULL)
+    return g_array_sized_new (FALSE, FALSE, element_size, reserved_size);
+
+  array_pool = &pool->array_pools[type];
+  array_pool->n_frame_acquired++;
+
+  if (array_pool->free_arrays != NULL && array_pool->free_arrays->len > 0)
+    return g_ptr_array_steal_index_fast (array_pool->free_arrays,
+                                         array_pool->free_arrays->len - 1);
+
+  pool->n_allocations++;
+
+  return g_array_sized_new (FALSE, FALSE, element_size, reserved_size);
+}
+
+static void
+array_pool_release (ClutterPaintNodePool *pool,
+                    ArrayPoolType         type,
+                    GArray               *array)
+{
+  ClutterPaintNodeArrayPool *array_pool;
+  size_t size = (size_t) array->len * g_array_get_element_size (array);
+
+  if (pool == NULL || size > MAX_POOLED_ARRAY_SIZE)
+    {
+      g_array_unref (array);
+      return;
+    }
+
+  array_pool = &pool->array_pools[type];
+  if (array_pool->free_arrays == NULL)
+    array_pool->free_arrays = g_ptr_array_new_with_free_func ((GDestroyNotify) g_array_unref);
+
+  g_array_set_size (array, 0);
+  g_ptr_array_add (array_pool->free_arrays, array);
+}
+
+static void
+array_pool_trim (ClutterPaintNodeArrayPool *array_pool,
+                 unsigned int               n_arrays)
+{
+  if (array_pool->free_arrays != NULL &&
+      array_pool->free_arrays->len > n_arrays)
+    g_ptr_array_set_size (array_pool->free_arrays, n_arrays);
+}
+
+static void
+on_view_finalized (gpointer  user_data,
+                   GObject  *view)
+{
+  ClutterPaintNodePool *pool = user_data;
+
+  g_hash_table_remove (pool->view_usages, view);
+}
+
+ClutterPaintNodePool *
+clutter_paint_node_pool_new (void)
+{
+  ClutterPaintNodePool *pool;
+
+  pool = g_new0 (ClutterPaintNodePool, 1);
+  g_ref_count_init (&pool->ref_count);
+  pool->view_usages = g_hash_table_new_full (NULL, NULL, NULL, g_free);
+
+  return pool;
+}
+
+static ClutterPaintNodePool *
+clutter_paint_node_pool_ref (ClutterPaintNodePool *pool)
+{
+  g_ref_count_inc (&pool->ref_count);
+
+  return pool;
+}
+
+void
+clutter_paint_node_pool_unref (ClutterPaintNodePool *pool)
+{
+  GHashTableIter iter;
+  gpointer view;
+  int i;
+
+  if (!g_ref_count_dec (&pool->ref_count))
+    return;
+
+  g_hash_table_iter_init (&iter, pool->view_usages);
+  while (g_hash_table_iter_next (&iter, &view, NULL))
+    g_object_weak_unref (view, on_view_finalized, pool);
+  g_hash_table_destroy (pool->view_usages);
+
+  for (i = 0; i < N_ARRAY_POOLS; i++)
+    g_clear_pointer (&pool->array_pools[i].free_arrays, g_ptr_array_unref);
+
+  g_free (pool);
+}
+
+/*< private >
+ * clutter_paint_node_pool_end_frame:
+ * @context: a #ClutterContext
+ * @view: the #ClutterStageView that was painted
+ *
+ * Marks the end of the paint of @view for the paint node array pool of
+ * @context. The pool is trimmed to the number of arrays used by the last
+ * paint of the view that used the most, and the number of allocations
+ * done while painting @view is made available through
+ * clutter_paint_node_get_n_frame_allocations().
+ */
+void
+clutter_paint_node_pool_end_frame (ClutterContext   *context,
+                                   ClutterStageView *view)
+{
+  ClutterPaintNodePool *pool = context->paint_node_pool;
+  ClutterPaintNodeViewUsage *usage;
+  unsigned int n_arrays[N_ARRAY_POOLS] = { 0, };
+  GHashTableIter iter;
+  int i;
+
+  if (pool == NULL)
+    return;
+
+  usage = g_hash_table_lookup (pool->view_usages, view);
+  if (usage == NULL)
+    {
+      usage = g_new0 (ClutterPaintNodeViewUsage, 1);
+      g_hash_table_insert (pool->view_usages, view, usage);
+      g_object_weak_ref (G_OBJECT (view), on_view_finalized, pool);
+    }
+
+  for (i = 0; i < N_ARRAY_POOLS; i++)
+    {
+      usage->n_acquired[i] = pool->array_pools[i].n_frame_acquired;
+      pool->array_pools[i].n_frame_acquired = 0;
+    }
+
+  usage->n_allocations = pool->n_allocations;
+  pool->n_allocations = 0;
+
+  g_hash_table_iter_init (&iter, pool->view_usages);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &usage))
+    {
+      for (i = 0; i < N_ARRAY_POOLS; i++)
+        n_arrays[i] = MAX (n_arrays[i], usage->n_acquired[i]);
+    }
+
+  for (i = 0; i < N_ARRAY_POOLS; i++)
+    array_pool_trim (&pool->array_pools[i], n_arrays[i]);
+}
+
+/*< private >
+ * clutter_paint_node_get_n_frame_allocations:
+ *
+ * Retrieves the number of paint nodes and operation arrays that had to be
+ * allocated for the default context during the last paint of each stage
+ * view, i.e. that could not be recycled.
+ *
+ * Return value: the number of allocations of the last frame of all views
+ */
+unsigned int
+clutter_paint_node_get_n_frame_allocations (void)
+{
+  ClutterContext *context = _clutter_context_get_default ();
+  ClutterPaintNodeViewUsage *usage;
+  unsigned int n_allocations = 0;
+  GHashTableIter iter;
+
+  g_return_val_if_fail (context->paint_node_pool != NULL, 0);
+
+  g_hash_table_iter_init (&iter, context->paint_node_pool->view_usages);
+  while (g_hash_table_iter_next (&iter, NULL, (gpointer *) &usage))
+    n_allocations += usage->n_allocations;
+
+  return n_allocations;
+}
+
 static void
 value_paint_node_init (GValue *value)
 {
@@ -167,10 +400,11 @@ clutter_paint_node_real_finalize (ClutterPaintNode *node)
           ClutterPaintOperation *op;
 
           op = &g_array_index (node->operations, ClutterPaintOperation, i);
-          clutter_paint_operation_clear (op);
+          clutter_paint_operation_clear (node->pool, op);
         }
 
-      g_array_unref (node->operations);
+      array_pool_release (node->pool, ARRAY_POOL_OPERATIONS,
+                          g_steal_pointer (&node->operations));
     }
 
   iter = node->first_child;
@@ -183,6 +417,8 @@ clutter_paint_node_real_finalize (ClutterPaintNode *node)
       iter = next;
     }
 
+  g_clear_pointer (&node->pool, clutter_paint_node_pool_unref);
+
   g_type_free_instance ((GTypeInstance *) node);
 }
 
@@ -558,7 +794,8 @@ clutter_value_dup_paint_node (const GValue *value)
 }
 
 static inline void
-clutter_paint_operation_clear (ClutterPaintOperation *op)
+clutter_paint_operation_clear (ClutterPaintNodePool  *pool,
+                               ClutterPaintOperation *op)
 {
   switch (op->opcode)
     {
@@ -570,7 +807,9 @@ clutter_paint_operation_clear (ClutterPaintOperation *op)
 
     case PAINT_OP_TEX_RECTS:
     case PAINT_OP_MULTITEX_RECT:
-      g_clear_pointer (&op->coords, g_array_unref);
+      if (op->coords != NULL)
+        array_pool_release (pool, ARRAY_POOL_COORDS,
+                            g_steal_pointer (&op->coords));
       break;
 
     case PAINT_OP_PRIMITIVE:
@@ -581,14 +820,15 @@ clutter_paint_operation_clear (ClutterPaintOperation *op)
 }
 
 static inline void
-clutter_paint_op_init_tex_rect (ClutterPaintOperation *op,
+clutter_paint_op_init_tex_rect (ClutterPaintNodePool  *pool,
+                                ClutterPaintOperation *op,
                                 const ClutterActorBox *rect,
                                 float                  x_1,
                                 float                  y_1,
                                 float                  x_2,
                                 float                  y_2)
 {
-  clutter_paint_operation_clear (op);
+  clutter_paint_operation_clear (pool, op);
 
   op->opcode = PAINT_OP_TEX_RECT;
   op->op.texrect[0] = rect->x1;
@@ -602,17 +842,19 @@ clutter_paint_op_init_tex_rect (ClutterPaintOperation *op,
 }
 
 static inline void
-clutter_paint_op_init_tex_rects (ClutterPaintOperation *op,
+clutter_paint_op_init_tex_rects (ClutterPaintNodePool  *pool,
+                                 ClutterPaintOperation *op,
                                  const float           *coords,
                                  unsigned int           n_rects,
                                  gboolean               use_default_tex_coords)
 {
   const unsigned int n_floats = n_rects * 8;
 
-  clutter_paint_operation_clear (op);
+  clutter_paint_operation_clear (pool, op);
 
   op->opcode = PAINT_OP_TEX_RECTS;
-  op->coords = g_array_sized_new (FALSE, FALSE, sizeof (float), n_floats);
+  op->coords = array_pool_acquire (pool, ARRAY_POOL_COORDS,
+                                   sizeof (float), n_floats);
 
   if (use_default_tex_coords)
     {
@@ -632,17 +874,17 @@ clutter_paint_op_init_tex_rects (ClutterPaintOperation *op,
 }
 
 static inline void
-clutter_paint_op_init_multitex_rect (ClutterPaintOperation *op,
+clutter_paint_op_init_multitex_rect (ClutterPaintNodePool  *pool,
+                                     ClutterPaintOperation *op,
                                      const ClutterActorBox *rect,
                                      const float           *tex_coords,
                                      unsigned int           tex_coords_len)
 {
-  clutter_paint_operation_clear (op);
+  clutter_paint_operation_clear (pool, op);
 
   op->opcode = PAINT_OP_MULTITEX_RECT;
-  op->coords = g_array_sized_new (FALSE, FALSE,
-                                  sizeof (float),
-                                  tex_coords_len);
+  op->coords = array_pool_acquire (pool, ARRAY_POOL_COORDS,
+                                   sizeof (float), tex_coords_len);
 
   g_array_append_vals (op->coords, tex_coords, tex_coords_len);
 
@@ -653,10 +895,11 @@ clutter_paint_op_init_multitex_rect (ClutterPaintOperation *op,
 }
 
 static inline void
-clutter_paint_op_init_primitive (ClutterPaintOperation *op,
+clutter_paint_op_init_primitive (ClutterPaintNodePool  *pool,
+                                 ClutterPaintOperation *op,
                                  CoglPrimitive         *primitive)
 {
-  clutter_paint_operation_clear (op);
+  clutter_paint_operation_clear (pool, op);
 
   op->opcode = PAINT_OP_PRIMITIVE;
   op->op.primitive = g_object_ref (primitive);
@@ -668,8 +911,9 @@ clutter_paint_node_maybe_init_operations (ClutterPaintNode *node)
   if (node->operations != NULL)
     return;
 
-  node->operations =
-    g_array_new (FALSE, FALSE, sizeof (ClutterPaintOperation));
+  node->operations = array_pool_acquire (node->pool, ARRAY_POOL_OPERATIONS,
+                                         sizeof (ClutterPaintOperation),
+                                         0);
 }
 
 /**
@@ -691,7 +935,8 @@ clutter_paint_node_add_rectangle (ClutterPaintNode      *node,
 
   clutter_paint_node_maybe_init_operations (node);
 
-  clutter_paint_op_init_tex_rect (&operation, rect, 0.0, 0.0, 1.0, 1.0);
+  clutter_paint_op_init_tex_rect (node->pool, &operation,
+                                  rect, 0.0, 0.0, 1.0, 1.0);
   g_array_append_val (node->operations, operation);
 }
 
@@ -721,7 +966,8 @@ clutter_paint_node_add_texture_rectangle (ClutterPaintNode      *node,
 
   clutter_paint_node_maybe_init_operations (node);
 
-  clutter_paint_op_init_tex_rect (&operation, rect, x_1, y_1, x_2, y_2);
+  clutter_paint_op_init_tex_rect (node->pool, &operation,
+                                  rect, x_1, y_1, x_2, y_2);
   g_array_append_val (node->operations, operation);
 }
 
@@ -748,7 +994,8 @@ clutter_paint_node_add_multitexture_rectangle (ClutterPaintNode      *node,
 
   clutter_paint_node_maybe_init_operations (node);
 
-  clutter_paint_op_init_multitex_rect (&operation, rect, text_coords, text_coords_len);
+  clutter_paint_op_init_multitex_rect (node->pool, &operation,
+                                       rect, text_coords, text_coords_len);
   g_array_append_val (node->operations, operation);
 }
 
@@ -782,7 +1029,8 @@ clutter_paint_node_add_rectangles (ClutterPaintNode *node,
 
   clutter_paint_node_maybe_init_operations (node);
 
-  clutter_paint_op_init_tex_rects (&operation, coords, n_rects, TRUE);
+  clutter_paint_op_init_tex_rects (node->pool, &operation,
+                                   coords, n_rects, TRUE);
   g_array_append_val (node->operations, operation);
 }
 
@@ -816,7 +1064,8 @@ clutter_paint_node_add_texture_rectangles (ClutterPaintNode *node,
 
   clutter_paint_node_maybe_init_operations (node);
 
-  clutter_paint_op_init_tex_rects (&operation, coords, n_rects, FALSE);
+  clutter_paint_op_init_tex_rects (node->pool, &operation,
+                                   coords, n_rects, FALSE);
   g_array_append_val (node->operations, operation);
 }
 
@@ -841,7 +1090,7 @@ clutter_paint_node_add_primitive (ClutterPaintNode *node,
 
   clutter_paint_node_maybe_init_operations (node);
 
-  clutter_paint_op_init_primitive (&operation, primitive);
+  clutter_paint_op_init_primitive (node->pool, &operation, primitive);
   g_array_append_val (node->operations, operation);
 }
 
@@ -892,9 +1141,20 @@ clutter_paint_node_paint (ClutterPaintNode    *node,
 gpointer
 _clutter_paint_node_create (GType gtype)
 {
+  ClutterContext *context = _clutter_context_get_default ();
+  ClutterPaintNode *node;
+
   g_return_val_if_fail (g_type_is_a (gtype, CLUTTER_TYPE_PAINT_NODE), NULL);
 
-  return (gpointer) g_type_create_instance (gtype);
+  node = (ClutterPaintNode *) g_type_create_instance (gtype);
+
+  if (context->paint_node_pool != NULL)
+    {
+      node->pool = clutter_paint_node_pool_ref (context->paint_node_pool);
+      node->pool->n_allocations++;
+    }
+
+  return node;
 }
 
 /**
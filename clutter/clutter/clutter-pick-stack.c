@@ -41,6 +41,11 @@ typedef struct
 {
   Record base;
   int prev;
+
+  /* Whether this clip and all its parents intersect the ray of the
+   * search identified by search_serial */
+  unsigned int search_serial;
+  gboolean intersects;
 } PickClipRecord;
 
 struct _ClutterPickStack
@@ -52,6 +57,8 @@ struct _ClutterPickStack
   GArray *clip_stack;
   int current_clip_stack_top;
 
+  unsigned int search_serial;
+
   gboolean sealed : 1;
 };
 
@@ -185,30 +192,43 @@ ray_intersects_input_region (Record                   *rec,
     }
 }
 
+/* Clip records are shared by every actor painted inside them, so the
+ * result for a whole chain of clips is only computed once per search.
+ */
 static gboolean
-ray_intersects_record (ClutterPickStack         *pick_stack,
-                       PickRecord               *rec,
+clip_chain_intersects (ClutterPickStack         *pick_stack,
+                       int                       clip_index,
                        const graphene_point3d_t *point,
                        const graphene_ray_t     *ray)
 {
-  int clip_index;
+  PickClipRecord *clip;
 
-  if (!ray_intersects_input_region (&rec->base, ray, point))
-    return FALSE;
+  if (clip_index < 0)
+    return TRUE;
+
+  clip = &g_array_index (pick_stack->clip_stack, PickClipRecord, clip_index);
 
-  clip_index = rec->clip_index;
-  while (clip_index >= 0)
+  if (clip->search_serial != pick_stack->search_serial)
     {
-      PickClipRecord *clip =
-        &g_array_index (pick_stack->clip_stack, PickClipRecord, clip_index);
+      clip->search_serial = pick_stack->search_serial;
+      clip->intersects =
+        ray_intersects_input_region (&clip->base, ray, point) &&
+        clip_chain_intersects (pick_stack, clip->prev, point, ray);
+    }
 
-      if (!ray_intersects_input_region (&clip->base, ray, point))
-        return FALSE;
+  return clip->intersects;
+}
 
-      clip_index = clip->prev;
-    }
+static gboolean
+ray_intersects_record (ClutterPickStack         *pick_stack,
+                       PickRecord               *rec,
+                       const graphene_point3d_t *point,
+                       const graphene_ray_t     *ray)
+{
+  if (!ray_intersects_input_region (&rec->base, ray, point))
+    return FALSE;
 
-  return TRUE;
+  return clip_chain_intersects (pick_stack, rec->clip_index, point, ray);
 }
 
 static void
@@ -380,6 +400,8 @@ clutter_pick_stack_push_clip (ClutterPickStack      *pick_stack,
   g_assert (!pick_stack->sealed);
 
   clip.prev = pick_stack->current_clip_stack_top;
+  clip.search_serial = 0;
+  clip.intersects = FALSE;
   clip.base.rect = *box;
   clip.base.projected = FALSE;
   clip.base.matrix_entry = cogl_matrix_stack_get_entry (pick_stack->matrix_stack);
@@ -527,9 +549,16 @@ clutter_pick_stack_search_actor (ClutterPickStack          *pick_stack,
 {
   int i;
 
+  /* Serials start at 1 so that freshly pushed clips are never considered
+   * tested */
+  pick_stack->search_serial++;
+  if (pick_stack->search_serial == 0)
+    pick_stack->search_serial++;
+
   /* Search all "painted" pickable actors from front to back. A linear search
-   * is required, and also performs fine since there is typically only
-   * on the order of dozens of actors in the list (on screen) at a time.
+   * is required, and also performs fine since actors whose paint volume
+   * doesn't intersect the ray are already culled when the stack is built,
+   * leaving only overlap markers for them.
    */
   for (i = pick_stack->vertices_stack->len - 1; i >= 0; i--)
     {
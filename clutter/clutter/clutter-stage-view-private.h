@@ -27,7 +27,8 @@ void clutter_stage_view_after_paint (ClutterStageView *view,
 
 CLUTTER_EXPORT
 void clutter_stage_view_before_swap_buffer (ClutterStageView *view,
-                                            const MtkRegion  *swap_region);
+                                            const MtkRegion  *swap_region,
+                                            int               buffer_age);
 
 gboolean clutter_stage_view_is_dirty_viewport (ClutterStageView *view);
 
@@ -84,6 +84,7 @@ typedef struct _ClutterStageViewPrivate
   gboolean use_shadowfb;
   struct {
     CoglOffscreen *framebuffer;
+    ClutterDamageHistory *damage_history;
   } shadow;
 
   CoglScanout *next_scanout;
@@ -506,6 +507,7 @@ init_shadowfb (ClutterStageView *view)
     }
 
   priv->shadow.framebuffer = offscreen;
+  priv->shadow.damage_history = clutter_damage_history_new ();
   return;
 }
 
@@ -544,38 +546,106 @@ clutter_stage_view_after_paint (ClutterStageView *view,
 
 static void
 copy_shadowfb_to_onscreen (ClutterStageView *view,
-                           const MtkRegion  *swap_region)
+                           const MtkRegion  *swap_region,
+                           int               buffer_age)
 {
   ClutterStageViewPrivate *priv =
     clutter_stage_view_get_instance_private (view);
   CoglFramebuffer *shadowfb = COGL_FRAMEBUFFER (priv->shadow.framebuffer);
+  ClutterDamageHistory *damage_history = priv->shadow.damage_history;
+  MtkRectangle full_damage = {
+    .width = cogl_framebuffer_get_width (priv->framebuffer),
+    .height = cogl_framebuffer_get_height (priv->framebuffer),
+  };
   g_autoptr (MtkRegion) damage_region = NULL;
+  g_autoptr (MtkRegion) blit_region = NULL;
   g_autoptr (GError) error = NULL;
 
+  COGL_TRACE_DEFINE_COUNTER_INT (ShadowfbBlitArea,
+                                 "ShadowFB blit area",
+                                 "Number of pixels copied from the shadow "
+                                 "framebuffer to the onscreen");
+
   if (mtk_region_is_empty (swap_region))
+    damage_region = mtk_region_create_rectangle (&full_damage);
+  else
+    damage_region = mtk_region_copy (swap_region);
+
+  /* The shadow framebuffer always holds the complete frame, but the
+   * onscreen back buffer we are about to copy into was last written
+   * buffer_age frames ago, so it also misses whatever changed in the
+   * frames in between. An age of 1 means it holds the previous frame,
+   * so nothing but the current damage needs to be copied. */
+  if (buffer_age == 1)
     {
-      MtkRectangle full_damage = {
-        .width = cogl_framebuffer_get_width (priv->framebuffer),
-        .height = cogl_framebuffer_get_height (priv->framebuffer),
-      };
-      damage_region = mtk_region_create_rectangle (&full_damage);
+      blit_region = mtk_region_ref (damage_region);
+    }
+  else if (buffer_age > 1 &&
+           clutter_damage_history_is_age_valid (damage_history,
+                                                buffer_age - 1))
+    {
+      int age;
+
+      blit_region = mtk_region_copy (damage_region);
+      for (age = 1; age < buffer_age; age++)
+        {
+          mtk_region_union (blit_region,
+                            clutter_damage_history_lookup (damage_history,
+                                                           age));
+        }
     }
   else
     {
-      damage_region = mtk_region_copy (swap_region);
+      blit_region = mtk_region_create_rectangle (&full_damage);
+    }
+
+  clutter_damage_history_record (damage_history, damage_region);
+  clutter_damage_history_step (damage_history);
+
+#ifdef HAVE_PROFILER
+  if (G_UNLIKELY (cogl_is_tracing_enabled ()))
+    {
+      int n_rects, i;
+      int area = 0;
+
+      n_rects = mtk_region_num_rectangles (blit_region);
+      for (i = 0; i < n_rects; i++)
+        {
+          MtkRectangle rect = mtk_region_get_rectangle (blit_region, i);
+
+          area += mtk_rectangle_area (&rect);
+        }
+
+      COGL_TRACE_SET_COUNTER_INT (ShadowfbBlitArea, area);
     }
+#endif
+
+  /* The copy is the only thing rendering to the onscreen, so let it know
+   * what the copy is going to touch. */
+  if (COGL_IS_ONSCREEN (priv->framebuffer))
+    cogl_onscreen_queue_damage_region (COGL_ONSCREEN (priv->framebuffer),
+                                       blit_region);
 
   if (!cogl_framebuffer_blit_region (shadowfb,
                                      priv->framebuffer,
-                                     damage_region,
+                                     blit_region,
                                      0, 0,
                                      &error))
     g_warning ("Failed to blit shadow buffer: %s", error->message);
 }
 
+/**
+ * clutter_stage_view_before_swap_buffer: (skip)
+ * @view: a #ClutterStageView
+ * @swap_region: the region that changed since the previous frame, in
+ *   onscreen coordinates, or an empty region if everything changed
+ * @buffer_age: the age of the onscreen back buffer as defined by
+ *   EGL_EXT_buffer_age, with 0 meaning its content is undefined
+ */
 void
 clutter_stage_view_before_swap_buffer (ClutterStageView *view,
-                                       const MtkRegion  *swap_region)
+                                       const MtkRegion  *swap_region,
+                                       int               buffer_age)
 {
   ClutterStageViewPrivate *priv =
     clutter_stage_view_get_instance_private (view);
@@ -584,7 +654,7 @@ clutter_stage_view_before_swap_buffer (ClutterStageView *view,
                            "Clutter::StageView::before_swap_buffer()");
 
   if (priv->shadow.framebuffer)
-    copy_shadowfb_to_onscreen (view, swap_region);
+    copy_shadowfb_to_onscreen (view, swap_region, buffer_age);
 }
 
 float
@@ -1019,6 +1089,21 @@ handle_frame_clock_frame (ClutterFrameClock *frame_clock,
   ClutterStage *stage = priv->stage;
   ClutterStageWindow *stage_window = _clutter_stage_get_window (stage);
   ClutterContext *context = clutter_actor_get_context (CLUTTER_ACTOR (stage));
+  CoglContext *cogl_context;
+  unsigned int n_built_programs;
+  unsigned int n_loaded_programs;
+  int64_t journal_flush_time_us;
+  int64_t start_time_us;
+
+  COGL_TRACE_DEFINE_COUNTER_INT (PipelinesCompiledDuringFrame,
+                                 "Pipelines compiled during frame",
+                                 "Number of GPU programs built while "
+                                 "painting a frame");
+  COGL_TRACE_DEFINE_COUNTER_INT (PipelinesLoadedDuringFrame,
+                                 "Pipelines loaded during frame",
+                                 "Number of GPU programs loaded from the "
+                                 "program binary cache while painting a "
+                                 "frame");
 
   if (CLUTTER_ACTOR_IN_DESTRUCTION (stage))
     return CLUTTER_FRAME_RESULT_IGNORED;
@@ -1036,10 +1121,15 @@ handle_frame_clock_frame (ClutterFrameClock *frame_clock,
   _clutter_run_repaint_functions (CLUTTER_REPAINT_FLAGS_PRE_PAINT);
   clutter_stage_emit_before_update (stage, view, frame);
 
+  start_time_us = g_get_monotonic_time ();
+
   clutter_stage_maybe_relayout (CLUTTER_ACTOR (stage));
 
   clutter_stage_finish_layout (stage);
 
+  clutter_frame_add_phase_time (frame, CLUTTER_FRAME_PHASE_LAYOUT,
+                                g_get_monotonic_time () - start_time_us);
+
   _clutter_stage_window_prepare_frame (stage_window, view, frame);
   clutter_stage_emit_prepare_frame (stage, view, frame);
 
@@ -1047,8 +1137,25 @@ handle_frame_clock_frame (ClutterFrameClock *frame_clock,
     {
       clutter_stage_emit_before_paint (stage, view, frame);
 
+      cogl_context = cogl_framebuffer_get_context (priv->framebuffer);
+      n_built_programs = cogl_context_get_n_built_programs (cogl_context);
+      n_loaded_programs = cogl_context_get_n_loaded_programs (cogl_context);
+      journal_flush_time_us =
+        cogl_context_get_journal_flush_time (cogl_context);
+
       _clutter_stage_window_redraw_view (stage_window, view, frame);
 
+      clutter_frame_add_phase_time (frame, CLUTTER_FRAME_PHASE_FLUSH,
+                                    cogl_context_get_journal_flush_time (cogl_context) -
+                                    journal_flush_time_us);
+
+      COGL_TRACE_SET_COUNTER_INT (PipelinesCompiledDuringFrame,
+                                  cogl_context_get_n_built_programs (cogl_context) -
+                                  n_built_programs);
+      COGL_TRACE_SET_COUNTER_INT (PipelinesLoadedDuringFrame,
+                                  cogl_context_get_n_loaded_programs (cogl_context) -
+                                  n_loaded_programs);
+
       clutter_frame_clock_record_flip_time (frame_clock,
                                             g_get_monotonic_time ());
 
@@ -1313,6 +1420,7 @@ clutter_stage_view_dispose (GObject *object)
   g_clear_pointer (&priv->name, g_free);
 
   g_clear_object (&priv->shadow.framebuffer);
+  g_clear_pointer (&priv->shadow.damage_history, clutter_damage_history_free);
 
   g_clear_object (&priv->color_state);
   g_clear_object (&priv->offscreen);
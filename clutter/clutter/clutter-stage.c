@@ -63,6 +63,7 @@
 #include "clutter/clutter-marshal.h"
 #include "clutter/clutter-mutter.h"
 #include "clutter/clutter-paint-context-private.h"
+#include "clutter/clutter-paint-node-private.h"
 #include "clutter/clutter-paint-volume-private.h"
 #include "clutter/clutter-pick-context-private.h"
 #include "clutter/clutter-private.h"
@@ -367,6 +368,7 @@ clutter_stage_do_paint_view (ClutterStage     *stage,
                              ClutterFrame     *frame,
                              const MtkRegion  *redraw_clip)
 {
+  ClutterContext *context = clutter_actor_get_context (CLUTTER_ACTOR (stage));
   ClutterPaintContext *paint_context;
   MtkRectangle clip_rect;
   g_autoptr (GArray) clip_frusta = NULL;
@@ -435,6 +437,8 @@ clutter_stage_do_paint_view (ClutterStage     *stage,
 
   clutter_actor_paint (CLUTTER_ACTOR (stage), paint_context);
   clutter_paint_context_destroy (paint_context);
+
+  clutter_paint_node_pool_end_frame (context, view);
 }
 
 /* This provides a common point of entry for painting the scenegraph
@@ -0,0 +1,453 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2026 Red Hat Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * The per-context cache of shaped layouts backing ClutterText.
+ *
+ * Each ClutterText keeps a handful of layouts for the sizes it was
+ * last measured at. Labels that are measured at more sizes than that,
+ * or many labels showing the same text, end up shaping the same
+ * layout over and over. This cache sits behind the per-actor slots
+ * and hands out shared layouts for identical keys, evicting the least
+ * recently used ones when it grows past its budget.
+ *
+ * Shared layouts are created using PangoContexts owned by the cache,
+ * one per base direction, so that an actor updating its own context
+ * does not affect layouts used by other actors. Actors whose context
+ * was customised, e.g. with a different language or matrix, can't
+ * use the shared layouts and create their own.
+ */
+
+#include "config.h"
+
+#include <pango/pangocairo.h>
+#include <string.h>
+
+#include "clutter/pango/clutter-text-layout-cache.h"
+
+#include "clutter/clutter-backend-private.h"
+#include "clutter/clutter-context-private.h"
+#include "clutter/clutter-debug.h"
+
+/* The budget is an estimate of the memory used by the cached layouts,
+ * accounting for a fixed overhead per layout plus the glyph strings
+ * and log attributes that scale with the length of the text */
+#define MAX_CACHE_SIZE          (2 * 1024 * 1024)
+#define MAX_CACHED_LAYOUTS      1024
+#define LAYOUT_BASE_SIZE        512
+#define LAYOUT_SIZE_PER_BYTE    32
+
+#define N_BASE_DIRS             (PANGO_DIRECTION_NEUTRAL + 1)
+
+typedef struct _LayoutCacheEntry
+{
+  /* The key must be first, as entries are used as their own keys in
+   * the hash table. Its strings, attributes and font description are
+   * owned by the entry */
+  ClutterTextLayoutKey key;
+
+  PangoLayout *layout;
+  size_t size;
+
+  GList link;
+} LayoutCacheEntry;
+
+struct _ClutterTextLayoutCache
+{
+  ClutterContext *context;
+
+  PangoContext *pango_contexts[N_BASE_DIRS];
+  gulong resolution_changed_id;
+  gulong font_changed_id;
+
+  GHashTable *entries;
+
+  /* Most recently used entries at the head */
+  GQueue lru;
+  size_t size;
+
+  unsigned int hits;
+  unsigned int misses;
+  unsigned int evictions;
+};
+
+static unsigned int
+attr_list_hash (PangoAttrList *attrs)
+{
+  GSList *attributes;
+  GSList *l;
+  unsigned int hash = 0;
+
+  /* pango_attr_list_equal() ignores the order of the attributes, so
+   * their hashes are combined with a sum. The values of the attributes
+   * are left to the equality check */
+  attributes = pango_attr_list_get_attributes (attrs);
+  for (l = attributes; l != NULL; l = l->next)
+    {
+      PangoAttribute *attr = l->data;
+      unsigned int attr_hash = attr->klass->type;
+
+      attr_hash = attr_hash * 31 + attr->start_index;
+      attr_hash = attr_hash * 31 + attr->end_index;
+
+      hash += attr_hash;
+    }
+
+  g_slist_free_full (attributes, (GDestroyNotify) pango_attribute_destroy);
+
+  return hash;
+}
+
+static unsigned int
+layout_key_hash (gconstpointer data)
+{
+  const ClutterTextLayoutKey *key = data;
+  unsigned int hash = 5381;
+  size_t i;
+
+  for (i = 0; i < key->text_len; i++)
+    hash = (hash << 5) + hash + (unsigned char) key->text[i];
+
+  if (key->font_desc)
+    hash ^= pango_font_description_hash (key->font_desc);
+
+  hash = hash * 31 + key->width;
+  hash = hash * 31 + key->height;
+  hash = hash * 31 + key->ellipsize;
+  hash = hash * 31 + key->wrap_mode;
+  hash = hash * 31 + key->alignment;
+  hash = hash * 31 + key->base_dir;
+  hash = hash * 31 + (key->justify ? 1 : 0);
+  hash = hash * 31 + (key->single_paragraph ? 1 : 0);
+  hash = hash * 31 + (key->attrs ? attr_list_hash (key->attrs) : 0);
+
+  return hash;
+}
+
+static gboolean
+layout_key_equal (gconstpointer a,
+                  gconstpointer b)
+{
+  const ClutterTextLayoutKey *key_a = a;
+  const ClutterTextLayoutKey *key_b = b;
+
+  if (key_a->text_len != key_b->text_len ||
+      key_a->width != key_b->width ||
+      key_a->height != key_b->height ||
+      key_a->ellipsize != key_b->ellipsize ||
+      key_a->wrap_mode != key_b->wrap_mode ||
+      key_a->alignment != key_b->alignment ||
+      key_a->base_dir != key_b->base_dir ||
+      !key_a->justify != !key_b->justify ||
+      !key_a->single_paragraph != !key_b->single_paragraph)
+    return FALSE;
+
+  if (memcmp (key_a->text, key_b->text, key_a->text_len) != 0)
+    return FALSE;
+
+  if (key_a->font_desc != key_b->font_desc &&
+      (!key_a->font_desc || !key_b->font_desc ||
+       !pango_font_description_equal (key_a->font_desc, key_b->font_desc)))
+    return FALSE;
+
+  if (key_a->attrs != key_b->attrs &&
+      (!key_a->attrs || !key_b->attrs ||
+       !pango_attr_list_equal (key_a->attrs, key_b->attrs)))
+    return FALSE;
+
+  return TRUE;
+}
+
+static void
+layout_cache_entry_free (gpointer data)
+{
+  LayoutCacheEntry *entry = data;
+
+  g_free ((char *) entry->key.text);
+  g_clear_pointer (&entry->key.attrs, pango_attr_list_unref);
+  g_clear_pointer ((PangoFontDescription **) &entry->key.font_desc,
+                   pango_font_description_free);
+  g_clear_object (&entry->layout);
+  g_free (entry);
+}
+
+static void
+update_pango_contexts (ClutterBackend         *backend,
+                       ClutterTextLayoutCache *cache)
+{
+  int i;
+
+  /* Cached layouts notice the change of their context and are shaped
+   * again the next time they are used */
+  for (i = 0; i < N_BASE_DIRS; i++)
+    {
+      if (!cache->pango_contexts[i])
+        continue;
+
+      clutter_backend_update_pango_context (backend, cache->pango_contexts[i]);
+      pango_context_set_base_dir (cache->pango_contexts[i], i);
+    }
+}
+
+static PangoContext *
+get_pango_context (ClutterTextLayoutCache *cache,
+                   PangoDirection          base_dir)
+{
+  PangoContext *pango_context;
+
+  g_return_val_if_fail (base_dir < N_BASE_DIRS, NULL);
+
+  if (G_LIKELY (cache->pango_contexts[base_dir]))
+    return cache->pango_contexts[base_dir];
+
+  pango_context =
+    pango_font_map_create_context (clutter_context_get_pango_fontmap (cache->context));
+  clutter_backend_update_pango_context (clutter_context_get_backend (cache->context),
+                                        pango_context);
+  pango_context_set_language (pango_context, pango_language_get_default ());
+  pango_context_set_base_dir (pango_context, base_dir);
+
+  cache->pango_contexts[base_dir] = pango_context;
+
+  return pango_context;
+}
+
+static gboolean
+matrix_equal (const PangoMatrix *matrix_a,
+              const PangoMatrix *matrix_b)
+{
+  if (matrix_a == matrix_b)
+    return TRUE;
+
+  if (!matrix_a || !matrix_b)
+    return FALSE;
+
+  return (matrix_a->xx == matrix_b->xx &&
+          matrix_a->xy == matrix_b->xy &&
+          matrix_a->yx == matrix_b->yx &&
+          matrix_a->yy == matrix_b->yy &&
+          matrix_a->x0 == matrix_b->x0 &&
+          matrix_a->y0 == matrix_b->y0);
+}
+
+static gboolean
+font_options_equal (const cairo_font_options_t *options_a,
+                    const cairo_font_options_t *options_b)
+{
+  if (options_a == options_b)
+    return TRUE;
+
+  if (!options_a || !options_b)
+    return FALSE;
+
+  return cairo_font_options_equal (options_a, options_b);
+}
+
+static PangoLayout *
+create_layout (ClutterTextLayoutCache     *cache,
+               const ClutterTextLayoutKey *key)
+{
+  PangoLayout *layout;
+
+  layout = pango_layout_new (get_pango_context (cache, key->base_dir));
+  pango_layout_set_font_description (layout, key->font_desc);
+  pango_layout_set_text (layout, key->text, key->text_len);
+
+  if (key->attrs)
+    pango_layout_set_attributes (layout, key->attrs);
+
+  pango_layout_set_alignment (layout, key->alignment);
+  pango_layout_set_single_paragraph_mode (layout, key->single_paragraph);
+  pango_layout_set_justify (layout, key->justify);
+  pango_layout_set_wrap (layout, key->wrap_mode);
+
+  pango_layout_set_ellipsize (layout, key->ellipsize);
+  pango_layout_set_width (layout, key->width);
+  pango_layout_set_height (layout, key->height);
+
+  return layout;
+}
+
+static void
+evict_entry (ClutterTextLayoutCache *cache,
+             LayoutCacheEntry       *entry)
+{
+  g_queue_unlink (&cache->lru, &entry->link);
+  cache->size -= entry->size;
+  cache->evictions++;
+
+  g_hash_table_remove (cache->entries, &entry->key);
+}
+
+ClutterTextLayoutCache *
+clutter_text_layout_cache_new (ClutterContext *context)
+{
+  ClutterBackend *backend = clutter_context_get_backend (context);
+  ClutterTextLayoutCache *cache = g_new0 (ClutterTextLayoutCache, 1);
+
+  cache->context = context;
+  cache->entries = g_hash_table_new_full (layout_key_hash,
+                                          layout_key_equal,
+                                          NULL,
+                                          layout_cache_entry_free);
+  g_queue_init (&cache->lru);
+
+  cache->resolution_changed_id =
+    g_signal_connect (backend, "resolution-changed",
+                      G_CALLBACK (update_pango_contexts), cache);
+  cache->font_changed_id =
+    g_signal_connect (backend, "font-changed",
+                      G_CALLBACK (update_pango_contexts), cache);
+
+  return cache;
+}
+
+void
+clutter_text_layout_cache_free (ClutterTextLayoutCache *cache)
+{
+  ClutterBackend *backend = clutter_context_get_backend (cache->context);
+  int i;
+
+  g_clear_signal_handler (&cache->resolution_changed_id, backend);
+  g_clear_signal_handler (&cache->font_changed_id, backend);
+
+  g_hash_table_destroy (cache->entries);
+
+  for (i = 0; i < N_BASE_DIRS; i++)
+    g_clear_object (&cache->pango_contexts[i]);
+
+  g_free (cache);
+}
+
+/*
+ * Whether layouts created with @pango_context would be shaped the same
+ * as the shared ones, ignoring the base direction which is part of the
+ * key.
+ */
+gboolean
+clutter_text_layout_cache_is_compatible (ClutterTextLayoutCache *cache,
+                                         PangoContext           *pango_context)
+{
+  PangoContext *cache_context;
+
+  cache_context = get_pango_context (cache, PANGO_DIRECTION_NEUTRAL);
+
+  return (pango_context_get_font_map (pango_context) ==
+          pango_context_get_font_map (cache_context) &&
+          pango_context_get_language (pango_context) ==
+          pango_context_get_language (cache_context) &&
+          pango_context_get_base_gravity (pango_context) ==
+          pango_context_get_base_gravity (cache_context) &&
+          pango_context_get_gravity_hint (pango_context) ==
+          pango_context_get_gravity_hint (cache_context) &&
+          pango_context_get_round_glyph_positions (pango_context) ==
+          pango_context_get_round_glyph_positions (cache_context) &&
+          pango_cairo_context_get_resolution (pango_context) ==
+          pango_cairo_context_get_resolution (cache_context) &&
+          matrix_equal (pango_context_get_matrix (pango_context),
+                        pango_context_get_matrix (cache_context)) &&
+          font_options_equal (pango_cairo_context_get_font_options (pango_context),
+                              pango_cairo_context_get_font_options (cache_context)) &&
+          pango_font_description_equal (pango_context_get_font_description (pango_context),
+                                        pango_context_get_font_description (cache_context)));
+}
+
+PangoLayout *
+clutter_text_layout_cache_get_layout (ClutterTextLayoutCache     *cache,
+                                      const ClutterTextLayoutKey *key)
+{
+  LayoutCacheEntry *entry;
+  size_t size;
+
+  entry = g_hash_table_lookup (cache->entries, key);
+  if (entry)
+    {
+      cache->hits++;
+
+      g_queue_unlink (&cache->lru, &entry->link);
+      g_queue_push_head_link (&cache->lru, &entry->link);
+
+      return g_object_ref (entry->layout);
+    }
+
+  cache->misses++;
+
+  /* Don't let a single huge text flush everything else */
+  size = LAYOUT_BASE_SIZE + key->text_len * LAYOUT_SIZE_PER_BYTE;
+  if (size > MAX_CACHE_SIZE / 4)
+    return create_layout (cache, key);
+
+  /* The layout is created from the copied key, so that changes to the
+   * attributes of the actor it was created for don't leak into it */
+  entry = g_new0 (LayoutCacheEntry, 1);
+  entry->key = *key;
+  entry->key.text = g_strndup (key->text, key->text_len);
+  entry->key.attrs = pango_attr_list_copy (key->attrs);
+  entry->key.font_desc = key->font_desc
+    ? pango_font_description_copy (key->font_desc)
+    : NULL;
+  entry->layout = create_layout (cache, &entry->key);
+  entry->size = size;
+  entry->link.data = entry;
+
+  g_hash_table_add (cache->entries, entry);
+  g_queue_push_head_link (&cache->lru, &entry->link);
+  cache->size += size;
+
+  while (cache->size > MAX_CACHE_SIZE ||
+         cache->lru.length > MAX_CACHED_LAYOUTS)
+    evict_entry (cache, g_queue_peek_tail (&cache->lru));
+
+  CLUTTER_NOTE (PANGO, "Text layout cache: %u layouts, %zu bytes",
+                cache->lru.length, cache->size);
+
+  return g_object_ref (entry->layout);
+}
+
+void
+clutter_text_layout_cache_clear (ClutterTextLayoutCache *cache)
+{
+  g_queue_init (&cache->lru);
+  g_hash_table_remove_all (cache->entries);
+  cache->size = 0;
+}
+
+void
+clutter_context_get_text_layout_cache_stats (ClutterContext              *context,
+                                             ClutterTextLayoutCacheStats *stats)
+{
+  ClutterTextLayoutCache *cache =
+    clutter_context_get_text_layout_cache (context);
+
+  *stats = (ClutterTextLayoutCacheStats) {
+    .hits = cache->hits,
+    .misses = cache->misses,
+    .evictions = cache->evictions,
+    .n_layouts = cache->lru.length,
+    .size = cache->size,
+  };
+}
+
+void
+clutter_context_clear_text_layout_cache (ClutterContext *context)
+{
+  clutter_text_layout_cache_clear (clutter_context_get_text_layout_cache (context));
+}
@@ -0,0 +1,86 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2026 Red Hat Inc.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <pango/pango.h>
+
+#include "clutter/clutter-context.h"
+#include "clutter/clutter-macros.h"
+
+G_BEGIN_DECLS
+
+typedef struct _ClutterTextLayoutCache ClutterTextLayoutCache;
+
+/* Everything that affects the shaping of a layout created by
+ * ClutterText. The strings, attributes and font description are
+ * only borrowed for the duration of a lookup; the cache copies
+ * what it needs when inserting a new layout.
+ */
+typedef struct _ClutterTextLayoutKey
+{
+  const char *text;
+  size_t text_len;
+  PangoAttrList *attrs;
+  const PangoFontDescription *font_desc;
+
+  int width;
+  int height;
+  PangoEllipsizeMode ellipsize;
+  PangoWrapMode wrap_mode;
+  PangoAlignment alignment;
+  gboolean justify;
+  gboolean single_paragraph;
+  PangoDirection base_dir;
+} ClutterTextLayoutKey;
+
+typedef struct _ClutterTextLayoutCacheStats
+{
+  unsigned int hits;
+  unsigned int misses;
+  unsigned int evictions;
+  unsigned int n_layouts;
+  size_t size;
+} ClutterTextLayoutCacheStats;
+
+ClutterTextLayoutCache * clutter_text_layout_cache_new (ClutterContext *context);
+
+void clutter_text_layout_cache_free (ClutterTextLayoutCache *cache);
+
+gboolean clutter_text_layout_cache_is_compatible (ClutterTextLayoutCache *cache,
+                                                  PangoContext           *pango_context);
+
+/* Returns a layout matching @key, shaping a new one if none is
+ * cached. The layout has a new reference so it is up to the caller
+ * to unref it, and it is shared so it must not be modified */
+PangoLayout * clutter_text_layout_cache_get_layout (ClutterTextLayoutCache     *cache,
+                                                    const ClutterTextLayoutKey *key);
+
+void clutter_text_layout_cache_clear (ClutterTextLayoutCache *cache);
+
+CLUTTER_EXPORT_TEST
+void clutter_context_get_text_layout_cache_stats (ClutterContext              *context,
+                                                  ClutterTextLayoutCacheStats *stats);
+
+CLUTTER_EXPORT_TEST
+void clutter_context_clear_text_layout_cache (ClutterContext *context);
+
+G_END_DECLS
@@ -51,6 +51,7 @@
 #include "clutter/pango/clutter-pango-private.h"
 #include "clutter/pango/clutter-text-accessible-private.h"
 #include "clutter/pango/clutter-text-buffer.h"
+#include "clutter/pango/clutter-text-layout-cache.h"
 #include "clutter/clutter-actor-private.h"
 #include "clutter/clutter-animatable.h"
 #include "clutter/clutter-backend-private.h"
@@ -125,6 +126,11 @@ typedef struct _ClutterTextPrivate
   LayoutCache cached_layouts[N_CACHED_LAYOUTS];
   guint cache_age;
 
+  /* The layout returned by clutter_text_get_layout() when the current
+   * one is shared with other actors, and the shared layout it mirrors */
+  PangoLayout *private_layout;
+  PangoLayout *private_layout_source;
+
   /* These are the attributes set by the attributes property */
   PangoAttrList *attrs;
   /* These are the attributes derived from the text when the
@@ -835,6 +841,42 @@ _clutter_find_base_dir (const gchar *text,
   return dir;
 }
 
+static ClutterTextDirection
+clutter_text_resolve_direction (ClutterText *text,
+                                const char  *contents,
+                                size_t       contents_len)
+{
+  ClutterTextPrivate *priv = clutter_text_get_instance_private (text);
+  ClutterTextDirection dir;
+
+  if (priv->password_char != 0)
+    dir = CLUTTER_TEXT_DIRECTION_DEFAULT;
+  else
+    dir = _clutter_find_base_dir (contents, contents_len);
+
+  if (dir == CLUTTER_TEXT_DIRECTION_DEFAULT)
+    {
+      if (clutter_actor_has_key_focus (CLUTTER_ACTOR (text)))
+        {
+          ClutterContext *clutter_context =
+            clutter_actor_get_context (CLUTTER_ACTOR (text));
+          ClutterBackend *backend =
+            clutter_context_get_backend (clutter_context);
+          ClutterSeat *seat =
+            clutter_backend_get_default_seat (backend);
+          ClutterKeymap *keymap = clutter_seat_get_keymap (seat);
+
+          dir = clutter_keymap_get_direction (keymap);
+        }
+      else
+        {
+          dir = clutter_actor_get_text_direction (CLUTTER_ACTOR (text));
+        }
+    }
+
+  return dir;
+}
+
 static PangoLayout *
 clutter_text_create_layout_no_cache (ClutterText       *text,
 				     gint               width,
@@ -885,31 +927,7 @@ clutter_text_create_layout_no_cache (ClutterText       *text,
       PangoDirection pango_dir;
       PangoContext *context;
 
-      if (priv->password_char != 0)
-        dir = CLUTTER_TEXT_DIRECTION_DEFAULT;
-      else
-        dir = _clutter_find_base_dir (contents, contents_len);
-
-      if (dir == CLUTTER_TEXT_DIRECTION_DEFAULT)
-        {
-          if (clutter_actor_has_key_focus (CLUTTER_ACTOR (text)))
-            {
-              ClutterContext *clutter_context =
-                clutter_actor_get_context (CLUTTER_ACTOR (text));
-              ClutterBackend *backend =
-                clutter_context_get_backend (clutter_context);
-              ClutterSeat *seat =
-                clutter_backend_get_default_seat (backend);
-              ClutterKeymap *keymap = clutter_seat_get_keymap (seat);
-
-              dir = clutter_keymap_get_direction (keymap);
-            }
-          else
-            {
-              dir = clutter_actor_get_text_direction (CLUTTER_ACTOR (text));
-            }
-        }
-
+      dir = clutter_text_resolve_direction (text, contents, contents_len);
       pango_dir = clutter_text_direction_to_pango_direction (dir);
       context = clutter_actor_get_pango_context (CLUTTER_ACTOR (text));
 
@@ -941,6 +959,89 @@ clutter_text_create_layout_no_cache (ClutterText       *text,
   return layout;
 }
 
+/*
+ * clutter_text_can_share_layout:
+ * @text: a #ClutterText
+ *
+ * Checks whether the layouts of @text can be shared through the text
+ * layout cache of the context. Editable actors can't, as their contents
+ * include the pre-edit string and change with every key press, and
+ * neither can actors whose PangoContext was customised, e.g. with a
+ * different language or matrix, since the shared layouts use contexts
+ * owned by the cache.
+ */
+static gboolean
+clutter_text_can_share_layout (ClutterText *text)
+{
+  ClutterTextPrivate *priv = clutter_text_get_instance_private (text);
+  ClutterContext *context = clutter_actor_get_context (CLUTTER_ACTOR (text));
+  PangoContext *pango_context;
+
+  if (priv->editable)
+    return FALSE;
+
+  pango_context = clutter_actor_get_pango_context (CLUTTER_ACTOR (text));
+
+  return clutter_text_layout_cache_is_compatible (clutter_context_get_text_layout_cache (context),
+                                                  pango_context);
+}
+
+/*
+ * clutter_text_get_shared_layout:
+ * @text: a #ClutterText
+ * @width: the width of the layout, in Pango units
+ * @height: the height of the layout, in Pango units
+ * @ellipsize: the ellipsize mode of the layout
+ *
+ * Like clutter_text_create_layout_no_cache(), but looks the layout up
+ * in the text layout cache of the context first, so that actors showing
+ * the same text at the same size share a single shaped layout.
+ *
+ * Must only be used when clutter_text_can_share_layout() is %TRUE.
+ */
+static PangoLayout *
+clutter_text_get_shared_layout (ClutterText       *text,
+                                int                width,
+                                int                height,
+                                PangoEllipsizeMode ellipsize)
+{
+  ClutterTextPrivate *priv = clutter_text_get_instance_private (text);
+  ClutterContext *context = clutter_actor_get_context (CLUTTER_ACTOR (text));
+  ClutterTextLayoutCache *layout_cache =
+    clutter_context_get_text_layout_cache (context);
+  g_autofree char *contents = NULL;
+  ClutterTextLayoutKey key;
+  size_t contents_len;
+  ClutterTextDirection dir;
+
+  contents = clutter_text_get_display_text (text);
+  contents_len = strlen (contents);
+
+  dir = clutter_text_resolve_direction (text, contents, contents_len);
+  priv->resolved_direction = dir;
+
+  /* This will merge the markup attributes and the attributes
+   * property if needed */
+  clutter_text_ensure_effective_attributes (text);
+
+  key = (ClutterTextLayoutKey) {
+    .text = contents,
+    .text_len = contents_len,
+    .attrs = priv->effective_attrs,
+    .font_desc = priv->font_desc,
+    .width = width,
+    .height = height,
+    .ellipsize = ellipsize,
+    .wrap_mode = priv->wrap_mode,
+    .alignment = priv->alignment,
+    .justify = priv->justify,
+    .single_paragraph = priv->single_line_mode,
+    .base_dir = clutter_text_direction_to_pango_direction (dir),
+  };
+
+  return clutter_text_layout_cache_get_layout (layout_cache, &key);
+}
+
 static void
 clutter_text_dirty_cache (ClutterText *text)
 {
@@ -952,6 +1053,9 @@ clutter_text_dirty_cache (ClutterText *text)
   for (i = 0; i < N_CACHED_LAYOUTS; i++)
     g_clear_object (&priv->cached_layouts[i].layout);
 
+  g_clear_object (&priv->private_layout);
+  g_clear_object (&priv->private_layout_source);
+
   clutter_actor_invalidate_paint_volume (CLUTTER_ACTOR (text));
 }
 
@@ -1051,7 +1155,8 @@ clutter_text_direction_changed_cb (GObject    *gobject,
  * Like clutter_text_create_layout_no_cache(), but will also ensure
  * the glyphs cache. If a previously cached layout generated using the
  * same width is available then that will be used instead of
- * generating a new one.
+ * generating a new one. Layouts of non-editable actors are also
+ * shared with other actors through the text layout cache.
  */
 static PangoLayout *
 clutter_text_create_layout (ClutterText *text,
@@ -1214,8 +1319,16 @@ clutter_text_create_layout (ClutterText *text,
   if (oldest_cache->layout)
     g_object_unref (oldest_cache->layout);
 
-  oldest_cache->layout =
-    clutter_text_create_layout_no_cache (text, width, height, ellipsize);
+  if (clutter_text_can_share_layout (text))
+    {
+      oldest_cache->layout =
+        clutter_text_get_shared_layout (text, width, height, ellipsize);
+    }
+  else
+    {
+      oldest_cache->layout =
+        clutter_text_create_layout_no_cache (text, width, height, ellipsize);
+    }
 
   clutter_ensure_glyph_cache_for_layout (context, oldest_cache->layout);
 
@@ -1254,6 +1367,33 @@ maybe_create_text_layout_with_resource_scale (ClutterText *text,
                                         resource_scale);
 }
 
+/*
+ * clutter_text_get_current_layout:
+ * @text: a #ClutterText
+ *
+ * Retrieves the layout used to paint, measure and pick @text. Unlike
+ * clutter_text_get_layout(), the returned layout may be shared with
+ * other actors, so it must not be modified.
+ */
+static PangoLayout *
+clutter_text_get_current_layout (ClutterText *text)
+{
+  ClutterTextPrivate *priv = clutter_text_get_instance_private (text);
+  PangoLayout *layout;
+  float width, height;
+
+  if (priv->editable && priv->single_line_mode)
+    return clutter_text_create_layout (text, -1, -1);
+
+  clutter_actor_get_size (CLUTTER_ACTOR (text), &width, &height);
+  layout = maybe_create_text_layout_with_resource_scale (text, width, height);
+
+  if (!layout)
+    layout = clutter_text_create_layout (text, width, height);
+
+  return layout;
+}
+
 /**
  * clutter_text_coords_to_position:
  * @self: a #ClutterText
@@ -1286,7 +1426,7 @@ clutter_text_coords_to_position (ClutterText *self,
   px = (int) logical_pixels_to_pango (x - priv->text_logical_x, resource_scale);
   py = (int) logical_pixels_to_pango (y - priv->text_logical_y, resource_scale);
 
-  pango_layout_xy_to_index (clutter_text_get_layout (self),
+  pango_layout_xy_to_index (clutter_text_get_current_layout (self),
                             px, py,
                             &index_, &trailing);
 
@@ -1358,7 +1498,7 @@ clutter_text_position_to_coords_internal (ClutterText *self,
       g_string_free (tmp, TRUE);
     }
 
-  pango_layout_get_cursor_pos (clutter_text_get_layout (self),
+  pango_layout_get_cursor_pos (clutter_text_get_current_layout (self),
                                index_,
                                &rect, NULL);
 
@@ -1997,7 +2137,7 @@ clutter_text_foreach_selection_rectangle (ClutterText              *self,
                                           gpointer                  user_data)
 {
   ClutterTextPrivate *priv = clutter_text_get_instance_private (self);
-  PangoLayout *layout = clutter_text_get_layout (self);
+  PangoLayout *layout = clutter_text_get_current_layout (self);
   gchar *utf8 = clutter_text_get_display_text (self);
   gint lines;
   gint start_index;
@@ -2122,7 +2262,7 @@ paint_selection_rectangle (ClutterText           *self,
   ClutterBackend *backend = clutter_context_get_backend (context);
   CoglContext *cogl_context = clutter_backend_get_cogl_context (backend);
   CoglPipeline *color_pipeline = create_color_pipeline (cogl_context);
-  PangoLayout *layout = clutter_text_get_layout (self);
+  PangoLayout *layout = clutter_text_get_current_layout (self);
   ClutterColorState *color_state =
     clutter_paint_context_get_color_state (paint_context);
   ClutterColorState *target_color_state =
@@ -2254,7 +2394,7 @@ clutter_text_move_word_backward (ClutterText *self,
 
   if (clutter_text_buffer_get_length (get_buffer (self)) > 0 && start > 0)
     {
-      PangoLayout *layout = clutter_text_get_layout (self);
+      PangoLayout *layout = clutter_text_get_current_layout (self);
       PangoLogAttr *log_attrs = NULL;
       gint n_attrs = 0;
 
@@ -2280,7 +2420,7 @@ clutter_text_move_word_forward (ClutterText *self,
   n_chars = clutter_text_buffer_get_length (get_buffer (self));
   if (n_chars > 0 && start < n_chars)
     {
-      PangoLayout *layout = clutter_text_get_layout (self);
+      PangoLayout *layout = clutter_text_get_current_layout (self);
       PangoLogAttr *log_attrs = NULL;
       gint n_attrs = 0;
 
@@ -2307,7 +2447,7 @@ clutter_text_move_line_start (ClutterText *self,
   gint position;
   const gchar *text;
 
-  layout = clutter_text_get_layout (self);
+  layout = clutter_text_get_current_layout (self);
   text = clutter_text_buffer_get_text (get_buffer (self));
 
   if (start == 0)
@@ -2343,7 +2483,7 @@ clutter_text_move_line_end (ClutterText *self,
   gint position;
   const gchar *text;
 
-  layout = clutter_text_get_layout (self);
+  layout = clutter_text_get_current_layout (self);
   text = clutter_text_buffer_get_text (get_buffer (self));
 
   if (start == 0)
@@ -2762,7 +2902,7 @@ clutter_text_get_paint_volume (ClutterActor       *self,
 
   clutter_paint_volume_init_from_actor (volume, self);
 
-  layout = clutter_text_get_layout (text);
+  layout = clutter_text_get_current_layout (text);
   pango_layout_get_extents (layout, &ink_rect, NULL);
 
   origin.x = pango_to_logical_pixels (ink_rect.x, resource_scale);
@@ -3136,7 +3276,7 @@ clutter_text_real_move_up (ClutterText         *self,
   gint x;
   const gchar *text;
 
-  layout = clutter_text_get_layout (self);
+  layout = clutter_text_get_current_layout (self);
   text = clutter_text_buffer_get_text (get_buffer (self));
 
   if (priv->position == 0)
@@ -3193,7 +3333,7 @@ clutter_text_real_move_down (ClutterText         *self,
   gint pos;
   const gchar *text;
 
-  layout = clutter_text_get_layout (self);
+  layout = clutter_text_get_current_layout (self);
   text = clutter_text_buffer_get_text (get_buffer (self));
 
   if (priv->position == 0)
@@ -5692,22 +5832,33 @@ PangoLayout *
 clutter_text_get_layout (ClutterText *self)
 {
   PangoLayout *layout;
-  gfloat width, height;
   ClutterTextPrivate *priv;
 
   g_return_val_if_fail (CLUTTER_IS_TEXT (self), NULL);
 
   priv = clutter_text_get_instance_private (self);
-  if (priv->editable && priv->single_line_mode)
-    return clutter_text_create_layout (self, -1, -1);
+  layout = clutter_text_get_current_layout (self);
 
-  clutter_actor_get_size (CLUTTER_ACTOR (self), &width, &height);
-  layout = maybe_create_text_layout_with_resource_scale (self, width, height);
+  if (!clutter_text_can_share_layout (self))
+    return layout;
 
-  if (!layout)
-    layout = clutter_text_create_layout (self, width, height);
+  /* Shared layouts use the contexts of the text layout cache and may be
+   * used by other actors, so callers get a copy of their own, created
+   * with the context of the actor. It is kept until the shared layout
+   * changes, so that it is only shaped once per change. */
+  if (priv->private_layout_source != layout)
+    {
+      g_clear_object (&priv->private_layout);
+      priv->private_layout =
+        clutter_text_create_layout_no_cache (self,
+                                             pango_layout_get_width (layout),
+                                             pango_layout_get_height (layout),
+                                             pango_layout_get_ellipsize (layout));
+
+      g_set_object (&priv->private_layout_source, layout);
+    }
 
-  return layout;
+  return priv->private_layout;
 }
 
 /**
@@ -36,9 +36,25 @@
 #include "cogl/cogl-context-private.h"
 #include "cogl/cogl-texture-private.h"
 #include "cogl/cogl-half-float.h"
+#include "cogl/cogl-cpu-caps.h"
 
 #include <string.h>
 
+/* Kernels using instruction set extensions beyond the compile time
+ * baseline are built with per function target attributes and picked at
+ * runtime according to cogl_cpu_caps. NEON is always available on
+ * aarch64 so it is used unconditionally there. */
+#if defined(__x86_64) && defined(__GNUC__)
+#define COGL_USE_X86_DISPATCH
+#define COGL_TARGET(isa) __attribute__ ((target (isa)))
+#include <immintrin.h>
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#define COGL_USE_NEON
+#include <arm_neon.h>
+#endif
+
 typedef enum
 {
   MEDIUM_TYPE_8,
@@ -346,10 +362,115 @@ _cogl_premult_alpha_last_four_pixels_sse2 (uint8_t *p)
 
 #endif /* COGL_USE_PREMULT_SSE2 */
 
+#ifdef COGL_USE_X86_DISPATCH
+
+/* Same arithmetic as the SSE2 version above, eight pixels at a time.
+ * Returns the number of pixels that were handled. */
+static int COGL_TARGET ("avx2")
+_cogl_premult_alpha_last_span_avx2 (uint8_t *data,
+                                    int      width)
+{
+  const __m256i zero = _mm256_setzero_si256 ();
+  const __m256i halves = _mm256_set1_epi16 (128);
+  const __m256i alpha_mask = _mm256_set1_epi32 ((int) 0xff000000);
+  int n;
+
+  for (n = 0; n + 8 <= width; n += 8)
+    {
+      __m256i pixels = _mm256_loadu_si256 ((const __m256i *) data);
+      __m256i lo = _mm256_unpacklo_epi8 (pixels, zero);
+      __m256i hi = _mm256_unpackhi_epi8 (pixels, zero);
+      __m256i alpha_lo, alpha_hi;
+
+      alpha_lo = _mm256_shufflehi_epi16 (_mm256_shufflelo_epi16 (lo, 0xff),
+                                         0xff);
+      alpha_hi = _mm256_shufflehi_epi16 (_mm256_shufflelo_epi16 (hi, 0xff),
+                                         0xff);
+
+      lo = _mm256_add_epi16 (_mm256_mullo_epi16 (lo, alpha_lo), halves);
+      hi = _mm256_add_epi16 (_mm256_mullo_epi16 (hi, alpha_hi), halves);
+      lo = _mm256_srli_epi16 (_mm256_add_epi16 (lo, _mm256_srli_epi16 (lo, 8)),
+                              8);
+      hi = _mm256_srli_epi16 (_mm256_add_epi16 (hi, _mm256_srli_epi16 (hi, 8)),
+                              8);
+
+      /* Keep the original alpha values */
+      pixels = _mm256_blendv_epi8 (_mm256_packus_epi16 (lo, hi),
+                                   pixels,
+                                   alpha_mask);
+      _mm256_storeu_si256 ((__m256i *) data, pixels);
+      data += 8 * 4;
+    }
+
+  return n;
+}
+
+static inline __m128i COGL_TARGET ("sse4.1")
+_cogl_unpremult_pixel_sse41 (__m128i pixel)
+{
+  __m128 components = _mm_cvtepi32_ps (pixel);
+  __m128 alpha = _mm_shuffle_ps (components, components, 0xff);
+  __m128 result;
+
+  result = _mm_div_ps (_mm_mul_ps (components, _mm_set1_ps (255.0f)), alpha);
+
+  /* Truncate to a byte the same way the integer version does */
+  return _mm_and_si128 (_mm_cvttps_epi32 (result), _mm_set1_epi32 (0xff));
+}
+
+/* Dividing in single precision gives exactly the same results as the
+ * integer division in _cogl_unpremult_alpha_last() for all 8-bit
+ * inputs. A zero alpha gives a non-finite quotient which converts to
+ * 0x80000000, so those pixels end up zeroed like with
+ * _cogl_unpremult_alpha_0(). Returns the number of pixels that were
+ * handled. */
+static int COGL_TARGET ("sse4.1")
+_cogl_unpremult_alpha_last_span_sse41 (uint8_t *data,
+                                       int      width)
+{
+  const __m128i alpha_mask = _mm_set1_epi32 ((int) 0xff000000);
+  int n;
+
+  for (n = 0; n + 4 <= width; n += 4)
+    {
+      __m128i pixels = _mm_loadu_si128 ((const __m128i *) data);
+      __m128i p0, p1, p2, p3;
+      __m128i result;
+
+      p0 = _cogl_unpremult_pixel_sse41 (_mm_cvtepu8_epi32 (pixels));
+      p1 = _cogl_unpremult_pixel_sse41 (
+        _mm_cvtepu8_epi32 (_mm_srli_si128 (pixels, 4)));
+      p2 = _cogl_unpremult_pixel_sse41 (
+        _mm_cvtepu8_epi32 (_mm_srli_si128 (pixels, 8)));
+      p3 = _cogl_unpremult_pixel_sse41 (
+        _mm_cvtepu8_epi32 (_mm_srli_si128 (pixels, 12)));
+
+      result = _mm_packus_epi16 (_mm_packus_epi32 (p0, p1),
+                                 _mm_packus_epi32 (p2, p3));
+      result = _mm_blendv_epi8 (result, pixels, alpha_mask);
+      _mm_storeu_si128 ((__m128i *) data, result);
+      data += 4 * 4;
+    }
+
+  return n;
+}
+
+#endif /* COGL_USE_X86_DISPATCH */
+
 static void
 _cogl_bitmap_premult_unpacked_span_8 (uint8_t *data,
                                       int width)
 {
+#ifdef COGL_USE_X86_DISPATCH
+  if (cogl_cpu_has_cap (COGL_CPU_CAP_AVX2))
+    {
+      int n = _cogl_premult_alpha_last_span_avx2 (data, width);
+
+      data += n * 4;
+      width -= n;
+    }
+#endif /* COGL_USE_X86_DISPATCH */
+
 #ifdef COGL_USE_PREMULT_SSE2
 
   /* Process 4 pixels at a time */
@@ -378,6 +499,16 @@ _cogl_bitmap_unpremult_unpacked_span_8 (uint8_t *data,
 {
   int x;
 
+#ifdef COGL_USE_X86_DISPATCH
+  if (cogl_cpu_has_cap (COGL_CPU_CAP_SSE4_1))
+    {
+      int n = _cogl_unpremult_alpha_last_span_sse41 (data, width);
+
+      data += n * 4;
+      width -= n;
+    }
+#endif /* COGL_USE_X86_DISPATCH */
+
   for (x = 0; x < width; x++)
     {
       if (data[3] == 0)
@@ -470,6 +601,49 @@ _cogl_bitmap_can_fast_premult (CoglPixelFormat format)
     }
 }
 
+/* Premultiplies a span of one of the formats accepted by
+ * _cogl_bitmap_can_fast_premult() in place */
+static void
+_cogl_bitmap_premult_span_8888 (CoglPixelFormat  format,
+                                uint8_t         *data,
+                                int              width)
+{
+  if (format & COGL_AFIRST_BIT)
+    {
+      while (width-- > 0)
+        {
+          _cogl_premult_alpha_first (data);
+          data += 4;
+        }
+    }
+  else
+    {
+      _cogl_bitmap_premult_unpacked_span_8 (data, width);
+    }
+}
+
+static void
+_cogl_bitmap_unpremult_span_8888 (CoglPixelFormat  format,
+                                  uint8_t         *data,
+                                  int              width)
+{
+  if (format & COGL_AFIRST_BIT)
+    {
+      while (width-- > 0)
+        {
+          if (data[0] == 0)
+            _cogl_unpremult_alpha_0 (data);
+          else
+            _cogl_unpremult_alpha_first (data);
+          data += 4;
+        }
+    }
+  else
+    {
+      _cogl_bitmap_unpremult_unpacked_span_8 (data, width);
+    }
+}
+
 static gboolean
 determine_medium_size (CoglPixelFormat format)
 {
@@ -559,6 +733,641 @@ calculate_medium_size_pixel_size (MediumType medium_type)
   g_assert_not_reached ();
 }
 
+/* Direct conversions
+ *
+ * Swizzling between the 8888 formats, narrowing the 10-bit formats to
+ * 8-bit and converting between half and single precision floats are
+ * common when uploading client buffers and reading back framebuffers.
+ * These are done without going through the intermediate medium row.
+ */
+
+typedef enum
+{
+  DIRECT_CONVERSION_SWIZZLE_8888,
+  DIRECT_CONVERSION_NARROW_2101010,
+  DIRECT_CONVERSION_HALF_TO_FLOAT,
+  DIRECT_CONVERSION_FLOAT_TO_HALF,
+} DirectConversionType;
+
+/* Marks a destination byte that is always set to 0xff */
+#define DIRECT_CONVERSION_OPAQUE 0x80
+
+typedef struct
+{
+  DirectConversionType type;
+
+  /* For swizzles, the source byte of each destination byte. When
+   * narrowing, the bit offset of the source component of each
+   * destination byte. */
+  uint8_t sources[4];
+
+  /* The destination byte holding alpha when narrowing */
+  int alpha_byte;
+} DirectConversion;
+
+/* Byte offsets of the red, green, blue and alpha (or padding)
+ * components of the 8888 formats */
+static gboolean
+get_8888_layout (CoglPixelFormat  format,
+                 int             *layout)
+{
+  static const int rgba[] = { 0, 1, 2, 3 };
+  static const int bgra[] = { 2, 1, 0, 3 };
+  static const int argb[] = { 1, 2, 3, 0 };
+  static const int abgr[] = { 3, 2, 1, 0 };
+
+  switch (format & ~COGL_PREMULT_BIT)
+    {
+    case COGL_PIXEL_FORMAT_RGBX_8888:
+    case COGL_PIXEL_FORMAT_RGBA_8888:
+      memcpy (layout, rgba, sizeof (rgba));
+      return TRUE;
+    case COGL_PIXEL_FORMAT_BGRX_8888:
+    case COGL_PIXEL_FORMAT_BGRA_8888:
+      memcpy (layout, bgra, sizeof (bgra));
+      return TRUE;
+    case COGL_PIXEL_FORMAT_XRGB_8888:
+    case COGL_PIXEL_FORMAT_ARGB_8888:
+      memcpy (layout, argb, sizeof (argb));
+      return TRUE;
+    case COGL_PIXEL_FORMAT_XBGR_8888:
+    case COGL_PIXEL_FORMAT_ABGR_8888:
+      memcpy (layout, abgr, sizeof (abgr));
+      return TRUE;
+    default:
+      return FALSE;
+    }
+}
+
+/* Bit offsets of the red, green, blue and alpha (or padding)
+ * components of the 10-bit formats */
+static gboolean
+get_2101010_layout (CoglPixelFormat  format,
+                    int             *layout)
+{
+  static const int rgba_1010102[] = { 22, 12, 2, 0 };
+  static const int bgra_1010102[] = { 2, 12, 22, 0 };
+  static const int argb_2101010[] = { 20, 10, 0, 30 };
+  static const int abgr_2101010[] = { 0, 10, 20, 30 };
+
+  switch (format & ~COGL_PREMULT_BIT)
+    {
+    case COGL_PIXEL_FORMAT_RGBA_1010102:
+      memcpy (layout, rgba_1010102, sizeof (rgba_1010102));
+      return TRUE;
+    case COGL_PIXEL_FORMAT_BGRA_1010102:
+      memcpy (layout, bgra_1010102, sizeof (bgra_1010102));
+      return TRUE;
+    case COGL_PIXEL_FORMAT_XRGB_2101010:
+    case COGL_PIXEL_FORMAT_ARGB_2101010:
+      memcpy (layout, argb_2101010, sizeof (argb_2101010));
+      return TRUE;
+    case COGL_PIXEL_FORMAT_XBGR_2101010:
+    case COGL_PIXEL_FORMAT_ABGR_2101010:
+      memcpy (layout, abgr_2101010, sizeof (abgr_2101010));
+      return TRUE;
+    default:
+      return FALSE;
+    }
+}
+
+static gboolean
+find_direct_conversion (CoglPixelFormat   src_format,
+                        CoglPixelFormat   dst_format,
+                        gboolean          need_premult,
+                        DirectConversion *conversion)
+{
+  int src_layout[4];
+  int dst_layout[4];
+  int i;
+
+  if (get_8888_layout (dst_format, dst_layout))
+    {
+      gboolean alpha_is_opaque = (!(src_format & COGL_A_BIT) ||
+                                  !(dst_format & COGL_A_BIT));
+
+      /* Any premultiplication is done on the destination row afterwards,
+       * which is what would happen with the 8-bit medium row too */
+      if (get_8888_layout (src_format, src_layout))
+        conversion->type = DIRECT_CONVERSION_SWIZZLE_8888;
+      else if (get_2101010_layout (src_format, src_layout))
+        conversion->type = DIRECT_CONVERSION_NARROW_2101010;
+      else
+        return FALSE;
+
+      for (i = 0; i < 4; i++)
+        {
+          if (i == 3 && alpha_is_opaque)
+            conversion->sources[dst_layout[i]] = DIRECT_CONVERSION_OPAQUE;
+          else
+            conversion->sources[dst_layout[i]] = src_layout[i];
+        }
+      conversion->alpha_byte = dst_layout[3];
+
+      return TRUE;
+    }
+
+  if (need_premult)
+    return FALSE;
+
+  switch (src_format & ~COGL_PREMULT_BIT)
+    {
+    case COGL_PIXEL_FORMAT_RGBA_FP_16161616:
+      if ((dst_format & ~COGL_PREMULT_BIT) != COGL_PIXEL_FORMAT_RGBA_FP_32323232)
+        return FALSE;
+      conversion->type = DIRECT_CONVERSION_HALF_TO_FLOAT;
+      return TRUE;
+    case COGL_PIXEL_FORMAT_RGBA_FP_32323232:
+      if ((dst_format & ~COGL_PREMULT_BIT) != COGL_PIXEL_FORMAT_RGBA_FP_16161616)
+        return FALSE;
+      conversion->type = DIRECT_CONVERSION_FLOAT_TO_HALF;
+      return TRUE;
+    default:
+      return FALSE;
+    }
+}
+
+/* Exactly UNPACK_10() for 8-bit components, i.e.
+ * (v * 255 + 0x1ff) / 0x3ff, for all 10-bit values */
+#define NARROW_10(v) (((v) * 1021 + 2048) >> 12)
+
+/* UNPACK_2() for 8-bit components */
+#define NARROW_2(v) ((v) * 85)
+
+static void
+swizzle_8888_span (const DirectConversion *conversion,
+                   const uint8_t          *src,
+                   uint8_t                *dst,
+                   int                     width)
+{
+  const uint8_t *sources = conversion->sources;
+  int i;
+
+  while (width-- > 0)
+    {
+      for (i = 0; i < 4; i++)
+        {
+          if (sources[i] & DIRECT_CONVERSION_OPAQUE)
+            dst[i] = 0xff;
+          else
+            dst[i] = src[sources[i]];
+        }
+      src += 4;
+      dst += 4;
+    }
+}
+
+static void
+narrow_2101010_span (const DirectConversion *conversion,
+                     const uint8_t          *src,
+                     uint8_t                *dst,
+                     int                     width)
+{
+  const uint8_t *sources = conversion->sources;
+  int i;
+
+  while (width-- > 0)
+    {
+      uint32_t v = *(const uint32_t *) src;
+
+      for (i = 0; i < 4; i++)
+        {
+          if (sources[i] & DIRECT_CONVERSION_OPAQUE)
+            dst[i] = 0xff;
+          else if (i == conversion->alpha_byte)
+            dst[i] = NARROW_2 ((v >> sources[i]) & 0x3);
+          else
+            dst[i] = NARROW_10 ((v >> sources[i]) & 0x3ff);
+        }
+      src += 4;
+      dst += 4;
+    }
+}
+
+static void
+half_to_float_span (const uint8_t *src,
+                    uint8_t       *dst,
+                    int            width)
+{
+  const uint16_t *src16 = (const uint16_t *) src;
+  float *dst32 = (float *) dst;
+  int i;
+
+  for (i = 0; i < width * 4; i++)
+    dst32[i] = cogl_half_to_float (src16[i]);
+}
+
+static void
+float_to_half_span (const uint8_t *src,
+                    uint8_t       *dst,
+                    int            width)
+{
+  const float *src32 = (const float *) src;
+  uint16_t *dst16 = (uint16_t *) dst;
+  int i;
+
+  for (i = 0; i < width * 4; i++)
+    dst16[i] = cogl_float_to_half (src32[i]);
+}
+
+#ifdef COGL_USE_X86_DISPATCH
+
+static void
+get_swizzle_masks (const DirectConversion *conversion,
+                   uint8_t                *shuffle,
+                   uint8_t                *opaque)
+{
+  int i;
+
+  for (i = 0; i < 16; i++)
+    {
+      uint8_t source = conversion->sources[i % 4];
+
+      if (source & DIRECT_CONVERSION_OPAQUE)
+        {
+          shuffle[i] = 0x80;
+          opaque[i] = 0xff;
+        }
+      else
+        {
+          shuffle[i] = (i & ~3) + source;
+          opaque[i] = 0;
+        }
+    }
+}
+
+static int COGL_TARGET ("sse4.1")
+swizzle_8888_span_sse41 (const DirectConversion *conversion,
+                         const uint8_t          *src,
+                         uint8_t                *dst,
+                         int                     width)
+{
+  uint8_t shuffle_bytes[16];
+  uint8_t opaque_bytes[16];
+  __m128i shuffle, opaque;
+  int n;
+
+  get_swizzle_masks (conversion, shuffle_bytes, opaque_bytes);
+  shuffle = _mm_loadu_si128 ((const __m128i *) shuffle_bytes);
+  opaque = _mm_loadu_si128 ((const __m128i *) opaque_bytes);
+
+  for (n = 0; n + 4 <= width; n += 4)
+    {
+      __m128i pixels = _mm_loadu_si128 ((const __m128i *) src);
+
+      pixels = _mm_or_si128 (_mm_shuffle_epi8 (pixels, shuffle), opaque);
+      _mm_storeu_si128 ((__m128i *) dst, pixels);
+      src += 4 * 4;
+      dst += 4 * 4;
+    }
+
+  return n;
+}
+
+static int COGL_TARGET ("avx2")
+swizzle_8888_span_avx2 (const DirectConversion *conversion,
+                        const uint8_t          *src,
+                        uint8_t                *dst,
+                        int                     width)
+{
+  uint8_t shuffle_bytes[16];
+  uint8_t opaque_bytes[16];
+  __m256i shuffle, opaque;
+  int n;
+
+  /* vpshufb shuffles within each 128-bit lane, so the same masks are
+   * used for both halves */
+  get_swizzle_masks (conversion, shuffle_bytes, opaque_bytes);
+  shuffle = _mm256_broadcastsi128_si256 (
+    _mm_loadu_si128 ((const __m128i *) shuffle_bytes));
+  opaque = _mm256_broadcastsi128_si256 (
+    _mm_loadu_si128 ((const __m128i *) opaque_bytes));
+
+  for (n = 0; n + 8 <= width; n += 8)
+    {
+      __m256i pixels = _mm256_loadu_si256 ((const __m256i *) src);
+
+      pixels = _mm256_or_si256 (_mm256_shuffle_epi8 (pixels, shuffle), opaque);
+      _mm256_storeu_si256 ((__m256i *) dst, pixels);
+      src += 8 * 4;
+      dst += 8 * 4;
+    }
+
+  return n;
+}
+
+static int COGL_TARGET ("sse4.1")
+narrow_2101010_span_sse41 (const DirectConversion *conversion,
+                           const uint8_t          *src,
+                           uint8_t                *dst,
+                           int                     width)
+{
+  const __m128i mask_10 = _mm_set1_epi32 (0x3ff);
+  const __m128i mask_2 = _mm_set1_epi32 (0x3);
+  const __m128i scale_10 = _mm_set1_epi32 (1021);
+  const __m128i bias_10 = _mm_set1_epi32 (2048);
+  const __m128i scale_2 = _mm_set1_epi32 (85);
+  uint32_t opaque_bits = 0;
+  __m128i opaque;
+  int n, i;
+
+  for (i = 0; i < 4; i++)
+    {
+      if (conversion->sources[i] & DIRECT_CONVERSION_OPAQUE)
+        opaque_bits |= 0xffu << (i * 8);
+    }
+  opaque = _mm_set1_epi32 ((int) opaque_bits);
+
+  for (n = 0; n + 4 <= width; n += 4)
+    {
+      __m128i pixels = _mm_loadu_si128 ((const __m128i *) src);
+      __m128i result = opaque;
+
+      for (i = 0; i < 4; i++)
+        {
+          uint8_t source = conversion->sources[i];
+          __m128i component;
+
+          if (source & DIRECT_CONVERSION_OPAQUE)
+            continue;
+
+          component = _mm_srl_epi32 (pixels, _mm_cvtsi32_si128 (source));
+          if (i == conversion->alpha_byte)
+            {
+              component = _mm_mullo_epi32 (_mm_and_si128 (component, mask_2),
+                                           scale_2);
+            }
+          else
+            {
+              component = _mm_mullo_epi32 (_mm_and_si128 (component, mask_10),
+                                           scale_10);
+              component = _mm_srli_epi32 (_mm_add_epi32 (component, bias_10),
+                                          12);
+            }
+
+          result = _mm_or_si128 (result,
+                                 _mm_sll_epi32 (component,
+                                                _mm_cvtsi32_si128 (i * 8)));
+        }
+
+      _mm_storeu_si128 ((__m128i *) dst, result);
+      src += 4 * 4;
+      dst += 4 * 4;
+    }
+
+  return n;
+}
+
+static int COGL_TARGET ("avx2")
+narrow_2101010_span_avx2 (const DirectConversion *conversion,
+                          const uint8_t          *src,
+                          uint8_t                *dst,
+                          int                     width)
+{
+  const __m256i mask_10 = _mm256_set1_epi32 (0x3ff);
+  const __m256i mask_2 = _mm256_set1_epi32 (0x3);
+  const __m256i scale_10 = _mm256_set1_epi32 (1021);
+  const __m256i bias_10 = _mm256_set1_epi32 (2048);
+  const __m256i scale_2 = _mm256_set1_epi32 (85);
+  uint32_t opaque_bits = 0;
+  __m256i opaque;
+  int n, i;
+
+  for (i = 0; i < 4; i++)
+    {
+      if (conversion->sources[i] & DIRECT_CONVERSION_OPAQUE)
+        opaque_bits |= 0xffu << (i * 8);
+    }
+  opaque = _mm256_set1_epi32 ((int) opaque_bits);
+
+  for (n = 0; n + 8 <= width; n += 8)
+    {
+      __m256i pixels = _mm256_loadu_si256 ((const __m256i *) src);
+      __m256i result = opaque;
+
+      for (i = 0; i < 4; i++)
+        {
+          uint8_t source = conversion->sources[i];
+          __m256i component;
+
+          if (source & DIRECT_CONVERSION_OPAQUE)
+            continue;
+
+          component = _mm256_srl_epi32 (pixels, _mm_cvtsi32_si128 (source));
+          if (i == conversion->alpha_byte)
+            {
+              component = _mm256_mullo_epi32 (_mm256_and_si256 (component,
+                                                                mask_2),
+                                              scale_2);
+            }
+          else
+            {
+              component = _mm256_mullo_epi32 (_mm256_and_si256 (component,
+                                                                mask_10),
+                                              scale_10);
+              component = _mm256_srli_epi32 (_mm256_add_epi32 (component,
+                                                               bias_10),
+                                             12);
+            }
+
+          result = _mm256_or_si256 (result,
+                                    _mm256_sll_epi32 (component,
+                                                      _mm_cvtsi32_si128 (i * 8)));
+        }
+
+      _mm256_storeu_si256 ((__m256i *) dst, result);
+      src += 8 * 4;
+      dst += 8 * 4;
+    }
+
+  return n;
+}
+
+static int COGL_TARGET ("avx,f16c")
+half_to_float_span_f16c (const uint8_t *src,
+                         uint8_t       *dst,
+                         int            width)
+{
+  int n;
+
+  for (n = 0; n + 2 <= width; n += 2)
+    {
+      __m128i halves = _mm_loadu_si128 ((const __m128i *) src);
+
+      _mm256_storeu_ps ((float *) dst, _mm256_cvtph_ps (halves));
+      src += 2 * 8;
+      dst += 2 * 16;
+    }
+
+  return n;
+}
+
+static int COGL_TARGET ("avx,f16c")
+float_to_half_span_f16c (const uint8_t *src,
+                         uint8_t       *dst,
+                         int            width)
+{
+  int n;
+
+  for (n = 0; n + 2 <= width; n += 2)
+    {
+      __m256 floats = _mm256_loadu_ps ((const float *) src);
+
+      /* Round to nearest like cogl_float_to_half() */
+      _mm_storeu_si128 ((__m128i *) dst,
+                        _mm256_cvtps_ph (floats, _MM_FROUND_TO_NEAREST_INT));
+      src += 2 * 16;
+      dst += 2 * 8;
+    }
+
+  return n;
+}
+
+#endif /* COGL_USE_X86_DISPATCH */
+
+#ifdef COGL_USE_NEON
+
+static int
+swizzle_8888_span_neon (const DirectConversion *conversion,
+                        const uint8_t          *src,
+                        uint8_t                *dst,
+                        int                     width)
+{
+  uint8_t shuffle_bytes[16];
+  uint8_t opaque_bytes[16];
+  uint8x16_t shuffle, opaque;
+  int n, i;
+
+  /* Out of range indices give zero with vqtbl1q_u8() */
+  for (i = 0; i < 16; i++)
+    {
+      uint8_t source = conversion->sources[i % 4];
+
+      if (source & DIRECT_CONVERSION_OPAQUE)
+        {
+          shuffle_bytes[i] = 0xff;
+          opaque_bytes[i] = 0xff;
+        }
+      else
+        {
+          shuffle_bytes[i] = (i & ~3) + source;
+          opaque_bytes[i] = 0;
+        }
+    }
+  shuffle = vld1q_u8 (shuffle_bytes);
+  opaque = vld1q_u8 (opaque_bytes);
+
+  for (n = 0; n + 4 <= width; n += 4)
+    {
+      uint8x16_t pixels = vld1q_u8 (src);
+
+      vst1q_u8 (dst, vorrq_u8 (vqtbl1q_u8 (pixels, shuffle), opaque));
+      src += 4 * 4;
+      dst += 4 * 4;
+    }
+
+  return n;
+}
+
+static int
+half_to_float_span_neon (const uint8_t *src,
+                         uint8_t       *dst,
+                         int            width)
+{
+  int n;
+
+  for (n = 0; n < width; n++)
+    {
+      float16x4_t halves;
+
+      halves = vreinterpret_f16_u16 (vld1_u16 ((const uint16_t *) src));
+
+      vst1q_f32 ((float *) dst, vcvt_f32_f16 (halves));
+      src += 8;
+      dst += 16;
+    }
+
+  return n;
+}
+
+static int
+float_to_half_span_neon (const uint8_t *src,
+                         uint8_t       *dst,
+                         int            width)
+{
+  int n;
+
+  for (n = 0; n < width; n++)
+    {
+      float32x4_t floats = vld1q_f32 ((const float *) src);
+
+      vst1_u16 ((uint16_t *) dst, vreinterpret_u16_f16 (vcvt_f16_f32 (floats)));
+      src += 16;
+      dst += 8;
+    }
+
+  return n;
+}
+
+#endif /* COGL_USE_NEON */
+
+static void
+direct_convert_span (const DirectConversion *conversion,
+                     const uint8_t          *src,
+                     uint8_t                *dst,
+                     int                     width)
+{
+  int n = 0;
+
+  switch (conversion->type)
+    {
+    case DIRECT_CONVERSION_SWIZZLE_8888:
+#if defined(COGL_USE_X86_DISPATCH)
+      if (cogl_cpu_has_cap (COGL_CPU_CAP_AVX2))
+        n = swizzle_8888_span_avx2 (conversion, src, dst, width);
+      else if (cogl_cpu_has_cap (COGL_CPU_CAP_SSE4_1))
+        n = swizzle_8888_span_sse41 (conversion, src, dst, width);
+#elif defined(COGL_USE_NEON)
+      n = swizzle_8888_span_neon (conversion, src, dst, width);
+#endif
+      swizzle_8888_span (conversion, src + n * 4, dst + n * 4, width - n);
+      break;
+
+    case DIRECT_CONVERSION_NARROW_2101010:
+#if defined(COGL_USE_X86_DISPATCH)
+      if (cogl_cpu_has_cap (COGL_CPU_CAP_AVX2))
+        n = narrow_2101010_span_avx2 (conversion, src, dst, width);
+      else if (cogl_cpu_has_cap (COGL_CPU_CAP_SSE4_1))
+        n = narrow_2101010_span_sse41 (conversion, src, dst, width);
+#endif
+      narrow_2101010_span (conversion, src + n * 4, dst + n * 4, width - n);
+      break;
+
+    case DIRECT_CONVERSION_HALF_TO_FLOAT:
+#if defined(COGL_USE_X86_DISPATCH)
+      if (cogl_cpu_has_cap (COGL_CPU_CAP_F16C))
+        n = half_to_float_span_f16c (src, dst, width);
+#elif defined(COGL_USE_NEON)
+      n = half_to_float_span_neon (src, dst, width);
+#endif
+      half_to_float_span (src + n * 8, dst + n * 16, width - n);
+      break;
+
+    case DIRECT_CONVERSION_FLOAT_TO_HALF:
+#if defined(COGL_USE_X86_DISPATCH)
+      if (cogl_cpu_has_cap (COGL_CPU_CAP_F16C))
+        n = float_to_half_span_f16c (src, dst, width);
+#elif defined(COGL_USE_NEON)
+      n = float_to_half_span_neon (src, dst, width);
+#endif
+      float_to_half_span (src + n * 16, dst + n * 8, width - n);
+      break;
+    }
+}
+
+#undef NARROW_10
+#undef NARROW_2
+
 gboolean
 _cogl_bitmap_convert_into_bitmap (CoglBitmap *src_bmp,
                                   CoglBitmap *dst_bmp,
@@ -577,6 +1386,8 @@ _cogl_bitmap_convert_into_bitmap (CoglBitmap *src_bmp,
   CoglPixelFormat dst_format;
   MediumType medium_type;
   gboolean need_premult;
+  DirectConversion direct_conversion;
+  gboolean use_direct_conversion;
 
   src_format = cogl_bitmap_get_format (src_bmp);
   src_rowstride = cogl_bitmap_get_rowstride (src_bmp);
@@ -636,17 +1447,38 @@ _cogl_bitmap_convert_into_bitmap (CoglBitmap *src_bmp,
       return FALSE;
     }
 
+  use_direct_conversion = find_direct_conversion (src_format, dst_format,
+                                                  need_premult,
+                                                  &direct_conversion);
+
   medium_type = determine_medium_size (dst_format);
 
   /* Allocate a buffer to hold a temporary RGBA row */
-  tmp_row = g_malloc (width * calculate_medium_size_pixel_size (medium_type));
+  if (use_direct_conversion)
+    tmp_row = NULL;
+  else
+    tmp_row = g_malloc (width * calculate_medium_size_pixel_size (medium_type));
 
-  /* FIXME: Optimize */
   for (y = 0; y < height; y++)
     {
       src = src_data + y * src_rowstride;
       dst = dst_data + y * dst_rowstride;
 
+      if (use_direct_conversion)
+        {
+          direct_convert_span (&direct_conversion, src, dst, width);
+
+          if (need_premult)
+            {
+              if (dst_format & COGL_PREMULT_BIT)
+                _cogl_bitmap_premult_span_8888 (dst_format, dst, width);
+              else
+                _cogl_bitmap_unpremult_span_8888 (dst_format, dst, width);
+            }
+
+          continue;
+        }
+
       switch (medium_type)
         {
         case MEDIUM_TYPE_8:
@@ -839,7 +1671,7 @@ _cogl_bitmap_unpremult (CoglBitmap *bmp,
 {
   uint8_t *p, *data;
   uint16_t *tmp_row;
-  int x,y;
+  int y;
   CoglPixelFormat format;
   int width, height;
   int rowstride;
@@ -875,21 +1707,7 @@ _cogl_bitmap_unpremult (CoglBitmap *bmp,
           _cogl_pack_16 (format, tmp_row, p, width);
         }
       else
-        {
-          if (format & COGL_AFIRST_BIT)
-            {
-              for (x = 0; x < width; x++)
-                {
-                  if (p[0] == 0)
-                    _cogl_unpremult_alpha_0 (p);
-                  else
-                    _cogl_unpremult_alpha_first (p);
-                  p += 4;
-                }
-            }
-          else
-            _cogl_bitmap_unpremult_unpacked_span_8 (p, width);
-        }
+        _cogl_bitmap_unpremult_span_8888 (format, p, width);
     }
 
   g_free (tmp_row);
@@ -907,7 +1725,7 @@ _cogl_bitmap_premult (CoglBitmap *bmp,
 {
   uint8_t *p, *data;
   uint16_t *tmp_row;
-  int x,y;
+  int y;
   CoglPixelFormat format;
   int width, height;
   int rowstride;
@@ -942,18 +1760,7 @@ _cogl_bitmap_premult (CoglBitmap *bmp,
           _cogl_pack_16 (format, tmp_row, p, width);
         }
       else
-        {
-          if (format & COGL_AFIRST_BIT)
-            {
-              for (x = 0; x < width; x++)
-                {
-                  _cogl_premult_alpha_first (p);
-                  p += 4;
-                }
-            }
-          else
-            _cogl_bitmap_premult_unpacked_span_8 (p, width);
-        }
+        _cogl_bitmap_premult_span_8888 (format, p, width);
     }
 
   g_free (tmp_row);
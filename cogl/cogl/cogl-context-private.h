@@ -102,6 +102,16 @@ cogl_context_set_current_pipeline_unknown_color_alpha (CoglContext *context,
 COGL_EXPORT_TEST
 CoglPipelineCache * cogl_context_get_pipeline_cache (CoglContext *context);
 
+void
+cogl_context_notify_program_built (CoglContext *context);
+
+void
+cogl_context_notify_program_loaded (CoglContext *context);
+
+void
+cogl_context_add_journal_flush_time (CoglContext *context,
+                                     int64_t      time_us);
+
 CoglFramebuffer *
 cogl_context_get_current_draw_buffer (CoglContext *context);
 
@@ -162,6 +162,13 @@ typedef struct _CoglContextPrivate
   int n_uniform_names;
 
   GHashTable *named_pipelines;
+
+  /* Number of GPU programs built for pipelines so far */
+  unsigned int n_built_programs;
+  unsigned int n_loaded_programs;
+
+  /* CPU time spent flushing journals so far */
+  int64_t journal_flush_time_us;
 } CoglContextPrivate;
 
 
@@ -466,6 +473,61 @@ cogl_context_flush (CoglContext *context)
     _cogl_framebuffer_flush_journal (l->data);
 }
 
+unsigned int
+cogl_context_get_n_built_programs (CoglContext *context)
+{
+  CoglContextPrivate *priv =
+    cogl_context_get_instance_private (context);
+
+  return priv->n_built_programs;
+}
+
+void
+cogl_context_notify_program_built (CoglContext *context)
+{
+  CoglContextPrivate *priv =
+    cogl_context_get_instance_private (context);
+
+  priv->n_built_programs++;
+}
+
+unsigned int
+cogl_context_get_n_loaded_programs (CoglContext *context)
+{
+  CoglContextPrivate *priv =
+    cogl_context_get_instance_private (context);
+
+  return priv->n_loaded_programs;
+}
+
+void
+cogl_context_notify_program_loaded (CoglContext *context)
+{
+  CoglContextPrivate *priv =
+    cogl_context_get_instance_private (context);
+
+  priv->n_loaded_programs++;
+}
+
+int64_t
+cogl_context_get_journal_flush_time (CoglContext *context)
+{
+  CoglContextPrivate *priv =
+    cogl_context_get_instance_private (context);
+
+  return priv->journal_flush_time_us;
+}
+
+void
+cogl_context_add_journal_flush_time (CoglContext *context,
+                                     int64_t      time_us)
+{
+  CoglContextPrivate *priv =
+    cogl_context_get_instance_private (context);
+
+  priv->journal_flush_time_us += time_us;
+}
+
 CoglDriver *
 cogl_context_get_driver (CoglContext *context)
 {
@@ -206,6 +206,48 @@ COGL_EXPORT CoglIndices *
 cogl_context_get_rectangle_indices (CoglContext *context,
                                     int          n_rectangles);
 
+/**
+ * cogl_context_get_n_built_programs:
+ * @context: A #CoglContext
+ *
+ * Gets the number of GPU programs that have been compiled and linked
+ * for the pipelines drawn with @context. Sampling this before and after
+ * painting a frame tells whether the frame had to wait for shader
+ * compilation. Programs loaded from the program binary cache are
+ * counted by cogl_context_get_n_loaded_programs() instead.
+ *
+ * Returns: the number of programs built so far
+ */
+COGL_EXPORT
+unsigned int cogl_context_get_n_built_programs (CoglContext *context);
+
+/**
+ * cogl_context_get_n_loaded_programs:
+ * @context: A #CoglContext
+ *
+ * Gets the number of GPU programs that have been loaded from the program
+ * binary cache for the pipelines drawn with @context, rather than being
+ * compiled.
+ *
+ * Returns: the number of programs loaded so far
+ */
+COGL_EXPORT
+unsigned int cogl_context_get_n_loaded_programs (CoglContext *context);
+
+/**
+ * cogl_context_get_journal_flush_time:
+ * @context: A #CoglContext
+ *
+ * Gets the total CPU time spent turning batched primitives into driver
+ * commands for the framebuffers of @context. Like
+ * cogl_context_get_n_built_programs(), this is meant to be sampled around
+ * a frame.
+ *
+ * Returns: the accumulated journal flush time, in microseconds
+ */
+COGL_EXPORT
+int64_t cogl_context_get_journal_flush_time (CoglContext *context);
+
 /**
  * cogl_context_get_driver:
  * @context: A #CoglContext
@@ -37,6 +37,8 @@
 typedef enum _CoglCpuCaps
 {
   COGL_CPU_CAP_F16C = 1 << 0,
+  COGL_CPU_CAP_SSE4_1 = 1 << 1,
+  COGL_CPU_CAP_AVX2 = 1 << 2,
 } CoglCpuCaps;
 
 COGL_EXPORT
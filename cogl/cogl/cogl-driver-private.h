@@ -112,6 +112,13 @@ struct _CoglDriverClass
                                              CoglPipeline           *owner,
                                              CoglPipelineLayer      *layer,
                                              CoglPipelineLayerState  change);
+
+  /* Builds the GPU program for the pipeline without drawing anything.
+   * The framebuffer is already bound when this is called.
+   */
+  void (* precompile_pipeline) (CoglDriver      *driver,
+                                CoglFramebuffer *framebuffer,
+                                CoglPipeline    *pipeline);
 };
 
 
@@ -2348,6 +2348,31 @@ _cogl_framebuffer_draw_indexed_attributes (CoglFramebuffer *framebuffer,
     }
 }
 
+void
+cogl_framebuffer_precompile_pipeline (CoglFramebuffer *framebuffer,
+                                      CoglPipeline    *pipeline)
+{
+  CoglFramebufferPrivate *priv =
+    cogl_framebuffer_get_instance_private (framebuffer);
+  CoglDriver *driver = cogl_context_get_driver (priv->context);
+  CoglDriverClass *driver_klass = COGL_DRIVER_GET_CLASS (driver);
+
+  if (!driver_klass->precompile_pipeline)
+    return;
+
+  /* Binding the framebuffer and flushing the pipeline changes the GL
+   * state behind the back of any drawing still queued in the journal,
+   * so get that out of the way first */
+  _cogl_framebuffer_flush_journal (framebuffer);
+
+  cogl_context_flush_framebuffer_state (priv->context,
+                                        framebuffer,
+                                        framebuffer,
+                                        COGL_FRAMEBUFFER_STATE_BIND);
+
+  driver_klass->precompile_pipeline (driver, framebuffer, pipeline);
+}
+
 void
 cogl_framebuffer_draw_rectangle (CoglFramebuffer *framebuffer,
                                  CoglPipeline *pipeline,
@@ -662,6 +662,25 @@ cogl_framebuffer_clear4f (CoglFramebuffer *framebuffer,
                           float blue,
                           float alpha);
 
+/**
+ * cogl_framebuffer_precompile_pipeline:
+ * @framebuffer: The #CoglFramebuffer @pipeline will be drawn to
+ * @pipeline: A #CoglPipeline state object
+ *
+ * Builds the GPU program needed to draw with @pipeline to @framebuffer
+ * without drawing anything. The program is shared with all pipelines
+ * that generate the same shader code, so this can be used to build
+ * the programs for expected pipelines ahead of time, avoiding a stall
+ * the first time one of them is drawn.
+ *
+ * Any drawing queued on @framebuffer is flushed first, so calling this
+ * in the middle of a frame is safe but defeats batching; it is best
+ * called before or after painting.
+ */
+COGL_EXPORT void
+cogl_framebuffer_precompile_pipeline (CoglFramebuffer *framebuffer,
+                                      CoglPipeline    *pipeline);
+
 /**
  * cogl_framebuffer_draw_rectangle:
  * @framebuffer: A destination #CoglFramebuffer
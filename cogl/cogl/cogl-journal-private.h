@@ -106,6 +106,27 @@ _cogl_journal_flush (CoglJournal *journal);
 void
 _cogl_journal_discard (CoglJournal *journal);
 
+/* Transforms the positions of n_quads logged quads by modelview, the way
+ * the journal does when uploading them. The scalar variant is the
+ * reference the vector kernels are tested against. */
+COGL_EXPORT_TEST void
+_cogl_journal_transform_quads (const graphene_matrix_t *modelview,
+                               const float             *vin,
+                               size_t                   in_stride,
+                               size_t                   array_stride,
+                               float                   *vout,
+                               size_t                   vb_stride,
+                               int                      n_quads);
+
+COGL_EXPORT_TEST void
+_cogl_journal_transform_quads_scalar (const graphene_matrix_t *modelview,
+                                      const float             *vin,
+                                      size_t                   in_stride,
+                                      size_t                   array_stride,
+                                      float                   *vout,
+                                      size_t                   vb_stride,
+                                      int                      n_quads);
+
 gboolean
 _cogl_journal_all_entries_within_bounds (CoglJournal *journal,
                                          float clip_x0,
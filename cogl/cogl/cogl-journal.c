@@ -48,6 +48,20 @@
 #include <gmodule.h>
 #include <math.h>
 
+/* The vertex transform kernels only use SSE2 and NEON, which are part of
+ * the baseline of x86_64 and aarch64 respectively, so unlike the pixel
+ * conversion kernels they don't need to be picked according to
+ * cogl_cpu_caps. */
+#if defined(__x86_64) && defined(__GNUC__)
+#define COGL_USE_SSE2
+#include <emmintrin.h>
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#define COGL_USE_NEON
+#include <arm_neon.h>
+#endif
+
 /* XXX NB:
  * The data logged in logged_vertices is formatted as follows:
  *
@@ -1161,6 +1175,222 @@ create_attribute_buffer (CoglJournal *journal,
   return g_object_ref (vbo);
 }
 
+/* The software transform only needs the x, y and z rows of the modelview
+ * for points with z = 0 and w = 1: each transformed vertex is
+ * x * x_axis + (y * y_axis + translation). The quad corners share their
+ * x and y values pairwise, so the products are computed once per corner
+ * coordinate and combined into the four vertices of the quad.
+ *
+ * The kernels below write the transformed positions of n_quads quads,
+ * reading the corners from vin, which is advanced by in_stride floats per
+ * quad, and writing the vertices to vout, vb_stride floats apart. The
+ * vector kernels store four floats per vertex, so the color that follows
+ * the position has to be written afterwards.
+ */
+typedef struct _JournalTransform
+{
+  float x_axis[4];
+  float y_axis[4];
+  float translation[4];
+} JournalTransform;
+
+static void
+journal_transform_init (JournalTransform        *transform,
+                        const graphene_matrix_t *matrix)
+{
+  float m[16];
+  int i;
+
+  graphene_matrix_to_float (matrix, m);
+
+  for (i = 0; i < 3; i++)
+    {
+      transform->x_axis[i] = m[i];
+      transform->y_axis[i] = m[4 + i];
+      transform->translation[i] = m[12 + i];
+    }
+
+  transform->x_axis[3] = 0.0f;
+  transform->y_axis[3] = 0.0f;
+  transform->translation[3] = 0.0f;
+}
+
+static int
+transform_quads (const JournalTransform *transform,
+                 const float            *vin,
+                 size_t                  in_stride,
+                 size_t                  array_stride,
+                 float                  *vout,
+                 size_t                  vb_stride,
+                 int                     n_quads)
+{
+  int n;
+
+  for (n = 0; n < n_quads; n++)
+    {
+      float x0 = vin[0];
+      float y0 = vin[1];
+      float x1 = vin[array_stride];
+      float y1 = vin[array_stride + 1];
+      int i;
+
+      for (i = 0; i < 3; i++)
+        {
+          float cx0 = x0 * transform->x_axis[i];
+          float cx1 = x1 * transform->x_axis[i];
+          float cy0 = y0 * transform->y_axis[i] + transform->translation[i];
+          float cy1 = y1 * transform->y_axis[i] + transform->translation[i];
+
+          vout[vb_stride * 0 + i] = cx0 + cy0;
+          vout[vb_stride * 1 + i] = cx0 + cy1;
+          vout[vb_stride * 2 + i] = cx1 + cy1;
+          vout[vb_stride * 3 + i] = cx1 + cy0;
+        }
+
+      vin += in_stride;
+      vout += vb_stride * 4;
+    }
+
+  return n;
+}
+
+#ifdef COGL_USE_SSE2
+
+static int
+transform_quads_sse2 (const JournalTransform *transform,
+                      const float            *vin,
+                      size_t                  in_stride,
+                      size_t                  array_stride,
+                      float                  *vout,
+                      size_t                  vb_stride,
+                      int                     n_quads)
+{
+  __m128 x_axis = _mm_loadu_ps (transform->x_axis);
+  __m128 y_axis = _mm_loadu_ps (transform->y_axis);
+  __m128 translation = _mm_loadu_ps (transform->translation);
+  int n;
+
+  for (n = 0; n < n_quads; n++)
+    {
+      __m128 cx0 = _mm_mul_ps (_mm_set1_ps (vin[0]), x_axis);
+      __m128 cx1 = _mm_mul_ps (_mm_set1_ps (vin[array_stride]), x_axis);
+      __m128 cy0 = _mm_add_ps (_mm_mul_ps (_mm_set1_ps (vin[1]), y_axis),
+                               translation);
+      __m128 cy1 = _mm_add_ps (_mm_mul_ps (_mm_set1_ps (vin[array_stride + 1]),
+                                           y_axis),
+                               translation);
+
+      _mm_storeu_ps (vout + vb_stride * 0, _mm_add_ps (cx0, cy0));
+      _mm_storeu_ps (vout + vb_stride * 1, _mm_add_ps (cx0, cy1));
+      _mm_storeu_ps (vout + vb_stride * 2, _mm_add_ps (cx1, cy1));
+      _mm_storeu_ps (vout + vb_stride * 3, _mm_add_ps (cx1, cy0));
+
+      vin += in_stride;
+      vout += vb_stride * 4;
+    }
+
+  return n;
+}
+
+#endif /* COGL_USE_SSE2 */
+
+#ifdef COGL_USE_NEON
+
+static int
+transform_quads_neon (const JournalTransform *transform,
+                      const float            *vin,
+                      size_t                  in_stride,
+                      size_t                  array_stride,
+                      float                  *vout,
+                      size_t                  vb_stride,
+                      int                     n_quads)
+{
+  float32x4_t x_axis = vld1q_f32 (transform->x_axis);
+  float32x4_t y_axis = vld1q_f32 (transform->y_axis);
+  float32x4_t translation = vld1q_f32 (transform->translation);
+  int n;
+
+  for (n = 0; n < n_quads; n++)
+    {
+      float32x4_t cx0 = vmulq_n_f32 (x_axis, vin[0]);
+      float32x4_t cx1 = vmulq_n_f32 (x_axis, vin[array_stride]);
+      float32x4_t cy0 = vaddq_f32 (vmulq_n_f32 (y_axis, vin[1]),
+                                   translation);
+      float32x4_t cy1 = vaddq_f32 (vmulq_n_f32 (y_axis,
+                                                vin[array_stride + 1]),
+                                   translation);
+
+      vst1q_f32 (vout + vb_stride * 0, vaddq_f32 (cx0, cy0));
+      vst1q_f32 (vout + vb_stride * 1, vaddq_f32 (cx0, cy1));
+      vst1q_f32 (vout + vb_stride * 2, vaddq_f32 (cx1, cy1));
+      vst1q_f32 (vout + vb_stride * 3, vaddq_f32 (cx1, cy0));
+
+      vin += in_stride;
+      vout += vb_stride * 4;
+    }
+
+  return n;
+}
+
+#endif /* COGL_USE_NEON */
+
+static void
+transform_quad_run (const JournalTransform *transform,
+                    const float            *vin,
+                    size_t                  in_stride,
+                    size_t                  array_stride,
+                    float                  *vout,
+                    size_t                  vb_stride,
+                    int                     n_quads)
+{
+  int n = 0;
+
+#if defined(COGL_USE_SSE2)
+  n = transform_quads_sse2 (transform, vin, in_stride, array_stride,
+                            vout, vb_stride, n_quads);
+#elif defined(COGL_USE_NEON)
+  n = transform_quads_neon (transform, vin, in_stride, array_stride,
+                            vout, vb_stride, n_quads);
+#endif
+
+  transform_quads (transform,
+                   vin + in_stride * n, in_stride, array_stride,
+                   vout + vb_stride * 4 * n, vb_stride,
+                   n_quads - n);
+}
+
+void
+_cogl_journal_transform_quads (const graphene_matrix_t *modelview,
+                               const float             *vin,
+                               size_t                   in_stride,
+                               size_t                   array_stride,
+                               float                   *vout,
+                               size_t                   vb_stride,
+                               int                      n_quads)
+{
+  JournalTransform transform;
+
+  journal_transform_init (&transform, modelview);
+  transform_quad_run (&transform, vin, in_stride, array_stride,
+                      vout, vb_stride, n_quads);
+}
+
+void
+_cogl_journal_transform_quads_scalar (const graphene_matrix_t *modelview,
+                                      const float             *vin,
+                                      size_t                   in_stride,
+                                      size_t                   array_stride,
+                                      float                   *vout,
+                                      size_t                   vb_stride,
+                                      int                      n_quads)
+{
+  JournalTransform transform;
+
+  journal_transform_init (&transform, modelview);
+  transform_quads (&transform, vin, in_stride, array_stride,
+                   vout, vb_stride, n_quads);
+}
+
 static CoglAttributeBuffer *
 upload_vertices (CoglJournal *journal,
                  const CoglJournalEntry *entries,
@@ -1174,8 +1404,6 @@ upload_vertices (CoglJournal *journal,
   float *vout;
   int entry_num;
   int i;
-  CoglMatrixEntry *last_modelview_entry = NULL;
-  graphene_matrix_t modelview;
 
   g_assert (needed_vbo_len);
 
@@ -1188,72 +1416,81 @@ upload_vertices (CoglJournal *journal,
                                                       needed_vbo_len * 4);
   vin = &g_array_index (vertices, float, 0);
 
-  /* Expand the number of vertices from 2 to 4 while uploading */
-  for (entry_num = 0; entry_num < n_entries; entry_num++)
+  /* Expand the number of vertices from 2 to 4 while uploading. Entries are
+   * handled in runs sharing a modelview and a number of layers, so that the
+   * positions of a whole run can be transformed in one go. */
+  entry_num = 0;
+  while (entry_num < n_entries)
     {
-      const CoglJournalEntry *entry = entries + entry_num;
-      size_t vb_stride = GET_JOURNAL_VB_STRIDE_FOR_N_LAYERS (entry->n_layers);
+      const CoglJournalEntry *run_start = entries + entry_num;
+      size_t vb_stride = GET_JOURNAL_VB_STRIDE_FOR_N_LAYERS (run_start->n_layers);
       size_t array_stride =
-        GET_JOURNAL_ARRAY_STRIDE_FOR_N_LAYERS (entry->n_layers);
+        GET_JOURNAL_ARRAY_STRIDE_FOR_N_LAYERS (run_start->n_layers);
+      size_t in_stride = 1 + array_stride * 2;
+      int run_length;
 
-      /* Copy the color to all four of the vertices */
-      for (i = 0; i < 4; i++)
-        memcpy (vout + vb_stride * i + POS_STRIDE, vin, 4);
-      vin++;
-
-      if (G_UNLIKELY (COGL_DEBUG_ENABLED (COGL_DEBUG_DISABLE_SOFTWARE_TRANSFORM)))
+      for (run_length = 1; entry_num + run_length < n_entries; run_length++)
         {
-          vout[vb_stride * 0] = vin[0];
-          vout[vb_stride * 0 + 1] = vin[1];
-          vout[vb_stride * 1] = vin[0];
-          vout[vb_stride * 1 + 1] = vin[array_stride + 1];
-          vout[vb_stride * 2] = vin[array_stride];
-          vout[vb_stride * 2 + 1] = vin[array_stride + 1];
-          vout[vb_stride * 3] = vin[array_stride];
-          vout[vb_stride * 3 + 1] = vin[1];
+          const CoglJournalEntry *entry = run_start + run_length;
+
+          if (entry->n_layers != run_start->n_layers ||
+              entry->modelview_entry != run_start->modelview_entry)
+            break;
         }
-      else
+
+      if (G_LIKELY (SW_TRANSFORM))
         {
-          float v[8];
-
-          v[0] = vin[0];
-          v[1] = vin[1];
-          v[2] = vin[0];
-          v[3] = vin[array_stride + 1];
-          v[4] = vin[array_stride];
-          v[5] = vin[array_stride + 1];
-          v[6] = vin[array_stride];
-          v[7] = vin[1];
-
-          if (entry->modelview_entry != last_modelview_entry)
-            cogl_matrix_entry_get (entry->modelview_entry, &modelview);
-          cogl_graphene_matrix_transform_points (&modelview,
-                                                 2, /* n_components */
-                                                 sizeof (float) * 2, /* stride_in */
-                                                 v, /* points_in */
-                                                 /* strideout */
-                                                 vb_stride * sizeof (float),
-                                                 vout, /* points_out */
-                                                 4 /* n_points */);
+          graphene_matrix_t modelview;
+          JournalTransform transform;
+
+          cogl_matrix_entry_get (run_start->modelview_entry, &modelview);
+          journal_transform_init (&transform, &modelview);
+
+          transform_quad_run (&transform,
+                              vin + 1, in_stride, array_stride,
+                              vout, vb_stride,
+                              run_length);
         }
 
-      for (i = 0; i < entry->n_layers; i++)
+      for (; run_length > 0; run_length--, entry_num++)
         {
-          const float *tin = vin + 2;
-          float *tout = vout + POS_STRIDE + COLOR_STRIDE;
-
-          tout[vb_stride * 0 + i * 2] = tin[i * 2];
-          tout[vb_stride * 0 + 1 + i * 2] = tin[i * 2 + 1];
-          tout[vb_stride * 1 + i * 2] = tin[i * 2];
-          tout[vb_stride * 1 + 1 + i * 2] = tin[array_stride + i * 2 + 1];
-          tout[vb_stride * 2 + i * 2] = tin[array_stride + i * 2];
-          tout[vb_stride * 2 + 1 + i * 2] = tin[array_stride + i * 2 + 1];
-          tout[vb_stride * 3 + i * 2] = tin[array_stride + i * 2];
-          tout[vb_stride * 3 + 1 + i * 2] = tin[i * 2 + 1];
-        }
+          const CoglJournalEntry *entry = entries + entry_num;
 
-      vin += array_stride * 2;
-      vout += vb_stride * 4;
+          /* Copy the color to all four of the vertices */
+          for (i = 0; i < 4; i++)
+            memcpy (vout + vb_stride * i + POS_STRIDE, vin, 4);
+          vin++;
+
+          if (G_UNLIKELY (!SW_TRANSFORM))
+            {
+              vout[vb_stride * 0] = vin[0];
+              vout[vb_stride * 0 + 1] = vin[1];
+              vout[vb_stride * 1] = vin[0];
+              vout[vb_stride * 1 + 1] = vin[array_stride + 1];
+              vout[vb_stride * 2] = vin[array_stride];
+              vout[vb_stride * 2 + 1] = vin[array_stride + 1];
+              vout[vb_stride * 3] = vin[array_stride];
+              vout[vb_stride * 3 + 1] = vin[1];
+            }
+
+          for (i = 0; i < entry->n_layers; i++)
+            {
+              const float *tin = vin + 2;
+              float *tout = vout + POS_STRIDE + COLOR_STRIDE;
+
+              tout[vb_stride * 0 + i * 2] = tin[i * 2];
+              tout[vb_stride * 0 + 1 + i * 2] = tin[i * 2 + 1];
+              tout[vb_stride * 1 + i * 2] = tin[i * 2];
+              tout[vb_stride * 1 + 1 + i * 2] = tin[array_stride + i * 2 + 1];
+              tout[vb_stride * 2 + i * 2] = tin[array_stride + i * 2];
+              tout[vb_stride * 2 + 1 + i * 2] = tin[array_stride + i * 2 + 1];
+              tout[vb_stride * 3 + i * 2] = tin[array_stride + i * 2];
+              tout[vb_stride * 3 + 1 + i * 2] = tin[i * 2 + 1];
+            }
+
+          vin += array_stride * 2;
+          vout += vb_stride * 4;
+        }
     }
 
   _cogl_buffer_unmap_for_fill_or_fallback (buffer);
@@ -1362,6 +1599,7 @@ _cogl_journal_flush (CoglJournal *journal)
   CoglFramebuffer *framebuffer;
   CoglContext *ctx;
   CoglJournalFlushState state;
+  int64_t start_time_us;
   int i;
   COGL_STATIC_TIMER (flush_timer,
                      "Mainloop", /* parent */
@@ -1393,6 +1631,7 @@ _cogl_journal_flush (CoglJournal *journal)
   /* Note: we start the timer after flushing dependency journals so
    * that the timer isn't started recursively. */
   COGL_TIMER_START (_cogl_uprof_context, flush_timer);
+  start_time_us = g_get_monotonic_time ();
 
   if (G_UNLIKELY (COGL_DEBUG_ENABLED (COGL_DEBUG_BATCHING)))
     g_print ("BATCHING: journal len = %d\n", journal->entries->len);
@@ -1478,6 +1717,9 @@ _cogl_journal_flush (CoglJournal *journal)
   _cogl_journal_discard (journal);
   COGL_TIMER_STOP (_cogl_uprof_context, discard_timer);
 
+  cogl_context_add_journal_flush_time (ctx,
+                                       g_get_monotonic_time () - start_time_us);
+
   COGL_TIMER_STOP (_cogl_uprof_context, flush_timer);
 }
 
@@ -42,6 +42,8 @@
 #include <GLES2/gl2ext.h>
 #endif
 
+typedef struct _CoglProgramBinaryCache CoglProgramBinaryCache;
+
 typedef struct _CoglDriverGLPrivate
 {
   int glsl_major;
@@ -59,6 +61,16 @@ typedef struct _CoglDriverGLPrivate
    when the sampler object extension is not supported */
   GLuint next_fake_sampler_object_number;
 
+  /* Persistent cache of linked GLSL programs. This is created the
+     first time a program is linked, and stays NULL if the driver
+     can't retrieve program binaries */
+  CoglProgramBinaryCache *program_binary_cache;
+  gboolean program_binary_cache_initialized;
+
+  /* Names of shaders that failed to compile, so that they aren't
+     compiled again for every program they are attached to */
+  GHashTable *failed_shaders;
+
   /* This defines a list of function pointers that Cogl uses from
      either GL or GLES. All functions are accessed indirectly through
      these pointers rather than linking to them directly */
@@ -142,6 +154,17 @@ const char * cogl_driver_gl_get_gl_version (CoglDriverGL *driver);
 
 GLint cogl_driver_gl_get_max_activateable_texture_units (CoglDriverGL *driver);
 
+CoglProgramBinaryCache * cogl_driver_gl_get_program_binary_cache (CoglDriverGL *driver);
+
+void cogl_driver_gl_set_shader_failed (CoglDriverGL *driver,
+                                       GLuint        shader);
+
+gboolean cogl_driver_gl_is_shader_failed (CoglDriverGL *driver,
+                                          GLuint        shader);
+
+void cogl_driver_gl_delete_shader (CoglDriverGL *driver,
+                                   GLuint        shader);
+
 gboolean cogl_parse_gl_version (const char *version_string,
                                 int        *major_out,
                                 int        *minor_out);
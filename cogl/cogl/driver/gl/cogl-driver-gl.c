@@ -40,6 +40,7 @@
 #include "cogl/driver/gl/cogl-pipeline-fragend-glsl-private.h"
 #include "cogl/driver/gl/cogl-pipeline-vertend-glsl-private.h"
 #include "cogl/driver/gl/cogl-pipeline-progend-glsl-private.h"
+#include "cogl/driver/gl/cogl-program-binary-cache-gl-private.h"
 
 /* This is a relatively new extension */
 #ifndef GL_PURGED_CONTEXT_RESET_NV
@@ -83,6 +84,10 @@ cogl_driver_gl_dispose (GObject *object)
       g_clear_pointer (&priv->texture_units, g_array_unref);
     }
 
+  g_clear_pointer (&priv->program_binary_cache,
+                   cogl_program_binary_cache_free);
+  g_clear_pointer (&priv->failed_shaders, g_hash_table_unref);
+
   G_OBJECT_CLASS (cogl_driver_gl_parent_class)->dispose (object);
 }
 
@@ -455,6 +460,19 @@ cogl_driver_gl_pipeline_layer_pre_change_notify (CoglDriver             *driver,
   cogl_pipeline_progend_glsl_layer_pre_change_notify (owner, layer, change);
 }
 
+static void
+cogl_driver_gl_precompile_pipeline (CoglDriver      *driver,
+                                    CoglFramebuffer *framebuffer,
+                                    CoglPipeline    *pipeline)
+{
+  CoglContext *ctx = cogl_framebuffer_get_context (framebuffer);
+
+  /* Flushing the pipeline generates, compiles and links its program
+   * and leaves the GL state consistent with what the context thinks
+   * is current, so subsequent draws just see a pipeline change */
+  _cogl_pipeline_flush_gl_state (ctx, pipeline, framebuffer, FALSE, FALSE);
+}
+
 static void
 cogl_driver_gl_class_init (CoglDriverGLClass *klass)
 {
@@ -474,6 +492,7 @@ cogl_driver_gl_class_init (CoglDriverGLClass *klass)
   driver_klass->sampler_init = cogl_driver_gl_sampler_init_init;
   driver_klass->sampler_free = cogl_driver_gl_sampler_free;
   driver_klass->set_uniform = cogl_driver_gl_set_uniform; /* XXX name is weird... */
+  driver_klass->precompile_pipeline = cogl_driver_gl_precompile_pipeline;
   driver_klass->pipeline_pre_change_notify = cogl_driver_gl_pipeline_pre_change_notify;
   driver_klass->pipeline_layer_pre_change_notify = cogl_driver_gl_pipeline_layer_pre_change_notify;
 }
@@ -712,6 +731,56 @@ cogl_driver_gl_get_max_activateable_texture_units (CoglDriverGL *driver)
   return priv->max_activateable_texture_units;
 }
 
+CoglProgramBinaryCache *
+cogl_driver_gl_get_program_binary_cache (CoglDriverGL *driver)
+{
+  CoglDriverGLPrivate *priv = cogl_driver_gl_get_instance_private (driver);
+
+  if (G_UNLIKELY (!priv->program_binary_cache_initialized))
+    {
+      priv->program_binary_cache = cogl_program_binary_cache_new (driver);
+      priv->program_binary_cache_initialized = TRUE;
+    }
+
+  return priv->program_binary_cache;
+}
+
+void
+cogl_driver_gl_set_shader_failed (CoglDriverGL *driver,
+                                  GLuint        shader)
+{
+  CoglDriverGLPrivate *priv = cogl_driver_gl_get_instance_private (driver);
+
+  if (!priv->failed_shaders)
+    priv->failed_shaders = g_hash_table_new (NULL, NULL);
+
+  g_hash_table_add (priv->failed_shaders, GUINT_TO_POINTER (shader));
+}
+
+gboolean
+cogl_driver_gl_is_shader_failed (CoglDriverGL *driver,
+                                 GLuint        shader)
+{
+  CoglDriverGLPrivate *priv = cogl_driver_gl_get_instance_private (driver);
+
+  return priv->failed_shaders &&
+         g_hash_table_contains (priv->failed_shaders,
+                                GUINT_TO_POINTER (shader));
+}
+
+void
+cogl_driver_gl_delete_shader (CoglDriverGL *driver,
+                              GLuint        shader)
+{
+  CoglDriverGLPrivate *priv = cogl_driver_gl_get_instance_private (driver);
+
+  /* The name may be reused by the next shader that is created */
+  if (priv->failed_shaders)
+    g_hash_table_remove (priv->failed_shaders, GUINT_TO_POINTER (shader));
+
+  GE (driver, glDeleteShader (shader));
+}
+
 /* Parses a GL version number stored in a string. @version_string must
  * point to the beginning of the version number (ie, it can't point to
  * the "OpenGL ES" part on GLES). The version number can be followed
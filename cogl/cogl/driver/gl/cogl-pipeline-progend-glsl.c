@@ -51,6 +51,7 @@
 #include "cogl/driver/gl/cogl-pipeline-fragend-glsl-private.h"
 #include "cogl/driver/gl/cogl-pipeline-vertend-glsl-private.h"
 #include "cogl/driver/gl/cogl-pipeline-progend-glsl-private.h"
+#include "cogl/driver/gl/cogl-program-binary-cache-gl-private.h"
 
 /* These are used to generalise updating some uniforms that are
    required when building for drivers missing some fixed function
@@ -350,6 +351,42 @@ dirty_program_state (CoglPipeline *pipeline)
                            NULL);
 }
 
+static void
+ensure_shader_compiled (CoglDriver *driver,
+                        GLuint      shader)
+{
+  GLint compile_status;
+
+  /* The fragend and vertend only set the source of their shaders, and
+   * a shader can be shared between several programs, so only compile
+   * it the first time a program that isn't in the binary cache needs
+   * it */
+  GE (driver, glGetShaderiv (shader, GL_COMPILE_STATUS, &compile_status));
+  if (compile_status)
+    return;
+
+  /* A failed compilation leaves the status unset, so remember the
+   * failure rather than compiling and warning again each time */
+  if (cogl_driver_gl_is_shader_failed (COGL_DRIVER_GL (driver), shader))
+    return;
+
+  GE (driver, glCompileShader (shader));
+  GE (driver, glGetShaderiv (shader, GL_COMPILE_STATUS, &compile_status));
+
+  if (!compile_status)
+    {
+      GLint len = 0;
+      char *shader_log;
+
+      GE (driver, glGetShaderiv (shader, GL_INFO_LOG_LENGTH, &len));
+      shader_log = g_alloca (len);
+      GE (driver, glGetShaderInfoLog (shader, len, &len, shader_log));
+      g_warning ("Shader compilation failed:\n%s", shader_log);
+
+      cogl_driver_gl_set_shader_failed (COGL_DRIVER_GL (driver), shader);
+    }
+}
+
 static void
 link_program (CoglContext *ctx,
               GLint        gl_program)
@@ -774,24 +811,70 @@ cogl_pipeline_progend_glsl_end (CoglPipeline  *pipeline,
 
   if (program_state->program == 0)
     {
-      GLuint backend_shader;
+      CoglProgramBinaryCache *binary_cache;
+      g_autofree char *binary_key = NULL;
+      GLuint backend_shaders[2];
+      int i;
 
       GE_RET (program_state->program, driver, glCreateProgram ());
 
-      /* Attach any shaders from the GLSL backends */
-      if ((backend_shader = _cogl_pipeline_fragend_glsl_get_shader (pipeline)))
-        GE (driver, glAttachShader (program_state->program, backend_shader));
-      if ((backend_shader = _cogl_pipeline_vertend_glsl_get_shader (pipeline)))
-        GE (driver, glAttachShader (program_state->program, backend_shader));
+      backend_shaders[0] = _cogl_pipeline_fragend_glsl_get_shader (pipeline);
+      backend_shaders[1] = _cogl_pipeline_vertend_glsl_get_shader (pipeline);
 
-      /* XXX: OpenGL as a special case requires the vertex position to
-       * be bound to generic attribute 0 so for simplicity we
-       * unconditionally bind the cogl_position_in attribute here...
-       */
-      GE (driver, glBindAttribLocation (program_state->program,
-                                        0, "cogl_position_in"));
+      binary_cache =
+        cogl_driver_gl_get_program_binary_cache (COGL_DRIVER_GL (driver));
+      if (binary_cache)
+        {
+          binary_key =
+            cogl_program_binary_cache_compute_key (binary_cache,
+                                                   COGL_DRIVER_GL (driver),
+                                                   backend_shaders,
+                                                   G_N_ELEMENTS (backend_shaders));
+        }
+
+      if (!binary_key ||
+          !cogl_program_binary_cache_load (binary_cache,
+                                           COGL_DRIVER_GL (driver),
+                                           binary_key,
+                                           program_state->program))
+        {
+          /* Attach any shaders from the GLSL backends */
+          for (i = 0; i < G_N_ELEMENTS (backend_shaders); i++)
+            {
+              if (!backend_shaders[i])
+                continue;
+
+              ensure_shader_compiled (driver, backend_shaders[i]);
+              GE (driver, glAttachShader (program_state->program,
+                                          backend_shaders[i]));
+            }
+
+          /* XXX: OpenGL as a special case requires the vertex position to
+           * be bound to generic attribute 0 so for simplicity we
+           * unconditionally bind the cogl_position_in attribute here...
+           */
+          GE (driver, glBindAttribLocation (program_state->program,
+                                            0, "cogl_position_in"));
 
-      link_program (ctx, program_state->program);
+          if (binary_key && GE_HAS (driver, glProgramParameteri))
+            GE (driver, glProgramParameteri (program_state->program,
+                                             GL_PROGRAM_BINARY_RETRIEVABLE_HINT,
+                                             GL_TRUE));
+
+          link_program (ctx, program_state->program);
+
+          if (binary_key)
+            cogl_program_binary_cache_store (binary_cache,
+                                             COGL_DRIVER_GL (driver),
+                                             binary_key,
+                                             program_state->program);
+
+          cogl_context_notify_program_built (ctx);
+        }
+      else
+        {
+          cogl_context_notify_program_loaded (ctx);
+        }
 
       program_changed = TRUE;
     }
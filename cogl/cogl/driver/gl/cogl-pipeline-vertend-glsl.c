@@ -120,7 +120,8 @@ destroy_shader_state (void *user_data)
         {
           CoglDriver *driver = cogl_context_get_driver (ctx);
 
-          GE (driver, glDeleteShader (shader_state->gl_shader));
+          cogl_driver_gl_delete_shader (COGL_DRIVER_GL (driver),
+                                        shader_state->gl_shader);
         }
 
       g_free (shader_state);
@@ -603,7 +604,6 @@ cogl_pipeline_vertend_glsl_end (CoglPipeline  *pipeline,
       CoglDriver *driver = cogl_context_get_driver (ctx);
       const char *source_strings[2];
       GLint lengths[2];
-      GLint compile_status;
       GLuint shader;
       CoglPipelineSnippetData snippet_data;
       CoglPipelineSnippetList *vertex_snippets;
@@ -714,19 +714,9 @@ cogl_pipeline_vertend_glsl_end (CoglPipeline  *pipeline,
                                                      2, /* count */
                                                      source_strings, lengths);
 
-      GE (driver, glCompileShader (shader));
-      GE (driver, glGetShaderiv (shader, GL_COMPILE_STATUS, &compile_status));
-
-      if (!compile_status)
-        {
-          GLint len = 0;
-          char *shader_log;
-
-          GE (driver, glGetShaderiv (shader, GL_INFO_LOG_LENGTH, &len));
-          shader_log = g_alloca (len);
-          GE (driver, glGetShaderInfoLog (shader, len, &len, shader_log));
-          g_warning ("Shader compilation failed:\n%s", shader_log);
-        }
+      /* Compilation is deferred to the progend so that it can be
+       * skipped entirely when the linked program is found in the
+       * program binary cache */
 
       shader_state->header = NULL;
       shader_state->source = NULL;
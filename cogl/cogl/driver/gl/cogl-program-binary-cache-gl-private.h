@@ -0,0 +1,63 @@
+/*
+ * Cogl
+ *
+ * A Low Level GPU Graphics and Utilities API
+ *
+ * Copyright (C) 2026 Red Hat.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#pragma once
+
+#include "cogl/driver/gl/cogl-driver-gl-private.h"
+
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+
+/*
+ * CoglProgramBinaryCache:
+ *
+ * A persistent cache of linked GLSL program binaries, stored under the
+ * user cache directory. Entries are keyed on a hash of the driver
+ * identity and the complete source of every attached shader, so a
+ * driver update or a change to the generated code never hits a stale
+ * entry. New entries are written to disk from a worker thread.
+ */
+CoglProgramBinaryCache * cogl_program_binary_cache_new (CoglDriverGL *driver);
+
+void cogl_program_binary_cache_free (CoglProgramBinaryCache *cache);
+
+char * cogl_program_binary_cache_compute_key (CoglProgramBinaryCache *cache,
+                                              CoglDriverGL           *driver,
+                                              const GLuint           *shaders,
+                                              int                     n_shaders);
+
+gboolean cogl_program_binary_cache_load (CoglProgramBinaryCache *cache,
+                                         CoglDriverGL           *driver,
+                                         const char             *key,
+                                         GLuint                  program);
+
+void cogl_program_binary_cache_store (CoglProgramBinaryCache *cache,
+                                      CoglDriverGL           *driver,
+                                      const char             *key,
+                                      GLuint                  program);
@@ -0,0 +1,478 @@
+/*
+ * Cogl
+ *
+ * A Low Level GPU Graphics and Utilities API
+ *
+ * Copyright (C) 2026 Red Hat.
+ *
+ * Permission is hereby granted, free of charge, to any person
+ * obtaining a copy of this software and associated documentation
+ * files (the "Software"), to deal in the Software without
+ * restriction, including without limitation the rights to use, copy,
+ * modify, merge, publish, distribute, sublicense, and/or sell copies
+ * of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be
+ * included in all copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS
+ * BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN
+ * ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+ * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ */
+
+#include "config.h"
+
+#include <glib/gstdio.h>
+#include <string.h>
+
+#include "cogl/cogl-debug.h"
+#include "cogl/driver/gl/cogl-program-binary-cache-gl-private.h"
+
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+#ifndef GL_SHADER_SOURCE_LENGTH
+#define GL_SHADER_SOURCE_LENGTH 0x8B88
+#endif
+
+#define COGL_PROGRAM_BINARY_MAGIC "CoglPB01"
+
+/* A single program binary larger than this is almost certainly not
+ * worth keeping around, and the total keeps a misbehaving driver from
+ * filling up the cache directory */
+#define COGL_PROGRAM_BINARY_MAX_ENTRY_SIZE (4 * 1024 * 1024)
+#define COGL_PROGRAM_BINARY_MAX_TOTAL_SIZE (32 * 1024 * 1024)
+
+/* Listing the cache directory is costly, so even when concurrent
+ * sessions keep pushing the total over the limit, eviction is only
+ * attempted once every this many stores */
+#define COGL_PROGRAM_BINARY_EVICTION_INTERVAL 16
+
+typedef struct
+{
+  char magic[8];
+  uint32_t binary_format;
+  uint32_t length;
+  uint8_t checksum[32];
+} CoglProgramBinaryHeader;
+
+G_STATIC_ASSERT (sizeof (CoglProgramBinaryHeader) == 48);
+
+struct _CoglProgramBinaryCache
+{
+  char *path;
+
+  /* Everything about the driver that could make a binary produced by
+   * an earlier session unusable in this one */
+  char *identity;
+
+  /* Writing entries and evicting old ones happens on this single worker
+   * thread, so that the paint path never waits for the disk. The fields
+   * below are only accessed from it. */
+  GThreadPool *writer;
+
+  goffset total_size;
+  unsigned int n_stores_since_eviction;
+};
+
+typedef struct
+{
+  char *key;
+  char *path;
+  uint8_t *contents;
+  size_t size;
+} CacheWriteJob;
+
+typedef struct
+{
+  char *path;
+  goffset size;
+  guint64 mtime;
+} CacheFileInfo;
+
+static void
+cache_file_info_free (CacheFileInfo *info)
+{
+  g_free (info->path);
+  g_free (info);
+}
+
+static int
+compare_mtime (gconstpointer a,
+               gconstpointer b)
+{
+  const CacheFileInfo *info_a = *(const CacheFileInfo **) a;
+  const CacheFileInfo *info_b = *(const CacheFileInfo **) b;
+
+  if (info_a->mtime < info_b->mtime)
+    return -1;
+  else if (info_a->mtime > info_b->mtime)
+    return 1;
+  else
+    return 0;
+}
+
+static GPtrArray *
+list_cache_files (CoglProgramBinaryCache *cache)
+{
+  GPtrArray *files;
+  GDir *dir;
+  const char *name;
+
+  files = g_ptr_array_new_with_free_func ((GDestroyNotify) cache_file_info_free);
+
+  dir = g_dir_open (cache->path, 0, NULL);
+  if (!dir)
+    return files;
+
+  while ((name = g_dir_read_name (dir)))
+    {
+      g_autofree char *path = NULL;
+      GStatBuf stat_buf;
+      CacheFileInfo *info;
+
+      if (!g_str_has_suffix (name, ".bin"))
+        continue;
+
+      path = g_build_filename (cache->path, name, NULL);
+      if (g_stat (path, &stat_buf) != 0 || !S_ISREG (stat_buf.st_mode))
+        continue;
+
+      info = g_new0 (CacheFileInfo, 1);
+      info->path = g_steal_pointer (&path);
+      info->size = stat_buf.st_size;
+      info->mtime = stat_buf.st_mtime;
+      g_ptr_array_add (files, info);
+    }
+
+  g_dir_close (dir);
+
+  return files;
+}
+
+static void
+evict_entries (CoglProgramBinaryCache *cache,
+               goffset                 target_size)
+{
+  g_autoptr (GPtrArray) files = NULL;
+  goffset total_size = 0;
+  unsigned int i;
+
+  files = list_cache_files (cache);
+  for (i = 0; i < files->len; i++)
+    total_size += ((CacheFileInfo *) files->pdata[i])->size;
+
+  g_ptr_array_sort (files, compare_mtime);
+
+  for (i = 0; i < files->len && total_size > target_size; i++)
+    {
+      CacheFileInfo *info = files->pdata[i];
+
+      if (g_unlink (info->path) == 0)
+        total_size -= info->size;
+    }
+
+  cache->total_size = total_size;
+  cache->n_stores_since_eviction = 0;
+}
+
+static void
+cache_write_job_free (CacheWriteJob *job)
+{
+  g_free (job->key);
+  g_free (job->path);
+  g_free (job->contents);
+  g_free (job);
+}
+
+static void
+write_entry (CacheWriteJob          *job,
+             CoglProgramBinaryCache *cache)
+{
+  g_autoptr (GError) error = NULL;
+
+  /* A job without contents only asks for the cache to be trimmed */
+  if (!job->contents)
+    {
+      evict_entries (cache, COGL_PROGRAM_BINARY_MAX_TOTAL_SIZE);
+      goto out;
+    }
+
+  cache->n_stores_since_eviction++;
+
+  if (cache->total_size + (goffset) job->size > COGL_PROGRAM_BINARY_MAX_TOTAL_SIZE &&
+      cache->n_stores_since_eviction >= COGL_PROGRAM_BINARY_EVICTION_INTERVAL)
+    evict_entries (cache, COGL_PROGRAM_BINARY_MAX_TOTAL_SIZE * 3 / 4);
+
+  /* g_file_set_contents() writes to a temporary file and renames it
+   * into place, so concurrent sessions never see a partial entry */
+  if (!g_file_set_contents (job->path, (const char *) job->contents,
+                            job->size, &error))
+    {
+      COGL_NOTE (OPENGL, "Failed to store program binary %s: %s",
+                 job->key, error->message);
+      goto out;
+    }
+
+  cache->total_size += job->size;
+
+  COGL_NOTE (OPENGL, "Stored program binary %s (%" G_GSIZE_FORMAT " bytes)",
+             job->key, job->size);
+
+out:
+  cache_write_job_free (job);
+}
+
+CoglProgramBinaryCache *
+cogl_program_binary_cache_new (CoglDriverGL *driver)
+{
+  CoglProgramBinaryCache *cache;
+  GLint n_formats = 0;
+
+  if (COGL_DEBUG_ENABLED (COGL_DEBUG_DISABLE_PROGRAM_CACHES))
+    return NULL;
+
+  if (!GE_HAS (COGL_DRIVER (driver), glGetProgramBinary) ||
+      !GE_HAS (COGL_DRIVER (driver), glProgramBinary))
+    return NULL;
+
+  /* Drivers are allowed to advertise the extension without supporting
+   * any binary formats, in which case every load would fail */
+  GE (driver, glGetIntegerv (GL_NUM_PROGRAM_BINARY_FORMATS, &n_formats));
+  if (n_formats <= 0)
+    return NULL;
+
+  cache = g_new0 (CoglProgramBinaryCache, 1);
+  cache->path = g_build_filename (g_get_user_cache_dir (),
+                                  "mutter", "program-binaries",
+                                  NULL);
+  cache->identity =
+    g_strdup_printf ("%s\n%s\n%s\n%s\n",
+                     cogl_driver_gl_get_gl_string (driver, GL_VENDOR),
+                     cogl_driver_gl_get_gl_string (driver, GL_RENDERER),
+                     cogl_driver_gl_get_gl_string (driver, GL_VERSION),
+                     cogl_driver_gl_get_gl_string (driver,
+                                                   GL_SHADING_LANGUAGE_VERSION));
+
+  if (g_mkdir_with_parents (cache->path, 0700) != 0)
+    {
+      COGL_NOTE (OPENGL, "Program binary cache disabled: can't create %s",
+                 cache->path);
+      cogl_program_binary_cache_free (cache);
+      return NULL;
+    }
+
+  cache->writer = g_thread_pool_new_full ((GFunc) write_entry,
+                                          cache,
+                                          (GDestroyNotify) cache_write_job_free,
+                                          1, FALSE, NULL);
+
+  /* Trim what earlier sessions left behind */
+  g_thread_pool_push (cache->writer, g_new0 (CacheWriteJob, 1), NULL);
+
+  return cache;
+}
+
+void
+cogl_program_binary_cache_free (CoglProgramBinaryCache *cache)
+{
+  /* Let the entries that are already queued reach the disk */
+  if (cache->writer)
+    g_thread_pool_free (cache->writer, FALSE, TRUE);
+
+  g_free (cache->path);
+  g_free (cache->identity);
+  g_free (cache);
+}
+
+char *
+cogl_program_binary_cache_compute_key (CoglProgramBinaryCache *cache,
+                                       CoglDriverGL           *driver,
+                                       const GLuint           *shaders,
+                                       int                     n_shaders)
+{
+  g_autoptr (GChecksum) checksum = NULL;
+  int i;
+
+  checksum = g_checksum_new (G_CHECKSUM_SHA256);
+  g_checksum_update (checksum,
+                     (const guchar *) COGL_PROGRAM_BINARY_MAGIC,
+                     strlen (COGL_PROGRAM_BINARY_MAGIC));
+  g_checksum_update (checksum,
+                     (const guchar *) cache->identity,
+                     strlen (cache->identity));
+
+  for (i = 0; i < n_shaders; i++)
+    {
+      g_autofree char *source = NULL;
+      GLint source_length = 0;
+      GLint shader_type = 0;
+      GLsizei length = 0;
+
+      if (shaders[i] == 0)
+        continue;
+
+      GE (driver, glGetShaderiv (shaders[i], GL_SHADER_TYPE, &shader_type));
+      GE (driver, glGetShaderiv (shaders[i], GL_SHADER_SOURCE_LENGTH,
+                                 &source_length));
+      if (source_length <= 0)
+        return NULL;
+
+      source = g_malloc (source_length);
+      GE (driver, glGetShaderSource (shaders[i], source_length,
+                                     &length, source));
+
+      g_checksum_update (checksum,
+                         (const guchar *) &shader_type,
+                         sizeof (shader_type));
+      g_checksum_update (checksum, (const guchar *) source, length);
+    }
+
+  return g_strdup (g_checksum_get_string (checksum));
+}
+
+static void
+compute_payload_checksum (const uint8_t *payload,
+                          size_t         length,
+                          uint8_t        digest[32])
+{
+  g_autoptr (GChecksum) checksum = NULL;
+  gsize digest_len = 32;
+
+  checksum = g_checksum_new (G_CHECKSUM_SHA256);
+  g_checksum_update (checksum, payload, length);
+  g_checksum_get_digest (checksum, digest, &digest_len);
+}
+
+static char *
+get_entry_path (CoglProgramBinaryCache *cache,
+                const char             *key)
+{
+  g_autofree char *name = g_strconcat (key, ".bin", NULL);
+
+  return g_build_filename (cache->path, name, NULL);
+}
+
+gboolean
+cogl_program_binary_cache_load (CoglProgramBinaryCache *cache,
+                                CoglDriverGL           *driver,
+                                const char             *key,
+                                GLuint                  program)
+{
+  CoglDriverGLPrivate *priv = cogl_driver_gl_get_private (driver);
+  g_autofree char *path = NULL;
+  g_autofree char *contents = NULL;
+  CoglProgramBinaryHeader header;
+  uint8_t digest[32];
+  const uint8_t *payload;
+  gsize size;
+  GLint link_status = GL_FALSE;
+
+  path = get_entry_path (cache, key);
+  if (!g_file_get_contents (path, &contents, &size, NULL))
+    return FALSE;
+
+  if (size < sizeof (header))
+    goto invalid;
+
+  memcpy (&header, contents, sizeof (header));
+  payload = (const uint8_t *) contents + sizeof (header);
+
+  if (memcmp (header.magic, COGL_PROGRAM_BINARY_MAGIC,
+              sizeof (header.magic)) != 0 ||
+      header.length != size - sizeof (header) ||
+      header.length > COGL_PROGRAM_BINARY_MAX_ENTRY_SIZE)
+    goto invalid;
+
+  compute_payload_checksum (payload, header.length, digest);
+  if (memcmp (digest, header.checksum, sizeof (digest)) != 0)
+    goto invalid;
+
+  /* The driver is free to reject a binary for any reason, for example
+   * after a firmware or kernel update that didn't change any of the
+   * strings the key is built from, so errors here are expected and
+   * must not be reported as GL errors */
+  cogl_driver_gl_clear_gl_errors (driver);
+  priv->glProgramBinary (program, header.binary_format,
+                         payload, header.length);
+  if (cogl_driver_gl_get_gl_error (driver) != GL_NO_ERROR)
+    goto invalid;
+
+  GE (driver, glGetProgramiv (program, GL_LINK_STATUS, &link_status));
+  if (!link_status)
+    goto invalid;
+
+  /* Refresh the modification time so that eviction drops the entries
+   * that haven't been used for the longest time first */
+  g_utime (path, NULL);
+
+  COGL_NOTE (OPENGL, "Loaded program binary %s", key);
+
+  return TRUE;
+
+invalid:
+  COGL_NOTE (OPENGL, "Discarding invalid program binary %s", key);
+  g_unlink (path);
+
+  return FALSE;
+}
+
+void
+cogl_program_binary_cache_store (CoglProgramBinaryCache *cache,
+                                 CoglDriverGL           *driver,
+                                 const char             *key,
+                                 GLuint                  program)
+{
+  g_autofree uint8_t *contents = NULL;
+  CoglProgramBinaryHeader header = { 0 };
+  CacheWriteJob *job;
+  GLint link_status = GL_FALSE;
+  GLint binary_length = 0;
+  GLsizei length = 0;
+  GLenum binary_format = 0;
+  size_t size;
+
+  GE (driver, glGetProgramiv (program, GL_LINK_STATUS, &link_status));
+  if (!link_status)
+    return;
+
+  GE (driver, glGetProgramiv (program, GL_PROGRAM_BINARY_LENGTH,
+                              &binary_length));
+  if (binary_length <= 0 ||
+      binary_length > COGL_PROGRAM_BINARY_MAX_ENTRY_SIZE)
+    return;
+
+  size = sizeof (header) + binary_length;
+  contents = g_malloc (size);
+
+  GE (driver, glGetProgramBinary (program, binary_length, &length,
+                                  &binary_format,
+                                  contents + sizeof (header)));
+  if (length <= 0 || length > binary_length)
+    return;
+
+  size = sizeof (header) + length;
+
+  memcpy (header.magic, COGL_PROGRAM_BINARY_MAGIC, sizeof (header.magic));
+  header.binary_format = binary_format;
+  header.length = length;
+  compute_payload_checksum (contents + sizeof (header), length,
+                            header.checksum);
+  memcpy (contents, &header, sizeof (header));
+
+  job = g_new0 (CacheWriteJob, 1);
+  job->key = g_strdup (key);
+  job->path = get_entry_path (cache, key);
+  job->contents = g_steal_pointer (&contents);
+  job->size = size;
+  g_thread_pool_push (cache->writer, job, NULL);
+}
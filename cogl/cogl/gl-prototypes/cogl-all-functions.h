@@ -216,6 +216,32 @@ COGL_EXT_FUNCTION (void, glDrawBuffers,
                    (GLsizei n, const GLenum *bufs))
 COGL_EXT_END ()
 
+COGL_EXT_BEGIN (get_program_binary, 4, 1,
+                COGL_EXT_IN_GLES3,
+                "ARB:\0OES\0",
+                "get_program_binary\0")
+COGL_EXT_FUNCTION (void, glGetProgramBinary,
+                   (GLuint program,
+                    GLsizei bufsize,
+                    GLsizei *length,
+                    GLenum *binary_format,
+                    GLvoid *binary))
+COGL_EXT_FUNCTION (void, glProgramBinary,
+                   (GLuint program,
+                    GLenum binary_format,
+                    const GLvoid *binary,
+                    GLsizei length))
+COGL_EXT_END ()
+
+/* Not part of GL_OES_get_program_binary */
+COGL_EXT_BEGIN (program_parameteri, 4, 1,
+                COGL_EXT_IN_GLES3,
+                "ARB:\0",
+                "get_program_binary\0")
+COGL_EXT_FUNCTION (void, glProgramParameteri,
+                   (GLuint program, GLenum pname, GLint value))
+COGL_EXT_END ()
+
 COGL_EXT_BEGIN (robustness, 255, 255,
                 0,
                 "ARB\0",
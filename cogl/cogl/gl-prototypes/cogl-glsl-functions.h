@@ -108,6 +108,11 @@ COGL_EXT_FUNCTION (void, glShaderSource,
                     const GLint          *length))
 COGL_EXT_FUNCTION (void, glCompileShader,
                    (GLuint                shader))
+COGL_EXT_FUNCTION (void, glGetShaderSource,
+                   (GLuint                shader,
+                    GLsizei               bufsize,
+                    GLsizei              *length,
+                    char                 *source))
 COGL_EXT_FUNCTION (void, glLinkProgram,
                    (GLuint                program))
 COGL_EXT_FUNCTION (GLint, glGetUniformLocation,
@@ -241,3 +241,5 @@ uint32_t meta_evdev_tool_button_to_clutter (uint32_t evdev_button);
 
 ClutterCursor * meta_backend_get_cursor (MetaBackend       *backend,
                                          ClutterCursorType  cursor_type);
+
+MetaCursorTheme * meta_backend_get_cursor_theme (MetaBackend *backend);
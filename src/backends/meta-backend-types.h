@@ -79,6 +79,8 @@ typedef struct _MetaBarrierImpl MetaBarrierImpl;
 
 typedef struct _MetaIdleManager MetaIdleManager;
 
+typedef struct _MetaCursorTheme MetaCursorTheme;
+
 typedef struct _MetaDbusSession MetaDbusSession;
 typedef struct _MetaDbusSessionManager MetaDbusSessionManager;
 typedef struct _MetaDbusSessionWatcher MetaDbusSessionWatcher;
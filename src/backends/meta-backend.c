@@ -2175,3 +2175,11 @@ meta_backend_get_cursor (MetaBackend       *backend,
 
   return meta_cursor_theme_get_cursor (priv->cursor_theme, cursor_type);
 }
+
+MetaCursorTheme *
+meta_backend_get_cursor_theme (MetaBackend *backend)
+{
+  MetaBackendPrivate *priv = meta_backend_get_instance_private (backend);
+
+  return priv->cursor_theme;
+}
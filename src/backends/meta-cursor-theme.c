@@ -21,8 +21,17 @@
 
 #include "backends/meta-cursor-theme.h"
 
+#include <math.h>
+#include <string.h>
+
 #include "backends/meta-backend-private.h"
 #include "backends/meta-cursor-xcursor.h"
+#include "backends/meta-logical-monitor-private.h"
+
+#define MAX_PRELOAD_SCALE 31
+
+#define CURSOR_IMAGES_KEY(cursor_type, size, scale) \
+  GUINT_TO_POINTER (((size) << 16) | ((scale) << 8) | (cursor_type))
 
 enum
 {
@@ -39,18 +48,318 @@ struct _MetaCursorTheme
 
   GHashTable *cursors;
 
+  /* Cursor images of the current theme, shared by all cursors and loaded
+   * ahead of time for every scale in use. */
+  GHashTable *images;
+  char *theme_name;
+  int size;
+  uint32_t preloaded_scales;
+  GCancellable *preload_cancellable;
+
   ClutterColorState *color_state;
   MetaBackend *backend;
 };
 
+typedef struct _PreloadData
+{
+  char *theme_name;
+  int size;
+  uint32_t scales;
+} PreloadData;
+
+typedef struct _PreloadedImages
+{
+  gpointer key;
+  MetaCursorImages *images;
+} PreloadedImages;
+
 G_DEFINE_TYPE (MetaCursorTheme, meta_cursor_theme, G_TYPE_OBJECT)
 
+static void maybe_preload_images (MetaCursorTheme *cursor_theme);
+
+static MetaCursorImages *
+meta_cursor_images_new (XcursorImages *xcursor_images)
+{
+  MetaCursorImages *images;
+
+  images = g_atomic_rc_box_new0 (MetaCursorImages);
+  images->xcursor_images = xcursor_images;
+
+  return images;
+}
+
+static void
+clear_cursor_images (MetaCursorImages *images)
+{
+  g_clear_pointer (&images->xcursor_images, xcursor_images_destroy);
+}
+
+MetaCursorImages *
+meta_cursor_images_ref (MetaCursorImages *images)
+{
+  return g_atomic_rc_box_acquire (images);
+}
+
+void
+meta_cursor_images_unref (MetaCursorImages *images)
+{
+  g_atomic_rc_box_release_full (images, (GDestroyNotify) clear_cursor_images);
+}
+
+static XcursorImages *
+create_blank_cursor_images (void)
+{
+  XcursorImages *images;
+
+  images = xcursor_images_create (1);
+  images->images[0] = xcursor_image_create (1, 1);
+
+  images->images[0]->xhot = 0;
+  images->images[0]->yhot = 0;
+  images->nimage = 1;
+  memset (images->images[0]->pixels, 0, sizeof(int32_t));
+
+  return images;
+}
+
+static XcursorImages *
+create_fallback_cursor_images (int scale)
+{
+  XcursorImages *xcursor_images;
+  int fallback_size;
+
+  fallback_size = 24 * scale;
+  xcursor_images = xcursor_images_create (1);
+  xcursor_images->images[0] = xcursor_image_create (fallback_size, fallback_size);
+  xcursor_images->images[0]->xhot = 0;
+  xcursor_images->images[0]->yhot = 0;
+  memset (xcursor_images->images[0]->pixels, 0xc0,
+          fallback_size * fallback_size * sizeof (int32_t));
+  return xcursor_images;
+}
+
+/* Called both from the main thread and from the preload thread. */
+static XcursorImages *
+load_xcursor_images (ClutterCursorType  cursor_type,
+                     const char        *theme_name,
+                     int                size,
+                     int                scale)
+{
+  const char *cursor_names[2];
+  int i;
+
+  if (cursor_type == CLUTTER_CURSOR_NONE)
+    return create_blank_cursor_images ();
+
+  cursor_names[0] = clutter_cursor_type_to_name (cursor_type);
+  cursor_names[1] = meta_cursor_get_legacy_name (cursor_type);
+
+  for (i = 0; i < G_N_ELEMENTS (cursor_names); i++)
+    {
+      XcursorImages *xcursor_images;
+
+      xcursor_images = xcursor_library_load_images (cursor_names[i],
+                                                    theme_name,
+                                                    size * scale);
+      if (xcursor_images)
+        return xcursor_images;
+    }
+
+  return NULL;
+}
+
+static void
+preload_data_free (PreloadData *data)
+{
+  g_free (data->theme_name);
+  g_free (data);
+}
+
+static void
+preloaded_images_free (PreloadedImages *preloaded)
+{
+  g_clear_pointer (&preloaded->images, meta_cursor_images_unref);
+  g_free (preloaded);
+}
+
+static void
+preload_images_in_thread (GTask        *task,
+                          gpointer      source_object,
+                          gpointer      task_data,
+                          GCancellable *cancellable)
+{
+  PreloadData *data = task_data;
+  g_autoptr (GPtrArray) results = NULL;
+  int scale;
+
+  results =
+    g_ptr_array_new_with_free_func ((GDestroyNotify) preloaded_images_free);
+
+  for (scale = 1; scale <= MAX_PRELOAD_SCALE; scale++)
+    {
+      ClutterCursorType cursor_type;
+
+      if (!(data->scales & (1u << scale)))
+        continue;
+
+      for (cursor_type = CLUTTER_CURSOR_NONE;
+           cursor_type <= CLUTTER_CURSOR_ALL_RESIZE;
+           cursor_type++)
+        {
+          XcursorImages *xcursor_images;
+          PreloadedImages *preloaded;
+
+          if (g_task_return_error_if_cancelled (task))
+            return;
+
+          /* Missing cursors are left for the main thread, which falls back
+           * to a placeholder and warns about it when it is actually used. */
+          xcursor_images = load_xcursor_images (cursor_type,
+                                                data->theme_name,
+                                                data->size,
+                                                scale);
+          if (!xcursor_images)
+            continue;
+
+          preloaded = g_new0 (PreloadedImages, 1);
+          preloaded->key = CURSOR_IMAGES_KEY (cursor_type, data->size, scale);
+          preloaded->images = meta_cursor_images_new (xcursor_images);
+          g_ptr_array_add (results, preloaded);
+        }
+    }
+
+  g_task_return_pointer (task, g_steal_pointer (&results),
+                         (GDestroyNotify) g_ptr_array_unref);
+}
+
+static void
+on_images_preloaded (GObject      *source_object,
+                     GAsyncResult *result,
+                     gpointer      user_data)
+{
+  MetaCursorTheme *cursor_theme = META_CURSOR_THEME (source_object);
+  g_autoptr (GPtrArray) results = NULL;
+  g_autoptr (GError) error = NULL;
+  unsigned int i;
+
+  results = g_task_propagate_pointer (G_TASK (result), &error);
+  if (!results)
+    {
+      if (!g_error_matches (error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+        g_warning ("Failed to preload cursor theme: %s", error->message);
+      return;
+    }
+
+  for (i = 0; i < results->len; i++)
+    {
+      PreloadedImages *preloaded = g_ptr_array_index (results, i);
+
+      /* Cursors used before preloading finished were loaded on demand. */
+      if (g_hash_table_contains (cursor_theme->images, preloaded->key))
+        continue;
+
+      g_hash_table_insert (cursor_theme->images,
+                           preloaded->key,
+                           g_steal_pointer (&preloaded->images));
+    }
+}
+
+static uint32_t
+get_scales_in_use (MetaCursorTheme *cursor_theme)
+{
+  MetaBackend *backend = cursor_theme->backend;
+  MetaMonitorManager *monitor_manager =
+    meta_backend_get_monitor_manager (backend);
+  GList *logical_monitors;
+  GList *l;
+  uint32_t scales;
+
+  /* Cursors start out at scale 1 until they are first prepared for a
+   * monitor, so always include it. */
+  scales = 1u << 1;
+
+  logical_monitors =
+    meta_monitor_manager_get_logical_monitors (monitor_manager);
+  for (l = logical_monitors; l; l = l->next)
+    {
+      MetaLogicalMonitor *logical_monitor = l->data;
+      float logical_scale = meta_logical_monitor_get_scale (logical_monitor);
+      int scale;
+
+      /* This matches how MetaCursorXcursor picks its theme scale. */
+      if (meta_backend_is_stage_views_scaled (backend))
+        scale = (int) ceilf (logical_scale);
+      else
+        scale = (int) logical_scale;
+
+      if (scale >= 1 && scale <= MAX_PRELOAD_SCALE)
+        scales |= 1u << scale;
+    }
+
+  return scales;
+}
+
+static void
+maybe_preload_images (MetaCursorTheme *cursor_theme)
+{
+  g_autoptr (GTask) task = NULL;
+  PreloadData *data;
+  uint32_t scales;
+
+  scales = get_scales_in_use (cursor_theme) & ~cursor_theme->preloaded_scales;
+  if (!scales)
+    return;
+
+  cursor_theme->preloaded_scales |= scales;
+
+  if (!cursor_theme->preload_cancellable)
+    cursor_theme->preload_cancellable = g_cancellable_new ();
+
+  data = g_new0 (PreloadData, 1);
+  data->theme_name = g_strdup (cursor_theme->theme_name);
+  data->size = cursor_theme->size;
+  data->scales = scales;
+
+  task = g_task_new (cursor_theme, cursor_theme->preload_cancellable,
+                     on_images_preloaded, NULL);
+  g_task_set_source_tag (task, maybe_preload_images);
+  g_task_set_task_data (task, data, (GDestroyNotify) preload_data_free);
+  g_task_run_in_thread (task, preload_images_in_thread);
+}
+
+static void
+update_theme_settings (MetaCursorTheme *cursor_theme)
+{
+  g_set_str (&cursor_theme->theme_name, meta_prefs_get_cursor_theme ());
+  cursor_theme->size = meta_prefs_get_cursor_size ();
+}
+
+static void
+on_monitors_changed (MetaMonitorManager *monitor_manager,
+                     MetaCursorTheme    *cursor_theme)
+{
+  maybe_preload_images (cursor_theme);
+}
+
+static void
+meta_cursor_theme_dispose (GObject *object)
+{
+  MetaCursorTheme *cursor_theme = META_CURSOR_THEME (object);
+
+  g_cancellable_cancel (cursor_theme->preload_cancellable);
+  g_clear_object (&cursor_theme->preload_cancellable);
+
+  G_OBJECT_CLASS (meta_cursor_theme_parent_class)->dispose (object);
+}
+
 static void
 meta_cursor_theme_finalize (GObject *object)
 {
   MetaCursorTheme *cursor_theme = META_CURSOR_THEME (object);
 
   g_clear_pointer (&cursor_theme->cursors, g_hash_table_unref);
+  g_clear_pointer (&cursor_theme->images, g_hash_table_unref);
+  g_clear_pointer (&cursor_theme->theme_name, g_free);
   g_clear_object (&cursor_theme->color_state);
 
   G_OBJECT_CLASS (meta_cursor_theme_parent_class)->finalize (object);
@@ -62,10 +371,19 @@ meta_cursor_theme_constructed (GObject *object)
   MetaCursorTheme *cursor_theme = META_CURSOR_THEME (object);
   ClutterContext *clutter_context =
     meta_backend_get_clutter_context (cursor_theme->backend);
+  MetaMonitorManager *monitor_manager =
+    meta_backend_get_monitor_manager (cursor_theme->backend);
 
   g_set_object (&cursor_theme->color_state,
                 clutter_context_get_default_color_state (clutter_context));
 
+  g_signal_connect_object (monitor_manager, "monitors-changed-internal",
+                           G_CALLBACK (on_monitors_changed),
+                           cursor_theme, G_CONNECT_DEFAULT);
+
+  update_theme_settings (cursor_theme);
+  maybe_preload_images (cursor_theme);
+
   G_OBJECT_CLASS (meta_cursor_theme_parent_class)->constructed (object);
 }
 
@@ -93,6 +411,7 @@ meta_cursor_theme_class_init (MetaCursorThemeClass *klass)
 {
   GObjectClass *object_class = G_OBJECT_CLASS (klass);
 
+  object_class->dispose = meta_cursor_theme_dispose;
   object_class->finalize = meta_cursor_theme_finalize;
   object_class->constructed = meta_cursor_theme_constructed;
   object_class->set_property = meta_cursor_theme_set_property;
@@ -112,6 +431,9 @@ meta_cursor_theme_init (MetaCursorTheme *cursor_theme)
 {
   cursor_theme->cursors =
     g_hash_table_new_full (NULL, NULL, NULL, (GDestroyNotify) g_object_unref);
+  cursor_theme->images =
+    g_hash_table_new_full (NULL, NULL, NULL,
+                           (GDestroyNotify) meta_cursor_images_unref);
 
   /* Ensure GType of default cursor implementation, so it is registered
    * as an extension.
@@ -173,5 +495,53 @@ meta_cursor_theme_get_cursor (MetaCursorTheme   *cursor_theme,
 void
 meta_cursor_theme_reset (MetaCursorTheme *cursor_theme)
 {
+  g_cancellable_cancel (cursor_theme->preload_cancellable);
+  g_clear_object (&cursor_theme->preload_cancellable);
+
   g_hash_table_remove_all (cursor_theme->cursors);
+  g_hash_table_remove_all (cursor_theme->images);
+  cursor_theme->preloaded_scales = 0;
+
+  update_theme_settings (cursor_theme);
+  maybe_preload_images (cursor_theme);
+}
+
+MetaCursorImages *
+meta_cursor_theme_get_images (MetaCursorTheme   *cursor_theme,
+                              ClutterCursorType  cursor_type,
+                              const char        *theme_name,
+                              int                size,
+                              int                scale)
+{
+  MetaCursorImages *images;
+  XcursorImages *xcursor_images;
+  gboolean is_current_theme;
+  gpointer key;
+
+  key = CURSOR_IMAGES_KEY (cursor_type, size, scale);
+  is_current_theme = g_strcmp0 (theme_name, cursor_theme->theme_name) == 0;
+
+  if (is_current_theme)
+    {
+      images = g_hash_table_lookup (cursor_theme->images, key);
+      if (images)
+        return meta_cursor_images_ref (images);
+    }
+
+  xcursor_images = load_xcursor_images (cursor_type, theme_name, size, scale);
+  if (!xcursor_images)
+    {
+      g_warning_once ("No cursor theme available, please install a cursor theme");
+      xcursor_images = create_fallback_cursor_images (scale);
+    }
+
+  images = meta_cursor_images_new (xcursor_images);
+
+  if (is_current_theme)
+    {
+      g_hash_table_insert (cursor_theme->images, key,
+                           meta_cursor_images_ref (images));
+    }
+
+  return images;
 }
@@ -22,6 +22,12 @@
 #include <glib-object.h>
 
 #include "meta/meta-backend.h"
+#include "third_party/xcursor/xcursor.h"
+
+typedef struct _MetaCursorImages
+{
+  XcursorImages *xcursor_images;
+} MetaCursorImages;
 
 #define META_TYPE_CURSOR_THEME meta_cursor_theme_get_type ()
 G_DECLARE_FINAL_TYPE (MetaCursorTheme, meta_cursor_theme,
@@ -33,3 +39,15 @@ ClutterCursor * meta_cursor_theme_get_cursor (MetaCursorTheme   *cursor_theme,
                                               ClutterCursorType  cursor_type);
 
 void meta_cursor_theme_reset (MetaCursorTheme *cursor_theme);
+
+MetaCursorImages * meta_cursor_theme_get_images (MetaCursorTheme   *cursor_theme,
+                                                 ClutterCursorType  cursor_type,
+                                                 const char        *theme_name,
+                                                 int                size,
+                                                 int                scale);
+
+MetaCursorImages * meta_cursor_images_ref (MetaCursorImages *images);
+
+void meta_cursor_images_unref (MetaCursorImages *images);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (MetaCursorImages, meta_cursor_images_unref)
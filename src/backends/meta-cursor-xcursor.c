@@ -21,6 +21,7 @@
 #include "backends/meta-cursor-xcursor.h"
 
 #include "backends/meta-backend-private.h"
+#include "backends/meta-cursor-theme.h"
 #include "backends/meta-logical-monitor-private.h"
 #include "clutter/clutter.h"
 #include "cogl/cogl.h"
@@ -31,7 +32,7 @@
 typedef struct _MetaCursorImageData
 {
   int scale;
-  XcursorImages *xcursor_images;
+  MetaCursorImages *images;
 } MetaCursorImageData;
 
 struct _MetaCursorXcursor
@@ -146,60 +147,6 @@ meta_cursor_get_legacy_name (ClutterCursorType cursor)
   return NULL;
 }
 
-static XcursorImages *
-create_blank_cursor_images (void)
-{
-  XcursorImages *images;
-
-  images = xcursor_images_create (1);
-  images->images[0] = xcursor_image_create (1, 1);
-
-  images->images[0]->xhot = 0;
-  images->images[0]->yhot = 0;
-  images->nimage = 1;
-  memset (images->images[0]->pixels, 0, sizeof(int32_t));
-
-  return images;
-}
-
-static XcursorImages *
-load_cursor_on_client (MetaCursorXcursor *cursor_xcursor,
-                       ClutterCursorType  cursor,
-                       int                scale)
-{
-  MetaCursor *meta_cursor = META_CURSOR (cursor_xcursor);
-  XcursorImages *xcursor_images;
-  int fallback_size, i;
-  const char *cursor_names[2];
-
-  if (cursor == CLUTTER_CURSOR_NONE)
-    return create_blank_cursor_images ();
-
-  cursor_names[0] = clutter_cursor_type_to_name (cursor);
-  cursor_names[1] = meta_cursor_get_legacy_name (cursor);
-
-  for (i = 0; i < G_N_ELEMENTS (cursor_names); i++)
-    {
-      xcursor_images =
-        xcursor_library_load_images (cursor_names[i],
-                                     meta_cursor_get_theme_name (meta_cursor),
-                                     meta_cursor_get_size (meta_cursor) * scale);
-      if (xcursor_images)
-        return xcursor_images;
-    }
-
-  g_warning_once ("No cursor theme available, please install a cursor theme");
-
-  fallback_size = 24 * scale;
-  xcursor_images = xcursor_images_create (1);
-  xcursor_images->images[0] = xcursor_image_create (fallback_size, fallback_size);
-  xcursor_images->images[0]->xhot = 0;
-  xcursor_images->images[0]->yhot = 0;
-  memset (xcursor_images->images[0]->pixels, 0xc0,
-          fallback_size * fallback_size * sizeof (int32_t));
-  return xcursor_images;
-}
-
 static void
 load_from_current_xcursor_image (MetaCursorXcursor *cursor_xcursor)
 {
@@ -340,20 +287,25 @@ load_cursor_from_theme (MetaCursorXcursor *cursor_xcursor)
       image_data = &g_array_index (cursor_xcursor->cursor_images,
                                    MetaCursorImageData, i);
       if (image_data->scale == cursor_xcursor->theme_scale)
-        xcursor_images = image_data->xcursor_images;
+        xcursor_images = image_data->images->xcursor_images;
     }
 
   if (!xcursor_images)
     {
+      MetaCursor *meta_cursor = META_CURSOR (cursor_xcursor);
+      MetaBackend *backend = meta_cursor_get_backend (meta_cursor);
+      MetaCursorTheme *cursor_theme = meta_backend_get_cursor_theme (backend);
       MetaCursorImageData new_cursor;
 
       new_cursor.scale = cursor_xcursor->theme_scale;
-      new_cursor.xcursor_images =
-        load_cursor_on_client (cursor_xcursor,
-                               cursor_type,
-                               new_cursor.scale);
-
-      xcursor_images = new_cursor.xcursor_images;
+      new_cursor.images =
+        meta_cursor_theme_get_images (cursor_theme,
+                                      cursor_type,
+                                      meta_cursor_get_theme_name (meta_cursor),
+                                      meta_cursor_get_size (meta_cursor),
+                                      new_cursor.scale);
+
+      xcursor_images = new_cursor.images->xcursor_images;
       g_array_append_val (cursor_xcursor->cursor_images, new_cursor);
     }
 
@@ -468,7 +420,7 @@ meta_cursor_xcursor_finalize (GObject *object)
 static void
 clear_cursor_image_data (MetaCursorImageData *data)
 {
-  g_clear_pointer (&data->xcursor_images, xcursor_images_destroy);
+  g_clear_pointer (&data->images, meta_cursor_images_unref);
 }
 
 static void
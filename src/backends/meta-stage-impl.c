@@ -256,6 +256,7 @@ static void
 swap_framebuffer (ClutterStageWindow *stage_window,
                   ClutterStageView   *stage_view,
                   MtkRegion          *swap_region,
+                  int                 buffer_age,
                   gboolean            swap_with_damage,
                   ClutterFrame       *frame)
 {
@@ -263,10 +264,13 @@ swap_framebuffer (ClutterStageWindow *stage_window,
   MetaStageImplPrivate *priv =
     meta_stage_impl_get_instance_private (stage_impl);
   CoglFramebuffer *framebuffer = clutter_stage_view_get_onscreen (stage_view);
+  int64_t start_time_us;
 
   COGL_TRACE_BEGIN_SCOPED (SwapFramebuffer, "Meta::StageImpl::swap_framebuffer()");
 
-  clutter_stage_view_before_swap_buffer (stage_view, swap_region);
+  start_time_us = g_get_monotonic_time ();
+
+  clutter_stage_view_before_swap_buffer (stage_view, swap_region, buffer_age);
 
   if (COGL_IS_ONSCREEN (framebuffer))
     {
@@ -318,6 +322,9 @@ swap_framebuffer (ClutterStageWindow *stage_window,
                                          frame->frame_count);
       priv->global_frame_counter++;
     }
+
+  clutter_frame_add_phase_time (frame, CLUTTER_FRAME_PHASE_SWAP,
+                                g_get_monotonic_time () - start_time_us);
 }
 
 static MtkRegion *
@@ -414,11 +421,17 @@ paint_stage (MetaStageImpl    *stage_impl,
              ClutterFrame     *frame)
 {
   ClutterStage *stage = stage_impl->wrapper;
+  int64_t start_time_us;
+
+  start_time_us = g_get_monotonic_time ();
 
   _clutter_stage_maybe_setup_viewport (stage, stage_view);
   clutter_stage_paint_view (stage, stage_view, redraw_clip, frame);
 
   clutter_stage_view_after_paint (stage_view, redraw_clip);
+
+  clutter_frame_add_phase_time (frame, CLUTTER_FRAME_PHASE_PAINT,
+                                g_get_monotonic_time () - start_time_us);
 }
 
 static MtkRegion *
@@ -506,6 +519,7 @@ meta_stage_impl_redraw_view_primary (MetaStageImpl    *stage_impl,
   gboolean use_clipped_redraw;
   gboolean buffer_has_valid_damage_history = FALSE;
   gboolean has_buffer_age;
+  gboolean has_shadowfb;
   gboolean swap_with_damage;
   g_autoptr (MtkRegion) redraw_clip = NULL;
   g_autoptr (MtkRegion) queued_redraw_clip = NULL;
@@ -544,11 +558,17 @@ meta_stage_impl_redraw_view_primary (MetaStageImpl    *stage_impl,
     is_full_redraw = FALSE;
 
   damage_history = meta_stage_view_get_damage_history (view);
+  has_shadowfb = clutter_stage_view_has_shadowfb (stage_view);
 
   if (has_buffer_age)
     {
       buffer_age = cogl_onscreen_get_buffer_age (COGL_ONSCREEN (onscreen));
+
+      /* The shadow framebuffer is never swapped, so it always holds the
+       * complete previous frame; stale regions of the onscreen back
+       * buffer are repaired when copying it out before the swap. */
       buffer_has_valid_damage_history =
+        has_shadowfb ||
         clutter_damage_history_is_age_valid (damage_history,
                                              buffer_age);
     }
@@ -617,8 +637,6 @@ meta_stage_impl_redraw_view_primary (MetaStageImpl    *stage_impl,
   /* swap_region does not need damage history, set it up before that */
   if (!use_clipped_redraw)
     swap_region = mtk_region_create ();
-  else if (clutter_stage_view_has_shadowfb (stage_view))
-    swap_region = mtk_region_ref (fb_clip_region);
   else
     swap_region = mtk_region_copy (fb_clip_region);
 
@@ -627,7 +645,11 @@ meta_stage_impl_redraw_view_primary (MetaStageImpl    *stage_impl,
     {
       clutter_damage_history_record (damage_history, fb_clip_region);
 
-      if (use_clipped_redraw)
+      if (use_clipped_redraw && has_shadowfb)
+        {
+          swap_with_damage = TRUE;
+        }
+      else if (use_clipped_redraw)
         {
           int age;
 
@@ -681,7 +703,8 @@ meta_stage_impl_redraw_view_primary (MetaStageImpl    *stage_impl,
     }
   else if (use_clipped_redraw)
     {
-      queue_damage_region (stage_window, stage_view, fb_clip_region);
+      if (!has_shadowfb)
+        queue_damage_region (stage_window, stage_view, fb_clip_region);
 
       cogl_framebuffer_push_region_clip (fb, fb_clip_region);
 
@@ -757,9 +780,12 @@ meta_stage_impl_redraw_view_primary (MetaStageImpl    *stage_impl,
       swap_region = g_steal_pointer (&transformed_swap_region);
     }
 
+  /* Without buffer age support the back buffer is either fully redrawn
+   * or preserved by a sub-buffer copy, i.e. it holds the previous frame. */
   swap_framebuffer (stage_window,
                     stage_view,
                     swap_region,
+                    has_buffer_age ? buffer_age : 1,
                     swap_with_damage,
                     frame);
 }
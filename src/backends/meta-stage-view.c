@@ -38,6 +38,7 @@ typedef struct _MetaStageViewPrivate
   CoglFrameClosure *frame_cb_closure;
 
   int inhibit_cursor_overlay_count;
+  int inhibit_overlay_planes_count;
 } MetaStageViewPrivate;
 
 G_DEFINE_TYPE_WITH_PRIVATE (MetaStageView, meta_stage_view,
@@ -259,3 +260,37 @@ meta_stage_view_is_cursor_overlay_inhibited (MetaStageView *view)
 
   return priv->inhibit_cursor_overlay_count > 0;
 }
+
+/*
+ * Keeps surfaces from being assigned to overlay planes of @view, e.g. while
+ * the contents of its framebuffer are being captured, as they would be
+ * missing from it.
+ */
+void
+meta_stage_view_inhibit_overlay_planes (MetaStageView *view)
+{
+  MetaStageViewPrivate *priv =
+    meta_stage_view_get_instance_private (view);
+
+  priv->inhibit_overlay_planes_count++;
+}
+
+void
+meta_stage_view_uninhibit_overlay_planes (MetaStageView *view)
+{
+  MetaStageViewPrivate *priv =
+    meta_stage_view_get_instance_private (view);
+
+  g_return_if_fail (priv->inhibit_overlay_planes_count > 0);
+
+  priv->inhibit_overlay_planes_count--;
+}
+
+gboolean
+meta_stage_view_is_overlay_planes_inhibited (MetaStageView *view)
+{
+  MetaStageViewPrivate *priv =
+    meta_stage_view_get_instance_private (view);
+
+  return priv->inhibit_overlay_planes_count > 0;
+}
@@ -18,8 +18,10 @@
 #pragma once
 
 #include "clutter/clutter-mutter.h"
+#include "core/util-private.h"
 
 #define META_TYPE_STAGE_VIEW (meta_stage_view_get_type ())
+META_EXPORT_TEST
 G_DECLARE_DERIVABLE_TYPE (MetaStageView,
                           meta_stage_view,
                           META, STAGE_VIEW,
@@ -30,3 +32,11 @@ void meta_stage_view_inhibit_cursor_overlay (MetaStageView *view);
 void meta_stage_view_uninhibit_cursor_overlay (MetaStageView *view);
 
 gboolean meta_stage_view_is_cursor_overlay_inhibited (MetaStageView *view);
+
+META_EXPORT_TEST
+void meta_stage_view_inhibit_overlay_planes (MetaStageView *view);
+
+META_EXPORT_TEST
+void meta_stage_view_uninhibit_overlay_planes (MetaStageView *view);
+
+gboolean meta_stage_view_is_overlay_planes_inhibited (MetaStageView *view);
@@ -30,6 +30,7 @@
 #include "backends/meta-monitor-private.h"
 #include "backends/meta-stream.h"
 #include "backends/meta-stage-private.h"
+#include "backends/meta-stage-view.h"
 #include "clutter/clutter.h"
 #include "clutter/clutter-color-state.h"
 #include "clutter/clutter-mutter.h"
@@ -52,6 +53,10 @@ struct _MetaStreamSourceMonitor
 
   GList *watches;
 
+  /* Views whose overlay planes are inhibited, as anything placed on them
+   * would be missing from the captured framebuffer */
+  GList *overlay_inhibited_views;
+
   GArray *formats;
 
   gulong position_invalidated_handler_id;
@@ -363,6 +368,49 @@ uninhibit_hw_cursor (MetaStreamSourceMonitor *source_monitor)
   source_monitor->hw_cursor_inhibited = FALSE;
 }
 
+static void
+uninhibit_overlay_planes (MetaStreamSourceMonitor *source_monitor)
+{
+  GList *l;
+
+  for (l = source_monitor->overlay_inhibited_views; l; l = l->next)
+    meta_stage_view_uninhibit_overlay_planes (l->data);
+
+  g_clear_list (&source_monitor->overlay_inhibited_views, g_object_unref);
+}
+
+static void
+inhibit_overlay_planes (MetaStreamSourceMonitor *source_monitor)
+{
+  MetaBackend *backend = get_backend (source_monitor);
+  MetaRenderer *renderer = meta_backend_get_renderer (backend);
+  MetaMonitor *monitor;
+  MetaLogicalMonitor *logical_monitor;
+  MtkRectangle logical_monitor_layout;
+  GList *l;
+
+  uninhibit_overlay_planes (source_monitor);
+
+  monitor = get_monitor (source_monitor);
+  logical_monitor = meta_monitor_get_logical_monitor (monitor);
+  logical_monitor_layout = meta_logical_monitor_get_layout (logical_monitor);
+
+  for (l = meta_renderer_get_views (renderer); l; l = l->next)
+    {
+      MetaStageView *view = l->data;
+      MtkRectangle view_layout;
+
+      clutter_stage_view_get_layout (CLUTTER_STAGE_VIEW (view), &view_layout);
+      if (!mtk_rectangle_overlap (&logical_monitor_layout, &view_layout))
+        continue;
+
+      meta_stage_view_inhibit_overlay_planes (view);
+      source_monitor->overlay_inhibited_views =
+        g_list_prepend (source_monitor->overlay_inhibited_views,
+                        g_object_ref (view));
+    }
+}
+
 static void
 add_view_watches (MetaStreamSourceMonitor *source_monitor,
                   MetaStageWatchPhase      watch_phase,
@@ -422,6 +470,8 @@ maybe_reattach_watches (MetaStreamSourceMonitor *source_monitor)
     meta_stage_remove_watch (META_STAGE (stage), l->data);
   g_clear_pointer (&source_monitor->watches, g_list_free);
 
+  inhibit_overlay_planes (source_monitor);
+
   add_view_watches (source_monitor,
                     META_STAGE_WATCH_BEFORE_PAINT,
                     before_stage_painted);
@@ -523,6 +573,8 @@ meta_stream_source_monitor_disable (MetaStreamSource *source)
     }
   g_clear_pointer (&source_monitor->watches, g_list_free);
 
+  uninhibit_overlay_planes (source_monitor);
+
   if (source_monitor->hw_cursor_inhibited)
     uninhibit_hw_cursor (source_monitor);
 
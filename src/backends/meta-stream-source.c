@@ -22,6 +22,7 @@
 
 #include <errno.h>
 #include <fcntl.h>
+#include <glib-unix.h>
 #include <glib/gstdio.h>
 #include <pipewire/pipewire.h>
 #include <pipewire/capabilities.h>
@@ -67,6 +68,11 @@
 
 #define PARAMS_BUFFER_SIZE 1024
 
+#define N_READBACK_BUFFERS 2
+
+/* Approximate fixed cost of issuing one readback, expressed in pixels */
+#define READBACK_RECT_OVERHEAD_PIXELS (64 * 64)
+
 enum
 {
   PROP_0,
@@ -105,6 +111,31 @@ typedef struct _MetaPipeWireSource
   struct pw_loop *pipewire_loop;
 } MetaPipeWireSource;
 
+typedef struct _MetaStreamReadbackRect
+{
+  MtkRectangle rect;
+  size_t offset;
+} MetaStreamReadbackRect;
+
+typedef struct _MetaStreamReadback
+{
+  MetaStreamSource *source;
+
+  struct pw_buffer *buffer;
+  gboolean bump_buffer_age;
+
+  CoglPixelBuffer *pixel_buffer;
+  GArray *rects;
+  gboolean flip;
+
+  uint8_t *data;
+  int stride;
+  int bpp;
+
+  int fence_fd;
+  GSource *fence_source;
+} MetaStreamReadback;
+
 typedef struct _MetaStreamSourcePrivate
 {
   MetaStream *stream;
@@ -152,6 +183,13 @@ typedef struct _MetaStreamSourcePrivate
   GList *dequeued_buffers;
 
   CoglFramebuffer *framebuffer;
+
+  /* Buffer currently being recorded into, if its readback may be deferred */
+  struct pw_buffer *readback_target;
+  MetaStreamReadback *pending_readback;
+  CoglPixelBuffer *readback_buffers[N_READBACK_BUFFERS];
+  int next_readback_buffer;
+
   MtkRectangle layout;
   MtkRegion *damage;
   ClutterDamageHistory *damage_history;
@@ -529,6 +567,387 @@ meta_stream_source_paint_to_framebuffer_clipped (MetaStreamSource  *source,
                                               paint_flags);
 }
 
+static void queue_pw_buffer (MetaStreamSource *source,
+                             struct pw_buffer *buffer,
+                             gboolean          bump_buffer_age);
+
+static void
+meta_stream_readback_free (MetaStreamReadback *readback)
+{
+  if (readback->fence_source)
+    {
+      g_source_destroy (readback->fence_source);
+      g_source_unref (readback->fence_source);
+    }
+  g_clear_fd (&readback->fence_fd, NULL);
+  g_clear_pointer (&readback->rects, g_array_unref);
+  g_clear_object (&readback->pixel_buffer);
+  g_free (readback);
+}
+
+static gboolean
+copy_readback_into_buffer (MetaStreamReadback  *readback,
+                           GError             **error)
+{
+  CoglBuffer *buffer = COGL_BUFFER (readback->pixel_buffer);
+  const MetaStreamReadbackRect *last_rect;
+  const uint8_t *src;
+  unsigned int i;
+
+  last_rect = &g_array_index (readback->rects, MetaStreamReadbackRect,
+                              readback->rects->len - 1);
+  src = cogl_buffer_map_range (buffer,
+                               0,
+                               last_rect->offset +
+                               (size_t) mtk_rectangle_area (&last_rect->rect) *
+                               readback->bpp,
+                               COGL_BUFFER_ACCESS_READ,
+                               0,
+                               error);
+  if (!src)
+    return FALSE;
+
+  for (i = 0; i < readback->rects->len; i++)
+    {
+      const MetaStreamReadbackRect *readback_rect =
+        &g_array_index (readback->rects, MetaStreamReadbackRect, i);
+      const MtkRectangle *rect = &readback_rect->rect;
+      size_t row_size = (size_t) rect->width * readback->bpp;
+      uint8_t *dst;
+      int y;
+
+      dst = readback->data +
+            rect->y * readback->stride +
+            rect->x * readback->bpp;
+
+      for (y = 0; y < rect->height; y++)
+        {
+          int src_y = readback->flip ? rect->height - y - 1 : y;
+
+          memcpy (dst + y * readback->stride,
+                  src + readback_rect->offset + src_y * row_size,
+                  row_size);
+        }
+    }
+
+  cogl_buffer_unmap (buffer);
+
+  return TRUE;
+}
+
+static void
+complete_pending_readback (MetaStreamSource *source)
+{
+  MetaStreamSourcePrivate *priv =
+    meta_stream_source_get_instance_private (source);
+  MetaStreamReadback *readback;
+  struct pw_buffer *buffer;
+  gboolean bump_buffer_age;
+  g_autoptr (GError) error = NULL;
+
+  readback = g_steal_pointer (&priv->pending_readback);
+  if (!readback)
+    return;
+
+  COGL_TRACE_BEGIN_SCOPED (CompleteReadback,
+                           "Meta::StreamSource::complete_pending_readback()");
+
+  buffer = readback->buffer;
+  bump_buffer_age = readback->bump_buffer_age;
+
+  if (!copy_readback_into_buffer (readback, &error))
+    {
+      struct spa_data *spa_data = &buffer->buffer->datas[0];
+
+      g_warning ("Failed to complete screen cast frame readback: %s",
+                 error->message);
+      spa_data->chunk->size = 0;
+      spa_data->chunk->flags = SPA_CHUNK_FLAG_CORRUPTED;
+      bump_buffer_age = FALSE;
+    }
+
+  meta_stream_readback_free (readback);
+
+  meta_topic (META_DEBUG_SCREEN_CAST,
+              "Queuing PipeWire buffer (%p) after deferred readback",
+              buffer->buffer);
+  queue_pw_buffer (source, buffer, bump_buffer_age);
+}
+
+static void
+discard_pending_readback (MetaStreamSource *source)
+{
+  MetaStreamSourcePrivate *priv =
+    meta_stream_source_get_instance_private (source);
+
+  g_clear_pointer (&priv->pending_readback, meta_stream_readback_free);
+}
+
+static gboolean
+on_readback_fence_signaled (int           fd,
+                            GIOCondition  condition,
+                            gpointer      user_data)
+{
+  MetaStreamReadback *readback = user_data;
+
+  g_source_destroy (readback->fence_source);
+  g_clear_pointer (&readback->fence_source, g_source_unref);
+  complete_pending_readback (readback->source);
+
+  return G_SOURCE_REMOVE;
+}
+
+static CoglPixelBuffer *
+ensure_readback_buffer (MetaStreamSource *source,
+                        CoglContext      *cogl_context,
+                        size_t            size)
+{
+  MetaStreamSourcePrivate *priv =
+    meta_stream_source_get_instance_private (source);
+  CoglPixelBuffer **pixel_buffer;
+
+  pixel_buffer = &priv->readback_buffers[priv->next_readback_buffer];
+  priv->next_readback_buffer =
+    (priv->next_readback_buffer + 1) % N_READBACK_BUFFERS;
+
+  if (*pixel_buffer &&
+      cogl_buffer_get_size (COGL_BUFFER (*pixel_buffer)) < size)
+    g_clear_object (pixel_buffer);
+
+  if (!*pixel_buffer)
+    {
+      *pixel_buffer = cogl_pixel_buffer_new (cogl_context, size, NULL);
+      cogl_buffer_set_update_hint (COGL_BUFFER (*pixel_buffer),
+                                   COGL_BUFFER_UPDATE_HINT_STREAM);
+    }
+
+  return *pixel_buffer;
+}
+
+static int
+get_readback_cost (const MtkRectangle *rect)
+{
+  return mtk_rectangle_area (rect) + READBACK_RECT_OVERHEAD_PIXELS;
+}
+
+/*
+ * Turns @damage into the list of rectangles to read back. Rectangles are
+ * merged when they overlap, so that no pixel is read back twice, and when
+ * reading back the gap between them is cheaper than issuing another
+ * readback. Everything collapses into the extents when that ends up being
+ * cheaper, or when there would be more rectangles than can be described in
+ * the damage metadata.
+ */
+static GArray *
+build_readback_rectangles (const MtkRegion *damage,
+                           int              width,
+                           int              height)
+{
+  GArray *rects;
+  MtkRectangle extents;
+  gboolean merged_any;
+  int n_rects;
+  int total_cost = 0;
+  int i;
+
+  rects = g_array_new (FALSE, FALSE, sizeof (MtkRectangle));
+
+  if (!damage)
+    {
+      extents = MTK_RECTANGLE_INIT (0, 0, width, height);
+      g_array_append_val (rects, extents);
+      return rects;
+    }
+
+  extents = mtk_region_get_extents (damage);
+
+  n_rects = mtk_region_num_rectangles (damage);
+  if (n_rects > NUM_DAMAGED_RECTS * 4)
+    {
+      g_array_append_val (rects, extents);
+      return rects;
+    }
+
+  for (i = 0; i < n_rects; i++)
+    {
+      MtkRectangle rect = mtk_region_get_rectangle (damage, i);
+
+      g_array_append_val (rects, rect);
+    }
+
+  /* Merging two rectangles can make the result overlap a third one, so
+   * keep going until nothing changes anymore */
+  do
+    {
+      unsigned int j, k;
+
+      merged_any = FALSE;
+
+      for (j = 0; j < rects->len; j++)
+        {
+          for (k = j + 1; k < rects->len; k++)
+            {
+              MtkRectangle *rect = &g_array_index (rects, MtkRectangle, j);
+              MtkRectangle *other = &g_array_index (rects, MtkRectangle, k);
+              MtkRectangle merged;
+
+              mtk_rectangle_union (rect, other, &merged);
+              if (!mtk_rectangle_overlap (rect, other) &&
+                  get_readback_cost (&merged) >=
+                  get_readback_cost (rect) + get_readback_cost (other))
+                continue;
+
+              *rect = merged;
+              g_array_remove_index_fast (rects, k);
+              merged_any = TRUE;
+              k = j;
+            }
+        }
+    }
+  while (merged_any);
+
+  for (i = 0; i < rects->len; i++)
+    total_cost += get_readback_cost (&g_array_index (rects, MtkRectangle, i));
+
+  if (rects->len > NUM_DAMAGED_RECTS ||
+      total_cost >= get_readback_cost (&extents))
+    {
+      g_array_set_size (rects, 0);
+      g_array_append_val (rects, extents);
+    }
+
+  return rects;
+}
+
+/*
+ * Issues the readback of @rects into a pixel buffer object without waiting
+ * for it to land in @data. The PipeWire buffer being recorded is queued by
+ * complete_pending_readback() once the GPU has signaled the fence, or at the
+ * latest when the next frame is recorded.
+ */
+static gboolean
+maybe_begin_async_readback (MetaStreamSource *source,
+                            CoglContext      *cogl_context,
+                            CoglFramebuffer  *framebuffer,
+                            GArray           *rects,
+                            int               stride,
+                            uint8_t          *data,
+                            CoglPixelFormat   format)
+{
+  MetaStreamSourcePrivate *priv =
+    meta_stream_source_get_instance_private (source);
+  CoglRenderer *cogl_renderer = cogl_context_get_renderer (cogl_context);
+  CoglDriver *cogl_driver = cogl_context_get_driver (cogl_context);
+  g_autoptr (GArray) readback_rects = NULL;
+  g_autoptr (GError) error = NULL;
+  MetaStreamReadback *readback;
+  CoglPixelBuffer *pixel_buffer;
+  CoglReadPixelsFlags read_flags;
+  gboolean flip;
+  size_t size = 0;
+  unsigned int i;
+  int bpp;
+
+  if (!priv->readback_target)
+    return FALSE;
+
+  if (!cogl_driver_has_feature (cogl_driver, COGL_FEATURE_ID_PBOS) ||
+      !COGL_IS_RENDERER_EGL (cogl_renderer))
+    return FALSE;
+
+  if (rects->len == 0)
+    return FALSE;
+
+  g_warn_if_fail (!priv->pending_readback);
+
+  bpp = cogl_pixel_format_get_bytes_per_pixel (format, 0);
+
+  readback_rects = g_array_sized_new (FALSE, FALSE,
+                                      sizeof (MetaStreamReadbackRect),
+                                      rects->len);
+  for (i = 0; i < rects->len; i++)
+    {
+      MetaStreamReadbackRect readback_rect;
+
+      readback_rect.rect = g_array_index (rects, MtkRectangle, i);
+      readback_rect.offset = size;
+      g_array_append_val (readback_rects, readback_rect);
+
+      size += (size_t) mtk_rectangle_area (&readback_rect.rect) * bpp;
+    }
+
+  pixel_buffer = ensure_readback_buffer (source, cogl_context,
+                                         MAX (size,
+                                              (size_t) priv->video_format.size.width *
+                                              priv->video_format.size.height *
+                                              bpp));
+
+  /* Let the rows land bottom-up in the pixel buffer and flip them while
+   * copying out, instead of having Cogl map the buffer to flip it in place.
+   */
+  flip = !cogl_framebuffer_is_y_flipped (framebuffer);
+  read_flags = COGL_READ_PIXELS_COLOR_BUFFER;
+  if (flip)
+    read_flags |= COGL_READ_PIXELS_NO_FLIP;
+
+  for (i = 0; i < readback_rects->len; i++)
+    {
+      MetaStreamReadbackRect *readback_rect =
+        &g_array_index (readback_rects, MetaStreamReadbackRect, i);
+      const MtkRectangle *rect = &readback_rect->rect;
+      g_autoptr (CoglBitmap) bitmap = NULL;
+
+      bitmap = cogl_bitmap_new_from_buffer (COGL_BUFFER (pixel_buffer),
+                                            format,
+                                            rect->width,
+                                            rect->height,
+                                            rect->width * bpp,
+                                            readback_rect->offset);
+
+      if (!cogl_framebuffer_read_pixels_into_bitmap (framebuffer,
+                                                     rect->x,
+                                                     rect->y,
+                                                     read_flags,
+                                                     bitmap))
+        return FALSE;
+    }
+
+  readback = g_new0 (MetaStreamReadback, 1);
+  readback->fence_fd = -1;
+  readback->source = source;
+  readback->buffer = priv->readback_target;
+  readback->bump_buffer_age = TRUE;
+  readback->pixel_buffer = g_object_ref (pixel_buffer);
+  readback->rects = g_steal_pointer (&readback_rects);
+  readback->flip = flip;
+  readback->data = data;
+  readback->stride = stride;
+  readback->bpp = bpp;
+
+  readback->fence_fd =
+    cogl_renderer_egl_create_sync_fd (COGL_RENDERER_EGL (cogl_renderer),
+                                      &error);
+  if (readback->fence_fd >= 0)
+    {
+      readback->fence_source = g_unix_fd_source_new (readback->fence_fd,
+                                                     G_IO_IN);
+      g_source_set_callback (readback->fence_source,
+                             G_SOURCE_FUNC (on_readback_fence_signaled),
+                             readback, NULL);
+      g_source_attach (readback->fence_source, NULL);
+    }
+  else
+    {
+      meta_topic (META_DEBUG_SCREEN_CAST,
+                  "Failed to create readback fence, completing with next "
+                  "frame: %s", error->message);
+    }
+
+  priv->pending_readback = readback;
+
+  return TRUE;
+}
+
 gboolean
 meta_stream_source_paint_to_buffer (MetaStreamSource   *source,
                                     ClutterColorState  *color_state,
@@ -551,9 +970,9 @@ meta_stream_source_paint_to_buffer (MetaStreamSource   *source,
   ClutterBackend *clutter_backend = clutter_context_get_backend (context);
   CoglContext *cogl_context =
     clutter_backend_get_cogl_context (clutter_backend);
-  g_autoptr (CoglBitmap) bitmap = NULL;
+  g_autoptr (GArray) rects = NULL;
   ClutterPaintFlag paint_flags;
-  MtkRectangle extents;
+  unsigned int i;
   int bpp;
 
   paint_flags = CLUTTER_PAINT_FLAG_NONE;
@@ -583,32 +1002,35 @@ meta_stream_source_paint_to_buffer (MetaStreamSource   *source,
                                                        paint_flags);
     }
 
-  if (damage)
-    {
-      extents = mtk_region_get_extents (damage);
-    }
-  else
+  rects = build_readback_rectangles (damage, width, height);
+
+  if (maybe_begin_async_readback (source, cogl_context, framebuffer, rects,
+                                  stride, data, format))
+    return TRUE;
+
+  bpp = cogl_pixel_format_get_bytes_per_pixel (format, 0);
+
+  for (i = 0; i < rects->len; i++)
     {
-      extents.x = extents.y = 0;
-      extents.width = width;
-      extents.height = height;
+      const MtkRectangle *rect = &g_array_index (rects, MtkRectangle, i);
+      g_autoptr (CoglBitmap) bitmap = NULL;
+
+      bitmap = cogl_bitmap_new_for_data (cogl_context,
+                                         rect->width,
+                                         rect->height,
+                                         format,
+                                         stride,
+                                         data +
+                                         rect->y * stride +
+                                         rect->x * bpp);
+
+      cogl_framebuffer_read_pixels_into_bitmap (framebuffer,
+                                                rect->x,
+                                                rect->y,
+                                                COGL_READ_PIXELS_COLOR_BUFFER,
+                                                bitmap);
     }
 
-  bpp = cogl_pixel_format_get_bytes_per_pixel (format, 0);
-  bitmap = cogl_bitmap_new_for_data (cogl_context,
-                                     extents.width,
-                                     extents.height,
-                                     format,
-                                     stride,
-                                     data +
-                                     extents.y * stride +
-                                     extents.x * bpp);
-
-  cogl_framebuffer_read_pixels_into_bitmap (framebuffer,
-                                            extents.x,
-                                            extents.y,
-                                            COGL_READ_PIXELS_COLOR_BUFFER,
-                                            bitmap);
   return TRUE;
 }
 
@@ -1104,6 +1526,7 @@ do_record_frame (MetaStreamSource      *source,
       COGL_TRACE_BEGIN_SCOPED (RecordToBuffer,
                                "Meta::StreamSource::record_to_buffer()");
 
+      priv->readback_target = buffer;
       result = meta_stream_source_record_to_buffer (source,
                                                     flags,
                                                     paint_phase,
@@ -1113,6 +1536,7 @@ do_record_frame (MetaStreamSource      *source,
                                                     spa_data->data,
                                                     damage,
                                                     error);
+      priv->readback_target = NULL;
     }
   else if (spa_data->type == SPA_DATA_DmaBuf)
     {
@@ -1165,8 +1589,11 @@ maybe_add_damaged_regions_metadata (MetaStreamSource  *source,
                                     struct spa_buffer *spa_buffer,
                                     MtkRegion         *damage)
 {
+  MetaStreamSourcePrivate *priv =
+    meta_stream_source_get_instance_private (source);
   struct spa_meta *spa_meta_video_damage;
   struct spa_meta_region *meta_region;
+  g_autoptr (GArray) rects = NULL;
   int num_buffers_available = 0;
   int n_rectangles;
   int i = 0;
@@ -1176,7 +1603,11 @@ maybe_add_damaged_regions_metadata (MetaStreamSource  *source,
   if (!spa_meta_video_damage)
     return;
 
-  n_rectangles = mtk_region_num_rectangles (damage);
+  /* Report the same rectangles that are read back for memfd buffers */
+  rects = build_readback_rectangles (damage,
+                                     priv->video_format.size.width,
+                                     priv->video_format.size.height);
+  n_rectangles = rects->len;
 
   spa_meta_for_each (meta_region, spa_meta_video_damage)
     ++num_buffers_available;
@@ -1198,14 +1629,14 @@ maybe_add_damaged_regions_metadata (MetaStreamSource  *source,
     {
       spa_meta_for_each (meta_region, spa_meta_video_damage)
         {
-          MtkRectangle rect;
+          MtkRectangle *rect;
 
           if (i == n_rectangles)
             break;
 
-          rect = mtk_region_get_rectangle (damage, i++);
-          meta_region->region = SPA_REGION (rect.x, rect.y,
-                                            rect.width, rect.height);
+          rect = &g_array_index (rects, MtkRectangle, i++);
+          meta_region->region = SPA_REGION (rect->x, rect->y,
+                                            rect->width, rect->height);
         }
     }
 
@@ -1475,6 +1906,11 @@ meta_stream_source_record_frame_with_timestamp (MetaStreamSource     *source,
               "cursor" : "full",
               priv->node_id);
 
+  /* Make sure the previous frame reaches the consumer before this one, even
+   * if its readback fence hasn't been dispatched yet.
+   */
+  complete_pending_readback (source);
+
   buffer = dequeue_pw_buffer (source, &error);
   if (!buffer)
     {
@@ -1553,8 +1989,18 @@ meta_stream_source_record_frame_with_timestamp (MetaStreamSource     *source,
                          error->message);
               g_clear_error (&error);
             }
-          spa_data->chunk->size = 0;
-          spa_data->chunk->flags = SPA_CHUNK_FLAG_CORRUPTED;
+
+          /* Hand the buffer back without sending a corrupted frame; the
+           * damage is kept and read back with the next recorded frame */
+          if (priv->pending_readback &&
+              priv->pending_readback->buffer == buffer)
+            discard_pending_readback (source);
+
+          meta_topic (META_DEBUG_SCREEN_CAST,
+                      "Returning PipeWire buffer (%p) after failed recording",
+                      buffer->buffer);
+          pw_stream_return_buffer (priv->pipewire_stream, buffer);
+          return record_result;
         }
     }
   else
@@ -1582,6 +2028,15 @@ meta_stream_source_record_frame_with_timestamp (MetaStreamSource     *source,
       meta_topic (META_DEBUG_SCREEN_CAST, "Queuing unsequenced PipeWire buffer");
     }
 
+  if (priv->pending_readback && priv->pending_readback->buffer == buffer)
+    {
+      meta_topic (META_DEBUG_SCREEN_CAST,
+                  "Deferring queuing of PipeWire buffer (%p) until readback "
+                  "completes",
+                  buffer->buffer);
+      return record_result;
+    }
+
   queue_pw_buffer (source,
                    buffer,
                    !(spa_data->chunk->flags & SPA_CHUNK_FLAG_CORRUPTED));
@@ -1674,6 +2129,8 @@ meta_stream_source_disable (MetaStreamSource *source)
 
   META_STREAM_SOURCE_GET_CLASS (source)->disable (source);
 
+  complete_pending_readback (source);
+
   priv->is_enabled = FALSE;
 }
 
@@ -2814,6 +3271,9 @@ on_stream_remove_buffer (void             *data,
   struct spa_buffer *spa_buffer = buffer->buffer;
   struct spa_data *spa_data = &spa_buffer->datas[0];
 
+  if (priv->pending_readback && priv->pending_readback->buffer == buffer)
+    discard_pending_readback (source);
+
   g_clear_pointer (&buffer->user_data, destroy_stream_buffer);
 
   if (spa_data->type == SPA_DATA_DmaBuf)
@@ -3125,10 +3585,13 @@ meta_stream_source_dispose (GObject *object)
     meta_stream_source_get_instance_private (source);
   GHashTableIter modifierIter;
   gpointer key, value;
+  int i;
 
   if (meta_stream_source_is_enabled (source))
     meta_stream_source_disable (source);
 
+  discard_pending_readback (source);
+
   g_hash_table_iter_init (&modifierIter,
                           priv->modifiers);
   while (g_hash_table_iter_next (&modifierIter, &key, &value))
@@ -3145,6 +3608,8 @@ meta_stream_source_dispose (GObject *object)
   g_clear_pointer (&priv->damage_history, clutter_damage_history_free);
   g_clear_object (&priv->color_state);
   g_clear_object (&priv->framebuffer);
+  for (i = 0; i < N_READBACK_BUFFERS; i++)
+    g_clear_object (&priv->readback_buffers[i]);
 
   g_clear_handle_id (&priv->negotiate_with_device_handle_id, mtk_source_remove);
 
@@ -33,6 +33,7 @@
 #include "backends/native/meta-kms-update.h"
 #include "backends/native/meta-kms.h"
 #include "backends/native/meta-monitor-manager-native.h"
+#include "cogl/cogl.h"
 
 enum
 {
@@ -53,8 +54,47 @@ struct _MetaCrtcKms
 
   MetaKmsPlane *assigned_primary_plane;
   MetaKmsPlane *assigned_cursor_plane;
+  MetaKmsPlane *assigned_overlay_plane;
+
+  /* Set of MetaCrtcKmsPlaneTest */
+  GHashTable *plane_tests;
+  int64_t n_plane_test_hits;
+  int64_t n_plane_test_misses;
+  int64_t plane_test_frame;
+
+  gboolean is_overlay_plane_lit;
 };
 
+typedef struct _MetaCrtcKmsPlaneTest
+{
+  uint32_t plane_id;
+  uint32_t format;
+  uint64_t modifier;
+  int width;
+  int height;
+  int n_planes;
+  int strides[4];
+  int offsets[4];
+  MtkMonitorTransform transform;
+  graphene_rect_t src_rect;
+  MtkRectangle dst_rect;
+
+  /* The TEST_ONLY update only carries the tested plane, so the result also
+   * depends on the other planes of the CRTC as they were committed */
+  gboolean is_overlay_plane_lit;
+
+  /* Not part of the key */
+  gboolean passed;
+  int64_t frame;
+} MetaCrtcKmsPlaneTest;
+
+#define MAX_CACHED_PLANE_TESTS 64
+
+/* Results are only trusted for this many frames, as not everything the
+ * kernel may take into account, such as the state of the cursor plane or
+ * bandwidth used by other CRTCs, is part of the key */
+#define MAX_PLANE_TEST_AGE_FRAMES 600
+
 static GQuark kms_crtc_crtc_kms_quark;
 
 G_DEFINE_TYPE (MetaCrtcKms, meta_crtc_kms, META_TYPE_CRTC_NATIVE)
@@ -223,6 +263,7 @@ typedef struct _CrtcKmsAssignment
 {
   MetaKmsPlane *primary_plane;
   MetaKmsPlane *cursor_plane;
+  MetaKmsPlane *overlay_plane;
 } CrtcKmsAssignment;
 
 static gboolean
@@ -253,7 +294,9 @@ is_plane_assigned (MetaKmsPlane     *plane,
             return TRUE;
           break;
         case META_KMS_PLANE_TYPE_OVERLAY:
-          g_assert_not_reached ();
+          if (kms_assignment->overlay_plane == plane)
+            return TRUE;
+          break;
         }
     }
 
@@ -271,6 +314,7 @@ crtc_assigned_plane (MetaCrtcKms      *crtc_kms,
     case META_KMS_PLANE_TYPE_CURSOR:
       return crtc_kms->assigned_cursor_plane;
     case META_KMS_PLANE_TYPE_OVERLAY:
+      return crtc_kms->assigned_overlay_plane;
     default:
       g_assert_not_reached ();
     }
@@ -359,6 +403,7 @@ meta_crtc_kms_assign_extra (MetaCrtc            *crtc,
   MetaCrtcKms *crtc_kms = META_CRTC_KMS (crtc);
   MetaKmsPlane *primary_plane;
   MetaKmsPlane *cursor_plane;
+  MetaKmsPlane *overlay_plane;
   CrtcKmsAssignment *kms_assignment;
 
   primary_plane = find_unassigned_plane (crtc_kms, META_KMS_PLANE_TYPE_PRIMARY,
@@ -377,10 +422,13 @@ meta_crtc_kms_assign_extra (MetaCrtc            *crtc,
 
   cursor_plane = find_unassigned_plane (crtc_kms, META_KMS_PLANE_TYPE_CURSOR,
                                         crtc_assignments);
+  overlay_plane = find_unassigned_plane (crtc_kms, META_KMS_PLANE_TYPE_OVERLAY,
+                                         crtc_assignments);
 
   kms_assignment = g_new0 (CrtcKmsAssignment, 1);
   kms_assignment->primary_plane = primary_plane;
   kms_assignment->cursor_plane = cursor_plane;
+  kms_assignment->overlay_plane = overlay_plane;
 
   crtc_assignment->backend_private = kms_assignment;
   crtc_assignment->backend_private_destroy = g_free;
@@ -398,6 +446,9 @@ meta_crtc_kms_set_config (MetaCrtc             *crtc,
 
   crtc_kms->assigned_primary_plane = kms_assignment->primary_plane;
   crtc_kms->assigned_cursor_plane = kms_assignment->cursor_plane;
+  crtc_kms->assigned_overlay_plane = kms_assignment->overlay_plane;
+
+  meta_crtc_kms_invalidate_plane_tests (crtc_kms);
 }
 
 void
@@ -407,6 +458,9 @@ meta_crtc_kms_assign_planes (MetaCrtcKms  *crtc_kms,
 {
   crtc_kms->assigned_primary_plane = primary_plane;
   crtc_kms->assigned_cursor_plane = cursor_plane;
+  crtc_kms->assigned_overlay_plane = NULL;
+
+  meta_crtc_kms_invalidate_plane_tests (crtc_kms);
 }
 
 static void
@@ -419,6 +473,9 @@ meta_crtc_kms_unset_config (MetaCrtc *crtc)
 
   crtc_kms->assigned_primary_plane = NULL;
   crtc_kms->assigned_cursor_plane = NULL;
+  crtc_kms->assigned_overlay_plane = NULL;
+
+  meta_crtc_kms_invalidate_plane_tests (crtc_kms);
 }
 
 static gboolean
@@ -464,6 +521,12 @@ meta_crtc_kms_get_assigned_primary_plane (MetaCrtcKms *crtc_kms)
   return crtc_kms->assigned_primary_plane;
 }
 
+MetaKmsPlane *
+meta_crtc_kms_get_assigned_overlay_plane (MetaCrtcKms *crtc_kms)
+{
+  return crtc_kms->assigned_overlay_plane;
+}
+
 static GList *
 generate_crtc_connector_list (MetaGpu  *gpu,
                               MetaCrtc *crtc)
@@ -526,6 +589,203 @@ meta_crtc_kms_set_mode (MetaCrtcKms   *crtc_kms,
                             kms_mode);
 }
 
+static guint
+plane_test_hash (gconstpointer key)
+{
+  const MetaCrtcKmsPlaneTest *test = key;
+  guint hash;
+  int i;
+
+  hash = test->plane_id;
+  hash = hash * 31 + test->format;
+  hash = hash * 31 + g_int64_hash (&test->modifier);
+  hash = hash * 31 + test->width;
+  hash = hash * 31 + test->height;
+  hash = hash * 31 + test->n_planes;
+  for (i = 0; i < test->n_planes; i++)
+    {
+      hash = hash * 31 + test->strides[i];
+      hash = hash * 31 + test->offsets[i];
+    }
+  hash = hash * 31 + test->transform;
+  hash = hash * 31 + (int) test->src_rect.origin.x;
+  hash = hash * 31 + (int) test->src_rect.origin.y;
+  hash = hash * 31 + (int) test->src_rect.size.width;
+  hash = hash * 31 + (int) test->src_rect.size.height;
+  hash = hash * 31 + test->dst_rect.x;
+  hash = hash * 31 + test->dst_rect.y;
+  hash = hash * 31 + test->dst_rect.width;
+  hash = hash * 31 + test->dst_rect.height;
+  hash = hash * 31 + (test->is_overlay_plane_lit ? 1 : 0);
+
+  return hash;
+}
+
+static gboolean
+plane_test_equal (gconstpointer a,
+                  gconstpointer b)
+{
+  const MetaCrtcKmsPlaneTest *test_a = a;
+  const MetaCrtcKmsPlaneTest *test_b = b;
+  int i;
+
+  if (test_a->plane_id != test_b->plane_id ||
+      test_a->format != test_b->format ||
+      test_a->modifier != test_b->modifier ||
+      test_a->width != test_b->width ||
+      test_a->height != test_b->height ||
+      test_a->n_planes != test_b->n_planes ||
+      test_a->transform != test_b->transform ||
+      !test_a->is_overlay_plane_lit != !test_b->is_overlay_plane_lit)
+    return FALSE;
+
+  for (i = 0; i < test_a->n_planes; i++)
+    {
+      if (test_a->strides[i] != test_b->strides[i] ||
+          test_a->offsets[i] != test_b->offsets[i])
+        return FALSE;
+    }
+
+  return (graphene_rect_equal (&test_a->src_rect, &test_b->src_rect) &&
+          mtk_rectangle_equal (&test_a->dst_rect, &test_b->dst_rect));
+}
+
+static void
+init_plane_test (MetaCrtcKms           *crtc_kms,
+                 MetaKmsPlane          *kms_plane,
+                 MetaDrmBuffer         *buffer,
+                 const graphene_rect_t *src_rect,
+                 const MtkRectangle    *dst_rect,
+                 MetaCrtcKmsPlaneTest  *test)
+{
+  const MetaCrtcConfig *crtc_config =
+    meta_crtc_get_config (META_CRTC (crtc_kms));
+  int i;
+
+  *test = (MetaCrtcKmsPlaneTest) {
+    .plane_id = meta_kms_plane_get_id (kms_plane),
+    .format = meta_drm_buffer_get_format (buffer),
+    .modifier = meta_drm_buffer_get_modifier (buffer),
+    .width = meta_drm_buffer_get_width (buffer),
+    .height = meta_drm_buffer_get_height (buffer),
+    .n_planes = MIN (meta_drm_buffer_get_n_planes (buffer),
+                     G_N_ELEMENTS (test->strides)),
+    .transform = crtc_config ? crtc_config->transform
+                             : MTK_MONITOR_TRANSFORM_NORMAL,
+    .src_rect = *src_rect,
+    .dst_rect = *dst_rect,
+    .is_overlay_plane_lit = (crtc_kms->is_overlay_plane_lit &&
+                             kms_plane != crtc_kms->assigned_overlay_plane),
+  };
+
+  for (i = 0; i < test->n_planes; i++)
+    {
+      test->strides[i] = meta_drm_buffer_get_stride_for_plane (buffer, i);
+      test->offsets[i] = meta_drm_buffer_get_offset_for_plane (buffer, i);
+    }
+}
+
+/**
+ * meta_crtc_kms_lookup_plane_test:
+ * @crtc_kms: A #MetaCrtcKms
+ * @kms_plane: The plane @buffer would be assigned to
+ * @buffer: The buffer to scan out
+ * @src_rect: The source rectangle within @buffer
+ * @dst_rect: The destination rectangle on the CRTC
+ * @out_passed: (out): Return location for the cached result
+ *
+ * Looks up the result of a recent TEST_ONLY update assigning a buffer
+ * with the same format, modifier, size and memory layout to @kms_plane
+ * with the same geometry, while the other planes of the CRTC were in the
+ * same state.
+ *
+ * Returns: %TRUE if a cached result was found
+ */
+gboolean
+meta_crtc_kms_lookup_plane_test (MetaCrtcKms           *crtc_kms,
+                                 MetaKmsPlane          *kms_plane,
+                                 MetaDrmBuffer         *buffer,
+                                 const graphene_rect_t *src_rect,
+                                 const MtkRectangle    *dst_rect,
+                                 gboolean              *out_passed)
+{
+  MetaCrtcKmsPlaneTest test;
+  MetaCrtcKmsPlaneTest *cached_test;
+
+  COGL_TRACE_DEFINE_COUNTER_INT (PlaneTestCacheHits,
+                                 "PlaneTestCacheHits",
+                                 "the number of scanout tests answered "
+                                 "from the CRTC plane test cache");
+  COGL_TRACE_DEFINE_COUNTER_INT (PlaneTestCacheMisses,
+                                 "PlaneTestCacheMisses",
+                                 "the number of scanout tests that needed "
+                                 "a TEST_ONLY update");
+
+  init_plane_test (crtc_kms, kms_plane, buffer, src_rect, dst_rect, &test);
+
+  cached_test = g_hash_table_lookup (crtc_kms->plane_tests, &test);
+  if (cached_test &&
+      crtc_kms->plane_test_frame - cached_test->frame > MAX_PLANE_TEST_AGE_FRAMES)
+    {
+      g_hash_table_remove (crtc_kms->plane_tests, cached_test);
+      cached_test = NULL;
+    }
+
+  if (!cached_test)
+    {
+      crtc_kms->n_plane_test_misses++;
+      COGL_TRACE_SET_COUNTER_INT (PlaneTestCacheMisses,
+                                  crtc_kms->n_plane_test_misses);
+      return FALSE;
+    }
+
+  crtc_kms->n_plane_test_hits++;
+  COGL_TRACE_SET_COUNTER_INT (PlaneTestCacheHits,
+                              crtc_kms->n_plane_test_hits);
+
+  *out_passed = cached_test->passed;
+  return TRUE;
+}
+
+void
+meta_crtc_kms_store_plane_test (MetaCrtcKms           *crtc_kms,
+                                MetaKmsPlane          *kms_plane,
+                                MetaDrmBuffer         *buffer,
+                                const graphene_rect_t *src_rect,
+                                const MtkRectangle    *dst_rect,
+                                gboolean               passed)
+{
+  MetaCrtcKmsPlaneTest *test;
+
+  if (g_hash_table_size (crtc_kms->plane_tests) >= MAX_CACHED_PLANE_TESTS)
+    g_hash_table_remove_all (crtc_kms->plane_tests);
+
+  test = g_new0 (MetaCrtcKmsPlaneTest, 1);
+  init_plane_test (crtc_kms, kms_plane, buffer, src_rect, dst_rect, test);
+  test->passed = passed;
+  test->frame = crtc_kms->plane_test_frame;
+
+  g_hash_table_replace (crtc_kms->plane_tests, test, test);
+}
+
+void
+meta_crtc_kms_invalidate_plane_tests (MetaCrtcKms *crtc_kms)
+{
+  g_hash_table_remove_all (crtc_kms->plane_tests);
+}
+
+/*
+ * Called for each frame posted to the CRTC, with whether it lights up the
+ * overlay plane. Cached test results expire after a number of frames.
+ */
+void
+meta_crtc_kms_notify_plane_frame (MetaCrtcKms *crtc_kms,
+                                  gboolean     is_overlay_plane_lit)
+{
+  crtc_kms->plane_test_frame++;
+  crtc_kms->is_overlay_plane_lit = is_overlay_plane_lit;
+}
+
 MetaKmsCrtc *
 meta_crtc_kms_get_kms_crtc (MetaCrtcKms *crtc_kms)
 {
@@ -558,17 +818,34 @@ meta_crtc_kms_new (MetaGpuKms  *gpu_kms,
   return crtc_kms;
 }
 
+static void
+meta_crtc_kms_finalize (GObject *object)
+{
+  MetaCrtcKms *crtc_kms = META_CRTC_KMS (object);
+
+  g_clear_pointer (&crtc_kms->plane_tests, g_hash_table_unref);
+
+  G_OBJECT_CLASS (meta_crtc_kms_parent_class)->finalize (object);
+}
+
 static void
 meta_crtc_kms_init (MetaCrtcKms *crtc_kms)
 {
+  crtc_kms->plane_tests = g_hash_table_new_full (plane_test_hash,
+                                                 plane_test_equal,
+                                                 g_free,
+                                                 NULL);
 }
 
 static void
 meta_crtc_kms_class_init (MetaCrtcKmsClass *klass)
 {
+  GObjectClass *object_class = G_OBJECT_CLASS (klass);
   MetaCrtcClass *crtc_class = META_CRTC_CLASS (klass);
   MetaCrtcNativeClass *crtc_native_class = META_CRTC_NATIVE_CLASS (klass);
 
+  object_class->finalize = meta_crtc_kms_finalize;
+
   crtc_class->get_gamma_lut_size = meta_crtc_kms_get_gamma_lut_size;
   crtc_class->get_gamma_lut = meta_crtc_kms_get_gamma_lut;
   crtc_class->set_gamma_lut = meta_crtc_kms_set_gamma_lut;
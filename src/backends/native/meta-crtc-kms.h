@@ -37,10 +37,14 @@ G_DECLARE_FINAL_TYPE (MetaCrtcKms, meta_crtc_kms,
                       META, CRTC_KMS,
                       MetaCrtcNative)
 
+META_EXPORT_TEST
 MetaKmsPlane * meta_crtc_kms_get_assigned_primary_plane (MetaCrtcKms *crtc_kms);
 
 MetaKmsPlane * meta_crtc_kms_get_assigned_cursor_plane (MetaCrtcKms *crtc_kms);
 
+META_EXPORT_TEST
+MetaKmsPlane * meta_crtc_kms_get_assigned_overlay_plane (MetaCrtcKms *crtc_kms);
+
 void meta_crtc_kms_assign_planes (MetaCrtcKms  *crtc_kms,
                                   MetaKmsPlane *primary_plane,
                                   MetaKmsPlane *cursor_plane);
@@ -48,6 +52,29 @@ void meta_crtc_kms_assign_planes (MetaCrtcKms  *crtc_kms,
 void meta_crtc_kms_set_mode (MetaCrtcKms   *crtc_kms,
                              MetaKmsUpdate *kms_update);
 
+META_EXPORT_TEST
+gboolean meta_crtc_kms_lookup_plane_test (MetaCrtcKms           *crtc_kms,
+                                          MetaKmsPlane          *kms_plane,
+                                          MetaDrmBuffer         *buffer,
+                                          const graphene_rect_t *src_rect,
+                                          const MtkRectangle    *dst_rect,
+                                          gboolean              *out_passed);
+
+META_EXPORT_TEST
+void meta_crtc_kms_store_plane_test (MetaCrtcKms           *crtc_kms,
+                                     MetaKmsPlane          *kms_plane,
+                                     MetaDrmBuffer         *buffer,
+                                     const graphene_rect_t *src_rect,
+                                     const MtkRectangle    *dst_rect,
+                                     gboolean               passed);
+
+META_EXPORT_TEST
+void meta_crtc_kms_invalidate_plane_tests (MetaCrtcKms *crtc_kms);
+
+META_EXPORT_TEST
+void meta_crtc_kms_notify_plane_frame (MetaCrtcKms *crtc_kms,
+                                       gboolean     is_overlay_plane_lit);
+
 META_EXPORT_TEST
 MetaKmsCrtc * meta_crtc_kms_get_kms_crtc (MetaCrtcKms *crtc_kms);
 
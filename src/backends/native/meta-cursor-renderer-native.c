@@ -64,6 +64,9 @@
 #include "wayland/meta-cursor-wayland.h"
 #include "wayland/meta-wayland-buffer.h"
 
+/* Number of ready-to-scan-out cursor buffers kept around per GPU. */
+#define CURSOR_BUFFER_CACHE_SIZE 16
+
 static GQuark quark_cursor_sprite = 0;
 
 typedef struct _CursorStageView
@@ -106,8 +109,34 @@ typedef struct _MetaCursorRendererNativeGpuData
   CoglPixelFormat cogl_format;
   uint64_t cursor_width;
   uint64_t cursor_height;
+
+  /* CursorBufferCacheEntry, most recently used first */
+  GQueue buffer_cache;
 } MetaCursorRendererNativeGpuData;
 
+typedef struct _CursorBufferKey
+{
+  const uint8_t *pixels;
+  int rowstride;
+  unsigned int pixels_hash;
+  int width;
+  int height;
+  uint32_t format;
+  graphene_matrix_t matrix;
+  ClutterColorState *color_state;
+  ClutterColorState *target_color_state;
+  int dst_width;
+  int dst_height;
+  uint64_t buffer_width;
+  uint64_t buffer_height;
+} CursorBufferKey;
+
+typedef struct _CursorBufferCacheEntry
+{
+  CursorBufferKey key;
+  MetaDrmBuffer *buffer;
+} CursorBufferCacheEntry;
+
 typedef struct _KmsCursorData
 {
   ClutterSeat *seat;
@@ -184,20 +213,180 @@ meta_cursor_renderer_native_gpu_data_from_gpu (MetaGpuKms *gpu_kms)
                              quark_cursor_renderer_native_gpu_data);
 }
 
+static void
+cursor_buffer_cache_entry_free (CursorBufferCacheEntry *entry)
+{
+  g_free ((uint8_t *) entry->key.pixels);
+  g_clear_object (&entry->key.color_state);
+  g_clear_object (&entry->key.target_color_state);
+  g_clear_object (&entry->buffer);
+  g_free (entry);
+}
+
+static void
+clear_cursor_buffer_cache (MetaCursorRendererNativeGpuData *cursor_renderer_gpu_data)
+{
+  g_queue_clear_full (&cursor_renderer_gpu_data->buffer_cache,
+                      (GDestroyNotify) cursor_buffer_cache_entry_free);
+}
+
+static void
+meta_cursor_renderer_native_gpu_data_free (MetaCursorRendererNativeGpuData *cursor_renderer_gpu_data)
+{
+  clear_cursor_buffer_cache (cursor_renderer_gpu_data);
+  g_free (cursor_renderer_gpu_data);
+}
+
 static MetaCursorRendererNativeGpuData *
 meta_create_cursor_renderer_native_gpu_data (MetaGpuKms *gpu_kms)
 {
   MetaCursorRendererNativeGpuData *cursor_renderer_gpu_data;
 
   cursor_renderer_gpu_data = g_new0 (MetaCursorRendererNativeGpuData, 1);
+  g_queue_init (&cursor_renderer_gpu_data->buffer_cache);
   g_object_set_qdata_full (G_OBJECT (gpu_kms),
                            quark_cursor_renderer_native_gpu_data,
                            cursor_renderer_gpu_data,
-                           g_free);
+                           (GDestroyNotify) meta_cursor_renderer_native_gpu_data_free);
 
   return cursor_renderer_gpu_data;
 }
 
+static unsigned int
+hash_cursor_pixels (const uint8_t *pixels,
+                    int            row_length,
+                    int            height,
+                    int            rowstride)
+{
+  unsigned int hash = 2166136261u;
+  int x, y;
+
+  /* FNV-1a over 32 bit words; cursor formats all have 4 or 8 bytes per
+   * pixel, so rows are always a multiple of 4 bytes. */
+  for (y = 0; y < height; y++)
+    {
+      const uint8_t *row = pixels + y * rowstride;
+
+      for (x = 0; x + 4 <= row_length; x += 4)
+        {
+          uint32_t word;
+
+          memcpy (&word, row + x, sizeof (word));
+          hash = (hash ^ word) * 16777619u;
+        }
+    }
+
+  return hash;
+}
+
+static gboolean
+color_states_equal (ClutterColorState *color_state,
+                    ClutterColorState *other_color_state)
+{
+  if (!color_state || !other_color_state)
+    return color_state == other_color_state;
+
+  return clutter_color_state_equals (color_state, other_color_state);
+}
+
+static gboolean
+cursor_buffer_key_equal (const CursorBufferKey *key,
+                         const CursorBufferKey *other_key,
+                         int                    row_length)
+{
+  int y;
+
+  if (key->pixels_hash != other_key->pixels_hash ||
+      key->width != other_key->width ||
+      key->height != other_key->height ||
+      key->format != other_key->format ||
+      key->dst_width != other_key->dst_width ||
+      key->dst_height != other_key->dst_height ||
+      key->buffer_width != other_key->buffer_width ||
+      key->buffer_height != other_key->buffer_height)
+    return FALSE;
+
+  if (!graphene_matrix_equal_fast (&key->matrix, &other_key->matrix))
+    return FALSE;
+
+  if (!color_states_equal (key->color_state, other_key->color_state) ||
+      !color_states_equal (key->target_color_state,
+                           other_key->target_color_state))
+    return FALSE;
+
+  for (y = 0; y < key->height; y++)
+    {
+      if (memcmp (key->pixels + y * key->rowstride,
+                  other_key->pixels + y * other_key->rowstride,
+                  row_length) != 0)
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+static MetaDrmBuffer *
+lookup_cached_cursor_buffer (MetaCursorRendererNativeGpuData *cursor_renderer_gpu_data,
+                             const CursorBufferKey           *key,
+                             int                              row_length)
+{
+  GQueue *buffer_cache = &cursor_renderer_gpu_data->buffer_cache;
+  GList *l;
+
+  for (l = buffer_cache->head; l; l = l->next)
+    {
+      CursorBufferCacheEntry *entry = l->data;
+
+      if (!cursor_buffer_key_equal (&entry->key, key, row_length))
+        continue;
+
+      if (l != buffer_cache->head)
+        {
+          g_queue_unlink (buffer_cache, l);
+          g_queue_push_head_link (buffer_cache, l);
+        }
+
+      return entry->buffer;
+    }
+
+  return NULL;
+}
+
+static void
+cache_cursor_buffer (MetaCursorRendererNativeGpuData *cursor_renderer_gpu_data,
+                     const CursorBufferKey           *key,
+                     int                              row_length,
+                     MetaDrmBuffer                   *buffer)
+{
+  GQueue *buffer_cache = &cursor_renderer_gpu_data->buffer_cache;
+  CursorBufferCacheEntry *entry;
+  uint8_t *pixels;
+  int y;
+
+  pixels = g_malloc (row_length * key->height);
+  for (y = 0; y < key->height; y++)
+    {
+      memcpy (pixels + y * row_length,
+              key->pixels + y * key->rowstride,
+              row_length);
+    }
+
+  entry = g_new0 (CursorBufferCacheEntry, 1);
+  entry->key = *key;
+  entry->key.pixels = pixels;
+  entry->key.rowstride = row_length;
+  if (key->color_state)
+    entry->key.color_state = g_object_ref (key->color_state);
+  if (key->target_color_state)
+    entry->key.target_color_state = g_object_ref (key->target_color_state);
+  entry->buffer = g_object_ref (buffer);
+
+  g_queue_push_head (buffer_cache, entry);
+
+  while (buffer_cache->length > CURSOR_BUFFER_CACHE_SIZE)
+    cursor_buffer_cache_entry_free (g_queue_pop_tail (buffer_cache));
+}
+
 static void
 meta_cursor_renderer_native_finalize (GObject *object)
 {
@@ -225,6 +414,7 @@ disable_hw_cursor_for_gpu (MetaGpuKms   *gpu_kms,
              "using OpenGL from now on",
              error->message);
   cursor_renderer_gpu_data->hw_cursor_broken = TRUE;
+  clear_cursor_buffer_cache (cursor_renderer_gpu_data);
 }
 
 void
@@ -741,41 +931,28 @@ supports_exact_cursor_size (MetaCrtcKms *crtc_kms,
   return FALSE;
 }
 
-static gboolean
-load_cursor_sprite_gbm_buffer_for_crtc (MetaCursorRendererNative *native,
-                                        MetaCrtcKms              *crtc_kms,
-                                        ClutterCursor            *cursor,
-                                        uint8_t                  *pixels,
-                                        uint                      width,
-                                        uint                      height,
-                                        int                       rowstride,
-                                        graphene_point_t         *hotspot,
-                                        MtkMonitorTransform       transform,
-                                        uint32_t                  gbm_format)
+static MetaDrmBuffer *
+create_cursor_buffer_for_crtc (MetaCursorRendererNative *native,
+                               MetaCrtcKms              *crtc_kms,
+                               uint8_t                  *pixels,
+                               uint                      width,
+                               uint                      height,
+                               int                       rowstride,
+                               uint64_t                  cursor_width,
+                               uint64_t                  cursor_height,
+                               uint32_t                  gbm_format)
 {
   MetaCursorRendererNativePrivate *priv =
     meta_cursor_renderer_native_get_instance_private (native);
   MetaBackendNative *backend_native = META_BACKEND_NATIVE (priv->backend);
-  MetaKms *kms = meta_backend_native_get_kms (backend_native);
-  MetaKmsCursorManager *kms_cursor_manager = meta_kms_get_cursor_manager (kms);
   MetaDevicePool *device_pool =
     meta_backend_native_get_device_pool (backend_native);
   MetaGpu *gpu = meta_crtc_get_gpu (META_CRTC (crtc_kms));
   MetaGpuKms *gpu_kms = META_GPU_KMS (gpu);
-  MetaKmsCrtc *kms_crtc;
-  uint64_t cursor_width, cursor_height;
-  g_autoptr (MetaDrmBuffer) buffer = NULL;
+  MetaDrmBuffer *buffer;
   g_autoptr (MetaDeviceFile) device_file = NULL;
   g_autoptr (GError) error = NULL;
 
-  if (!get_optimal_cursor_size (crtc_kms,
-                                width, height,
-                                &cursor_width, &cursor_height))
-    {
-      g_warning_once ("Can't handle cursor size %ux%u", width, height);
-      return FALSE;
-    }
-
   device_file = meta_device_pool_open (device_pool,
                                        meta_gpu_kms_get_file_path (gpu_kms),
                                        META_DEVICE_FILE_FLAG_TAKE_CONTROL,
@@ -786,7 +963,7 @@ load_cursor_sprite_gbm_buffer_for_crtc (MetaCursorRendererNative *native,
                  meta_gpu_kms_get_file_path (gpu_kms),
                  error->message);
       disable_hw_cursor_for_gpu (gpu_kms, error);
-      return FALSE;
+      return NULL;
     }
 
   buffer = create_cursor_drm_buffer (gpu_kms, device_file,
@@ -800,16 +977,10 @@ load_cursor_sprite_gbm_buffer_for_crtc (MetaCursorRendererNative *native,
     {
       g_warning ("Realizing HW cursor failed: %s", error->message);
       disable_hw_cursor_for_gpu (gpu_kms, error);
-      return FALSE;
+      return NULL;
     }
 
-  kms_crtc = meta_crtc_kms_get_kms_crtc (crtc_kms);
-  meta_kms_cursor_manager_update_sprite (kms_cursor_manager,
-                                         kms_crtc,
-                                         buffer,
-                                         transform,
-                                         hotspot);
-  return TRUE;
+  return buffer;
 }
 
 static CoglTexture *
@@ -904,6 +1075,9 @@ load_scaled_and_transformed_cursor_sprite (MetaCursorRendererNative *native,
 {
   MetaCursorRendererNativePrivate *priv =
     meta_cursor_renderer_native_get_instance_private (native);
+  MetaBackendNative *backend_native = META_BACKEND_NATIVE (priv->backend);
+  MetaKms *kms = meta_backend_native_get_kms (backend_native);
+  MetaKmsCursorManager *kms_cursor_manager = meta_kms_get_cursor_manager (kms);
   MetaCursorRendererNativeGpuData *cursor_renderer_gpu_data;
   MetaCrtc *crtc = META_CRTC (crtc_kms);
   MetaGpu *gpu = meta_crtc_get_gpu (crtc);
@@ -927,9 +1101,18 @@ load_scaled_and_transformed_cursor_sprite (MetaCursorRendererNative *native,
   int crtc_dst_width;
   int crtc_dst_height;
   ClutterColorState *cursor_color_state;
-  gboolean retval = FALSE;
   graphene_point_t hotspot;
   int hot_x, hot_y;
+  gboolean needs_processing;
+  int buffer_width;
+  int buffer_height;
+  MtkMonitorTransform buffer_transform;
+  uint64_t cursor_width, cursor_height;
+  const MetaFormatInfo *format_info;
+  int row_length;
+  CursorBufferKey key;
+  g_autoptr (MetaDrmBuffer) buffer = NULL;
+  MetaKmsCrtc *kms_crtc;
 
   cursor_renderer_gpu_data =
     meta_cursor_renderer_native_gpu_data_from_gpu (gpu_kms);
@@ -1012,24 +1195,75 @@ load_scaled_and_transformed_cursor_sprite (MetaCursorRendererNative *native,
                                          &hot_x, &hot_y);
   hotspot = GRAPHENE_POINT_INIT (hot_x, hot_y);
 
-  if (width != crtc_dst_width || height != crtc_dst_height ||
-      !graphene_matrix_is_identity (&matrix) ||
-      gbm_format != cursor_renderer_gpu_data->drm_format ||
-      clutter_color_pipeline_shader_needs_color_state (cursor_color_state,
-                                                       target_color_state,
-                                                       0))
+  needs_processing =
+    (width != crtc_dst_width || height != crtc_dst_height ||
+     !graphene_matrix_is_identity (&matrix) ||
+     gbm_format != cursor_renderer_gpu_data->drm_format ||
+     clutter_color_pipeline_shader_needs_color_state (cursor_color_state,
+                                                      target_color_state,
+                                                      0));
+  if (needs_processing)
+    {
+      buffer_width = crtc_dst_width;
+      buffer_height = crtc_dst_height;
+      buffer_transform = relative_transform;
+    }
+  else
+    {
+      buffer_width = width;
+      buffer_height = height;
+      buffer_transform = MTK_MONITOR_TRANSFORM_NORMAL;
+    }
+
+  if (!get_optimal_cursor_size (crtc_kms,
+                                buffer_width, buffer_height,
+                                &cursor_width, &cursor_height))
+    {
+      g_warning_once ("Can't handle cursor size %dx%d",
+                      buffer_width, buffer_height);
+      return FALSE;
+    }
+
+  format_info = meta_format_info_from_drm_format (gbm_format);
+  if (!format_info)
+    return FALSE;
+
+  row_length =
+    width * cogl_pixel_format_get_bytes_per_pixel (format_info->cogl_format, 0);
+
+  /* Realizing the same image again, e.g. when it moves to another monitor
+   * or when an animation loops, can reuse an earlier buffer as long as
+   * everything that went into it is the same. */
+  key = (CursorBufferKey) {
+    .pixels = data,
+    .rowstride = rowstride,
+    .pixels_hash = hash_cursor_pixels (data, row_length, height, rowstride),
+    .width = width,
+    .height = height,
+    .format = gbm_format,
+    .matrix = matrix,
+    .color_state = cursor_color_state,
+    .target_color_state = target_color_state,
+    .dst_width = buffer_width,
+    .dst_height = buffer_height,
+    .buffer_width = cursor_width,
+    .buffer_height = cursor_height,
+  };
+
+  buffer = lookup_cached_cursor_buffer (cursor_renderer_gpu_data,
+                                        &key, row_length);
+  if (buffer)
+    {
+      g_object_ref (buffer);
+    }
+  else if (needs_processing)
     {
-      const MetaFormatInfo *format_info;
       g_autoptr (GError) error = NULL;
       g_autoptr (CoglTexture) texture = NULL;
       g_autofree uint8_t *cursor_data = NULL;
       int bpp;
       int cursor_rowstride;
 
-      format_info = meta_format_info_from_drm_format (gbm_format);
-      if (!format_info)
-        return FALSE;
-
       texture = scale_and_transform_cursor_sprite_cpu (native,
                                                        target_color_state,
                                                        cursor,
@@ -1059,33 +1293,44 @@ load_scaled_and_transformed_cursor_sprite (MetaCursorRendererNative *native,
                              cursor_rowstride,
                              cursor_data);
 
-      retval =
-        load_cursor_sprite_gbm_buffer_for_crtc (native,
-                                                crtc_kms,
-                                                cursor,
-                                                cursor_data,
-                                                crtc_dst_width,
-                                                crtc_dst_height,
-                                                cursor_rowstride,
-                                                &hotspot,
-                                                relative_transform,
-                                                cursor_renderer_gpu_data->drm_format);
+      buffer = create_cursor_buffer_for_crtc (native,
+                                              crtc_kms,
+                                              cursor_data,
+                                              crtc_dst_width,
+                                              crtc_dst_height,
+                                              cursor_rowstride,
+                                              cursor_width,
+                                              cursor_height,
+                                              cursor_renderer_gpu_data->drm_format);
+      if (!buffer)
+        return FALSE;
+
+      cache_cursor_buffer (cursor_renderer_gpu_data, &key, row_length, buffer);
     }
   else
     {
-      retval = load_cursor_sprite_gbm_buffer_for_crtc (native,
-                                                       crtc_kms,
-                                                       cursor,
-                                                       data,
-                                                       width,
-                                                       height,
-                                                       rowstride,
-                                                       &hotspot,
-                                                       MTK_MONITOR_TRANSFORM_NORMAL,
-                                                       cursor_renderer_gpu_data->drm_format);
+      buffer = create_cursor_buffer_for_crtc (native,
+                                              crtc_kms,
+                                              data,
+                                              width,
+                                              height,
+                                              rowstride,
+                                              cursor_width,
+                                              cursor_height,
+                                              cursor_renderer_gpu_data->drm_format);
+      if (!buffer)
+        return FALSE;
+
+      cache_cursor_buffer (cursor_renderer_gpu_data, &key, row_length, buffer);
     }
 
-  return retval;
+  kms_crtc = meta_crtc_kms_get_kms_crtc (crtc_kms);
+  meta_kms_cursor_manager_update_sprite (kms_cursor_manager,
+                                         kms_crtc,
+                                         buffer,
+                                         buffer_transform,
+                                         &hotspot);
+  return TRUE;
 }
 
 static gboolean
@@ -48,6 +48,11 @@ void meta_frame_native_set_scanout (MetaFrameNative *frame_native,
 
 CoglScanout * meta_frame_native_get_scanout (MetaFrameNative *frame_native);
 
+void meta_frame_native_set_overlay_scanout (MetaFrameNative *frame_native,
+                                            CoglScanout     *scanout);
+
+CoglScanout * meta_frame_native_get_overlay_scanout (MetaFrameNative *frame_native);
+
 void
 meta_frame_native_set_damage (MetaFrameNative *frame_native,
                               const MtkRegion *damage);
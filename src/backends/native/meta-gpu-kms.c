@@ -371,10 +371,15 @@ meta_gpu_kms_read_current (MetaGpu  *gpu,
                            GError  **error)
 {
   MetaGpuKms *gpu_kms = META_GPU_KMS (gpu);
+  GList *l;
 
   update_modes (gpu_kms);
   update_outputs (gpu_kms);
 
+  /* Plane capabilities may have changed with a hotplug. */
+  for (l = meta_gpu_get_crtcs (gpu); l; l = l->next)
+    meta_crtc_kms_invalidate_plane_tests (META_CRTC_KMS (l->data));
+
   return TRUE;
 }
 
@@ -45,6 +45,7 @@ typedef enum _MetaKmsPlaneProp
   META_KMS_PLANE_PROP_SIZE_HINTS,
   META_KMS_PLANE_PROP_YCBCR_COLOR_ENCODING,
   META_KMS_PLANE_PROP_YCBCR_COLOR_RANGE,
+  META_KMS_PLANE_PROP_ZPOS,
   META_KMS_PLANE_N_PROPS
 } MetaKmsPlaneProp;
 
@@ -276,6 +276,25 @@ meta_kms_plane_supports_cursor_hotspot (MetaKmsPlane *plane)
     }
 }
 
+/*
+ * Gets the position of the plane in the stacking order of the planes of a
+ * CRTC, with higher values stacked above lower ones. Returns FALSE if the
+ * driver doesn't expose it, in which case overlay planes are meant to be
+ * stacked above the primary plane.
+ */
+gboolean
+meta_kms_plane_get_zpos (MetaKmsPlane *plane,
+                         uint64_t     *zpos)
+{
+  MetaKmsProp *prop = &plane->prop_table.props[META_KMS_PLANE_PROP_ZPOS];
+
+  if (!prop->prop_id)
+    return FALSE;
+
+  *zpos = prop->value;
+  return TRUE;
+}
+
 GArray *
 meta_kms_plane_get_modifiers_for_format (MetaKmsPlane *plane,
                                          uint32_t      format)
@@ -687,6 +706,11 @@ init_properties (MetaKmsPlane            *plane,
           .num_enum_values = META_KMS_PLANE_YCBCR_COLOR_RANGE_N_PROPS,
           .default_value = META_KMS_PLANE_YCBCR_COLOR_RANGE_LIMITED,
         },
+      [META_KMS_PLANE_PROP_ZPOS] =
+        {
+          .name = "zpos",
+          .type = DRM_MODE_PROP_RANGE,
+        },
     },
     .rotation_bitmask = {
       [META_KMS_PLANE_ROTATION_BIT_ROTATE_0] =
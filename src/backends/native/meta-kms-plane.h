@@ -82,6 +82,9 @@ gboolean meta_kms_plane_is_color_range_handled (MetaKmsPlane                *pla
 
 gboolean meta_kms_plane_supports_cursor_hotspot (MetaKmsPlane *plane);
 
+gboolean meta_kms_plane_get_zpos (MetaKmsPlane *plane,
+                                  uint64_t     *zpos);
+
 GArray * meta_kms_plane_get_modifiers_for_format (MetaKmsPlane *plane,
                                                   uint32_t      format);
 
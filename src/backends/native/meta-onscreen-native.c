@@ -71,6 +71,11 @@
  */
 #define MAX_SECONDARY_GPU_BUFFER_AGE 2
 
+/*
+ * The number of dumb buffers used for CPU copies to secondary GPUs.
+ */
+#define N_SECONDARY_GPU_DUMB_BUFFERS 3
+
 typedef enum _MetaSharedFramebufferImportStatus
 {
   /* Not tried importing yet. */
@@ -93,7 +98,13 @@ typedef struct _MetaOnscreenNativeSecondaryGpuState
 
   struct {
     MetaDrmBufferDumb *current_dumb_fb;
-    MetaDrmBufferDumb *dumb_fbs[3];
+    MetaDrmBufferDumb *dumb_fbs[N_SECONDARY_GPU_DUMB_BUFFERS];
+
+    /* The damage of the frame last copied into the dumb buffer with the
+     * same index, and whether that buffer is known to have been fully
+     * repaired by the CPU copy path. */
+    MtkRegion *damage_regions[N_SECONDARY_GPU_DUMB_BUFFERS];
+    gboolean dumb_fb_valid[N_SECONDARY_GPU_DUMB_BUFFERS];
   } cpu;
 
   MtkRegion *damage_regions[MAX_SECONDARY_GPU_BUFFER_AGE];
@@ -141,6 +152,15 @@ struct _MetaOnscreenNative
   ClutterFrame *next_frame;
   GSource *next_frame_ready_source;
 
+  /* Client buffer to place on the CRTC's overlay plane on top of the next
+   * composited frame, and the state needed to take it down again. The
+   * presented overlay buffer is kept alive for the same reasons as
+   * presented_buffer.
+   */
+  CoglScanout *next_overlay;
+  MetaKmsPlane *active_overlay_plane;
+  MetaDrmBuffer *presented_overlay_buffer;
+
   struct {
     struct gbm_surface *surface;
 
@@ -456,6 +476,8 @@ notify_crtc_presented (MetaKmsCrtc      *kms_crtc,
   MetaOnscreenNative *onscreen_native = META_ONSCREEN_NATIVE (onscreen);
   MetaFrameNative *frame_native = meta_frame_native_from_frame (frame);
   MetaDrmBuffer *buffer = meta_frame_native_get_buffer (frame_native);
+  CoglScanout *overlay_scanout =
+    meta_frame_native_get_overlay_scanout (frame_native);
   MetaCrtc *crtc;
   int64_t frame_counter;
 
@@ -490,7 +512,22 @@ notify_crtc_presented (MetaKmsCrtc      *kms_crtc,
   notify_frame_info_complete (frame_info);
 
   if (buffer)
-    g_set_object (&onscreen_native->presented_buffer, buffer);
+    {
+      g_set_object (&onscreen_native->presented_buffer, buffer);
+
+      if (overlay_scanout)
+        {
+          CoglScanoutBuffer *overlay_buffer =
+            cogl_scanout_get_buffer (overlay_scanout);
+
+          g_set_object (&onscreen_native->presented_overlay_buffer,
+                        META_DRM_BUFFER (overlay_buffer));
+        }
+      else
+        {
+          g_clear_object (&onscreen_native->presented_overlay_buffer);
+        }
+    }
 
   meta_onscreen_native_clear_posted_fb (onscreen);
 }
@@ -684,17 +721,17 @@ apply_color_range (MetaKmsPlaneAssignment *kms_plane_assignment,
 }
 
 static MetaKmsPlaneAssignment *
-assign_primary_plane (MetaCrtcKms            *crtc_kms,
-                      MetaDrmBuffer          *buffer,
-                      MetaKmsUpdate          *kms_update,
-                      MetaKmsAssignPlaneFlag  flags,
-                      const graphene_rect_t  *src_rect,
-                      const MtkRectangle     *dst_rect)
+assign_plane (MetaCrtcKms            *crtc_kms,
+              MetaKmsPlane           *kms_plane,
+              MetaDrmBuffer          *buffer,
+              MetaKmsUpdate          *kms_update,
+              MetaKmsAssignPlaneFlag  flags,
+              const graphene_rect_t  *src_rect,
+              const MtkRectangle     *dst_rect)
 {
   MetaCrtc *crtc = META_CRTC (crtc_kms);
   MetaFixed16Rectangle src_rect_fixed16;
   MetaKmsCrtc *kms_crtc;
-  MetaKmsPlane *primary_kms_plane;
   MetaKmsPlaneAssignment *plane_assignment;
 
   src_rect_fixed16 = (MetaFixed16Rectangle) {
@@ -705,29 +742,102 @@ assign_primary_plane (MetaCrtcKms            *crtc_kms,
   };
 
   meta_topic (META_DEBUG_KMS,
-              "Assigning buffer to primary plane update on CRTC "
+              "Assigning buffer to %s plane update on CRTC "
               "(%" G_GUINT64_FORMAT ") with src rect %f,%f %fx%f "
               "and dst rect %d,%d %dx%d",
+              meta_kms_plane_type_to_string (meta_kms_plane_get_plane_type (kms_plane)),
               meta_crtc_get_id (crtc), src_rect->origin.x, src_rect->origin.y,
               src_rect->size.width, src_rect->size.height,
               dst_rect->x, dst_rect->y, dst_rect->width, dst_rect->height);
 
   kms_crtc = meta_crtc_kms_get_kms_crtc (crtc_kms);
-  primary_kms_plane = meta_crtc_kms_get_assigned_primary_plane (crtc_kms);
   plane_assignment = meta_kms_update_assign_plane (kms_update,
                                                    kms_crtc,
-                                                   primary_kms_plane,
+                                                   kms_plane,
                                                    buffer,
                                                    src_rect_fixed16,
                                                    *dst_rect,
                                                    flags);
-  apply_transform (crtc_kms, plane_assignment, primary_kms_plane);
-  apply_color_encoding (plane_assignment, primary_kms_plane);
-  apply_color_range (plane_assignment, primary_kms_plane);
+  apply_transform (crtc_kms, plane_assignment, kms_plane);
+  apply_color_encoding (plane_assignment, kms_plane);
+  apply_color_range (plane_assignment, kms_plane);
 
   return plane_assignment;
 }
 
+static MetaKmsPlaneAssignment *
+assign_primary_plane (MetaCrtcKms            *crtc_kms,
+                      MetaDrmBuffer          *buffer,
+                      MetaKmsUpdate          *kms_update,
+                      MetaKmsAssignPlaneFlag  flags,
+                      const graphene_rect_t  *src_rect,
+                      const MtkRectangle     *dst_rect)
+{
+  MetaKmsPlane *primary_kms_plane =
+    meta_crtc_kms_get_assigned_primary_plane (crtc_kms);
+
+  return assign_plane (crtc_kms, primary_kms_plane, buffer, kms_update,
+                       flags, src_rect, dst_rect);
+}
+
+static MetaKmsPlaneAssignment *
+assign_overlay_plane (MetaCrtcKms   *crtc_kms,
+                      CoglScanout   *scanout,
+                      MetaKmsUpdate *kms_update)
+{
+  MetaKmsPlane *overlay_kms_plane =
+    meta_crtc_kms_get_assigned_overlay_plane (crtc_kms);
+  MetaDrmBuffer *buffer;
+  graphene_rect_t src_rect;
+  MtkRectangle dst_rect;
+
+  buffer = META_DRM_BUFFER (cogl_scanout_get_buffer (scanout));
+  cogl_scanout_get_src_rect (scanout, &src_rect);
+  cogl_scanout_get_dst_rect (scanout, &dst_rect);
+
+  return assign_plane (crtc_kms, overlay_kms_plane, buffer, kms_update,
+                       META_KMS_ASSIGN_PLANE_FLAG_DISABLE_IMPLICIT_SYNC,
+                       &src_rect, &dst_rect);
+}
+
+static void
+update_overlay_plane (MetaOnscreenNative *onscreen_native,
+                      MetaCrtcKms        *crtc_kms,
+                      MetaFrameNative    *frame_native,
+                      MetaKmsUpdate      *kms_update)
+{
+  MetaKmsCrtc *kms_crtc = meta_crtc_kms_get_kms_crtc (crtc_kms);
+  MetaKmsPlane *overlay_kms_plane =
+    meta_crtc_kms_get_assigned_overlay_plane (crtc_kms);
+  CoglScanout *overlay_scanout;
+
+  overlay_scanout = meta_frame_native_get_overlay_scanout (frame_native);
+  if (overlay_scanout && overlay_kms_plane)
+    {
+      assign_overlay_plane (crtc_kms, overlay_scanout, kms_update);
+      onscreen_native->active_overlay_plane = overlay_kms_plane;
+      return;
+    }
+
+  meta_frame_native_set_overlay_scanout (frame_native, NULL);
+
+  if (!onscreen_native->active_overlay_plane)
+    return;
+
+  /* A mode set in between disables all planes, and may have handed the
+   * plane to another CRTC, in which case there is nothing to take down. */
+  if (onscreen_native->active_overlay_plane == overlay_kms_plane)
+    {
+      meta_topic (META_DEBUG_KMS,
+                  "Unassigning overlay plane %u from CRTC %u",
+                  meta_kms_plane_get_id (overlay_kms_plane),
+                  meta_kms_crtc_get_id (kms_crtc));
+      meta_kms_update_unassign_plane (kms_update, kms_crtc, overlay_kms_plane);
+    }
+
+  onscreen_native->active_overlay_plane = NULL;
+}
+
 static gboolean
 meta_onscreen_native_flip_crtc (CoglOnscreen           *onscreen,
                                 ClutterFrame           *frame,
@@ -804,6 +914,11 @@ meta_onscreen_native_flip_crtc (CoglOnscreen           *onscreen,
 
       if (region && !mtk_region_is_empty (region))
         meta_kms_plane_assignment_set_fb_damage (plane_assignment, region);
+
+      update_overlay_plane (onscreen_native, crtc_kms, frame_native,
+                            kms_update);
+      meta_crtc_kms_notify_plane_frame (crtc_kms,
+                                        !!onscreen_native->active_overlay_plane);
       break;
     case META_RENDERER_NATIVE_MODE_SURFACELESS:
       g_assert_not_reached ();
@@ -967,7 +1082,12 @@ secondary_gpu_release_dumb (MetaOnscreenNativeSecondaryGpuState *secondary_gpu_s
   unsigned i;
 
   for (i = 0; i < G_N_ELEMENTS (secondary_gpu_state->cpu.dumb_fbs); i++)
-    g_clear_object (&secondary_gpu_state->cpu.dumb_fbs[i]);
+    {
+      g_clear_object (&secondary_gpu_state->cpu.dumb_fbs[i]);
+      g_clear_pointer (&secondary_gpu_state->cpu.damage_regions[i],
+                       mtk_region_unref);
+      secondary_gpu_state->cpu.dumb_fb_valid[i] = FALSE;
+    }
 }
 
 static void
@@ -1253,8 +1373,8 @@ done:
   return dst_buffer_gbm ? META_DRM_BUFFER (dst_buffer_gbm) : NULL;
 }
 
-static MetaDrmBufferDumb *
-secondary_gpu_get_next_dumb_buffer (MetaOnscreenNativeSecondaryGpuState *secondary_gpu_state)
+static int
+secondary_gpu_get_next_dumb_buffer_index (MetaOnscreenNativeSecondaryGpuState *secondary_gpu_state)
 {
   MetaDrmBufferDumb *current_dumb_fb;
   const int n_dumb_fbs = G_N_ELEMENTS (secondary_gpu_state->cpu.dumb_fbs);
@@ -1264,10 +1384,91 @@ secondary_gpu_get_next_dumb_buffer (MetaOnscreenNativeSecondaryGpuState *seconda
   for (i = 0; i < n_dumb_fbs; i++)
     {
       if (current_dumb_fb == secondary_gpu_state->cpu.dumb_fbs[i])
-        return secondary_gpu_state->cpu.dumb_fbs[(i + 1) % n_dumb_fbs];
+        return (i + 1) % n_dumb_fbs;
+    }
+
+  return 0;
+}
+
+static MetaDrmBufferDumb *
+secondary_gpu_get_next_dumb_buffer (MetaOnscreenNativeSecondaryGpuState *secondary_gpu_state)
+{
+  int index;
+
+  index = secondary_gpu_get_next_dumb_buffer_index (secondary_gpu_state);
+  return secondary_gpu_state->cpu.dumb_fbs[index];
+}
+
+static void
+push_secondary_gpu_cpu_damage (MetaOnscreenNativeSecondaryGpuState *secondary_gpu_state,
+                               int                                  dumb_fb_index,
+                               const MtkRegion                     *region,
+                               int                                  width,
+                               int                                  height)
+{
+  MtkRegion **damage_region =
+    &secondary_gpu_state->cpu.damage_regions[dumb_fb_index];
+
+  g_clear_pointer (damage_region, mtk_region_unref);
+  if (region && mtk_region_num_rectangles (region) > 0)
+    {
+      *damage_region = mtk_region_copy (region);
+    }
+  else
+    {
+      *damage_region =
+        mtk_region_create_rectangle (&MTK_RECTANGLE_INIT (0, 0,
+                                                          width, height));
+    }
+}
+
+static void
+invalidate_secondary_gpu_cpu_damage (MetaOnscreenNativeSecondaryGpuState *secondary_gpu_state)
+{
+  unsigned int i;
+
+  for (i = 0; i < G_N_ELEMENTS (secondary_gpu_state->cpu.dumb_fbs); i++)
+    secondary_gpu_state->cpu.dumb_fb_valid[i] = FALSE;
+}
+
+/*
+ * The dumb buffers are used strictly in turn, so what is stale in the dumb
+ * buffer about to be copied into is the damage of the frames that went into
+ * the other dumb buffers since, plus the damage of the current frame, which
+ * is expected to have been pushed already.
+ */
+static MtkRegion *
+build_secondary_gpu_cpu_damage_region (MetaOnscreenNativeSecondaryGpuState *secondary_gpu_state,
+                                       int                                  dumb_fb_index,
+                                       int                                  width,
+                                       int                                  height)
+{
+  const int n_dumb_fbs = G_N_ELEMENTS (secondary_gpu_state->cpu.dumb_fbs);
+  MtkRegion **damage_regions = secondary_gpu_state->cpu.damage_regions;
+  g_autoptr (MtkRegion) region = NULL;
+  int i;
+
+  if (!secondary_gpu_state->cpu.dumb_fb_valid[dumb_fb_index])
+    goto full_damage;
+
+  region = mtk_region_create ();
+
+  for (i = 0; i < n_dumb_fbs; i++)
+    {
+      if (!damage_regions[i])
+        goto full_damage;
+
+      mtk_region_union (region, damage_regions[i]);
     }
 
-  return secondary_gpu_state->cpu.dumb_fbs[0];
+  if (mtk_region_num_rectangles (region) > MAX_DAMAGE_RECTANGLES)
+    goto full_damage;
+
+  return g_steal_pointer (&region);
+
+full_damage:
+  return mtk_region_create_rectangle (&MTK_RECTANGLE_INIT (0, 0,
+                                                           width, height));
 }
 
 static MetaDrmBuffer *
@@ -1295,6 +1496,7 @@ copy_shared_framebuffer_primary_gpu (CoglOnscreen                        *onscre
   uint32_t drm_format;
   uint64_t modifier;
   int n_rectangles;
+  int dumb_fb_index;
 
   COGL_TRACE_BEGIN_SCOPED (CopySharedFramebufferPrimaryGpu,
                            "copy_shared_framebuffer_primary_gpu()");
@@ -1358,6 +1560,14 @@ copy_shared_framebuffer_primary_gpu (CoglOnscreen                        *onscre
       return NULL;
     }
 
+  /* Only the current damage is blitted, so the dumb buffer can't be used as
+   * a base for damage tracking by the CPU copy path.
+   */
+  dumb_fb_index = secondary_gpu_get_next_dumb_buffer_index (secondary_gpu_state);
+  push_secondary_gpu_cpu_damage (secondary_gpu_state, dumb_fb_index, region,
+                                 width, height);
+  secondary_gpu_state->cpu.dumb_fb_valid[dumb_fb_index] = FALSE;
+
   n_rectangles = mtk_region_num_rectangles (region);
   if (((n_rectangles == 0 || n_rectangles > MAX_DAMAGE_RECTANGLES) &&
        !cogl_framebuffer_blit (framebuffer,
@@ -1382,7 +1592,8 @@ copy_shared_framebuffer_primary_gpu (CoglOnscreen                        *onscre
 static MetaDrmBuffer *
 copy_shared_framebuffer_cpu (CoglOnscreen                        *onscreen,
                              MetaOnscreenNativeSecondaryGpuState *secondary_gpu_state,
-                             MetaRendererNativeGpuData           *renderer_gpu_data)
+                             MetaRendererNativeGpuData           *renderer_gpu_data,
+                             const MtkRegion                     *region)
 {
   CoglFramebuffer *framebuffer = COGL_FRAMEBUFFER (onscreen);
   CoglContext *cogl_context = cogl_framebuffer_get_context (framebuffer);
@@ -1390,15 +1601,25 @@ copy_shared_framebuffer_cpu (CoglOnscreen                        *onscreen,
   MetaDrmBuffer *buffer;
   int width, height, stride;
   uint32_t drm_format;
-  void *buffer_data;
-  CoglBitmap *dumb_bitmap;
+  uint8_t *buffer_data;
   CoglPixelFormat cogl_format;
   const MetaFormatInfo *format_info;
+  g_autoptr (MtkRegion) copy_region = NULL;
+  int dumb_fb_index;
+  int bpp;
+  int64_t n_bytes = 0;
+  gboolean succeeded = TRUE;
+  int i, n_rectangles;
 
   COGL_TRACE_BEGIN_SCOPED (CopySharedFramebufferCpu,
                            "copy_shared_framebuffer_cpu()");
+  COGL_TRACE_DEFINE_COUNTER_INT (CopySharedFramebufferCpuBytes,
+                                 "SecondaryGpuCpuCopyBytes",
+                                 "the number of bytes read back for a "
+                                 "secondary GPU output");
 
-  buffer_dumb = secondary_gpu_get_next_dumb_buffer (secondary_gpu_state);
+  dumb_fb_index = secondary_gpu_get_next_dumb_buffer_index (secondary_gpu_state);
+  buffer_dumb = secondary_gpu_state->cpu.dumb_fbs[dumb_fb_index];
   buffer = META_DRM_BUFFER (buffer_dumb);
 
   width = meta_drm_buffer_get_width (buffer);
@@ -1413,25 +1634,55 @@ copy_shared_framebuffer_cpu (CoglOnscreen                        *onscreen,
   format_info = meta_format_info_from_drm_format (drm_format);
   g_assert (format_info);
   cogl_format = format_info->cogl_format;
+  bpp = cogl_pixel_format_get_bytes_per_pixel (cogl_format, 0);
 
-  dumb_bitmap = cogl_bitmap_new_for_data (cogl_context,
-                                          width,
-                                          height,
-                                          cogl_format,
-                                          stride,
-                                          buffer_data);
-
-  if (!cogl_framebuffer_read_pixels_into_bitmap (framebuffer,
-                                                 0 /* x */,
-                                                 0 /* y */,
-                                                 COGL_READ_PIXELS_COLOR_BUFFER,
-                                                 dumb_bitmap))
-    g_warning ("Failed to CPU-copy to a secondary GPU output");
+  push_secondary_gpu_cpu_damage (secondary_gpu_state, dumb_fb_index, region,
+                                 width, height);
+  copy_region = build_secondary_gpu_cpu_damage_region (secondary_gpu_state,
+                                                       dumb_fb_index,
+                                                       width, height);
+
+  n_rectangles = mtk_region_num_rectangles (copy_region);
+  for (i = 0; i < n_rectangles; i++)
+    {
+      MtkRectangle rect = mtk_region_get_rectangle (copy_region, i);
+      g_autoptr (CoglBitmap) dumb_bitmap = NULL;
+
+      if (!mtk_rectangle_intersect (&rect,
+                                    &MTK_RECTANGLE_INIT (0, 0, width, height),
+                                    &rect))
+        continue;
+
+      dumb_bitmap = cogl_bitmap_new_for_data (cogl_context,
+                                              rect.width,
+                                              rect.height,
+                                              cogl_format,
+                                              stride,
+                                              buffer_data +
+                                              rect.y * stride +
+                                              rect.x * bpp);
+
+      if (!cogl_framebuffer_read_pixels_into_bitmap (framebuffer,
+                                                     rect.x,
+                                                     rect.y,
+                                                     COGL_READ_PIXELS_COLOR_BUFFER,
+                                                     dumb_bitmap))
+        {
+          succeeded = FALSE;
+          break;
+        }
 
-  g_object_unref (dumb_bitmap);
+      n_bytes += (int64_t) rect.width * rect.height * bpp;
+    }
 
+  if (!succeeded)
+    g_warning ("Failed to CPU-copy to a secondary GPU output");
+
+  secondary_gpu_state->cpu.dumb_fb_valid[dumb_fb_index] = succeeded;
   secondary_gpu_state->cpu.current_dumb_fb = buffer_dumb;
 
+  COGL_TRACE_SET_COUNTER_INT (CopySharedFramebufferCpuBytes, n_bytes);
+
   return g_object_ref (buffer);
 }
 
@@ -1463,7 +1714,10 @@ update_secondary_gpu_state_pre_swap_buffers (CoglOnscreen    *onscreen,
           /* Done after eglSwapBuffers. */
           if (secondary_gpu_state->import_status ==
               META_SHARED_FRAMEBUFFER_IMPORT_STATUS_OK)
-            break;
+            {
+              invalidate_secondary_gpu_cpu_damage (secondary_gpu_state);
+              break;
+            }
           /* prepare fallback */
           G_GNUC_FALLTHROUGH;
         case META_SHARED_FRAMEBUFFER_COPY_MODE_PRIMARY:
@@ -1487,7 +1741,8 @@ update_secondary_gpu_state_pre_swap_buffers (CoglOnscreen    *onscreen,
 
               copy = copy_shared_framebuffer_cpu (onscreen,
                                                   secondary_gpu_state,
-                                                  renderer_gpu_data);
+                                                  renderer_gpu_data,
+                                                  region);
             }
           else if (!secondary_gpu_state->noted_primary_gpu_copy_ok)
             {
@@ -1587,6 +1842,9 @@ swap_buffer_result_feedback (const MetaKmsFeedback *kms_feedback,
   ClutterFrame *frame = user_data;
   CoglFrameInfo *frame_info = clutter_frame_get_cogl_frame_info (frame);
   CoglOnscreen *onscreen = cogl_frame_info_get_onscreen (frame_info);
+  MetaOnscreenNative *onscreen_native = META_ONSCREEN_NATIVE (onscreen);
+  MetaFrameNative *frame_native = meta_frame_native_from_frame (frame);
+  CoglScanout *overlay_scanout;
   const GError *error = NULL;
 
   /*
@@ -1614,6 +1872,20 @@ swap_buffer_result_feedback (const MetaKmsFeedback *kms_feedback,
                         G_IO_ERROR_PERMISSION_DENIED))
     g_warning ("Page flip failed: %s", error->message);
 
+  /* We no longer know whether the overlay plane is lit, so make sure the
+   * next frame not using it takes it down explicitly. */
+  onscreen_native->active_overlay_plane =
+    meta_crtc_kms_get_assigned_overlay_plane (META_CRTC_KMS (onscreen_native->crtc));
+
+  /* The surface was left out of the composited frame; whoever assigned it
+   * to the overlay plane repaints the area it covers. */
+  overlay_scanout = meta_frame_native_get_overlay_scanout (frame_native);
+  if (overlay_scanout &&
+      !g_error_matches (error,
+                        G_IO_ERROR,
+                        G_IO_ERROR_PERMISSION_DENIED))
+    cogl_scanout_notify_failed (overlay_scanout, onscreen);
+
   frame_info->flags |= COGL_FRAME_INFO_FLAG_SYMBOLIC;
   notify_frame_info_complete (frame_info);
 
@@ -1768,6 +2040,10 @@ meta_onscreen_native_swap_buffers_with_damage (CoglOnscreen    *onscreen,
 
   assign_next_frame (onscreen_native, frame);
 
+  meta_frame_native_set_overlay_scanout (frame_native,
+                                         onscreen_native->next_overlay);
+  g_clear_object (&onscreen_native->next_overlay);
+
   secondary_gpu_fb =
     update_secondary_gpu_state_pre_swap_buffers (onscreen, region);
 
@@ -2140,11 +2416,12 @@ post_failed:
   notify_frame_info_complete (frame_info);
 }
 
-gboolean
-meta_onscreen_native_is_buffer_scanout_compatible (CoglOnscreen *onscreen,
-                                                   CoglScanout  *scanout)
+static gboolean
+is_buffer_plane_compatible (MetaOnscreenNative *onscreen_native,
+                            MetaKmsPlane       *kms_plane,
+                            CoglScanout        *scanout,
+                            const char         *description)
 {
-  MetaOnscreenNative *onscreen_native = META_ONSCREEN_NATIVE (onscreen);
   MetaCrtc *crtc = onscreen_native->crtc;
   MetaCrtcKms *crtc_kms = META_CRTC_KMS (crtc);
   MetaGpuKms *gpu_kms;
@@ -2153,7 +2430,7 @@ meta_onscreen_native_is_buffer_scanout_compatible (CoglOnscreen *onscreen,
   MetaKmsUpdate *test_update;
   MetaDrmBuffer *buffer;
   g_autoptr (MetaKmsFeedback) kms_feedback = NULL;
-  MetaKmsFeedbackResult result;
+  gboolean passed;
   graphene_rect_t src_rect;
   MtkRectangle dst_rect;
 
@@ -2161,21 +2438,35 @@ meta_onscreen_native_is_buffer_scanout_compatible (CoglOnscreen *onscreen,
   kms_device = meta_gpu_kms_get_kms_device (gpu_kms);
   kms_crtc = meta_crtc_kms_get_kms_crtc (crtc_kms);
 
-  test_update = meta_kms_update_new (kms_device);
-
+  buffer = META_DRM_BUFFER (cogl_scanout_get_buffer (scanout));
   cogl_scanout_get_src_rect (scanout, &src_rect);
   cogl_scanout_get_dst_rect (scanout, &dst_rect);
 
-  buffer = META_DRM_BUFFER (cogl_scanout_get_buffer (scanout));
-  assign_primary_plane (crtc_kms,
-                        buffer,
-                        test_update,
-                        META_KMS_ASSIGN_PLANE_FLAG_DISABLE_IMPLICIT_SYNC,
-                        &src_rect,
-                        &dst_rect);
+  if (meta_crtc_kms_lookup_plane_test (crtc_kms, kms_plane, buffer,
+                                       &src_rect, &dst_rect,
+                                       &passed))
+    {
+      meta_topic (META_DEBUG_KMS,
+                  "Using cached %s test result for CRTC %u (%s): %s",
+                  description,
+                  meta_kms_crtc_get_id (kms_crtc),
+                  meta_kms_device_get_path (kms_device),
+                  passed ? "passed" : "failed");
+      return passed;
+    }
+
+  test_update = meta_kms_update_new (kms_device);
+  assign_plane (crtc_kms,
+                kms_plane,
+                buffer,
+                test_update,
+                META_KMS_ASSIGN_PLANE_FLAG_DISABLE_IMPLICIT_SYNC,
+                &src_rect,
+                &dst_rect);
 
   meta_topic (META_DEBUG_KMS,
-              "Posting direct scanout test update for CRTC %u (%s) synchronously",
+              "Posting %s test update for CRTC %u (%s) synchronously",
+              description,
               meta_kms_crtc_get_id (kms_crtc),
               meta_kms_device_get_path (kms_device));
 
@@ -2183,8 +2474,53 @@ meta_onscreen_native_is_buffer_scanout_compatible (CoglOnscreen *onscreen,
     meta_kms_device_process_update_sync (kms_device, test_update,
                                          META_KMS_UPDATE_FLAG_TEST_ONLY);
 
-  result = meta_kms_feedback_get_result (kms_feedback);
-  return result == META_KMS_FEEDBACK_PASSED;
+  passed = meta_kms_feedback_get_result (kms_feedback) ==
+           META_KMS_FEEDBACK_PASSED;
+  meta_crtc_kms_store_plane_test (crtc_kms, kms_plane, buffer,
+                                  &src_rect, &dst_rect,
+                                  passed);
+
+  return passed;
+}
+
+gboolean
+meta_onscreen_native_is_buffer_scanout_compatible (CoglOnscreen *onscreen,
+                                                   CoglScanout  *scanout)
+{
+  MetaOnscreenNative *onscreen_native = META_ONSCREEN_NATIVE (onscreen);
+  MetaCrtcKms *crtc_kms = META_CRTC_KMS (onscreen_native->crtc);
+
+  return is_buffer_plane_compatible (onscreen_native,
+                                     meta_crtc_kms_get_assigned_primary_plane (crtc_kms),
+                                     scanout,
+                                     "direct scanout");
+}
+
+gboolean
+meta_onscreen_native_is_buffer_overlay_compatible (CoglOnscreen *onscreen,
+                                                   CoglScanout  *scanout)
+{
+  MetaOnscreenNative *onscreen_native = META_ONSCREEN_NATIVE (onscreen);
+  MetaCrtcKms *crtc_kms = META_CRTC_KMS (onscreen_native->crtc);
+  MetaKmsPlane *overlay_plane;
+
+  overlay_plane = meta_crtc_kms_get_assigned_overlay_plane (crtc_kms);
+  if (!overlay_plane)
+    return FALSE;
+
+  return is_buffer_plane_compatible (onscreen_native,
+                                     overlay_plane,
+                                     scanout,
+                                     "overlay plane");
+}
+
+void
+meta_onscreen_native_set_next_overlay (CoglOnscreen *onscreen,
+                                       CoglScanout  *scanout)
+{
+  MetaOnscreenNative *onscreen_native = META_ONSCREEN_NATIVE (onscreen);
+
+  g_set_object (&onscreen_native->next_overlay, scanout);
 }
 
 gboolean
@@ -2266,6 +2602,8 @@ meta_onscreen_native_direct_scanout (CoglOnscreen   *onscreen,
 
   assign_next_frame (onscreen_native, frame);
 
+  g_clear_object (&onscreen_native->next_overlay);
+
   meta_frame_native_set_scanout (frame_native, scanout);
   meta_frame_native_set_buffer (frame_native,
                                 META_DRM_BUFFER (cogl_scanout_get_buffer (scanout)));
@@ -3844,6 +4182,8 @@ meta_onscreen_native_dispose (GObject *object)
   meta_onscreen_native_discard_pending_swaps (onscreen);
   g_clear_pointer (&onscreen_native->posted_frame, clutter_frame_unref);
   g_clear_object (&onscreen_native->presented_buffer);
+  g_clear_object (&onscreen_native->next_overlay);
+  g_clear_object (&onscreen_native->presented_overlay_buffer);
 
   renderer_gpu_data =
     meta_renderer_native_get_gpu_data (renderer_native,
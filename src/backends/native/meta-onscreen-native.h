@@ -46,6 +46,12 @@ void meta_onscreen_native_dummy_power_save_page_flip (CoglOnscreen *onscreen);
 gboolean meta_onscreen_native_is_buffer_scanout_compatible (CoglOnscreen *onscreen,
                                                             CoglScanout  *scanout);
 
+gboolean meta_onscreen_native_is_buffer_overlay_compatible (CoglOnscreen *onscreen,
+                                                            CoglScanout  *scanout);
+
+void meta_onscreen_native_set_next_overlay (CoglOnscreen *onscreen,
+                                            CoglScanout  *scanout);
+
 gboolean meta_onscreen_native_supports_direct_scanout (CoglOnscreen *onscreen);
 
 void meta_onscreen_native_discard_pending_swaps (CoglOnscreen *onscreen);
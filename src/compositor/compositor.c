@@ -58,6 +58,7 @@
 #include "cogl/cogl.h"
 #include "compositor/meta-cullable.h"
 #include "compositor/meta-later-private.h"
+#include "compositor/meta-shaped-texture-private.h"
 #include "compositor/meta-window-actor-private.h"
 #include "compositor/meta-window-actor-wayland.h"
 #include "compositor/meta-window-group-private.h"
@@ -135,6 +136,7 @@ typedef struct _MetaCompositorPrivate
   MetaWindowDrag *current_drag;
 
   MetaLaters *laters;
+  unsigned int precompile_pipelines_later_id;
 
   float background_blur_radius;
   float background_saturation;
@@ -882,6 +884,53 @@ maybe_update_top_window_actor_for_views (MetaCompositor *compositor)
     }
 }
 
+static gboolean
+precompile_pipelines_idle (gpointer user_data)
+{
+  MetaCompositor *compositor = META_COMPOSITOR (user_data);
+  MetaCompositorPrivate *priv =
+    meta_compositor_get_instance_private (compositor);
+  ClutterContext *clutter_context =
+    meta_backend_get_clutter_context (priv->backend);
+  ClutterStage *stage =
+    CLUTTER_STAGE (meta_backend_get_stage (priv->backend));
+  ClutterColorState *color_state;
+  GList *l;
+
+  priv->precompile_pipelines_later_id = 0;
+
+  /* Most clients don't specify a color state, so their content is in the
+   * default one; build the programs needed to paint such windows on each
+   * view now rather than in the first frame that shows one */
+  color_state = clutter_context_get_default_color_state (clutter_context);
+
+  for (l = clutter_stage_peek_stage_views (stage); l; l = l->next)
+    {
+      ClutterStageView *stage_view = l->data;
+
+      meta_shaped_texture_precompile_pipelines (clutter_context,
+                                                stage_view,
+                                                color_state);
+    }
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+queue_precompile_pipelines (MetaCompositor *compositor)
+{
+  MetaCompositorPrivate *priv =
+    meta_compositor_get_instance_private (compositor);
+
+  if (priv->precompile_pipelines_later_id)
+    return;
+
+  priv->precompile_pipelines_later_id =
+    meta_laters_add (priv->laters, META_LATER_IDLE,
+                     precompile_pipelines_idle,
+                     compositor, NULL);
+}
+
 static void
 meta_compositor_ensure_compositor_views (MetaCompositor *compositor)
 {
@@ -909,7 +958,14 @@ meta_compositor_ensure_compositor_views (MetaCompositor *compositor)
                                quark_compositor_view,
                                compositor_view,
                                g_object_unref);
+
+      g_signal_connect_object (stage_view, "notify::color-state",
+                               G_CALLBACK (queue_precompile_pipelines),
+                               compositor,
+                               G_CONNECT_SWAPPED);
     }
+
+  queue_precompile_pipelines (compositor);
 }
 
 static void
@@ -949,8 +1005,11 @@ meta_compositor_real_before_paint (MetaCompositor     *compositor,
   ClutterStageView *stage_view;
   MtkRectangle stage_rect;
   MtkRegion *unobscured_region;
+  int64_t start_time_us;
   GList *l;
 
+  start_time_us = g_get_monotonic_time ();
+
   stage_rect = (MtkRectangle) {
     0, 0,
     (int) clutter_actor_get_width (stage),
@@ -969,6 +1028,9 @@ meta_compositor_real_before_paint (MetaCompositor     *compositor,
   meta_cullable_cull_unobscured (META_CULLABLE (priv->feedback_group), unobscured_region);
   mtk_region_unref (unobscured_region);
 
+  clutter_frame_add_phase_time (frame, CLUTTER_FRAME_PHASE_CULL,
+                                g_get_monotonic_time () - start_time_us);
+
   stage_view = meta_compositor_view_get_stage_view (compositor_view);
 
   for (l = priv->windows; l; l = l->next)
@@ -31,12 +31,15 @@
 
 typedef struct _MetaEdgeResistanceData MetaEdgeResistanceData;
 
+/* The edges are stored by value, the vertical ones (LEFT and RIGHT) sorted
+ * by x and the horizontal ones (TOP and BOTTOM) sorted by y, so that each
+ * motion of a drag only needs to look at the edges near the position of
+ * the window, found with a binary search.
+ */
 struct _MetaEdgeResistanceData
 {
-  GArray *left_edges;
-  GArray *right_edges;
-  GArray *top_edges;
-  GArray *bottom_edges;
+  GArray *vertical_edges;
+  GArray *horizontal_edges;
 };
 
 static GQuark edge_resistance_data_quark = 0;
@@ -64,6 +67,40 @@ is_window_relevant_for_edges (MetaWindow *window)
     }
 }
 
+static inline int
+get_edge_position (const GArray *edges,
+                   int           index,
+                   gboolean      horizontal)
+{
+  const MetaEdge *edge = &g_array_index (edges, MetaEdge, index);
+
+  return horizontal ? edge->rect.x : edge->rect.y;
+}
+
+/* Returns the index of the first edge at or after position, which is
+ * edges->len if there is none.
+ */
+static int
+find_first_edge_at_or_after (const GArray *edges,
+                             int           position,
+                             gboolean      horizontal)
+{
+  int low = 0;
+  int high = edges->len;
+
+  while (low < high)
+    {
+      int mid = low + (high - low) / 2;
+
+      if (get_edge_position (edges, mid, horizontal) < position)
+        low = mid + 1;
+      else
+        high = mid;
+    }
+
+  return low;
+}
+
 /* !WARNING!: this function can return invalid indices (namely, either -1 or
  * edges->len); this is by design, but you need to remember this.
  */
@@ -73,8 +110,8 @@ find_index_of_edge_near_position (const GArray *edges,
                                   gboolean      want_interval_min,
                                   gboolean      horizontal)
 {
-  /* This is basically like a binary search, except that we're trying to
-   * find a range instead of an exact value.  So, if we have in our array
+  /* We're trying to find a range instead of an exact value.  So, if we
+   * have in our array
    *   Value: 3  27 316 316 316 505 522 800 1213
    *   Index: 0   1   2   3   4   5   6   7    8
    * and we call this function with position=500 & want_interval_min=TRUE
@@ -88,86 +125,10 @@ find_index_of_edge_near_position (const GArray *edges,
    *           2              FALSE              -1
    *        2000               TRUE               9
    */
-  int low, high, mid;
-  int compare;
-  MetaEdge *edge;
-
-  /* Initialize mid, edge, & compare in the off change that the array only
-   * has one element.
-   */
-  mid  = 0;
-  edge = g_array_index (edges, MetaEdge*, mid);
-  compare = horizontal ? edge->rect.x : edge->rect.y;
-
-  /* Begin the search... */
-  low  = 0;
-  high = edges->len - 1;
-  while (low < high)
-    {
-      mid = low + (high - low)/2;
-      edge = g_array_index (edges, MetaEdge*, mid);
-      compare = horizontal ? edge->rect.x : edge->rect.y;
-
-      if (compare == position)
-        break;
-
-      if (compare > position)
-        high = mid - 1;
-      else
-        low = mid + 1;
-    }
-
-  /* mid should now be _really_ close to the index we want, so we start
-   * linearly searching.  However, note that we don't know if mid is less
-   * than or greater than what we need and it's possible that there are
-   * several equal values equal to what we were searching for and we ended
-   * up in the middle of them instead of at the end.  So we may need to
-   * move mid multiple locations over.
-   */
   if (want_interval_min)
-    {
-      while (compare >= position && mid > 0)
-        {
-          mid--;
-          edge = g_array_index (edges, MetaEdge*, mid);
-          compare = horizontal ? edge->rect.x : edge->rect.y;
-        }
-      while (compare < position && mid < (int)edges->len - 1)
-        {
-          mid++;
-          edge = g_array_index (edges, MetaEdge*, mid);
-          compare = horizontal ? edge->rect.x : edge->rect.y;
-        }
-
-      /* Special case for no values in array big enough */
-      if (compare < position)
-        return edges->len;
-
-      /* Return the found value */
-      return mid;
-    }
+    return find_first_edge_at_or_after (edges, position, horizontal);
   else
-    {
-      while (compare <= position && mid < (int)edges->len - 1)
-        {
-          mid++;
-          edge = g_array_index (edges, MetaEdge*, mid);
-          compare = horizontal ? edge->rect.x : edge->rect.y;
-        }
-      while (compare > position && mid > 0)
-        {
-          mid--;
-          edge = g_array_index (edges, MetaEdge*, mid);
-          compare = horizontal ? edge->rect.x : edge->rect.y;
-        }
-
-      /* Special case for no values in array small enough */
-      if (compare > position)
-        return -1;
-
-      /* Return the found value */
-      return mid;
-    }
+    return find_first_edge_at_or_after (edges, position + 1, horizontal) - 1;
 }
 
 static gboolean
@@ -189,63 +150,39 @@ find_nearest_position (const GArray       *edges,
    * actual value.  Also, we ignore any edges that aren't relevant
    * given the horizontal/vertical position of new_rect.
    */
-  int low, high, mid;
+  int mid;
   int compare;
-  MetaEdge *edge;
+  const MetaEdge *edge;
   int best, best_dist, i;
   gboolean edges_align;
 
-  /* Initialize mid, edge, & compare in the off change that the array only
-   * has one element.
-   */
-  mid  = 0;
-  edge = g_array_index (edges, MetaEdge*, mid);
-  compare = horizontal ? edge->rect.x : edge->rect.y;
-
-  /* Begin the search... */
-  low  = 0;
-  high = edges->len - 1;
-  while (low < high)
-    {
-      mid = low + (high - low)/2;
-      edge = g_array_index (edges, MetaEdge*, mid);
-      compare = horizontal ? edge->rect.x : edge->rect.y;
-
-      if (compare == position)
-        break;
-
-      if (compare > position)
-        high = mid - 1;
-      else
-        low = mid + 1;
-    }
+  mid = find_first_edge_at_or_after (edges, position, horizontal);
 
-  /* mid should now be _really_ close to the index we want, so we
-   * start searching nearby for something that overlaps and is closer
+  /* We start searching at mid for something that overlaps and is closer
    * than the original position.
    */
   best = old_position;
   best_dist = INT_MAX;
 
   /* Start the search at mid */
-  edge = g_array_index (edges, MetaEdge*, mid);
-  compare = horizontal ? edge->rect.x : edge->rect.y;
-  edges_align = meta_rectangle_edge_aligns (new_rect, edge);
-  if (edges_align &&
-      (!only_forward || !points_on_same_side (position, compare, old_position)))
+  if (mid < (int) edges->len)
     {
-      int dist = ABS (compare - position);
-      if (dist < best_dist)
+      edge = &g_array_index (edges, MetaEdge, mid);
+      compare = horizontal ? edge->rect.x : edge->rect.y;
+      edges_align = meta_rectangle_edge_aligns (new_rect, edge);
+      if (edges_align &&
+          (!only_forward ||
+           !points_on_same_side (position, compare, old_position)))
         {
           best = compare;
-          best_dist = dist;
+          best_dist = ABS (compare - position);
         }
     }
 
   /* Now start searching higher than mid */
   for (i = mid + 1; i < (int)edges->len; i++)
     {
-      edge = g_array_index (edges, MetaEdge*, i);
+      edge = &g_array_index (edges, MetaEdge, i);
       compare = horizontal ? edge->rect.x : edge->rect.y;
 
       edges_align = horizontal ?
@@ -269,7 +206,7 @@ find_nearest_position (const GArray       *edges,
   /* Now start searching lower than mid */
   for (i = mid-1; i >= 0; i--)
     {
-      edge = g_array_index (edges, MetaEdge*, i);
+      edge = &g_array_index (edges, MetaEdge, i);
       compare = horizontal ? edge->rect.x : edge->rect.y;
 
       edges_align = horizontal ?
@@ -355,7 +292,7 @@ apply_edge_resistance (MetaWindow         *window,
          (!increasing && i >= end))
     {
       gboolean  edges_align;
-      MetaEdge *edge = g_array_index (edges, MetaEdge*, i);
+      MetaEdge *edge = &g_array_index (edges, MetaEdge, i);
       int       compare = xdir ? edge->rect.x : edge->rect.y;
 
       /* Find out if this edge is relevant */
@@ -495,28 +432,28 @@ apply_edge_resistance_to_each_side (MetaEdgeResistanceData  *edge_data,
       new_left   = apply_edge_snapping (BOX_LEFT (*old_outer),
                                         BOX_LEFT (*new_outer),
                                         new_outer,
-                                        edge_data->left_edges,
+                                        edge_data->vertical_edges,
                                         TRUE,
                                         keyboard_op);
 
       new_right  = apply_edge_snapping (BOX_RIGHT (*old_outer),
                                         BOX_RIGHT (*new_outer),
                                         new_outer,
-                                        edge_data->right_edges,
+                                        edge_data->vertical_edges,
                                         TRUE,
                                         keyboard_op);
 
       new_top    = apply_edge_snapping (BOX_TOP (*old_outer),
                                         BOX_TOP (*new_outer),
                                         new_outer,
-                                        edge_data->top_edges,
+                                        edge_data->horizontal_edges,
                                         FALSE,
                                         keyboard_op);
 
       new_bottom = apply_edge_snapping (BOX_BOTTOM (*old_outer),
                                         BOX_BOTTOM (*new_outer),
                                         new_outer,
-                                        edge_data->bottom_edges,
+                                        edge_data->horizontal_edges,
                                         FALSE,
                                         keyboard_op);
     }
@@ -580,7 +517,7 @@ apply_edge_resistance_to_each_side (MetaEdgeResistanceData  *edge_data,
                                               BOX_LEFT (*new_outer),
                                               old_outer,
                                               new_outer,
-                                              edge_data->left_edges,
+                                              edge_data->vertical_edges,
                                               TRUE,
                                               include_windows,
                                               keyboard_op);
@@ -589,7 +526,7 @@ apply_edge_resistance_to_each_side (MetaEdgeResistanceData  *edge_data,
                                               BOX_RIGHT (*new_outer),
                                               old_outer,
                                               new_outer,
-                                              edge_data->right_edges,
+                                              edge_data->vertical_edges,
                                               TRUE,
                                               include_windows,
                                               keyboard_op);
@@ -607,7 +544,7 @@ apply_edge_resistance_to_each_side (MetaEdgeResistanceData  *edge_data,
                                               BOX_TOP (*new_outer),
                                               old_outer,
                                               new_outer,
-                                              edge_data->top_edges,
+                                              edge_data->horizontal_edges,
                                               FALSE,
                                               include_windows,
                                               keyboard_op);
@@ -616,7 +553,7 @@ apply_edge_resistance_to_each_side (MetaEdgeResistanceData  *edge_data,
                                               BOX_BOTTOM (*new_outer),
                                               old_outer,
                                               new_outer,
-                                              edge_data->bottom_edges,
+                                              edge_data->horizontal_edges,
                                               FALSE,
                                               include_windows,
                                               keyboard_op);
@@ -641,66 +578,8 @@ apply_edge_resistance_to_each_side (MetaEdgeResistanceData  *edge_data,
 static void
 meta_edge_resistance_data_free (MetaEdgeResistanceData *edge_data)
 {
-  guint i,j;
-  GHashTable *edges_to_be_freed;
-
-  /* We first need to clean out any window edges */
-  edges_to_be_freed = g_hash_table_new_full (g_direct_hash, g_direct_equal,
-                                             g_free, NULL);
-  for (i = 0; i < 4; i++)
-    {
-      GArray *tmp = NULL;
-      MetaSide side;
-      switch (i)
-        {
-        case 0:
-          tmp = edge_data->left_edges;
-          side = META_SIDE_LEFT;
-          break;
-        case 1:
-          tmp = edge_data->right_edges;
-          side = META_SIDE_RIGHT;
-          break;
-        case 2:
-          tmp = edge_data->top_edges;
-          side = META_SIDE_TOP;
-          break;
-        case 3:
-          tmp = edge_data->bottom_edges;
-          side = META_SIDE_BOTTOM;
-          break;
-        default:
-          g_assert_not_reached ();
-        }
-
-      for (j = 0; j < tmp->len; j++)
-        {
-          MetaEdge *edge = g_array_index (tmp, MetaEdge*, j);
-          if (edge->edge_type == META_EDGE_WINDOW &&
-              edge->side_type == side)
-            {
-              /* The same edge will appear in two arrays, and we can't free
-               * it yet we still need to compare edge->side_type for the other
-               * array that it is in.  So store it in a hash table for later
-               * freeing.  Could also do this in a simple linked list.
-               */
-              g_hash_table_insert (edges_to_be_freed, edge, edge);
-            }
-        }
-    }
-
-  /* Now free all the window edges (the key destroy function is g_free) */
-  g_hash_table_destroy (edges_to_be_freed);
-
-  /* Now free the arrays and data */
-  g_array_free (edge_data->left_edges, TRUE);
-  g_array_free (edge_data->right_edges, TRUE);
-  g_array_free (edge_data->top_edges, TRUE);
-  g_array_free (edge_data->bottom_edges, TRUE);
-  edge_data->left_edges = NULL;
-  edge_data->right_edges = NULL;
-  edge_data->top_edges = NULL;
-  edge_data->bottom_edges = NULL;
+  g_array_free (edge_data->vertical_edges, TRUE);
+  g_array_free (edge_data->horizontal_edges, TRUE);
 
   g_free (edge_data);
 }
@@ -714,15 +593,6 @@ meta_window_drag_edge_resistance_cleanup (MetaWindowDrag *window_drag)
   g_object_set_qdata (G_OBJECT (window_drag), edge_resistance_data_quark, NULL);
 }
 
-static int
-stupid_sort_requiring_extra_pointer_dereference (gconstpointer a,
-                                                 gconstpointer b)
-{
-  const MetaEdge * const *a_edge = a;
-  const MetaEdge * const *b_edge = b;
-  return meta_rectangle_edge_cmp_ignore_type (*a_edge, *b_edge);
-}
-
 static MetaEdgeResistanceData *
 cache_edges (MetaDisplay *display,
              GList *window_edges,
@@ -731,7 +601,7 @@ cache_edges (MetaDisplay *display,
 {
   MetaEdgeResistanceData *edge_data;
   GList *tmp;
-  int num_left, num_right, num_top, num_bottom;
+  int num_vertical, num_horizontal;
   int i;
 
   /*
@@ -760,9 +630,9 @@ cache_edges (MetaDisplay *display,
 #endif
 
   /*
-   * 1st: Get the total number of each kind of edge
+   * 1st: Get the total number of each orientation of edge
    */
-  num_left = num_right = num_top = num_bottom = 0;
+  num_vertical = num_horizontal = 0;
   for (i = 0; i < 3; i++)
     {
       tmp = NULL;
@@ -787,16 +657,12 @@ cache_edges (MetaDisplay *display,
           switch (edge->side_type)
             {
             case META_SIDE_LEFT:
-              num_left++;
-              break;
             case META_SIDE_RIGHT:
-              num_right++;
+              num_vertical++;
               break;
             case META_SIDE_TOP:
-              num_top++;
-              break;
             case META_SIDE_BOTTOM:
-              num_bottom++;
+              num_horizontal++;
               break;
             default:
               g_assert_not_reached ();
@@ -809,25 +675,18 @@ cache_edges (MetaDisplay *display,
    * 2nd: Allocate the edges
    */
   edge_data = g_new0 (MetaEdgeResistanceData, 1);
-  edge_data->left_edges   = g_array_sized_new (FALSE,
-                                               FALSE,
-                                               sizeof(MetaEdge*),
-                                               num_left + num_right);
-  edge_data->right_edges  = g_array_sized_new (FALSE,
-                                               FALSE,
-                                               sizeof(MetaEdge*),
-                                               num_left + num_right);
-  edge_data->top_edges    = g_array_sized_new (FALSE,
-                                               FALSE,
-                                               sizeof(MetaEdge*),
-                                               num_top + num_bottom);
-  edge_data->bottom_edges = g_array_sized_new (FALSE,
-                                               FALSE,
-                                               sizeof(MetaEdge*),
-                                               num_top + num_bottom);
+  edge_data->vertical_edges   = g_array_sized_new (FALSE,
+                                                   FALSE,
+                                                   sizeof (MetaEdge),
+                                                   num_vertical);
+  edge_data->horizontal_edges = g_array_sized_new (FALSE,
+                                                   FALSE,
+                                                   sizeof (MetaEdge),
+                                                   num_horizontal);
 
   /*
-   * 3rd: Add the edges to the arrays
+   * 3rd: Copy the edges into the arrays; the workspace edges may be
+   * replaced when the work areas are revalidated during the drag.
    */
   for (i = 0; i < 3; i++)
     {
@@ -854,13 +713,11 @@ cache_edges (MetaDisplay *display,
             {
             case META_SIDE_LEFT:
             case META_SIDE_RIGHT:
-              g_array_append_val (edge_data->left_edges, edge);
-              g_array_append_val (edge_data->right_edges, edge);
+              g_array_append_val (edge_data->vertical_edges, *edge);
               break;
             case META_SIDE_TOP:
             case META_SIDE_BOTTOM:
-              g_array_append_val (edge_data->top_edges, edge);
-              g_array_append_val (edge_data->bottom_edges, edge);
+              g_array_append_val (edge_data->horizontal_edges, *edge);
               break;
             default:
               g_assert_not_reached ();
@@ -870,19 +727,12 @@ cache_edges (MetaDisplay *display,
     }
 
   /*
-   * 4th: Sort the arrays (FIXME: This is kinda dumb since the arrays were
-   * individually sorted earlier and we could have done this faster and
-   * avoided this sort by sticking them into the array with some simple
-   * merging of the lists).
+   * 4th: Sort the arrays
    */
-  g_array_sort (edge_data->left_edges,
-                stupid_sort_requiring_extra_pointer_dereference);
-  g_array_sort (edge_data->right_edges,
-                stupid_sort_requiring_extra_pointer_dereference);
-  g_array_sort (edge_data->top_edges,
-                stupid_sort_requiring_extra_pointer_dereference);
-  g_array_sort (edge_data->bottom_edges,
-                stupid_sort_requiring_extra_pointer_dereference);
+  g_array_sort (edge_data->vertical_edges,
+                meta_rectangle_edge_cmp_ignore_type);
+  g_array_sort (edge_data->horizontal_edges,
+                meta_rectangle_edge_cmp_ignore_type);
 
   return edge_data;
 }
@@ -1052,11 +902,6 @@ compute_resistance_and_snapping_edges (MetaWindowDrag *window_drag)
       stack_position++;
     }
 
-  /* Sort the list.  FIXME: Should I bother with this sorting?  I just
-   * sort again later in cache_edges() anyway...
-   */
-  edges = g_list_sort (edges, meta_rectangle_edge_cmp);
-
   /*
    * 5th: Cache the combination of these edges with the onscreen and
    * monitor edges in an array for quick access.  Free the edges since
@@ -1066,6 +911,7 @@ compute_resistance_and_snapping_edges (MetaWindowDrag *window_drag)
                            edges,
                            active_workspace->monitor_edges,
                            active_workspace->screen_edges);
+  g_list_free_full (g_steal_pointer (&edges), g_free);
 
   return edge_data;
 }
@@ -27,6 +27,7 @@
 
 #include "backends/meta-crtc.h"
 #include "backends/native/meta-crtc-kms.h"
+#include "backends/native/meta-kms-plane.h"
 #include "backends/native/meta-onscreen-native.h"
 #include "clutter/clutter.h"
 #include "compositor/compositor-private.h"
@@ -35,6 +36,10 @@
 #include "core/window-private.h"
 #include "wayland/meta-wayland-surface-private.h"
 
+/* The number of windows from the top of the stack that are considered for
+ * the overlay plane, to bound the work done for each frame */
+#define MAX_OVERLAY_CANDIDATES 4
+
 static void update_fullscreen_actor (MetaCompositorViewNative *view_native,
                                      MetaSurfaceActor         *fullscreen_actor);
 
@@ -42,7 +47,7 @@ typedef struct _MetaCursorOverlapData MetaCursorOverlapData;
 struct _MetaCursorOverlapData
 {
   MetaCompositor *compositor;
-  ClutterStageView *stage_view;
+  graphene_rect_t rect;
   gboolean has_overlap;
 };
 
@@ -54,6 +59,8 @@ struct _MetaCompositorViewNative
 
   MetaSurfaceActor *fullscreen_actor;
 
+  MetaSurfaceActor *overlay_actor;
+
   gulong fullscreen_surface_repaint_scheduled_id;
   gulong fullscreen_surface_update_scheduled_id;
   gulong fullscreen_actor_destroy_id;
@@ -113,17 +120,12 @@ update_scanout_candidate (MetaCompositorViewNative *view_native,
     }
 }
 
-static MetaSurfaceActor *
-find_candidate (MetaCompositorView *compositor_view,
-                MetaCompositor     *compositor,
-                const char         *topic)
+static MetaWindowActor *
+find_top_window_actor (MetaCompositorView *compositor_view,
+                       MetaCompositor     *compositor,
+                       const char         *topic)
 {
-  ClutterStageView *stage_view =
-    meta_compositor_view_get_stage_view (compositor_view);
   MetaWindowActor *window_actor;
-  MetaSurfaceActor *surface_actor;
-  MtkRectangle view_rect;
-  ClutterActorBox actor_box;
 
   if (meta_compositor_is_unredirect_inhibited (compositor))
     {
@@ -159,6 +161,25 @@ find_candidate (MetaCompositorView *compositor_view,
       return NULL;
     }
 
+  return window_actor;
+}
+
+static MetaSurfaceActor *
+find_candidate (MetaCompositorView *compositor_view,
+                MetaCompositor     *compositor,
+                const char         *topic)
+{
+  ClutterStageView *stage_view =
+    meta_compositor_view_get_stage_view (compositor_view);
+  MetaWindowActor *window_actor;
+  MetaSurfaceActor *surface_actor;
+  MtkRectangle view_rect;
+  ClutterActorBox actor_box;
+
+  window_actor = find_top_window_actor (compositor_view, compositor, topic);
+  if (!window_actor)
+    return NULL;
+
   clutter_stage_view_get_layout (stage_view, &view_rect);
 
   if (!clutter_actor_get_paint_box (CLUTTER_ACTOR (window_actor),
@@ -218,8 +239,6 @@ has_overlapping_cursor_overlay_foreach (ClutterStage  *stage,
   MetaBackend *backend = meta_compositor_get_backend (data->compositor);
   MetaCursorRenderer *cursor_renderer;
   ClutterCursor *cursor;
-  MtkRectangle view_rect;
-  graphene_rect_t graphene_view_rect;
   graphene_rect_t cursor_rect;
 
   cursor_renderer = meta_backend_get_cursor_renderer_for_sprite (backend,
@@ -233,25 +252,19 @@ has_overlapping_cursor_overlay_foreach (ClutterStage  *stage,
   cursor_rect = meta_cursor_renderer_calculate_rect (cursor_renderer,
                                                      cursor);
 
-  clutter_stage_view_get_layout (data->stage_view, &view_rect);
-  graphene_view_rect = mtk_rectangle_to_graphene_rect (&view_rect);
-
-  data->has_overlap |= graphene_rect_intersection (&graphene_view_rect,
+  data->has_overlap |= graphene_rect_intersection (&data->rect,
                                                    &cursor_rect,
                                                    NULL);
   return !data->has_overlap;
 }
 
 static gboolean
-surface_actor_has_overlapping_cursor_overlays (MetaCompositor     *compositor,
-                                               MetaCompositorView *compositor_view,
-                                               MetaSurfaceActor   *surface_actor)
+has_overlapping_cursor_overlays (MetaCompositor        *compositor,
+                                 const graphene_rect_t *rect)
 {
   MetaBackend *backend = meta_compositor_get_backend (compositor);
   ClutterStage *stage = CLUTTER_STAGE (meta_backend_get_stage (backend));
-  ClutterStageView *stage_view =
-    meta_compositor_view_get_stage_view (compositor_view);
-  MetaCursorOverlapData data = { compositor, stage_view, FALSE };
+  MetaCursorOverlapData data = { compositor, *rect, FALSE };
 
   clutter_stage_foreach_sprite (stage,
                                 has_overlapping_cursor_overlay_foreach,
@@ -260,6 +273,117 @@ surface_actor_has_overlapping_cursor_overlays (MetaCompositor     *compositor,
   return data.has_overlap;
 }
 
+static gboolean
+get_scanout_onscreen (MetaCompositorView  *compositor_view,
+                      const char          *topic,
+                      MetaCrtc           **crtc_out,
+                      CoglOnscreen       **onscreen_out)
+{
+  ClutterStageView *stage_view =
+    meta_compositor_view_get_stage_view (compositor_view);
+  MetaRendererView *renderer_view = META_RENDERER_VIEW (stage_view);
+  MetaCrtc *crtc;
+  CoglFramebuffer *framebuffer;
+  CoglOnscreen *onscreen;
+
+  crtc = meta_renderer_view_get_crtc (renderer_view);
+  if (!META_IS_CRTC_KMS (crtc))
+    {
+      meta_topic (META_DEBUG_RENDER,
+                  "No %s candidate: no KMS CRTC",
+                  topic);
+      return FALSE;
+    }
+
+  framebuffer = clutter_stage_view_get_onscreen (stage_view);
+  if (!COGL_IS_ONSCREEN (framebuffer))
+    {
+      meta_topic (META_DEBUG_RENDER,
+                  "No %s candidate: no onscreen framebuffer",
+                  topic);
+      return FALSE;
+    }
+
+  onscreen = COGL_ONSCREEN (framebuffer);
+  if (!meta_onscreen_native_supports_direct_scanout (onscreen))
+    {
+      meta_topic (META_DEBUG_RENDER,
+                  "No %s candidate: "
+                  "onscreen framebuffer doesn't support direct scanout",
+                  topic);
+      return FALSE;
+    }
+
+  if (clutter_stage_view_has_shadowfb (stage_view))
+    {
+      meta_topic (META_DEBUG_RENDER,
+                  "No %s candidate: stage-view has shadowfb",
+                  topic);
+      return FALSE;
+    }
+
+  *crtc_out = crtc;
+  *onscreen_out = onscreen;
+
+  return TRUE;
+}
+
+static gboolean
+surface_actor_needs_color_mapping (MetaCompositorView *compositor_view,
+                                   MetaSurfaceActor   *surface_actor,
+                                   const char         *topic)
+{
+  ClutterStageView *stage_view =
+    meta_compositor_view_get_stage_view (compositor_view);
+  ClutterColorState *output_color_state;
+  ClutterColorState *surface_color_state;
+
+  if (meta_get_debug_paint_flags () &
+      META_DEBUG_PAINT_IGNORE_COLOR_STATE_FOR_DIRECT_SCANOUT)
+    return FALSE;
+
+  output_color_state = clutter_stage_view_get_output_color_state (stage_view);
+  surface_color_state =
+    clutter_actor_get_color_state (CLUTTER_ACTOR (surface_actor));
+  if (clutter_color_pipeline_shader_needs_color_state (surface_color_state,
+                                                       output_color_state, 0))
+    {
+      meta_topic (META_DEBUG_RENDER,
+                  "No %s candidate: "
+                  "surface color state (%s) needs mapping to the output's (%s)",
+                  topic,
+                  clutter_color_state_to_string (surface_color_state),
+                  clutter_color_state_to_string (output_color_state));
+      return TRUE;
+    }
+
+  return FALSE;
+}
+
+static gboolean
+surface_has_supported_color_model (MetaWaylandSurface *surface,
+                                   const char         *topic)
+{
+  MetaMultiTextureCoefficients coeffs;
+
+  if (meta_get_debug_paint_flags () &
+      META_DEBUG_PAINT_IGNORE_COLOR_STATE_FOR_DIRECT_SCANOUT)
+    return TRUE;
+
+  coeffs = surface->applied_state.coeffs;
+  if (coeffs != META_MULTI_TEXTURE_COEFFICIENTS_NONE &&
+      coeffs != META_MULTI_TEXTURE_COEFFICIENTS_IDENTITY_FULL &&
+      coeffs != META_MULTI_TEXTURE_COEFFICIENTS_BT709_LIMITED)
+    {
+      meta_topic (META_DEBUG_RENDER,
+                  "No %s candidate: unsupported color model",
+                  topic);
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
 static gboolean
 find_scanout_candidate (MetaCompositorView  *compositor_view,
                         MetaCompositor      *compositor,
@@ -270,9 +394,7 @@ find_scanout_candidate (MetaCompositorView  *compositor_view,
   ClutterStageView *stage_view =
     meta_compositor_view_get_stage_view (compositor_view);
   MetaStageView *view = META_STAGE_VIEW (stage_view);
-  MetaRendererView *renderer_view = META_RENDERER_VIEW (stage_view);
   MetaCrtc *crtc;
-  CoglFramebuffer *framebuffer;
   MetaSurfaceActor *surface_actor;
   MetaSurfaceActorWayland *surface_actor_wayland;
   MetaWaylandSurface *surface;
@@ -288,103 +410,313 @@ find_scanout_candidate (MetaCompositorView  *compositor_view,
   if (!surface_actor)
     return FALSE;
 
-  if (!meta_stage_view_is_cursor_overlay_inhibited (view) &&
-      surface_actor_has_overlapping_cursor_overlays (compositor,
-                                                     compositor_view,
-                                                     surface_actor))
+  if (!meta_stage_view_is_cursor_overlay_inhibited (view))
+    {
+      MtkRectangle view_rect;
+      graphene_rect_t graphene_view_rect;
+
+      clutter_stage_view_get_layout (stage_view, &view_rect);
+      graphene_view_rect = mtk_rectangle_to_graphene_rect (&view_rect);
+      if (has_overlapping_cursor_overlays (compositor, &graphene_view_rect))
+        {
+          meta_topic (META_DEBUG_RENDER,
+                      "No direct scanout candidate: overlapping software cursors");
+          return FALSE;
+        }
+    }
+
+  if (!get_scanout_onscreen (compositor_view, "direct scanout",
+                             &crtc, &onscreen))
+    return FALSE;
+
+  if (surface_actor_needs_color_mapping (compositor_view, surface_actor,
+                                         "direct scanout"))
+    return FALSE;
+
+  surface_actor_wayland = META_SURFACE_ACTOR_WAYLAND (surface_actor);
+  surface = meta_surface_actor_wayland_get_surface (surface_actor_wayland);
+  if (!surface)
     {
       meta_topic (META_DEBUG_RENDER,
-                  "No direct scanout candidate: overlapping software cursors");
+                  "No direct scanout candidate: no surface");
       return FALSE;
     }
 
-  crtc = meta_renderer_view_get_crtc (renderer_view);
-  if (!META_IS_CRTC_KMS (crtc))
+  if (!surface_has_supported_color_model (surface, "direct scanout"))
+    return FALSE;
+
+  *crtc_out = crtc;
+  *onscreen_out = onscreen;
+  *surface_out = surface;
+
+  return TRUE;
+}
+
+static gboolean
+paint_boxes_intersect (const ClutterActorBox *box_a,
+                       const ClutterActorBox *box_b)
+{
+  return (box_a->x1 < box_b->x2 && box_b->x1 < box_a->x2 &&
+          box_a->y1 < box_b->y2 && box_b->y1 < box_a->y2);
+}
+
+/*
+ * Whether anything painted after @actor, i.e. a mapped later sibling of it
+ * or of one of its ancestors, may cover @box, or whether an ancestor applies
+ * effects that an overlay plane can't reproduce.
+ */
+static gboolean
+is_actor_painted_over (ClutterActor          *actor,
+                       const ClutterActorBox *box)
+{
+  ClutterActor *stage = clutter_actor_get_stage (actor);
+
+  while (actor && actor != stage)
+    {
+      ClutterActor *sibling;
+
+      if (clutter_actor_has_effects (actor))
+        return TRUE;
+
+      for (sibling = clutter_actor_get_next_sibling (actor);
+           sibling;
+           sibling = clutter_actor_get_next_sibling (sibling))
+        {
+          ClutterActorBox sibling_box;
+
+          if (!clutter_actor_is_mapped (sibling))
+            continue;
+
+          if (!clutter_actor_get_paint_box (sibling, &sibling_box))
+            return TRUE;
+
+          if (paint_boxes_intersect (box, &sibling_box))
+            return TRUE;
+        }
+
+      actor = clutter_actor_get_parent (actor);
+    }
+
+  return FALSE;
+}
+
+static gboolean
+is_overlay_plane_above_primary (MetaCrtcKms *crtc_kms)
+{
+  MetaKmsPlane *primary_plane =
+    meta_crtc_kms_get_assigned_primary_plane (crtc_kms);
+  MetaKmsPlane *overlay_plane =
+    meta_crtc_kms_get_assigned_overlay_plane (crtc_kms);
+  uint64_t primary_zpos;
+  uint64_t overlay_zpos;
+
+  if (!meta_kms_plane_get_zpos (primary_plane, &primary_zpos) ||
+      !meta_kms_plane_get_zpos (overlay_plane, &overlay_zpos))
+    return TRUE;
+
+  return overlay_zpos > primary_zpos;
+}
+
+static gboolean
+are_overlay_planes_disabled (void)
+{
+  static int disabled = -1;
+
+  if (G_UNLIKELY (disabled == -1))
+    {
+      disabled = g_strcmp0 (g_getenv ("MUTTER_DEBUG_DISABLE_OVERLAY_PLANES"),
+                            "1") == 0;
+    }
+
+  return disabled;
+}
+
+static gboolean
+get_overlay_onscreen (MetaCompositorView  *compositor_view,
+                      MetaCompositor      *compositor,
+                      CoglOnscreen       **onscreen_out)
+{
+  ClutterStageView *stage_view =
+    meta_compositor_view_get_stage_view (compositor_view);
+  MetaStageView *view = META_STAGE_VIEW (stage_view);
+  MetaCrtc *crtc;
+  MetaCrtcKms *crtc_kms;
+
+  if (meta_get_debug_paint_flags () & META_DEBUG_PAINT_DISABLE_DIRECT_SCANOUT)
+    return FALSE;
+
+  if (are_overlay_planes_disabled ())
+    return FALSE;
+
+  if (meta_stage_view_is_overlay_planes_inhibited (view))
     {
       meta_topic (META_DEBUG_RENDER,
-                  "No direct scanout candidate: no KMS CRTC");
+                  "No overlay plane candidate: overlay planes inhibited");
       return FALSE;
     }
 
-  framebuffer = clutter_stage_view_get_onscreen (stage_view);
-  if (!COGL_IS_ONSCREEN (framebuffer))
+  if (meta_compositor_is_unredirect_inhibited (compositor))
     {
       meta_topic (META_DEBUG_RENDER,
-                  "No direct scanout candidate: no onscreen framebuffer");
+                  "No overlay plane candidate: unredirect inhibited");
       return FALSE;
     }
 
-  onscreen = COGL_ONSCREEN (framebuffer);
-  if (!meta_onscreen_native_supports_direct_scanout (onscreen))
+  if (!get_scanout_onscreen (compositor_view, "overlay plane",
+                             &crtc, onscreen_out))
+    return FALSE;
+
+  crtc_kms = META_CRTC_KMS (crtc);
+  if (!meta_crtc_kms_get_assigned_overlay_plane (crtc_kms))
     {
       meta_topic (META_DEBUG_RENDER,
-                  "No direct scanout candidate: "
-                  "onscreen framebuffer doesn't support direct scanout");
+                  "No overlay plane candidate: CRTC has no overlay plane");
       return FALSE;
     }
 
-  if (clutter_stage_view_has_shadowfb (stage_view))
+  /* The surface is left out of the primary plane, so it would disappear
+   * if the overlay plane was stacked below it */
+  if (!is_overlay_plane_above_primary (crtc_kms))
     {
       meta_topic (META_DEBUG_RENDER,
-                  "No direct scanout candidate: stage-view has shadowfb");
+                  "No overlay plane candidate: "
+                  "overlay plane is not stacked above the primary plane");
       return FALSE;
     }
 
-  if (!(meta_get_debug_paint_flags () &
-        META_DEBUG_PAINT_IGNORE_COLOR_STATE_FOR_DIRECT_SCANOUT))
+  return TRUE;
+}
+
+static gboolean
+is_overlay_candidate (MetaCompositorView  *compositor_view,
+                      MetaCompositor      *compositor,
+                      MetaWindowActor     *window_actor,
+                      MetaSurfaceActor   **surface_actor_out,
+                      MetaWaylandSurface **surface_out)
+{
+  ClutterStageView *stage_view =
+    meta_compositor_view_get_stage_view (compositor_view);
+  MetaStageView *view = META_STAGE_VIEW (stage_view);
+  MetaSurfaceActor *surface_actor;
+  MetaSurfaceActorWayland *surface_actor_wayland;
+  MetaWaylandSurface *surface;
+  MtkRectangle view_rect;
+  ClutterActorBox actor_box;
+
+  if (meta_window_actor_effect_in_progress (window_actor))
     {
-      ClutterColorState *output_color_state;
-      ClutterColorState *surface_color_state;
+      meta_topic (META_DEBUG_RENDER,
+                  "No overlay plane candidate: "
+                  "window-actor effects in progress");
+      return FALSE;
+    }
 
-      output_color_state =
-        clutter_stage_view_get_output_color_state (CLUTTER_STAGE_VIEW (view));
-      surface_color_state =
-        clutter_actor_get_color_state (CLUTTER_ACTOR (surface_actor));
-      if (clutter_color_pipeline_shader_needs_color_state (surface_color_state,
-                                                           output_color_state, 0))
-        {
-          meta_topic (META_DEBUG_RENDER,
-                      "No direct scanout candidate: "
-                      "surface color state (%s) needs mapping to the output's (%s)",
-                      clutter_color_state_to_string (surface_color_state),
-                      clutter_color_state_to_string (output_color_state));
-          return FALSE;
-        }
+  if (clutter_actor_has_transitions (CLUTTER_ACTOR (window_actor)))
+    {
+      meta_topic (META_DEBUG_RENDER,
+                  "No overlay plane candidate: window-actor has transition");
+      return FALSE;
     }
 
-  surface_actor_wayland = META_SURFACE_ACTOR_WAYLAND (surface_actor);
-  surface = meta_surface_actor_wayland_get_surface (surface_actor_wayland);
-  if (!surface)
+  surface_actor = meta_window_actor_get_scanout_candidate (window_actor);
+  if (!surface_actor)
     {
       meta_topic (META_DEBUG_RENDER,
-                  "No direct scanout candidate: no surface");
+                  "No overlay plane candidate: "
+                  "window-actor has no scanout candidate");
       return FALSE;
     }
 
-  if (!(meta_get_debug_paint_flags () &
-        META_DEBUG_PAINT_IGNORE_COLOR_STATE_FOR_DIRECT_SCANOUT))
+  if (meta_surface_actor_is_effectively_obscured (surface_actor))
     {
-      MetaMultiTextureCoefficients coeffs;
+      meta_topic (META_DEBUG_RENDER,
+                  "No overlay plane candidate: surface-actor is obscured");
+      return FALSE;
+    }
 
-      coeffs = surface->applied_state.coeffs;
-      if (coeffs != META_MULTI_TEXTURE_COEFFICIENTS_NONE &&
-          coeffs != META_MULTI_TEXTURE_COEFFICIENTS_IDENTITY_FULL &&
-          coeffs != META_MULTI_TEXTURE_COEFFICIENTS_BT709_LIMITED)
+  if (clutter_actor_has_mapped_clones (CLUTTER_ACTOR (surface_actor)))
+    {
+      meta_topic (META_DEBUG_RENDER,
+                  "No overlay plane candidate: surface-actor has mapped clones");
+      return FALSE;
+    }
+
+  if (!meta_surface_actor_is_opaque (surface_actor) ||
+      clutter_actor_get_paint_opacity (CLUTTER_ACTOR (surface_actor)) != 0xff)
+    {
+      meta_topic (META_DEBUG_RENDER,
+                  "No overlay plane candidate: surface-actor is not opaque");
+      return FALSE;
+    }
+
+  if (!clutter_actor_get_paint_box (CLUTTER_ACTOR (surface_actor),
+                                    &actor_box))
+    {
+      meta_topic (META_DEBUG_RENDER,
+                  "No overlay plane candidate: no surface actor paint-box");
+      return FALSE;
+    }
+
+  clutter_stage_view_get_layout (stage_view, &view_rect);
+  if (actor_box.x1 < view_rect.x ||
+      actor_box.y1 < view_rect.y ||
+      actor_box.x2 > view_rect.x + view_rect.width ||
+      actor_box.y2 > view_rect.y + view_rect.height)
+    {
+      meta_topic (META_DEBUG_RENDER,
+                  "No overlay plane candidate: paint-box (%f,%f,%f,%f) is "
+                  "not within stage-view layout (%d,%d,%d,%d)",
+                  actor_box.x1, actor_box.y1,
+                  actor_box.x2 - actor_box.x1, actor_box.y2 - actor_box.y1,
+                  view_rect.x, view_rect.y, view_rect.width, view_rect.height);
+      return FALSE;
+    }
+
+  if (is_actor_painted_over (CLUTTER_ACTOR (surface_actor), &actor_box))
+    {
+      meta_topic (META_DEBUG_RENDER,
+                  "No overlay plane candidate: surface-actor is painted over");
+      return FALSE;
+    }
+
+  if (!meta_stage_view_is_cursor_overlay_inhibited (view))
+    {
+      graphene_rect_t actor_rect;
+
+      actor_rect = GRAPHENE_RECT_INIT (actor_box.x1, actor_box.y1,
+                                       actor_box.x2 - actor_box.x1,
+                                       actor_box.y2 - actor_box.y1);
+      if (has_overlapping_cursor_overlays (compositor, &actor_rect))
         {
           meta_topic (META_DEBUG_RENDER,
-                      "No direct scanout candidate: unsupported color model");
+                      "No overlay plane candidate: overlapping software cursors");
           return FALSE;
         }
     }
 
-  *crtc_out = crtc;
-  *onscreen_out = onscreen;
+  if (surface_actor_needs_color_mapping (compositor_view, surface_actor,
+                                         "overlay plane"))
+    return FALSE;
+
+  surface_actor_wayland = META_SURFACE_ACTOR_WAYLAND (surface_actor);
+  surface = meta_surface_actor_wayland_get_surface (surface_actor_wayland);
+  if (!surface)
+    {
+      meta_topic (META_DEBUG_RENDER,
+                  "No overlay plane candidate: no surface");
+      return FALSE;
+    }
+
+  if (!surface_has_supported_color_model (surface, "overlay plane"))
+    return FALSE;
+
+  *surface_actor_out = surface_actor;
   *surface_out = surface;
 
   return TRUE;
 }
 
-static void
+static gboolean
 try_assign_next_scanout (MetaCompositorView *compositor_view,
                          CoglOnscreen       *onscreen,
                          MetaWaylandSurface *surface)
@@ -395,16 +727,179 @@ try_assign_next_scanout (MetaCompositorView *compositor_view,
   stage_view = meta_compositor_view_get_stage_view (compositor_view);
   scanout = meta_wayland_surface_try_acquire_scanout (surface,
                                                       onscreen,
-                                                      stage_view);
+                                                      stage_view,
+                                                      META_WAYLAND_SCANOUT_PLANE_PRIMARY);
   if (!scanout)
     {
       meta_topic (META_DEBUG_RENDER,
                   "Could not acquire scanout");
-      return;
+      return FALSE;
     }
 
   meta_topic (META_DEBUG_RENDER, "Assigning scanout to stage view");
   clutter_stage_view_assign_next_scanout (stage_view, scanout);
+  return TRUE;
+}
+
+static void
+update_overlay_actor (MetaCompositorViewNative *view_native,
+                      MetaSurfaceActor         *surface_actor)
+{
+  MetaCompositorView *compositor_view = META_COMPOSITOR_VIEW (view_native);
+  ClutterStageView *stage_view =
+    meta_compositor_view_get_stage_view (compositor_view);
+
+  if (view_native->overlay_actor == surface_actor)
+    return;
+
+  if (view_native->overlay_actor)
+    {
+      ClutterActor *actor = CLUTTER_ACTOR (view_native->overlay_actor);
+      ClutterActorBox actor_box;
+
+      meta_surface_actor_set_overlay_view (view_native->overlay_actor, NULL);
+
+      /* The surface wasn't painted into the primary plane while it was on
+       * the overlay plane, so that area needs to be painted again. */
+      if (clutter_actor_get_paint_box (actor, &actor_box))
+        {
+          graphene_rect_t actor_rect;
+          MtkRectangle redraw_clip;
+
+          actor_rect = GRAPHENE_RECT_INIT (actor_box.x1, actor_box.y1,
+                                           actor_box.x2 - actor_box.x1,
+                                           actor_box.y2 - actor_box.y1);
+          mtk_rectangle_from_graphene_rect (&actor_rect,
+                                            MTK_ROUNDING_STRATEGY_GROW,
+                                            &redraw_clip);
+          clutter_stage_view_add_redraw_clip (stage_view, &redraw_clip);
+        }
+      else
+        {
+          clutter_stage_view_add_redraw_clip (stage_view, NULL);
+        }
+    }
+
+  if (surface_actor)
+    meta_surface_actor_set_overlay_view (surface_actor, stage_view);
+
+  g_set_weak_pointer (&view_native->overlay_actor, surface_actor);
+}
+
+static void
+clear_overlay (MetaCompositorViewNative *view_native)
+{
+  MetaCompositorView *compositor_view = META_COMPOSITOR_VIEW (view_native);
+  ClutterStageView *stage_view =
+    meta_compositor_view_get_stage_view (compositor_view);
+  CoglFramebuffer *framebuffer;
+
+  framebuffer = clutter_stage_view_get_onscreen (stage_view);
+  if (META_IS_ONSCREEN_NATIVE (framebuffer))
+    meta_onscreen_native_set_next_overlay (COGL_ONSCREEN (framebuffer), NULL);
+
+  update_overlay_actor (view_native, NULL);
+}
+
+static void
+on_overlay_scanout_failed (CoglScanout              *scanout,
+                           CoglOnscreen             *onscreen,
+                           MetaCompositorViewNative *view_native)
+{
+  MetaCompositorView *compositor_view = META_COMPOSITOR_VIEW (view_native);
+  ClutterStageView *stage_view =
+    meta_compositor_view_get_stage_view (compositor_view);
+
+  /* The surface was left out of the composited frame, so paint it back
+   * into the primary plane. The buffer is tainted for this onscreen, so it
+   * won't be tried on the overlay plane again. */
+  clear_overlay (view_native);
+  clutter_stage_view_schedule_update (stage_view);
+}
+
+static gboolean
+try_assign_overlay (MetaCompositorViewNative *view_native,
+                    CoglOnscreen             *onscreen,
+                    MetaSurfaceActor         *surface_actor,
+                    MetaWaylandSurface       *surface)
+{
+  MetaCompositorView *compositor_view = META_COMPOSITOR_VIEW (view_native);
+  ClutterStageView *stage_view =
+    meta_compositor_view_get_stage_view (compositor_view);
+  g_autoptr (CoglScanout) scanout = NULL;
+
+  scanout = meta_wayland_surface_try_acquire_scanout (surface,
+                                                      onscreen,
+                                                      stage_view,
+                                                      META_WAYLAND_SCANOUT_PLANE_OVERLAY);
+  if (!scanout)
+    {
+      meta_topic (META_DEBUG_RENDER,
+                  "Could not acquire overlay plane scanout");
+      return FALSE;
+    }
+
+  g_signal_connect_object (scanout, "scanout-failed",
+                           G_CALLBACK (on_overlay_scanout_failed),
+                           view_native, 0);
+
+  meta_topic (META_DEBUG_RENDER, "Assigning surface to overlay plane");
+  meta_onscreen_native_set_next_overlay (onscreen, scanout);
+  update_overlay_actor (view_native, surface_actor);
+
+  return TRUE;
+}
+
+static void
+maybe_assign_overlay (MetaCompositorViewNative *view_native,
+                      MetaCompositor           *compositor)
+{
+  MetaCompositorView *compositor_view = META_COMPOSITOR_VIEW (view_native);
+  ClutterStageView *stage_view =
+    meta_compositor_view_get_stage_view (compositor_view);
+  CoglOnscreen *onscreen = NULL;
+  MtkRectangle view_layout;
+  GList *l;
+  int n_candidates = 0;
+
+  if (!get_overlay_onscreen (compositor_view, compositor, &onscreen))
+    {
+      clear_overlay (view_native);
+      return;
+    }
+
+  clutter_stage_view_get_layout (stage_view, &view_layout);
+
+  /* Windows further down the stack are only eligible when nothing above
+   * them covers them, which is checked by is_overlay_candidate() */
+  for (l = g_list_last (meta_compositor_get_window_actors (compositor));
+       l && n_candidates < MAX_OVERLAY_CANDIDATES;
+       l = l->prev)
+    {
+      MetaWindowActor *window_actor = l->data;
+      MetaWindow *window = meta_window_actor_get_meta_window (window_actor);
+      MetaSurfaceActor *surface_actor = NULL;
+      MetaWaylandSurface *surface = NULL;
+      MtkRectangle buffer_rect;
+
+      if (!window->visible_to_compositor)
+        continue;
+
+      meta_window_get_buffer_rect (window, &buffer_rect);
+      if (!mtk_rectangle_overlap (&view_layout, &buffer_rect))
+        continue;
+
+      n_candidates++;
+
+      if (!is_overlay_candidate (compositor_view, compositor, window_actor,
+                                 &surface_actor, &surface))
+        continue;
+
+      if (try_assign_overlay (view_native, onscreen, surface_actor, surface))
+        return;
+    }
+
+  clear_overlay (view_native);
 }
 
 void
@@ -416,6 +911,7 @@ meta_compositor_view_native_maybe_assign_scanout (MetaCompositorViewNative *view
   CoglOnscreen *onscreen = NULL;
   MetaWaylandSurface *surface = NULL;
   gboolean candidate_found;
+  gboolean scanout_assigned = FALSE;
 
   candidate_found = find_scanout_candidate (compositor_view,
                                             compositor,
@@ -424,12 +920,17 @@ meta_compositor_view_native_maybe_assign_scanout (MetaCompositorViewNative *view
                                             &surface);
   if (candidate_found)
     {
-      try_assign_next_scanout (compositor_view,
-                               onscreen,
-                               surface);
+      scanout_assigned = try_assign_next_scanout (compositor_view,
+                                                  onscreen,
+                                                  surface);
     }
 
   update_scanout_candidate (view_native, surface, crtc);
+
+  if (scanout_assigned)
+    clear_overlay (view_native);
+  else
+    maybe_assign_overlay (view_native, compositor);
 }
 
 static MetaSurfaceActor *
@@ -521,6 +1022,12 @@ meta_compositor_view_native_dispose (GObject *object)
                           view_native->fullscreen_actor);
   view_native->fullscreen_actor = NULL;
 
+  if (view_native->overlay_actor)
+    {
+      meta_surface_actor_set_overlay_view (view_native->overlay_actor, NULL);
+      g_clear_weak_pointer (&view_native->overlay_actor);
+    }
+
   G_OBJECT_CLASS (meta_compositor_view_native_parent_class)->dispose (object);
 }
 
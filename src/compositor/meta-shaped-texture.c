@@ -1751,3 +1751,103 @@ meta_shaped_texture_set_color_repr (MetaShapedTexture            *stex,
   meta_texture_mipmap_set_coeffs (stex->texture_mipmap, coeffs);
   meta_shaped_texture_reset_pipelines (stex);
 }
+
+static void
+precompile_pipeline (CoglFramebuffer  *framebuffer,
+                     CoglPipeline     *pipeline,
+                     MetaMultiTexture *texture,
+                     CoglTexture      *mask_texture)
+{
+  int n_planes;
+  int i;
+
+  n_planes = meta_multi_texture_get_n_planes (texture);
+  for (i = 0; i < n_planes; i++)
+    {
+      cogl_pipeline_set_layer_texture (pipeline, i,
+                                       meta_multi_texture_get_plane (texture, i));
+    }
+
+  if (mask_texture)
+    cogl_pipeline_set_layer_texture (pipeline, n_planes, mask_texture);
+
+  cogl_framebuffer_precompile_pipeline (framebuffer, pipeline);
+}
+
+/**
+ * meta_shaped_texture_precompile_pipelines: (skip)
+ * @clutter_context: A #ClutterContext
+ * @stage_view: The #ClutterStageView the pipelines will be painted on
+ * @color_state: The #ClutterColorState of the expected window content
+ *
+ * Builds the GPU programs for the pipelines a window with content in
+ * @color_state will use when painted on @stage_view, so that mapping
+ * the first such window doesn't stall the frame on shader compilation.
+ */
+void
+meta_shaped_texture_precompile_pipelines (ClutterContext    *clutter_context,
+                                          ClutterStageView  *stage_view,
+                                          ClutterColorState *color_state)
+{
+  ClutterBackend *clutter_backend =
+    clutter_context_get_backend (clutter_context);
+  CoglContext *cogl_context =
+    clutter_backend_get_cogl_context (clutter_backend);
+  CoglFramebuffer *framebuffer =
+    clutter_stage_view_get_framebuffer (stage_view);
+  static const uint8_t pixel[4] = { 0xff, 0xff, 0xff, 0xff };
+  g_autoptr (MetaShapedTexture) stex = NULL;
+  g_autoptr (MetaMultiTexture) texture = NULL;
+  g_autoptr (CoglTexture) mask_texture = NULL;
+  g_autoptr (CoglPipeline) unblended_pipeline = NULL;
+  g_autoptr (CoglPipeline) unmasked_pipeline = NULL;
+  g_autoptr (CoglPipeline) masked_pipeline = NULL;
+  ClutterPaintContext *paint_context;
+  CoglTexture *plane;
+  g_autoptr (GError) error = NULL;
+
+  COGL_TRACE_BEGIN_SCOPED (MetaShapedTexturePrecompile,
+                           "Meta::ShapedTexture::precompile_pipelines()");
+
+  plane = cogl_texture_2d_new_from_data (cogl_context, 1, 1,
+                                         COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                                         0, pixel, &error);
+  if (!plane)
+    {
+      g_warning ("Failed to create texture for pipeline precompilation: %s",
+                 error->message);
+      return;
+    }
+  texture = meta_multi_texture_new_simple (plane);
+
+  mask_texture = cogl_texture_2d_new_from_data (cogl_context, 1, 1,
+                                                COGL_PIXEL_FORMAT_A_8,
+                                                0, pixel, &error);
+  if (!mask_texture)
+    {
+      g_warning ("Failed to create texture for pipeline precompilation: %s",
+                 error->message);
+      return;
+    }
+
+  stex = meta_shaped_texture_new (clutter_context, color_state);
+  meta_shaped_texture_set_texture (stex, texture);
+
+  paint_context =
+    clutter_paint_context_new_for_framebuffer (framebuffer, NULL,
+                                               CLUTTER_PAINT_FLAG_NONE,
+                                               clutter_stage_view_get_color_state (stage_view));
+
+  /* These mirror the pipelines do_paint_content() uses for the opaque
+   * region, the blended parts and shaped (masked) windows */
+  unblended_pipeline = get_unblended_pipeline (stex, paint_context, texture);
+  precompile_pipeline (framebuffer, unblended_pipeline, texture, NULL);
+
+  unmasked_pipeline = get_unmasked_pipeline (stex, paint_context, texture);
+  precompile_pipeline (framebuffer, unmasked_pipeline, texture, NULL);
+
+  masked_pipeline = get_masked_pipeline (stex, paint_context, texture);
+  precompile_pipeline (framebuffer, masked_pipeline, texture, mask_texture);
+
+  clutter_paint_context_destroy (paint_context);
+}
@@ -60,6 +60,9 @@ typedef struct _MetaSurfaceActorPrivate
   /* Freeze/thaw accounting */
   MtkRegion *pending_damage;
   gboolean is_frozen;
+
+  /* Stage view whose overlay plane is showing the surface */
+  ClutterStageView *overlay_view;
 } MetaSurfaceActorPrivate;
 
 static void cullable_iface_init (MetaCullableInterface *iface);
@@ -357,6 +360,7 @@ meta_surface_actor_dispose (GObject *object)
   g_clear_object (&priv->content);
 
   set_unobscured_region (self, NULL);
+  g_clear_weak_pointer (&priv->overlay_view);
 
   G_OBJECT_CLASS (meta_surface_actor_parent_class)->dispose (object);
 }
@@ -902,3 +906,29 @@ meta_surface_actor_is_frozen (MetaSurfaceActor *self)
 
   return priv->is_frozen;
 }
+
+/*
+ * Marks the surface as being shown by an overlay plane of @stage_view, or
+ * clears the mark when @stage_view is %NULL. While marked, the surface is
+ * left out when compositing that view, while its opaque region still culls
+ * what is below it.
+ */
+void
+meta_surface_actor_set_overlay_view (MetaSurfaceActor *surface_actor,
+                                     ClutterStageView *stage_view)
+{
+  MetaSurfaceActorPrivate *priv =
+    meta_surface_actor_get_instance_private (surface_actor);
+
+  g_set_weak_pointer (&priv->overlay_view, stage_view);
+}
+
+gboolean
+meta_surface_actor_is_on_overlay_plane (MetaSurfaceActor *surface_actor,
+                                        ClutterStageView *stage_view)
+{
+  MetaSurfaceActorPrivate *priv =
+    meta_surface_actor_get_instance_private (surface_actor);
+
+  return stage_view && priv->overlay_view == stage_view;
+}
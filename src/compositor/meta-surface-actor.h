@@ -3,6 +3,7 @@
 #pragma once
 
 #include "backends/meta-backend-types.h"
+#include "core/util-private.h"
 #include "meta/meta-shaped-texture.h"
 #include "meta/window.h"
 
@@ -64,4 +65,12 @@ gboolean meta_surface_actor_is_opaque (MetaSurfaceActor *actor);
 gboolean meta_surface_actor_is_frozen (MetaSurfaceActor *actor);
 void meta_surface_actor_set_frozen (MetaSurfaceActor *actor,
                                     gboolean          frozen);
+
+void meta_surface_actor_set_overlay_view (MetaSurfaceActor *surface_actor,
+                                          ClutterStageView *stage_view);
+
+META_EXPORT_TEST
+gboolean meta_surface_actor_is_on_overlay_plane (MetaSurfaceActor *surface_actor,
+                                                 ClutterStageView *stage_view);
+
 G_END_DECLS
@@ -86,6 +86,11 @@ meta_surface_content_paint_content (ClutterContent      *content,
   if (clip_region && mtk_region_is_empty (clip_region))
     return;
 
+  if (!clutter_actor_is_in_clone_paint (actor) &&
+      meta_surface_actor_is_on_overlay_plane (META_SURFACE_ACTOR (actor),
+                                              clutter_paint_context_get_stage_view (paint_context)))
+    return;
+
   if (!meta_shaped_texture_get_texture (texture))
     return;
 
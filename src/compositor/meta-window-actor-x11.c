@@ -22,6 +22,8 @@
 
 #include "compositor/meta-window-actor-x11.h"
 
+#include <string.h>
+
 #include "backends/meta-logical-monitor-private.h"
 #include "clutter/clutter-frame-clock.h"
 #include "compositor/compositor-private.h"
@@ -634,43 +636,6 @@ check_needs_shadow (MetaWindowActorX11 *actor_x11)
     meta_shadow_unref (old_shadow);
 }
 
-static MtkRegion *
-scan_visible_region (guchar    *mask_data,
-                     int        stride,
-                     MtkRegion *scan_area)
-{
-  int i, n_rects = mtk_region_num_rectangles (scan_area);
-  MtkRegionBuilder builder;
-
-  mtk_region_builder_init (&builder);
-
-  for (i = 0; i < n_rects; i++)
-    {
-      int x, y;
-      MtkRectangle rect;
-
-      rect = mtk_region_get_rectangle (scan_area, i);
-
-      for (y = rect.y; y < (rect.y + rect.height); y++)
-        {
-          for (x = rect.x; x < (rect.x + rect.width); x++)
-            {
-              int x2 = x;
-              while (x2 < (rect.x + rect.width) && mask_data[y * stride + x2] == 255)
-                x2++;
-
-              if (x2 > x)
-                {
-                  mtk_region_builder_add_rectangle (&builder, x, y, x2 - x, 1);
-                  x = x2;
-                }
-            }
-        }
-    }
-
-  return mtk_region_builder_finish (&builder);
-}
-
 static void
 get_client_area_rect_from_texture (MetaWindowActorX11 *actor_x11,
                                    MetaShapedTexture  *shaped_texture,
@@ -707,24 +672,95 @@ get_client_area_rect (MetaWindowActorX11 *actor_x11,
 }
 
 static void
-region_to_cairo_path (MtkRegion *region,
-                      cairo_t   *cr)
+fill_region_mask (uint8_t   *mask_data,
+                  int        stride,
+                  MtkRegion *region)
 {
-  MtkRectangle rect;
   int n_rects, i;
 
   n_rects = mtk_region_num_rectangles (region);
 
   for (i = 0; i < n_rects; i++)
     {
-      rect = mtk_region_get_rectangle (region, i);
-      cairo_rectangle (cr, rect.x, rect.y, rect.width, rect.height);
+      MtkRectangle rect = mtk_region_get_rectangle (region, i);
+      uint8_t *row = mask_data + rect.y * stride + rect.x;
+      int y;
+
+      for (y = 0; y < rect.height; y++)
+        {
+          memset (row, 255, rect.width);
+          row += stride;
+        }
     }
 }
 
+/**
+ * meta_window_actor_x11_build_frame_mask:
+ * @ctx: a #CoglContext
+ * @shape_region: the client shape, in surface coordinates
+ * @width: the surface width
+ * @height: the surface height
+ * @client_area: (nullable): the client area within the surface
+ * @frame_area: (nullable): the area covered by the frame
+ * @error: return location for a #GError
+ *
+ * Adds the visible part of the frame, that is @frame_area outside of
+ * @client_area, to @shape_region, and creates an alpha mask texture
+ * covering the result. Everything is pixel aligned, so both are built
+ * directly from the region rectangles.
+ *
+ * Returns: (transfer full) (nullable): the mask texture, or %NULL if the
+ *   mask would cover the whole surface, or on error.
+ */
+CoglTexture *
+meta_window_actor_x11_build_frame_mask (CoglContext         *ctx,
+                                        MtkRegion           *shape_region,
+                                        int                  width,
+                                        int                  height,
+                                        const MtkRectangle  *client_area,
+                                        const MtkRectangle  *frame_area,
+                                        GError             **error)
+{
+  MtkRectangle bounds = { 0, 0, width, height };
+  g_autoptr (MtkRegion) mask_region = NULL;
+  g_autofree uint8_t *mask_data = NULL;
+  int stride;
+
+  if (frame_area)
+    {
+      g_autoptr (MtkRegion) frame_paint_region = NULL;
+
+      /* Make sure we don't paint the frame over the client window. */
+      frame_paint_region = mtk_region_create_rectangle (&bounds);
+      mtk_region_subtract_rectangle (frame_paint_region, client_area);
+      mtk_region_intersect_rectangle (frame_paint_region, frame_area);
+
+      mtk_region_union (shape_region, frame_paint_region);
+    }
+
+  mask_region = mtk_region_copy (shape_region);
+  mtk_region_intersect_rectangle (mask_region, &bounds);
+
+  if (mtk_region_num_rectangles (mask_region) == 1)
+    {
+      MtkRectangle extents = mtk_region_get_extents (mask_region);
+
+      if (mtk_rectangle_equal (&extents, &bounds))
+        return NULL;
+    }
+
+  stride = width;
+  mask_data = g_malloc0 (stride * height);
+  fill_region_mask (mask_data, stride, mask_region);
+
+  return cogl_texture_2d_new_from_data (ctx, width, height,
+                                        COGL_PIXEL_FORMAT_A_8,
+                                        stride, mask_data, error);
+}
+
 static void
-build_and_scan_frame_mask (MetaWindowActorX11 *actor_x11,
-                           MtkRegion          *shape_region)
+build_frame_mask (MetaWindowActorX11 *actor_x11,
+                  MtkRegion          *shape_region)
 {
   ClutterContext *clutter_context =
     clutter_actor_get_context (CLUTTER_ACTOR (actor_x11));
@@ -735,13 +771,11 @@ build_and_scan_frame_mask (MetaWindowActorX11 *actor_x11,
   MetaSurfaceActor *surface =
     meta_window_actor_get_surface (META_WINDOW_ACTOR (actor_x11));
   MetaFrame *frame = meta_window_x11_get_frame (window);
-  uint8_t *mask_data;
   unsigned int tex_width, tex_height;
   MetaShapedTexture *stex;
-  CoglTexture *mask_texture;
-  int stride;
-  cairo_t *cr;
-  cairo_surface_t *image;
+  g_autoptr (CoglTexture) mask_texture = NULL;
+  MtkRectangle client_area;
+  MtkRectangle frame_area;
   g_autoptr (GError) error = NULL;
 
   stex = meta_surface_actor_get_texture (surface);
@@ -755,29 +789,8 @@ build_and_scan_frame_mask (MetaWindowActorX11 *actor_x11,
   if (tex_width == 0 || tex_height == 0)
     return;
 
-  stride = cairo_format_stride_for_width (CAIRO_FORMAT_A8, tex_width);
-
-  /* Create data for an empty image */
-  mask_data = g_malloc0 (stride * tex_height);
-
-  image = cairo_image_surface_create_for_data (mask_data,
-                                               CAIRO_FORMAT_A8,
-                                               tex_width,
-                                               tex_height,
-                                               stride);
-  cr = cairo_create (image);
-
-  region_to_cairo_path (shape_region, cr);
-  cairo_fill (cr);
-
   if (frame)
     {
-      g_autoptr (MtkRegion) frame_paint_region = NULL;
-      g_autoptr (MtkRegion) scanned_region = NULL;
-      MtkRectangle rect = { 0, 0, tex_width, tex_height };
-      MtkRectangle client_area;
-      MtkRectangle frame_rect;
-
       /* If we update the shape regardless of the frozen state of the actor,
        * as with Xwayland to avoid the black shadow effect, we ought to base
        * the frame size on the buffer size rather than the reported window's
@@ -785,56 +798,26 @@ build_and_scan_frame_mask (MetaWindowActorX11 *actor_x11,
        * point.
        */
       if (meta_window_x11_always_update_shape (window))
-        {
-          meta_window_x11_surface_rect_to_frame_rect (window, &rect, &frame_rect);
-          get_client_area_rect_from_texture (actor_x11, stex, &client_area);
-        }
+        get_client_area_rect_from_texture (actor_x11, stex, &client_area);
       else
-        {
-          meta_window_get_frame_rect (window, &frame_rect);
-          meta_window_get_client_area_rect (window, &client_area);
-        }
+        meta_window_get_client_area_rect (window, &client_area);
 
-      /* Make sure we don't paint the frame over the client window. */
-      frame_paint_region = mtk_region_create_rectangle (&rect);
-      mtk_region_subtract_rectangle (frame_paint_region, &client_area);
-
-      region_to_cairo_path (frame_paint_region, cr);
-      cairo_clip (cr);
-
-      cairo_rectangle (cr,
-                       0, 0,
-                       frame->rect.width,
-                       frame->rect.height);
-      cairo_set_source_rgb (cr, 0, 0, 0);
-      cairo_fill (cr);
-
-      cairo_surface_flush (image);
-      scanned_region = scan_visible_region (mask_data, stride, frame_paint_region);
-      mtk_region_union (shape_region, scanned_region);
+      frame_area = (MtkRectangle) {
+        .width = frame->rect.width,
+        .height = frame->rect.height,
+      };
     }
 
-  cairo_destroy (cr);
-  cairo_surface_destroy (image);
-
-  mask_texture = cogl_texture_2d_new_from_data (ctx, tex_width, tex_height,
-                                                COGL_PIXEL_FORMAT_A_8,
-                                                stride, mask_data, &error);
-
+  mask_texture = meta_window_actor_x11_build_frame_mask (ctx, shape_region,
+                                                         tex_width,
+                                                         tex_height,
+                                                         frame ? &client_area : NULL,
+                                                         frame ? &frame_area : NULL,
+                                                         &error);
   if (error)
     g_warning ("Failed to allocate mask texture: %s", error->message);
 
-  if (mask_texture)
-    {
-      meta_shaped_texture_set_mask_texture (stex, mask_texture);
-      g_object_unref (mask_texture);
-    }
-  else
-    {
-      meta_shaped_texture_set_mask_texture (stex, NULL);
-    }
-
-  g_free (mask_data);
+  meta_shaped_texture_set_mask_texture (stex, mask_texture);
 }
 
 static void
@@ -880,7 +863,7 @@ update_shape_region (MetaWindowActorX11 *actor_x11)
     }
 
   if (priv->shape_region || frame)
-    build_and_scan_frame_mask (actor_x11, region);
+    build_frame_mask (actor_x11, region);
 
   g_clear_pointer (&actor_x11->shape_region, mtk_region_unref);
   actor_x11->shape_region = region;
@@ -23,6 +23,7 @@
 #include <X11/extensions/Xdamage.h>
 
 #include "compositor/meta-window-actor-private.h"
+#include "core/util-private.h"
 
 #define META_TYPE_WINDOW_ACTOR_X11 (meta_window_actor_x11_get_type())
 G_DECLARE_FINAL_TYPE (MetaWindowActorX11,
@@ -31,3 +32,12 @@ G_DECLARE_FINAL_TYPE (MetaWindowActorX11,
                       MetaWindowActor)
 
 void meta_window_actor_x11_update_shape (MetaWindowActorX11 *actor_x11);
+
+META_EXPORT_TEST
+CoglTexture * meta_window_actor_x11_build_frame_mask (CoglContext         *ctx,
+                                                      MtkRegion           *shape_region,
+                                                      int                  width,
+                                                      int                  height,
+                                                      const MtkRectangle  *client_area,
+                                                      const MtkRectangle  *frame_area,
+                                                      GError             **error);
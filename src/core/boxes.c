@@ -210,114 +210,174 @@ meta_rectangle_resize_with_gravity (const MtkRectangle *old_rect,
   rect->height = new_height;
 }
 
+/* The temporary sets of rectangles and edges of the spanning set and edge
+ * computations below are kept in arrays, reused across the steps of a
+ * computation, rather than in lists of individually allocated elements.
+ * Only the final results are turned into lists, as that is what the
+ * callers consume.
+ */
+static GList *
+rect_array_to_list (GArray *rects)
+{
+  GList *ret = NULL;
+  int i;
+
+  for (i = rects->len - 1; i >= 0; i--)
+    {
+      MtkRectangle *rect = g_new (MtkRectangle, 1);
+
+      *rect = g_array_index (rects, MtkRectangle, i);
+      ret = g_list_prepend (ret, rect);
+    }
+
+  return ret;
+}
+
+static GList *
+edge_array_to_list (GArray *edges)
+{
+  GList *ret = NULL;
+  int i;
+
+  for (i = edges->len - 1; i >= 0; i--)
+    {
+      MetaEdge *edge = g_new (MetaEdge, 1);
+
+      *edge = g_array_index (edges, MetaEdge, i);
+      ret = g_list_prepend (ret, edge);
+    }
+
+  return ret;
+}
+
 /* Not so simple helper function for get_minimal_spanning_set_for_region() */
-static GList*
-merge_spanning_rects_in_region (GList *region)
+static void
+merge_spanning_rects_in_region (GArray *region)
 {
   /* NOTE FOR ANY OPTIMIZATION PEOPLE OUT THERE: Please see the
    * documentation of get_minimal_spanning_set_for_region() for performance
    * considerations that also apply to this function.
    */
 
-  GList *compare;
-  compare = region;
+  unsigned int compare = 0;
 
-  if (region == NULL)
+  if (region->len == 0)
     {
       g_warning ("Region to merge was empty! Either you have some "
                  "pathological STRUT list or there's a bug somewhere!");
-      return NULL;
+      return;
     }
 
-  while (compare && compare->next)
+  while (compare + 1 < region->len)
     {
-      MtkRectangle *a = compare->data;
-      GList *other = compare->next;
+      MtkRectangle *a = &g_array_index (region, MtkRectangle, compare);
+      unsigned int other = compare + 1;
 
       g_assert (a->width > 0 && a->height > 0);
 
-      while (other)
+      while (other < region->len)
         {
-          MtkRectangle *b = other->data;
-          GList *delete_me = NULL;
+          MtkRectangle *b = &g_array_index (region, MtkRectangle, other);
 
           g_assert (b->width > 0 && b->height > 0);
 
           /* If a contains b, just remove b */
           if (mtk_rectangle_contains_rect (a, b))
             {
-              delete_me = other;
+              g_array_remove_index (region, other);
+              continue;
             }
-          /* If b contains a, just remove a */
+          /* If b contains a, just remove a, and continue with what comes
+           * after it */
           else if (mtk_rectangle_contains_rect (b, a))
             {
-              delete_me = compare;
+              g_array_remove_index (region, compare);
+              a = &g_array_index (region, MtkRectangle, compare);
+              other = compare + 1;
+              continue;
             }
           /* If a and b might be mergeable horizontally */
           else if (a->y == b->y && a->height == b->height)
             {
-              /* If a and b overlap */
-              if (mtk_rectangle_overlap (a, b))
-                {
-                  int new_x = MIN (a->x, b->x);
-                  a->width = MAX (a->x + a->width, b->x + b->width) - new_x;
-                  a->x = new_x;
-                  delete_me = other;
-                }
-              /* If a and b are adjacent */
-              else if (a->x + a->width == b->x || a->x == b->x + b->width)
+              /* If a and b overlap or are adjacent */
+              if (mtk_rectangle_overlap (a, b) ||
+                  a->x + a->width == b->x || a->x == b->x + b->width)
                 {
                   int new_x = MIN (a->x, b->x);
                   a->width = MAX (a->x + a->width, b->x + b->width) - new_x;
                   a->x = new_x;
-                  delete_me = other;
+                  g_array_remove_index (region, other);
+                  continue;
                 }
             }
           /* If a and b might be mergeable vertically */
           else if (a->x == b->x && a->width == b->width)
             {
-              /* If a and b overlap */
-              if (mtk_rectangle_overlap (a, b))
+              /* If a and b overlap or are adjacent */
+              if (mtk_rectangle_overlap (a, b) ||
+                  a->y + a->height == b->y || a->y == b->y + b->height)
                 {
                   int new_y = MIN (a->y, b->y);
                   a->height = MAX (a->y + a->height, b->y + b->height) - new_y;
                   a->y = new_y;
-                  delete_me = other;
-                }
-              /* If a and b are adjacent */
-              else if (a->y + a->height == b->y || a->y == b->y + b->height)
-                {
-                  int new_y = MIN (a->y, b->y);
-                  a->height = MAX (a->y + a->height, b->y + b->height) - new_y;
-                  a->y = new_y;
-                  delete_me = other;
+                  g_array_remove_index (region, other);
+                  continue;
                 }
             }
 
-          other = other->next;
+          other++;
+        }
 
-          /* Delete any rectangle in the list that is no longer wanted */
-          if (delete_me != NULL)
-            {
-              /* Deleting the rect we compare others to is a little tricker */
-              if (compare == delete_me)
-                {
-                  compare = compare->next;
-                  other = compare->next;
-                  a = compare->data;
-                }
+      compare++;
+    }
+}
 
-              /* Okay, we can free it now */
-              g_free (delete_me->data);
-              region = g_list_delete_link (region, delete_me);
-            }
+/* Removes the rectangles that are contained in another one of the set.
+ * Splitting them further can only yield rectangles contained in the
+ * splits of the containing one, which the merge at the end would throw
+ * away anyway, so doing this after each strut keeps the set from blowing
+ * up with the number of struts.
+ */
+static void
+remove_contained_rects (GArray *rects)
+{
+  unsigned int i, j, n_rects;
 
-        }
+  for (i = 0; i < rects->len; i++)
+    {
+      MtkRectangle *a = &g_array_index (rects, MtkRectangle, i);
+
+      if (a->width == 0)
+        continue;
+
+      for (j = i + 1; j < rects->len; j++)
+        {
+          MtkRectangle *b = &g_array_index (rects, MtkRectangle, j);
 
-      compare = compare->next;
+          if (b->width == 0)
+            continue;
+
+          if (mtk_rectangle_contains_rect (a, b))
+            {
+              b->width = 0;
+            }
+          else if (mtk_rectangle_contains_rect (b, a))
+            {
+              a->width = 0;
+              break;
+            }
+        }
     }
 
-  return region;
+  n_rects = 0;
+  for (i = 0; i < rects->len; i++)
+    {
+      MtkRectangle *rect = &g_array_index (rects, MtkRectangle, i);
+
+      if (rect->width > 0)
+        g_array_index (rects, MtkRectangle, n_rects++) = *rect;
+    }
+  g_array_set_size (rects, n_rects);
 }
 
 /* Simple helper function for get_minimal_spanning_set_for_region()... */
@@ -382,19 +442,17 @@ meta_rectangle_get_minimal_spanning_set_for_region (
   /* NOTE FOR OPTIMIZERS: This function *might* be somewhat slow,
    * especially due to the call to merge_spanning_rects_in_region() (which
    * is O(n^2) where n is the size of the list generated in this function).
-   * This is made more onerous due to the fact that it involves a fair
-   * number of memory allocation and deallocation calls.  However, n is 1
-   * for default installations of Gnome (because partial struts aren't used
-   * by default and only partial struts increase the size of the spanning
-   * set generated).  With one partial strut, n will be 2 or 3.  With 2
-   * partial struts, n will probably be 4 or 5.  So, n probably isn't large
-   * enough to make this worth bothering.  Further, it is only called from
-   * workspace.c:ensure_work_areas_validated (at least as of the time of
-   * writing this comment), which in turn should only be called if the
-   * strut list changes or the screen or monitor size changes.  If it ever
-   * does show up on profiles (most likely because people start using
-   * ridiculously huge numbers of partial struts), possible optimizations
-   * include:
+   * However, n is 1 for default installations of Gnome (because partial
+   * struts aren't used by default and only partial struts increase the
+   * size of the spanning set generated).  With one partial strut, n will
+   * be 2 or 3.  With 2 partial struts, n will probably be 4 or 5.  So, n
+   * probably isn't large enough to make this worth bothering.  Further, it
+   * is only called from workspace.c:ensure_work_areas_validated (at least
+   * as of the time of writing this comment), which in turn should only be
+   * called if the strut list changes or the screen or monitor size
+   * changes.  If it ever does show up on profiles (most likely because
+   * people start using ridiculously huge numbers of partial struts),
+   * possible optimizations include:
    *
    * (1) rewrite merge_spanning_rects_in_region() to be O(n) or O(nlogn).
    *     I'm not totally sure it's possible, but with a couple copies of
@@ -415,10 +473,10 @@ meta_rectangle_get_minimal_spanning_set_for_region (
    *     URL splitting.)
    */
 
-  GList         *ret;
-  GList         *tmp_list;
+  GArray        *rects;
+  GArray        *split_rects;
   const GSList  *strut_iter;
-  MtkRectangle *temp_rect;
+  GList         *ret;
 
   /* The algorithm is basically as follows:
    *   Initialize rectangle_set to basic_rect
@@ -429,79 +487,87 @@ meta_rectangle_get_minimal_spanning_set_for_region (
    *       - Remove the old (pre-split) rectangle from the rectangle_set,
    *         and replace it with the new rectangles generated from the
    *         splitting
+   *
+   * The rectangle set of each step is built in a second array, walking
+   * the previous one backwards, which keeps the order of the rectangles
+   * (and hence which ones end up being merged) the same as it has always
+   * been.
    */
 
-  temp_rect = g_new (MtkRectangle, 1);
-  *temp_rect = *basic_rect;
-  ret = g_list_prepend (NULL, temp_rect);
+  rects = g_array_sized_new (FALSE, FALSE, sizeof (MtkRectangle), 16);
+  split_rects = g_array_sized_new (FALSE, FALSE, sizeof (MtkRectangle), 16);
+  g_array_append_val (rects, *basic_rect);
 
   for (strut_iter = all_struts; strut_iter; strut_iter = strut_iter->next)
     {
-      GList *rect_iter;
       MetaStrut *strut = (MetaStrut*)strut_iter->data;
       MtkRectangle *strut_rect = &strut->rect;
+      gboolean strut_aligns = check_strut_align (strut, basic_rect);
+      GArray *tmp;
+      int i;
 
-      tmp_list = g_steal_pointer (&ret);
-      rect_iter = tmp_list;
-      while (rect_iter)
+      g_array_set_size (split_rects, 0);
+
+      for (i = rects->len - 1; i >= 0; i--)
         {
-          MtkRectangle *rect = (MtkRectangle*) rect_iter->data;
+          MtkRectangle rect = g_array_index (rects, MtkRectangle, i);
+          MtkRectangle temp_rect;
 
-          if (!mtk_rectangle_overlap (strut_rect, rect) ||
-              !check_strut_align (strut, basic_rect))
-            ret = g_list_prepend (ret, rect);
-          else
+          if (!strut_aligns || !mtk_rectangle_overlap (strut_rect, &rect))
             {
-              /* If there is area in rect left of strut */
-              if (BOX_LEFT (*rect) < BOX_LEFT (*strut_rect))
-                {
-                  temp_rect = g_new (MtkRectangle, 1);
-                  *temp_rect = *rect;
-                  temp_rect->width = BOX_LEFT (*strut_rect) - BOX_LEFT (*rect);
-                  ret = g_list_prepend (ret, temp_rect);
-                }
-              /* If there is area in rect right of strut */
-              if (BOX_RIGHT (*rect) > BOX_RIGHT (*strut_rect))
-                {
-                  int new_x;
-                  temp_rect = g_new (MtkRectangle, 1);
-                  *temp_rect = *rect;
-                  new_x = BOX_RIGHT (*strut_rect);
-                  temp_rect->width = BOX_RIGHT (*rect) - new_x;
-                  temp_rect->x = new_x;
-                  ret = g_list_prepend (ret, temp_rect);
-                }
-              /* If there is area in rect above strut */
-              if (BOX_TOP (*rect) < BOX_TOP (*strut_rect))
-                {
-                  temp_rect = g_new (MtkRectangle, 1);
-                  *temp_rect = *rect;
-                  temp_rect->height = BOX_TOP (*strut_rect) - BOX_TOP (*rect);
-                  ret = g_list_prepend (ret, temp_rect);
-                }
-              /* If there is area in rect below strut */
-              if (BOX_BOTTOM (*rect) > BOX_BOTTOM (*strut_rect))
-                {
-                  int new_y;
-                  temp_rect = g_new (MtkRectangle, 1);
-                  *temp_rect = *rect;
-                  new_y = BOX_BOTTOM (*strut_rect);
-                  temp_rect->height = BOX_BOTTOM (*rect) - new_y;
-                  temp_rect->y = new_y;
-                  ret = g_list_prepend (ret, temp_rect);
-                }
-              g_free (rect);
+              g_array_append_val (split_rects, rect);
+              continue;
+            }
+
+          /* If there is area in rect below strut */
+          if (BOX_BOTTOM (rect) > BOX_BOTTOM (*strut_rect))
+            {
+              temp_rect = rect;
+              temp_rect.y = BOX_BOTTOM (*strut_rect);
+              temp_rect.height = BOX_BOTTOM (rect) - temp_rect.y;
+              g_array_append_val (split_rects, temp_rect);
+            }
+          /* If there is area in rect above strut */
+          if (BOX_TOP (rect) < BOX_TOP (*strut_rect))
+            {
+              temp_rect = rect;
+              temp_rect.height = BOX_TOP (*strut_rect) - BOX_TOP (rect);
+              g_array_append_val (split_rects, temp_rect);
+            }
+          /* If there is area in rect right of strut */
+          if (BOX_RIGHT (rect) > BOX_RIGHT (*strut_rect))
+            {
+              temp_rect = rect;
+              temp_rect.x = BOX_RIGHT (*strut_rect);
+              temp_rect.width = BOX_RIGHT (rect) - temp_rect.x;
+              g_array_append_val (split_rects, temp_rect);
+            }
+          /* If there is area in rect left of strut */
+          if (BOX_LEFT (rect) < BOX_LEFT (*strut_rect))
+            {
+              temp_rect = rect;
+              temp_rect.width = BOX_LEFT (*strut_rect) - BOX_LEFT (rect);
+              g_array_append_val (split_rects, temp_rect);
             }
-          rect_iter = rect_iter->next;
         }
-      g_list_free (tmp_list);
+
+      remove_contained_rects (split_rects);
+
+      tmp = rects;
+      rects = split_rects;
+      split_rects = tmp;
     }
 
   /* Sort by maximal area, just because I feel like it... */
-  ret = g_list_sort (ret, compare_rect_areas);
+  g_array_sort (rects, compare_rect_areas);
 
   /* Merge rectangles if possible so that the list really is minimal */
-  ret = merge_spanning_rects_in_region (ret);
+  merge_spanning_rects_in_region (rects);
+
+  ret = rect_array_to_list (rects);
+
+  g_array_free (rects, TRUE);
+  g_array_free (split_rects, TRUE);
 
   return ret;
 }
@@ -1029,84 +1095,52 @@ meta_rectangle_edge_aligns (const MtkRectangle *rect,
     }
 }
 
-static GList*
-get_rect_minus_overlap (const GList  *rect_in_list,
-                        MtkRectangle *overlap)
+/* Appends the parts of rect that are not covered by overlap to rects,
+ * returning how many there were.
+ */
+static int
+append_rect_minus_overlap (GArray             *rects,
+                           const MtkRectangle *rect,
+                           const MtkRectangle *overlap)
 {
-  MtkRectangle *temp;
-  MtkRectangle *rect = rect_in_list->data;
-  GList *ret = NULL;
+  MtkRectangle temp;
+  int n_rects = 0;
 
-  if (BOX_LEFT (*rect) < BOX_LEFT (*overlap))
-    {
-      temp = g_new (MtkRectangle, 1);
-      *temp = *rect;
-      temp->width = BOX_LEFT (*overlap) - BOX_LEFT (*rect);
-      ret = g_list_prepend (ret, temp);
-    }
-  if (BOX_RIGHT (*rect) > BOX_RIGHT (*overlap))
+  if (BOX_BOTTOM (*rect) > BOX_BOTTOM (*overlap))
     {
-      temp = g_new (MtkRectangle, 1);
-      *temp = *rect;
-      temp->x = BOX_RIGHT (*overlap);
-      temp->width = BOX_RIGHT (*rect) - BOX_RIGHT (*overlap);
-      ret = g_list_prepend (ret, temp);
+      temp.x      = overlap->x;
+      temp.width  = overlap->width;
+      temp.y      = BOX_BOTTOM (*overlap);
+      temp.height = BOX_BOTTOM (*rect) - BOX_BOTTOM (*overlap);
+      g_array_append_val (rects, temp);
+      n_rects++;
     }
   if (BOX_TOP (*rect) < BOX_TOP (*overlap))
     {
-      temp = g_new (MtkRectangle, 1);
-      temp->x      = overlap->x;
-      temp->width  = overlap->width;
-      temp->y      = BOX_TOP (*rect);
-      temp->height = BOX_TOP (*overlap) - BOX_TOP (*rect);
-      ret = g_list_prepend (ret, temp);
+      temp.x      = overlap->x;
+      temp.width  = overlap->width;
+      temp.y      = BOX_TOP (*rect);
+      temp.height = BOX_TOP (*overlap) - BOX_TOP (*rect);
+      g_array_append_val (rects, temp);
+      n_rects++;
     }
-  if (BOX_BOTTOM (*rect) > BOX_BOTTOM (*overlap))
-    {
-      temp = g_new (MtkRectangle, 1);
-      temp->x      = overlap->x;
-      temp->width  = overlap->width;
-      temp->y      = BOX_BOTTOM (*overlap);
-      temp->height = BOX_BOTTOM (*rect) - BOX_BOTTOM (*overlap);
-      ret = g_list_prepend (ret, temp);
-    }
-
-  return ret;
-}
-
-static GList*
-replace_rect_with_list (GList *old_element,
-                        GList *new_list)
-{
-  GList *ret;
-  g_assert (old_element != NULL);
-
-  if (!new_list)
+  if (BOX_RIGHT (*rect) > BOX_RIGHT (*overlap))
     {
-      /* If there is no new list, just remove the old_element */
-      ret = g_list_remove_link (old_element, old_element);
+      temp = *rect;
+      temp.x = BOX_RIGHT (*overlap);
+      temp.width = BOX_RIGHT (*rect) - BOX_RIGHT (*overlap);
+      g_array_append_val (rects, temp);
+      n_rects++;
     }
-  else
+  if (BOX_LEFT (*rect) < BOX_LEFT (*overlap))
     {
-      /* Fix up the prev and next pointers everywhere */
-      ret = new_list;
-      if (old_element->prev)
-        {
-          old_element->prev->next = new_list;
-          new_list->prev = old_element->prev;
-        }
-      if (old_element->next)
-        {
-          GList *tmp = g_list_last (new_list);
-          old_element->next->prev = tmp;
-          tmp->next = old_element->next;
-        }
+      temp = *rect;
+      temp.width = BOX_LEFT (*overlap) - BOX_LEFT (*rect);
+      g_array_append_val (rects, temp);
+      n_rects++;
     }
 
-  /* Free the old_element and return the appropriate "next" point */
-  g_free (old_element->data);
-  g_list_free_1 (old_element);
-  return ret;
+  return n_rects;
 }
 
 /* Make a copy of the strut list, make sure that copy only contains parts
@@ -1115,24 +1149,23 @@ replace_rect_with_list (GList *old_element,
  * that aren't disjoint in a way that the overlapping part is only included
  * once, so it's not really magic...).
  */
-static GList*
+static GArray *
 get_disjoint_strut_rect_list_in_region (const GSList       *old_struts,
                                         const MtkRectangle *region)
 {
-  GList *strut_rects;
-  GList *tmp;
+  GArray *strut_rects;
+  GArray *leftovers;
+  unsigned int i, j;
 
-  /* First, copy the list */
-  strut_rects = NULL;
+  /* First, copy the list, in reverse order as it always was */
+  strut_rects = g_array_sized_new (FALSE, FALSE, sizeof (MtkRectangle), 8);
   while (old_struts)
     {
       MtkRectangle *cur = &((MetaStrut*)old_struts->data)->rect;
-      MtkRectangle *copy = g_new (MtkRectangle, 1);
-      *copy = *cur;
-      if (mtk_rectangle_intersect (copy, region, copy))
-        strut_rects = g_list_prepend (strut_rects, copy);
-      else
-        g_free (copy);
+      MtkRectangle copy;
+
+      if (mtk_rectangle_intersect (cur, region, &copy))
+        g_array_prepend_val (strut_rects, copy);
 
       old_struts = old_struts->next;
     }
@@ -1140,53 +1173,51 @@ get_disjoint_strut_rect_list_in_region (const GSList       *old_struts,
   /* Now, loop over the list and check for intersections, fixing things up
    * where they do intersect.
    */
-  tmp = strut_rects;
-  while (tmp)
+  leftovers = g_array_sized_new (FALSE, FALSE, sizeof (MtkRectangle), 8);
+  for (i = 0; i < strut_rects->len; i++)
     {
-      GList *compare;
-
-      MtkRectangle *cur = tmp->data;
-
-      compare = tmp->next;
-      while (compare)
+      j = i + 1;
+      while (j < strut_rects->len)
         {
-          MtkRectangle *comp = compare->data;
+          MtkRectangle cur = g_array_index (strut_rects, MtkRectangle, i);
+          MtkRectangle comp = g_array_index (strut_rects, MtkRectangle, j);
           MtkRectangle overlap;
+          int n_cur_leftovers, n_comp_leftovers;
 
-          if (mtk_rectangle_intersect (cur, comp, &overlap))
+          if (!mtk_rectangle_intersect (&cur, &comp, &overlap))
             {
-              /* Get a list of rectangles for each strut that don't overlap
-               * the intersection region.
-               */
-              GList *cur_leftover  = get_rect_minus_overlap (tmp,  &overlap);
-              GList *comp_leftover = get_rect_minus_overlap (compare, &overlap);
-
-              /* Add the intersection region to cur_leftover */
-              MtkRectangle *overlap_allocated = g_new (MtkRectangle, 1);
-              *overlap_allocated = overlap;
-              cur_leftover = g_list_prepend (cur_leftover, overlap_allocated);
-
-              /* Fix up tmp, compare, and cur -- maybe struts too */
-              if (strut_rects == tmp)
-                {
-                  strut_rects = replace_rect_with_list (tmp, cur_leftover);
-                  tmp = strut_rects;
-                }
-              else
-                tmp   = replace_rect_with_list (tmp,     cur_leftover);
-              compare = replace_rect_with_list (compare, comp_leftover);
-
-              if (compare == NULL)
-                break;
-
-              cur = tmp->data;
+              j++;
+              continue;
             }
 
-          compare = compare->next;
+          /* Replace cur by the intersection region followed by the parts
+           * of cur that don't overlap it, and comp by the parts of comp
+           * that don't overlap it.
+           */
+          g_array_set_size (leftovers, 0);
+          n_comp_leftovers = append_rect_minus_overlap (leftovers,
+                                                        &comp, &overlap);
+          n_cur_leftovers = append_rect_minus_overlap (leftovers,
+                                                       &cur, &overlap);
+
+          g_array_remove_index (strut_rects, j);
+          g_array_insert_vals (strut_rects, j,
+                               leftovers->data, n_comp_leftovers);
+
+          g_array_index (strut_rects, MtkRectangle, i) = overlap;
+          g_array_insert_vals (strut_rects, i + 1,
+                               &g_array_index (leftovers, MtkRectangle,
+                                               n_comp_leftovers),
+                               n_cur_leftovers);
+          j += n_cur_leftovers;
+
+          /* Carry on after the first rectangle that replaced comp, or
+           * after the one that followed it if nothing did, as the list
+           * based version of this always has. */
+          j++;
         }
-
-      tmp = tmp->next;
     }
+  g_array_free (leftovers, TRUE);
 
   return strut_rects;
 }
@@ -1353,162 +1384,179 @@ rectangle_and_edge_intersection (const MtkRectangle *rect,
   return intersect;
 }
 
-/* Add all edges of the given rect to cur_edges and return the result.  If
- * rect_is_internal is false, the side types are switched (LEFT<->RIGHT and
- * TOP<->BOTTOM).
+/* Append all edges of the given rect to edges.  If rect_is_internal is
+ * false, the side types are switched (LEFT<->RIGHT and TOP<->BOTTOM).
  */
-static GList*
-add_edges (GList              *cur_edges,
+static void
+add_edges (GArray             *edges,
            const MtkRectangle *rect,
            gboolean            rect_is_internal)
 {
-  MetaEdge *temp_edge;
+  MetaEdge temp_edge;
   int i;
 
   for (i=0; i<4; i++)
     {
-      temp_edge = g_new (MetaEdge, 1);
-      temp_edge->rect = *rect;
+      temp_edge.rect = *rect;
       switch (i)
         {
         case 0:
-          temp_edge->side_type =
+          temp_edge.side_type =
             rect_is_internal ? META_SIDE_LEFT : META_SIDE_RIGHT;
-          temp_edge->rect.width = 0;
+          temp_edge.rect.width = 0;
           break;
         case 1:
-          temp_edge->side_type =
+          temp_edge.side_type =
             rect_is_internal ? META_SIDE_RIGHT : META_SIDE_LEFT;
-          temp_edge->rect.x     += temp_edge->rect.width;
-          temp_edge->rect.width  = 0;
+          temp_edge.rect.x     += temp_edge.rect.width;
+          temp_edge.rect.width  = 0;
           break;
         case 2:
-          temp_edge->side_type =
+          temp_edge.side_type =
             rect_is_internal ? META_SIDE_TOP : META_SIDE_BOTTOM;
-          temp_edge->rect.height = 0;
+          temp_edge.rect.height = 0;
           break;
         case 3:
-          temp_edge->side_type =
+          temp_edge.side_type =
             rect_is_internal ? META_SIDE_BOTTOM : META_SIDE_TOP;
-          temp_edge->rect.y      += temp_edge->rect.height;
-          temp_edge->rect.height  = 0;
+          temp_edge.rect.y      += temp_edge.rect.height;
+          temp_edge.rect.height  = 0;
           break;
         }
-      temp_edge->edge_type = META_EDGE_SCREEN;
-      cur_edges = g_list_prepend (cur_edges, temp_edge);
+      temp_edge.edge_type = META_EDGE_SCREEN;
+      g_array_append_val (edges, temp_edge);
     }
-
-  return cur_edges;
 }
 
-/* Remove any part of old_edge that intersects remove and add any resulting
- * edges to cur_list.  Return cur_list when finished.
+/* Remove any part of old_edge that intersects remove and append any
+ * resulting edges to edges.
  */
-static GList*
-split_edge (GList          *cur_list,
-            const MetaEdge *old_edge,
-            const MetaEdge *remove)
+static void
+split_edge_into_array (GArray         *edges,
+                       MetaEdge        old_edge,
+                       const MetaEdge *remove)
 {
-  MetaEdge *temp_edge;
-  switch (old_edge->side_type)
+  MetaEdge temp_edge;
+
+  switch (old_edge.side_type)
     {
     case META_SIDE_LEFT:
     case META_SIDE_RIGHT:
-      g_assert (mtk_rectangle_vert_overlap (&old_edge->rect, &remove->rect));
-      if (BOX_TOP (old_edge->rect)  < BOX_TOP (remove->rect))
+      g_assert (mtk_rectangle_vert_overlap (&old_edge.rect, &remove->rect));
+      if (BOX_TOP (old_edge.rect)  < BOX_TOP (remove->rect))
         {
-          temp_edge = g_new (MetaEdge, 1);
-          *temp_edge = *old_edge;
-          temp_edge->rect.height = BOX_TOP (remove->rect)
-                                   - BOX_TOP (old_edge->rect);
-          cur_list = g_list_prepend (cur_list, temp_edge);
+          temp_edge = old_edge;
+          temp_edge.rect.height = BOX_TOP (remove->rect)
+                                  - BOX_TOP (old_edge.rect);
+          g_array_append_val (edges, temp_edge);
         }
-      if (BOX_BOTTOM (old_edge->rect) > BOX_BOTTOM (remove->rect))
+      if (BOX_BOTTOM (old_edge.rect) > BOX_BOTTOM (remove->rect))
         {
-          temp_edge = g_new (MetaEdge, 1);
-          *temp_edge = *old_edge;
-          temp_edge->rect.y = BOX_BOTTOM (remove->rect);
-          temp_edge->rect.height = BOX_BOTTOM (old_edge->rect)
-                                   - BOX_BOTTOM (remove->rect);
-          cur_list = g_list_prepend (cur_list, temp_edge);
+          temp_edge = old_edge;
+          temp_edge.rect.y = BOX_BOTTOM (remove->rect);
+          temp_edge.rect.height = BOX_BOTTOM (old_edge.rect)
+                                  - BOX_BOTTOM (remove->rect);
+          g_array_append_val (edges, temp_edge);
         }
       break;
     case META_SIDE_TOP:
     case META_SIDE_BOTTOM:
-      g_assert (mtk_rectangle_horiz_overlap (&old_edge->rect, &remove->rect));
-      if (BOX_LEFT (old_edge->rect)  < BOX_LEFT (remove->rect))
+      g_assert (mtk_rectangle_horiz_overlap (&old_edge.rect, &remove->rect));
+      if (BOX_LEFT (old_edge.rect)  < BOX_LEFT (remove->rect))
         {
-          temp_edge = g_new (MetaEdge, 1);
-          *temp_edge = *old_edge;
-          temp_edge->rect.width = BOX_LEFT (remove->rect)
-                                  - BOX_LEFT (old_edge->rect);
-          cur_list = g_list_prepend (cur_list, temp_edge);
+          temp_edge = old_edge;
+          temp_edge.rect.width = BOX_LEFT (remove->rect)
+                                 - BOX_LEFT (old_edge.rect);
+          g_array_append_val (edges, temp_edge);
         }
-      if (BOX_RIGHT (old_edge->rect) > BOX_RIGHT (remove->rect))
+      if (BOX_RIGHT (old_edge.rect) > BOX_RIGHT (remove->rect))
         {
-          temp_edge = g_new (MetaEdge, 1);
-          *temp_edge = *old_edge;
-          temp_edge->rect.x = BOX_RIGHT (remove->rect);
-          temp_edge->rect.width = BOX_RIGHT (old_edge->rect)
-                                  - BOX_RIGHT (remove->rect);
-          cur_list = g_list_prepend (cur_list, temp_edge);
+          temp_edge = old_edge;
+          temp_edge.rect.x = BOX_RIGHT (remove->rect);
+          temp_edge.rect.width = BOX_RIGHT (old_edge.rect)
+                                 - BOX_RIGHT (remove->rect);
+          g_array_append_val (edges, temp_edge);
         }
       break;
     default:
       g_assert_not_reached ();
     }
+}
+
+/* Remove any part of old_edge that intersects remove and add any resulting
+ * edges to cur_list.  Return cur_list when finished.
+ */
+static GList*
+split_edge (GList          *cur_list,
+            const MetaEdge *old_edge,
+            const MetaEdge *remove)
+{
+  g_autoptr (GArray) edge_splits = NULL;
+  unsigned int i;
+
+  edge_splits = g_array_sized_new (FALSE, FALSE, sizeof (MetaEdge), 2);
+  split_edge_into_array (edge_splits, *old_edge, remove);
+
+  for (i = 0; i < edge_splits->len; i++)
+    {
+      MetaEdge *temp_edge = g_new (MetaEdge, 1);
+
+      *temp_edge = g_array_index (edge_splits, MetaEdge, i);
+      cur_list = g_list_prepend (cur_list, temp_edge);
+    }
 
   return cur_list;
 }
 
 /* Split up edge and remove preliminary edges from strut_edges depending on
- * if and how rect and edge intersect.
+ * if and how rect and edge intersect. Returns whether edge needs to be
+ * replaced by the parts appended to edge_splits.
+ *
+ * Like in meta_rectangle_find_onscreen_edges(), strut_edges is in reverse
+ * order.
  */
-static void
-fix_up_edges (MtkRectangle *rect,
-              MetaEdge     *edge,
-              GList       **strut_edges,
-              GList       **edge_splits,
-              gboolean     *edge_needs_removal)
+static gboolean
+fix_up_edges (const MtkRectangle *rect,
+              const MetaEdge     *edge,
+              GArray             *strut_edges,
+              GArray             *edge_splits)
 {
   MetaEdge overlap;
   int      handle_type;
+  gboolean edge_needs_removal = FALSE;
 
   if (!rectangle_and_edge_intersection (rect, edge, &overlap, &handle_type))
-    return;
+    return FALSE;
 
   if (handle_type == 0 || handle_type == 1)
     {
       /* Put the result of removing overlap from edge into edge_splits */
-      *edge_splits = split_edge (*edge_splits, edge, &overlap);
-      *edge_needs_removal = TRUE;
+      split_edge_into_array (edge_splits, *edge, &overlap);
+      edge_needs_removal = TRUE;
     }
 
   if (handle_type == -1 || handle_type == 1)
     {
       /* Remove the overlap from strut_edges */
+      int i;
+
       /* First, loop over the edges of the strut */
-      GList *tmp = *strut_edges;
-      while (tmp)
+      for (i = strut_edges->len - 1; i >= 0; i--)
         {
-          MetaEdge *cur = tmp->data;
+          MetaEdge cur = g_array_index (strut_edges, MetaEdge, i);
+
           /* If this is the edge that overlaps, then we need to split it */
-          if (edges_overlap (cur, &overlap))
+          if (edges_overlap (&cur, &overlap))
             {
-              GList *delete_me = tmp;
-
-              /* Split this edge into some new ones */
-              *strut_edges = split_edge (*strut_edges, cur, &overlap);
-
-              /* Delete the old one */
-              tmp = tmp->next;
-              g_free (cur);
-              *strut_edges = g_list_delete_link (*strut_edges, delete_me);
+              /* Split this edge into some new ones, and delete the old
+               * one */
+              split_edge_into_array (strut_edges, cur, &overlap);
+              g_array_remove_index (strut_edges, i);
             }
-          else
-            tmp = tmp->next;
         }
     }
+
+  return edge_needs_removal;
 }
 
 /**
@@ -1589,10 +1637,13 @@ GList*
 meta_rectangle_find_onscreen_edges (const MtkRectangle *basic_rect,
                                     const GSList       *all_struts)
 {
+  GArray       *edges;
+  GArray       *strut_edges;
+  GArray       *edge_splits;
+  GArray       *fixed_strut_rects;
   GList        *ret;
-  GList        *fixed_strut_rects;
-  GList        *edge_iter;
-  const GList  *strut_rect_iter;
+  unsigned int  i;
+  int           j;
 
   /* The algorithm is basically as follows:
    *   Make sure the struts are disjoint
@@ -1607,6 +1658,10 @@ meta_rectangle_find_onscreen_edges (const MtkRectangle *basic_rect,
    *         edge_set and the preliminary edge for the strut will need to
    *         be split
    *     Add any remaining "preliminary" strut edges to the edge_set
+   *
+   * New edges have always been put in front of the edge set, so the edge
+   * arrays are kept in reverse order, and walked backwards; that way
+   * adding an edge is appending to an array.
    */
 
   /* Make sure the struts are disjoint */
@@ -1614,55 +1669,56 @@ meta_rectangle_find_onscreen_edges (const MtkRectangle *basic_rect,
     get_disjoint_strut_rect_list_in_region (all_struts, basic_rect);
 
   /* Start off the list with the edges of basic_rect */
-  ret = add_edges (NULL, basic_rect, TRUE);
+  edges = g_array_sized_new (FALSE, FALSE, sizeof (MetaEdge), 32);
+  add_edges (edges, basic_rect, TRUE);
 
-  strut_rect_iter = fixed_strut_rects;
-  while (strut_rect_iter)
+  strut_edges = g_array_sized_new (FALSE, FALSE, sizeof (MetaEdge), 8);
+  edge_splits = g_array_sized_new (FALSE, FALSE, sizeof (MetaEdge), 8);
+
+  for (i = 0; i < fixed_strut_rects->len; i++)
     {
-      MtkRectangle *strut_rect = (MtkRectangle*) strut_rect_iter->data;
+      MtkRectangle *strut_rect =
+        &g_array_index (fixed_strut_rects, MtkRectangle, i);
 
       /* Get the new possible edges we may need to add from the strut */
-      GList *new_strut_edges = add_edges (NULL, strut_rect, FALSE);
+      g_array_set_size (strut_edges, 0);
+      add_edges (strut_edges, strut_rect, FALSE);
 
-      edge_iter = ret;
-      while (edge_iter)
+      for (j = edges->len - 1; j >= 0; j--)
         {
-          MetaEdge *cur_edge = edge_iter->data;
-          GList *splits_of_cur_edge = NULL;
-          gboolean edge_needs_removal = FALSE;
+          MetaEdge *cur_edge = &g_array_index (edges, MetaEdge, j);
 
-          fix_up_edges (strut_rect,       cur_edge,
-                        &new_strut_edges, &splits_of_cur_edge,
-                        &edge_needs_removal);
-
-          if (edge_needs_removal)
-            {
-              /* Delete the old edge */
-              GList *delete_me = edge_iter;
-              edge_iter = edge_iter->next;
-              g_free (cur_edge);
-              ret = g_list_delete_link (ret, delete_me);
-
-              /* Add the new split parts of the edge */
-              ret = g_list_concat (splits_of_cur_edge, ret);
-            }
-          else
+          g_array_set_size (edge_splits, 0);
+          if (fix_up_edges (strut_rect, cur_edge, strut_edges, edge_splits))
             {
-              edge_iter = edge_iter->next;
+              /* Replace the old edge by its split parts, which need not
+               * be looked at again for this strut */
+              g_array_append_vals (edges, edge_splits->data, edge_splits->len);
+              g_array_remove_index (edges, j);
             }
-
-          /* edge_iter was already advanced above */
         }
 
-      ret = g_list_concat (new_strut_edges, ret);
-      strut_rect_iter = strut_rect_iter->next;
+      g_array_append_vals (edges, strut_edges->data, strut_edges->len);
     }
 
-  /* Sort the list */
-  ret = g_list_sort (ret, meta_rectangle_edge_cmp);
+  /* Sort the edges; the sort is stable, so restore the list order first */
+  for (i = 0; i < edges->len / 2; i++)
+    {
+      MetaEdge *a = &g_array_index (edges, MetaEdge, i);
+      MetaEdge *b = &g_array_index (edges, MetaEdge, edges->len - 1 - i);
+      MetaEdge tmp = *a;
+
+      *a = *b;
+      *b = tmp;
+    }
+  g_array_sort (edges, meta_rectangle_edge_cmp);
+
+  ret = edge_array_to_list (edges);
 
-  /* Free the fixed struts list */
-  meta_rectangle_free_list_and_elements (fixed_strut_rects);
+  g_array_free (edges, TRUE);
+  g_array_free (strut_edges, TRUE);
+  g_array_free (edge_splits, TRUE);
+  g_array_free (fixed_strut_rects, TRUE);
 
   return ret;
 }
@@ -45,6 +45,8 @@
 #define CASCADE_FUZZ 15
 /* space between top-left corners of cascades */
 #define CASCADE_INTERVAL 50
+/* size of the cells of the occupancy grid used for first fit placement */
+#define PLACEMENT_GRID_CELL_SIZE 16
 
 typedef enum
 {
@@ -500,104 +502,321 @@ avoid_being_obscured_as_second_modal_dialog (MetaWindow    *window,
     }
 }
 
+/* Coarse occupancy grid over a work area, used to test candidate
+ * placements against the windows already there without walking all of
+ * them. Each table is a summed-area table over the grid cells, counting
+ * the cells touched by some window, and the cells entirely covered by
+ * some window respectively.
+ */
+typedef struct
+{
+  MtkRectangle area;
+  int columns;
+  int rows;
+  int *touched;
+  int *covered;
+  /* Window frame rects, clipped to the area */
+  GArray *rects;
+} PlacementGrid;
+
 static gboolean
-rectangle_overlaps_some_window (MtkRectangle *rect,
-                                GList        *windows)
+window_blocks_placement (MetaWindow *window)
 {
-  GList *tmp;
-  MtkRectangle dest;
+  switch (window->type)
+    {
+    case META_WINDOW_DOCK:
+    case META_WINDOW_SPLASHSCREEN:
+    case META_WINDOW_DESKTOP:
+    case META_WINDOW_DIALOG:
+    case META_WINDOW_MODAL_DIALOG:
+    /* override redirect window types: */
+    case META_WINDOW_DROPDOWN_MENU:
+    case META_WINDOW_POPUP_MENU:
+    case META_WINDOW_TOOLTIP:
+    case META_WINDOW_NOTIFICATION:
+    case META_WINDOW_COMBO:
+    case META_WINDOW_DND:
+    case META_WINDOW_OVERRIDE_OTHER:
+      return FALSE;
 
-  tmp = windows;
-  while (tmp != NULL)
+    case META_WINDOW_NORMAL:
+    case META_WINDOW_UTILITY:
+    case META_WINDOW_TOOLBAR:
+    case META_WINDOW_MENU:
+      return TRUE;
+    }
+
+  return FALSE;
+}
+
+static inline int
+placement_grid_index (PlacementGrid *grid,
+                      int            column,
+                      int            row)
+{
+  return row * (grid->columns + 1) + column;
+}
+
+static void
+placement_grid_mark (PlacementGrid *grid,
+                     int           *table,
+                     int            first_column,
+                     int            first_row,
+                     int            last_column,
+                     int            last_row)
+{
+  if (first_column > last_column || first_row > last_row)
+    return;
+
+  /* Mark the corners of the cell range; integrating the table afterwards
+   * yields the number of ranges covering each cell. */
+  table[placement_grid_index (grid, first_column, first_row)]++;
+  table[placement_grid_index (grid, last_column + 1, first_row)]--;
+  table[placement_grid_index (grid, first_column, last_row + 1)]--;
+  table[placement_grid_index (grid, last_column + 1, last_row + 1)]++;
+}
+
+static void
+placement_grid_integrate (PlacementGrid *grid,
+                          int           *table)
+{
+  int stride = grid->columns + 1;
+  int column, row;
+
+  /* Turn the range corners into per cell counts... */
+  for (row = 0; row < grid->rows; row++)
     {
-      MetaWindow *other = tmp->data;
-      MtkRectangle other_rect;
+      for (column = 0; column < grid->columns; column++)
+        {
+          int i = placement_grid_index (grid, column, row);
+
+          if (column > 0)
+            table[i] += table[i - 1];
+          if (row > 0)
+            table[i] += table[i - stride];
+          if (column > 0 && row > 0)
+            table[i] -= table[i - stride - 1];
+        }
+    }
 
-      switch (other->type)
+  /* ...then into occupied cells, and shift them by one cell so that the
+   * summed-area table has a zero first row and column. */
+  for (row = grid->rows - 1; row >= 0; row--)
+    {
+      for (column = grid->columns - 1; column >= 0; column--)
         {
-        case META_WINDOW_DOCK:
-        case META_WINDOW_SPLASHSCREEN:
-        case META_WINDOW_DESKTOP:
-        case META_WINDOW_DIALOG:
-        case META_WINDOW_MODAL_DIALOG:
-        /* override redirect window types: */
-        case META_WINDOW_DROPDOWN_MENU:
-        case META_WINDOW_POPUP_MENU:
-        case META_WINDOW_TOOLTIP:
-        case META_WINDOW_NOTIFICATION:
-        case META_WINDOW_COMBO:
-        case META_WINDOW_DND:
-        case META_WINDOW_OVERRIDE_OTHER:
-          break;
+          table[placement_grid_index (grid, column + 1, row + 1)] =
+            table[placement_grid_index (grid, column, row)] > 0;
+        }
+    }
 
-        case META_WINDOW_NORMAL:
-        case META_WINDOW_UTILITY:
-        case META_WINDOW_TOOLBAR:
-        case META_WINDOW_MENU:
-          meta_window_get_frame_rect (other, &other_rect);
+  for (column = 0; column <= grid->columns; column++)
+    table[placement_grid_index (grid, column, 0)] = 0;
+  for (row = 0; row <= grid->rows; row++)
+    table[placement_grid_index (grid, 0, row)] = 0;
 
-          if (mtk_rectangle_intersect (rect, &other_rect, &dest))
-            return TRUE;
-          break;
-        }
+  for (row = 1; row <= grid->rows; row++)
+    {
+      for (column = 1; column <= grid->columns; column++)
+        {
+          int i = placement_grid_index (grid, column, row);
 
-      tmp = tmp->next;
+          table[i] += table[i - 1] + table[i - stride] - table[i - stride - 1];
+        }
     }
+}
 
-  return FALSE;
+static int
+placement_grid_count (PlacementGrid *grid,
+                      int           *table,
+                      int            first_column,
+                      int            first_row,
+                      int            last_column,
+                      int            last_row)
+{
+  if (first_column > last_column || first_row > last_row)
+    return 0;
+
+  return (table[placement_grid_index (grid, last_column + 1, last_row + 1)] -
+          table[placement_grid_index (grid, first_column, last_row + 1)] -
+          table[placement_grid_index (grid, last_column + 1, first_row)] +
+          table[placement_grid_index (grid, first_column, first_row)]);
 }
 
-static gint
-leftmost_cmp (gconstpointer a,
-              gconstpointer b)
+/* Cells are PLACEMENT_GRID_CELL_SIZE wide and high, except for the last
+ * column and row which are clipped to the area. Given a span relative to
+ * the area, find the cells it touches and the cells it entirely covers.
+ */
+static void
+placement_grid_get_cell_span (int  start,
+                              int  length,
+                              int  area_length,
+                              int  n_cells,
+                              int *first_touched,
+                              int *last_touched,
+                              int *first_covered,
+                              int *last_covered)
 {
-  MetaWindow *aw = (gpointer) a;
-  MetaWindow *bw = (gpointer) b;
-  MtkRectangle a_frame;
-  MtkRectangle b_frame;
-  int ax, bx;
+  int end = start + length;
 
-  meta_window_get_frame_rect (aw, &a_frame);
-  meta_window_get_frame_rect (bw, &b_frame);
-  ax = a_frame.x;
-  bx = b_frame.x;
+  *first_touched = start / PLACEMENT_GRID_CELL_SIZE;
+  *last_touched = (end - 1) / PLACEMENT_GRID_CELL_SIZE;
 
-  if (ax < bx)
-    return -1;
-  else if (ax > bx)
-    return 1;
+  *first_covered = (start + PLACEMENT_GRID_CELL_SIZE - 1) /
+                   PLACEMENT_GRID_CELL_SIZE;
+  if (end == area_length)
+    *last_covered = n_cells - 1;
   else
-    return 0;
+    *last_covered = end / PLACEMENT_GRID_CELL_SIZE - 1;
+}
+
+static void
+placement_grid_init (PlacementGrid *grid,
+                     MtkRectangle  *area,
+                     GList         *windows)
+{
+  GList *l;
+  int n_entries;
+  guint i;
+
+  grid->area = *area;
+  grid->columns = MAX ((area->width + PLACEMENT_GRID_CELL_SIZE - 1) /
+                       PLACEMENT_GRID_CELL_SIZE, 1);
+  grid->rows = MAX ((area->height + PLACEMENT_GRID_CELL_SIZE - 1) /
+                    PLACEMENT_GRID_CELL_SIZE, 1);
+  grid->rects = g_array_new (FALSE, FALSE, sizeof (MtkRectangle));
+
+  n_entries = (grid->columns + 1) * (grid->rows + 1);
+  grid->touched = g_new0 (int, n_entries);
+  grid->covered = g_new0 (int, n_entries);
+
+  for (l = windows; l; l = l->next)
+    {
+      MetaWindow *other = l->data;
+      MtkRectangle frame_rect;
+      MtkRectangle rect;
+
+      if (!window_blocks_placement (other))
+        continue;
+
+      meta_window_get_frame_rect (other, &frame_rect);
+      if (!mtk_rectangle_intersect (&frame_rect, area, &rect))
+        continue;
+
+      g_array_append_val (grid->rects, rect);
+    }
+
+  for (i = 0; i < grid->rects->len; i++)
+    {
+      MtkRectangle *rect = &g_array_index (grid->rects, MtkRectangle, i);
+      int first_column, last_column, first_covered_column, last_covered_column;
+      int first_row, last_row, first_covered_row, last_covered_row;
+
+      placement_grid_get_cell_span (rect->x - area->x, rect->width,
+                                    area->width, grid->columns,
+                                    &first_column, &last_column,
+                                    &first_covered_column,
+                                    &last_covered_column);
+      placement_grid_get_cell_span (rect->y - area->y, rect->height,
+                                    area->height, grid->rows,
+                                    &first_row, &last_row,
+                                    &first_covered_row, &last_covered_row);
+
+      placement_grid_mark (grid, grid->touched,
+                           first_column, first_row,
+                           last_column, last_row);
+      placement_grid_mark (grid, grid->covered,
+                           first_covered_column, first_covered_row,
+                           last_covered_column, last_covered_row);
+    }
+
+  placement_grid_integrate (grid, grid->touched);
+  placement_grid_integrate (grid, grid->covered);
+}
+
+static void
+placement_grid_clear (PlacementGrid *grid)
+{
+  g_clear_pointer (&grid->touched, g_free);
+  g_clear_pointer (&grid->covered, g_free);
+  g_clear_pointer (&grid->rects, g_array_unref);
+}
+
+/* rect must be contained in the area of the grid */
+static gboolean
+placement_grid_overlaps (PlacementGrid *grid,
+                         MtkRectangle  *rect)
+{
+  int first_column, last_column, first_covered_column, last_covered_column;
+  int first_row, last_row, first_covered_row, last_covered_row;
+  guint i;
+
+  placement_grid_get_cell_span (rect->x - grid->area.x, rect->width,
+                                grid->area.width, grid->columns,
+                                &first_column, &last_column,
+                                &first_covered_column, &last_covered_column);
+  placement_grid_get_cell_span (rect->y - grid->area.y, rect->height,
+                                grid->area.height, grid->rows,
+                                &first_row, &last_row,
+                                &first_covered_row, &last_covered_row);
+
+  if (placement_grid_count (grid, grid->touched,
+                            first_column, first_row,
+                            last_column, last_row) == 0)
+    return FALSE;
+
+  if (placement_grid_count (grid, grid->covered,
+                            first_covered_column, first_covered_row,
+                            last_covered_column, last_covered_row) > 0)
+    return TRUE;
+
+  /* Only partially covered cells are involved, so the grid can't tell */
+  for (i = 0; i < grid->rects->len; i++)
+    {
+      MtkRectangle *other_rect = &g_array_index (grid->rects, MtkRectangle, i);
+      MtkRectangle dest;
+
+      if (mtk_rectangle_intersect (rect, other_rect, &dest))
+        return TRUE;
+    }
+
+  return FALSE;
 }
 
 static gint
-rightmost_cmp (gconstpointer a,
-               gconstpointer b)
+below_cmp (gconstpointer a,
+           gconstpointer b,
+           gpointer      user_data)
 {
-  return -leftmost_cmp (a, b);
+  const MtkRectangle *a_frame = a;
+  const MtkRectangle *b_frame = b;
+  gboolean ltr = GPOINTER_TO_INT (user_data);
+
+  if (a_frame->y != b_frame->y)
+    return a_frame->y < b_frame->y ? -1 : 1;
+
+  if (a_frame->x != b_frame->x)
+    return (a_frame->x < b_frame->x) == ltr ? -1 : 1;
+
+  return 0;
 }
 
 static gint
-topmost_cmp (gconstpointer a,
-             gconstpointer b)
+end_cmp (gconstpointer a,
+         gconstpointer b,
+         gpointer      user_data)
 {
-  MetaWindow *aw = (gpointer) a;
-  MetaWindow *bw = (gpointer) b;
-  MtkRectangle a_frame;
-  MtkRectangle b_frame;
-  int ay, by;
+  const MtkRectangle *a_frame = a;
+  const MtkRectangle *b_frame = b;
+  gboolean ltr = GPOINTER_TO_INT (user_data);
 
-  meta_window_get_frame_rect (aw, &a_frame);
-  meta_window_get_frame_rect (bw, &b_frame);
-  ay = a_frame.y;
-  by = b_frame.y;
+  if (a_frame->x != b_frame->x)
+    return (a_frame->x < b_frame->x) == ltr ? -1 : 1;
 
-  if (ay < by)
-    return -1;
-  else if (ay > by)
-    return 1;
-  else
-    return 0;
+  if (a_frame->y != b_frame->y)
+    return a_frame->y < b_frame->y ? -1 : 1;
+
+  return 0;
 }
 
 static void
@@ -647,9 +866,11 @@ find_first_fit (MetaWindow         *window,
    * existing window in each of those cases.
    */
   int retval;
-  GList *below_sorted;
-  GList *end_sorted;
-  GList *tmp;
+  g_autoptr (GArray) below_sorted = NULL;
+  g_autoptr (GArray) end_sorted = NULL;
+  PlacementGrid grid;
+  GList *l;
+  guint i;
   MtkRectangle rect = MTK_RECTANGLE_INIT (0, 0, width, height);
   MtkRectangle work_area;
   gboolean ltr = clutter_get_text_direction () == CLUTTER_TEXT_DIRECTION_LTR;
@@ -657,14 +878,20 @@ find_first_fit (MetaWindow         *window,
   retval = FALSE;
 
   /* Below each window */
-  below_sorted = g_list_copy (windows);
-  below_sorted = g_list_sort (below_sorted, ltr ? leftmost_cmp : rightmost_cmp);
-  below_sorted = g_list_sort (below_sorted, topmost_cmp);
+  below_sorted = g_array_new (FALSE, FALSE, sizeof (MtkRectangle));
+  for (l = windows; l; l = l->next)
+    {
+      MtkRectangle frame_rect;
+
+      meta_window_get_frame_rect (l->data, &frame_rect);
+      g_array_append_val (below_sorted, frame_rect);
+    }
 
   /* To the right of each window */
-  end_sorted = g_list_copy (windows);
-  end_sorted = g_list_sort (end_sorted, topmost_cmp);
-  end_sorted = g_list_sort (end_sorted, ltr ? leftmost_cmp : rightmost_cmp);
+  end_sorted = g_array_copy (below_sorted);
+
+  g_array_sort_with_data (below_sorted, below_cmp, GINT_TO_POINTER (ltr));
+  g_array_sort_with_data (end_sorted, end_cmp, GINT_TO_POINTER (ltr));
 
 #ifdef WITH_VERBOSE_MODE
   {
@@ -682,10 +909,12 @@ find_first_fit (MetaWindow         *window,
                                                  logical_monitor,
                                                  &work_area);
 
+  placement_grid_init (&grid, &work_area, windows);
+
   center_tile_rect_in_area (&rect, &work_area);
 
   if (mtk_rectangle_contains_rect (&work_area, &rect) &&
-      !rectangle_overlaps_some_window (&rect, windows))
+      !placement_grid_overlaps (&grid, &rect))
     {
       *new_x = rect.x;
       *new_y = rect.y;
@@ -696,19 +925,15 @@ find_first_fit (MetaWindow         *window,
     }
 
   /* try below each window */
-  tmp = below_sorted;
-  while (tmp != NULL)
+  for (i = 0; i < below_sorted->len; i++)
     {
-      MetaWindow *w = tmp->data;
-      MtkRectangle frame_rect;
-
-      meta_window_get_frame_rect (w, &frame_rect);
+      MtkRectangle *frame_rect = &g_array_index (below_sorted, MtkRectangle, i);
 
-      rect.x = frame_rect.x;
-      rect.y = frame_rect.y + frame_rect.height;
+      rect.x = frame_rect->x;
+      rect.y = frame_rect->y + frame_rect->height;
 
       if (mtk_rectangle_contains_rect (&work_area, &rect) &&
-          !rectangle_overlaps_some_window (&rect, below_sorted))
+          !placement_grid_overlaps (&grid, &rect))
         {
           *new_x = rect.x;
           *new_y = rect.y;
@@ -717,27 +942,21 @@ find_first_fit (MetaWindow         *window,
 
           goto out;
         }
-
-      tmp = tmp->next;
     }
 
   /* try to the right (or left in RTL environment) of each window */
-  tmp = end_sorted;
-  while (tmp != NULL)
+  for (i = 0; i < end_sorted->len; i++)
     {
-      MetaWindow *w = tmp->data;
-      MtkRectangle frame_rect;
-
-      meta_window_get_frame_rect (w, &frame_rect);
+      MtkRectangle *frame_rect = &g_array_index (end_sorted, MtkRectangle, i);
 
       if (ltr)
-        rect.x = frame_rect.x + frame_rect.width;
+        rect.x = frame_rect->x + frame_rect->width;
       else
-        rect.x = frame_rect.x - rect.width;
-      rect.y = frame_rect.y;
+        rect.x = frame_rect->x - rect.width;
+      rect.y = frame_rect->y;
 
       if (mtk_rectangle_contains_rect (&work_area, &rect) &&
-          !rectangle_overlaps_some_window (&rect, end_sorted))
+          !placement_grid_overlaps (&grid, &rect))
         {
           *new_x = rect.x;
           *new_y = rect.y;
@@ -746,13 +965,10 @@ find_first_fit (MetaWindow         *window,
 
           goto out;
         }
-
-      tmp = tmp->next;
     }
 
 out:
-  g_list_free (below_sorted);
-  g_list_free (end_sorted);
+  placement_grid_clear (&grid);
   return retval;
 }
 
@@ -57,6 +57,7 @@ struct _MetaWorkspace
   GHashTable *logical_monitor_data;
 
   MtkRectangle work_area_screen;
+  MtkRectangle work_areas_display_rect;
   GList  *screen_region;
   GList  *screen_edges;
   GList  *monitor_edges;
@@ -81,15 +82,20 @@ void           meta_workspace_remove_window (MetaWorkspace *workspace,
 void           meta_workspace_relocate_windows (MetaWorkspace *workspace,
                                                 MetaWorkspace *new_home);
 
+META_EXPORT_TEST
 void meta_workspace_get_work_area_for_logical_monitor (MetaWorkspace      *workspace,
                                                        MetaLogicalMonitor *logical_monitor,
                                                        MtkRectangle       *area);
 
+META_EXPORT_TEST
 void meta_workspace_ensure_work_areas_validated (MetaWorkspace *workspace);
 
+META_EXPORT_TEST
 void meta_workspace_invalidate_work_area (MetaWorkspace *workspace);
 
+META_EXPORT_TEST
 GList* meta_workspace_get_onscreen_region       (MetaWorkspace *workspace);
+META_EXPORT_TEST
 GList * meta_workspace_get_onmonitor_region (MetaWorkspace      *workspace,
                                              MetaLogicalMonitor *logical_monitor);
 
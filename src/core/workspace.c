@@ -83,6 +83,11 @@ typedef struct _MetaWorkspaceLogicalMonitorData
 {
   GList *logical_monitor_region;
   MtkRectangle logical_monitor_work_area;
+
+  /* What the region and work area were computed from */
+  MtkRectangle rect;
+  GSList *struts;
+  gboolean computed;
 } MetaWorkspaceLogicalMonitorData;
 
 typedef struct _MetaWorkspaceFocusableAncestorData
@@ -105,6 +110,7 @@ workspace_logical_monitor_data_free (MetaWorkspaceLogicalMonitorData *data)
 {
   g_clear_pointer (&data->logical_monitor_region,
                    meta_rectangle_free_list_and_elements);
+  g_slist_free_full (data->struts, g_free);
   g_free (data);
 }
 
@@ -314,20 +320,10 @@ meta_workspace_remove (MetaWorkspace *workspace)
 
   workspace_free_builtin_struts (workspace);
 
-  /* screen.c:update_num_workspaces(), which calls us, removes windows from
-   * workspaces first, which can cause the workareas on the workspace to be
-   * invalidated (and hence for struts/regions/edges to be freed).
-   * So, no point trying to double free it; that causes a crash
-   * anyway.  #361804.
-   */
-
-  if (!workspace->work_areas_invalid)
-    {
-      workspace_free_all_struts (workspace);
-      meta_rectangle_free_list_and_elements (workspace->screen_region);
-      meta_rectangle_free_list_and_elements (workspace->screen_edges);
-      meta_rectangle_free_list_and_elements (workspace->monitor_edges);
-    }
+  workspace_free_all_struts (workspace);
+  meta_rectangle_free_list_and_elements (workspace->screen_region);
+  meta_rectangle_free_list_and_elements (workspace->screen_edges);
+  meta_rectangle_free_list_and_elements (workspace->monitor_edges);
 
   g_object_unref (workspace);
 
@@ -808,17 +804,9 @@ meta_workspace_invalidate_work_area (MetaWorkspace *workspace)
       workspace == workspace->manager->active_workspace)
     meta_window_drag_update_edges (window_drag);
 
-  meta_workspace_clear_logical_monitor_data (workspace);
-
-  workspace_free_all_struts (workspace);
-
-  meta_rectangle_free_list_and_elements (workspace->screen_region);
-  meta_rectangle_free_list_and_elements (workspace->screen_edges);
-  meta_rectangle_free_list_and_elements (workspace->monitor_edges);
-  workspace->screen_region = NULL;
-  workspace->screen_edges = NULL;
-  workspace->monitor_edges = NULL;
-
+  /* The previously computed regions and edges are kept around, so that
+   * meta_workspace_ensure_work_areas_validated() can reuse the parts that
+   * are not affected by whatever caused the invalidation. */
   workspace->work_areas_invalid = TRUE;
 
   /* redo the size/position constraints on all windows */
@@ -852,80 +840,295 @@ copy_strut_list(GSList *original)
   return g_slist_reverse (result);
 }
 
-void
-meta_workspace_ensure_work_areas_validated (MetaWorkspace *workspace)
+static gboolean
+strut_lists_equal (GSList *l,
+                   GSList *m)
 {
-  MetaContext *context = meta_display_get_context (workspace->display);
-  MetaBackend *backend = meta_context_get_backend (context);
-  MetaMonitorManager *monitor_manager =
-    meta_backend_get_monitor_manager (backend);
-  GList *windows;
-  GList *tmp;
-  GList *logical_monitors, *l;
-  MtkRectangle display_rect = { 0 };
-  MtkRectangle work_area;
+  for (; l && m; l = l->next, m = m->next)
+    {
+      MetaStrut *a = l->data;
+      MetaStrut *b = m->data;
 
-  if (!workspace->work_areas_invalid)
-    return;
+      if (a->side != b->side ||
+          !mtk_rectangle_equal (&a->rect, &b->rect))
+        return FALSE;
+    }
 
-  g_assert (workspace->all_struts == NULL);
-  g_assert (workspace->screen_region == NULL);
-  g_assert (workspace->screen_edges == NULL);
-  g_assert (workspace->monitor_edges == NULL);
+  return l == NULL && m == NULL;
+}
 
-  meta_display_get_size (workspace->display,
-                         &display_rect.width,
-                         &display_rect.height);
+static int
+compare_struts (gconstpointer a,
+                gconstpointer b)
+{
+  const MetaStrut *strut_a = a;
+  const MetaStrut *strut_b = b;
+
+  if (strut_a->side != strut_b->side)
+    return strut_a->side < strut_b->side ? -1 : 1;
+  if (strut_a->rect.x != strut_b->rect.x)
+    return strut_a->rect.x < strut_b->rect.x ? -1 : 1;
+  if (strut_a->rect.y != strut_b->rect.y)
+    return strut_a->rect.y < strut_b->rect.y ? -1 : 1;
+  if (strut_a->rect.width != strut_b->rect.width)
+    return strut_a->rect.width < strut_b->rect.width ? -1 : 1;
+  if (strut_a->rect.height != strut_b->rect.height)
+    return strut_a->rect.height < strut_b->rect.height ? -1 : 1;
+
+  return 0;
+}
 
-  /* STEP 1: Get the list of struts */
+static gpointer
+copy_rectangle (gconstpointer src,
+                gpointer      user_data)
+{
+  return g_memdup2 (src, sizeof (MtkRectangle));
+}
 
-  workspace->all_struts = copy_strut_list (workspace->builtin_struts);
+static gpointer
+copy_edge (gconstpointer src,
+           gpointer      user_data)
+{
+  return g_memdup2 (src, sizeof (MetaEdge));
+}
+
+/* Collects the builtin struts and the struts of all windows on the
+ * workspace. The list is sorted, so that it can be compared with the
+ * struts the work areas were last computed from, no matter in which
+ * order the windows are stacked. */
+static GSList *
+collect_struts (MetaWorkspace *workspace)
+{
+  GSList *struts;
+  GList *windows, *l;
+
+  struts = copy_strut_list (workspace->builtin_struts);
 
   windows = meta_workspace_list_windows (workspace);
-  for (tmp = windows; tmp != NULL; tmp = tmp->next)
+  for (l = windows; l != NULL; l = l->next)
     {
-      MetaWindow *win = tmp->data;
+      MetaWindow *win = l->data;
       GSList *s_iter;
 
-      for (s_iter = win->struts; s_iter != NULL; s_iter = s_iter->next) {
-        workspace->all_struts = g_slist_prepend (workspace->all_struts,
-                                                 copy_strut(s_iter->data));
-      }
+      for (s_iter = win->struts; s_iter != NULL; s_iter = s_iter->next)
+        struts = g_slist_prepend (struts, copy_strut (s_iter->data));
     }
   g_list_free (windows);
 
-  /* STEP 2: Get the maximal/spanning rects for the onscreen and
-   *         on-single-monitor regions
-   */
-  g_assert (workspace->screen_region   == NULL);
+  return g_slist_sort (struts, compare_struts);
+}
+
+/* Struts that don't intersect a rectangle don't take anything away from
+ * it, so only these need to be compared to tell whether the work area of
+ * a logical monitor changed. */
+static GSList *
+get_struts_intersecting_rect (GSList             *struts,
+                              const MtkRectangle *rect)
+{
+  GSList *result = NULL;
+
+  for (; struts != NULL; struts = struts->next)
+    {
+      MetaStrut *strut = struts->data;
+
+      if (mtk_rectangle_overlap (&strut->rect, rect))
+        result = g_slist_prepend (result, copy_strut (strut));
+    }
+
+  return g_slist_reverse (result);
+}
+
+static gboolean
+copy_logical_monitor_data_from_other_workspace (MetaWorkspace                   *workspace,
+                                                MetaLogicalMonitor              *logical_monitor,
+                                                MetaWorkspaceLogicalMonitorData *data)
+{
+  GList *l;
+
+  for (l = workspace->manager->workspaces; l; l = l->next)
+    {
+      MetaWorkspace *other = l->data;
+      MetaWorkspaceLogicalMonitorData *other_data;
+
+      if (other == workspace || other->work_areas_invalid)
+        continue;
+
+      other_data = meta_workspace_get_logical_monitor_data (other,
+                                                            logical_monitor);
+      if (!other_data ||
+          !mtk_rectangle_equal (&other_data->rect, &data->rect) ||
+          !strut_lists_equal (other_data->struts, data->struts))
+        continue;
+
+      data->logical_monitor_region =
+        g_list_copy_deep (other_data->logical_monitor_region,
+                          copy_rectangle, NULL);
+      data->logical_monitor_work_area = other_data->logical_monitor_work_area;
+      return TRUE;
+    }
+
+  return FALSE;
+}
+
+static void
+compute_logical_monitor_work_area (MetaWorkspace                   *workspace,
+                                   MetaLogicalMonitor              *logical_monitor,
+                                   MetaWorkspaceLogicalMonitorData *data)
+{
+  MtkRectangle work_area;
+
+  if (copy_logical_monitor_data_from_other_workspace (workspace,
+                                                      logical_monitor,
+                                                      data))
+    {
+      meta_topic (META_DEBUG_WORKAREA,
+                  "Reused work area for workspace %d monitor %d "
+                  "from another workspace",
+                  meta_workspace_index (workspace),
+                  logical_monitor->number);
+      return;
+    }
+
+  data->logical_monitor_region =
+    meta_rectangle_get_minimal_spanning_set_for_region (&data->rect,
+                                                        data->struts);
+
+  work_area = data->rect;
+  if (!data->logical_monitor_region)
+    /* FIXME: constraints.c untested with this, but it might be nice for
+     * a screen reader or magnifier.
+     */
+    work_area = MTK_RECTANGLE_INIT (work_area.x, work_area.y, -1, -1);
+  else
+    meta_rectangle_clip_to_region (data->logical_monitor_region,
+                                   FIXED_DIRECTION_NONE,
+                                   &work_area);
+
+  data->logical_monitor_work_area = work_area;
+
+  meta_topic (META_DEBUG_WORKAREA,
+              "Computed work area for workspace %d "
+              "monitor %d: %d,%d %d x %d",
+              meta_workspace_index (workspace),
+              logical_monitor->number,
+              data->logical_monitor_work_area.x,
+              data->logical_monitor_work_area.y,
+              data->logical_monitor_work_area.width,
+              data->logical_monitor_work_area.height);
+}
+
+/* Updates the regions and work areas of the logical monitors, leaving the
+ * ones alone whose geometry and intersecting struts didn't change.
+ * Returns whether the set of logical monitors or any of their geometries
+ * changed. */
+static gboolean
+update_logical_monitor_work_areas (MetaWorkspace *workspace,
+                                   GList         *logical_monitors)
+{
+  gboolean monitors_changed = FALSE;
+  GHashTableIter iter;
+  gpointer key;
+  GList *l;
+
+  if (workspace->logical_monitor_data)
+    {
+      g_hash_table_iter_init (&iter, workspace->logical_monitor_data);
+      while (g_hash_table_iter_next (&iter, &key, NULL))
+        {
+          if (g_list_find (logical_monitors, key))
+            continue;
+
+          g_hash_table_iter_remove (&iter);
+          monitors_changed = TRUE;
+        }
+    }
 
-  logical_monitors =
-    meta_monitor_manager_get_logical_monitors (monitor_manager);
   for (l = logical_monitors; l; l = l->next)
     {
       MetaLogicalMonitor *logical_monitor = l->data;
       MetaWorkspaceLogicalMonitorData *data;
+      GSList *struts;
+
+      data = meta_workspace_get_logical_monitor_data (workspace,
+                                                      logical_monitor);
+      if (!data)
+        {
+          data = meta_workspace_ensure_logical_monitor_data (workspace,
+                                                             logical_monitor);
+          monitors_changed = TRUE;
+        }
+      else if (!mtk_rectangle_equal (&data->rect, &logical_monitor->rect))
+        {
+          monitors_changed = TRUE;
+        }
 
-      g_assert (!meta_workspace_get_logical_monitor_data (workspace,
-                                                          logical_monitor));
+      struts = get_struts_intersecting_rect (workspace->all_struts,
+                                             &logical_monitor->rect);
 
-      data = meta_workspace_ensure_logical_monitor_data (workspace,
-                                                         logical_monitor);
-      data->logical_monitor_region =
-        meta_rectangle_get_minimal_spanning_set_for_region (
-          &logical_monitor->rect,
-          workspace->all_struts);
+      if (data->computed &&
+          mtk_rectangle_equal (&data->rect, &logical_monitor->rect) &&
+          strut_lists_equal (data->struts, struts))
+        {
+          g_slist_free_full (struts, g_free);
+          continue;
+        }
+
+      g_clear_pointer (&data->logical_monitor_region,
+                       meta_rectangle_free_list_and_elements);
+      g_slist_free_full (data->struts, g_free);
+      data->struts = struts;
+      data->rect = logical_monitor->rect;
+
+      compute_logical_monitor_work_area (workspace, logical_monitor, data);
+      data->computed = TRUE;
+    }
+
+  return monitors_changed;
+}
+
+static gboolean
+copy_screen_data_from_other_workspace (MetaWorkspace      *workspace,
+                                       const MtkRectangle *display_rect)
+{
+  GList *l;
+
+  for (l = workspace->manager->workspaces; l; l = l->next)
+    {
+      MetaWorkspace *other = l->data;
+
+      if (other == workspace ||
+          other->work_areas_invalid ||
+          !other->screen_region ||
+          !mtk_rectangle_equal (&other->work_areas_display_rect,
+                                display_rect) ||
+          !strut_lists_equal (other->all_struts, workspace->all_struts))
+        continue;
+
+      workspace->screen_region =
+        g_list_copy_deep (other->screen_region, copy_rectangle, NULL);
+      workspace->screen_edges =
+        g_list_copy_deep (other->screen_edges, copy_edge, NULL);
+      workspace->monitor_edges =
+        g_list_copy_deep (other->monitor_edges, copy_edge, NULL);
+      workspace->work_area_screen = other->work_area_screen;
+      return TRUE;
     }
 
+  return FALSE;
+}
+
+static void
+compute_screen_work_area (MetaWorkspace      *workspace,
+                          const MtkRectangle *display_rect)
+{
+  MtkRectangle work_area;
+
   workspace->screen_region =
     meta_rectangle_get_minimal_spanning_set_for_region (
-      &display_rect,
+      display_rect,
       workspace->all_struts);
 
-  /* STEP 3: Get the work areas (region-to-maximize-to) for the screen and
-   *         monitors.
-   */
-  work_area = display_rect;  /* start with the screen */
+  work_area = *display_rect;  /* start with the screen */
   if (workspace->screen_region == NULL)
     work_area = MTK_RECTANGLE_INIT (0, 0, -1, -1);
   else
@@ -936,14 +1139,14 @@ meta_workspace_ensure_work_areas_validated (MetaWorkspace *workspace)
   /* Lots of paranoia checks, forcing work_area_screen to be sane */
 #define MIN_SANE_AREA 100
   if (work_area.width < MIN_SANE_AREA &&
-      work_area.width != display_rect.width)
+      work_area.width != display_rect->width)
     {
       g_warning ("struts occupy an unusually large percentage of the screen; "
                  "available remaining width = %d < %d",
                  work_area.width, MIN_SANE_AREA);
       if (work_area.width < 1)
         {
-          work_area.x = (display_rect.width - MIN_SANE_AREA)/2;
+          work_area.x = (display_rect->width - MIN_SANE_AREA)/2;
           work_area.width = MIN_SANE_AREA;
         }
       else
@@ -954,14 +1157,14 @@ meta_workspace_ensure_work_areas_validated (MetaWorkspace *workspace)
         }
     }
   if (work_area.height < MIN_SANE_AREA &&
-      work_area.height != display_rect.height)
+      work_area.height != display_rect->height)
     {
       g_warning ("struts occupy an unusually large percentage of the screen; "
                  "available remaining height = %d < %d",
                  work_area.height, MIN_SANE_AREA);
       if (work_area.height < 1)
         {
-          work_area.y = (display_rect.height - MIN_SANE_AREA)/2;
+          work_area.y = (display_rect->height - MIN_SANE_AREA)/2;
           work_area.height = MIN_SANE_AREA;
         }
       else
@@ -980,42 +1183,7 @@ meta_workspace_ensure_work_areas_validated (MetaWorkspace *workspace)
               workspace->work_area_screen.width,
               workspace->work_area_screen.height);
 
-  /* Now find the work areas for each monitor */
-  for (l = logical_monitors; l; l = l->next)
-    {
-      MetaLogicalMonitor *logical_monitor = l->data;
-      MetaWorkspaceLogicalMonitorData *data;
-
-      data = meta_workspace_get_logical_monitor_data (workspace,
-                                                      logical_monitor);
-      work_area = logical_monitor->rect;
-
-      if (!data->logical_monitor_region)
-        /* FIXME: constraints.c untested with this, but it might be nice for
-         * a screen reader or magnifier.
-         */
-        work_area = MTK_RECTANGLE_INIT (work_area.x, work_area.y, -1, -1);
-      else
-        meta_rectangle_clip_to_region (data->logical_monitor_region,
-                                       FIXED_DIRECTION_NONE,
-                                       &work_area);
-
-      data->logical_monitor_work_area = work_area;
-
-      meta_topic (META_DEBUG_WORKAREA,
-                  "Computed work area for workspace %d "
-                  "monitor %d: %d,%d %d x %d",
-                  meta_workspace_index (workspace),
-                  logical_monitor->number,
-                  data->logical_monitor_work_area.x,
-                  data->logical_monitor_work_area.y,
-                  data->logical_monitor_work_area.width,
-                  data->logical_monitor_work_area.height);
-    }
-
-  /* STEP 4: Make sure the screen_region is nonempty (separate from step 2
-   *         since it relies on step 3).
-   */
+  /* Make sure the screen_region is nonempty */
   if (workspace->screen_region == NULL)
     {
       MtkRectangle *nonempty_region;
@@ -1024,43 +1192,112 @@ meta_workspace_ensure_work_areas_validated (MetaWorkspace *workspace)
       workspace->screen_region = g_list_prepend (NULL, nonempty_region);
     }
 
-  /* STEP 5: Cache screen and monitor edges for edge resistance and snapping */
-  g_assert (workspace->screen_edges    == NULL);
-  g_assert (workspace->monitor_edges  == NULL);
   workspace->screen_edges =
-    meta_rectangle_find_onscreen_edges (&display_rect,
+    meta_rectangle_find_onscreen_edges (display_rect,
                                         workspace->all_struts);
-  tmp = NULL;
+}
+
+static void
+compute_monitor_edges (MetaWorkspace *workspace,
+                       GList         *logical_monitors)
+{
+  GList *monitor_rects = NULL;
+  GList *l;
+
   for (l = logical_monitors; l; l = l->next)
     {
       MetaLogicalMonitor *logical_monitor = l->data;
 
-      tmp = g_list_prepend (tmp, &logical_monitor->rect);
+      monitor_rects = g_list_prepend (monitor_rects, &logical_monitor->rect);
     }
   workspace->monitor_edges =
-    meta_rectangle_find_nonintersected_monitor_edges (tmp,
+    meta_rectangle_find_nonintersected_monitor_edges (monitor_rects,
                                                        workspace->all_struts);
-  g_list_free (tmp);
-
-  /* We're all done, YAAY!  Record that everything has been validated. */
-  workspace->work_areas_invalid = FALSE;
+  g_list_free (monitor_rects);
 }
 
-static gboolean
-strut_lists_equal (GSList *l,
-                   GSList *m)
+void
+meta_workspace_ensure_work_areas_validated (MetaWorkspace *workspace)
 {
-  for (; l && m; l = l->next, m = m->next)
+  MetaContext *context = meta_display_get_context (workspace->display);
+  MetaBackend *backend = meta_context_get_backend (context);
+  MetaMonitorManager *monitor_manager =
+    meta_backend_get_monitor_manager (backend);
+  GList *logical_monitors;
+  GSList *struts;
+  MtkRectangle display_rect = { 0 };
+  gboolean struts_changed;
+  gboolean monitors_changed;
+
+  if (!workspace->work_areas_invalid)
+    return;
+
+  meta_display_get_size (workspace->display,
+                         &display_rect.width,
+                         &display_rect.height);
+
+  /* STEP 1: Get the list of struts, and find out whether anything
+   *         changed since the work areas were last computed.
+   */
+  struts = collect_struts (workspace);
+  struts_changed =
+    !workspace->screen_region ||
+    !mtk_rectangle_equal (&display_rect,
+                          &workspace->work_areas_display_rect) ||
+    !strut_lists_equal (struts, workspace->all_struts);
+
+  workspace_free_all_struts (workspace);
+  workspace->all_struts = struts;
+  workspace->work_areas_display_rect = display_rect;
+
+  /* STEP 2: Get the regions and work areas of the logical monitors whose
+   *         geometry or intersecting struts changed.
+   */
+  logical_monitors =
+    meta_monitor_manager_get_logical_monitors (monitor_manager);
+  monitors_changed = update_logical_monitor_work_areas (workspace,
+                                                        logical_monitors);
+
+  if (!struts_changed && !monitors_changed)
     {
-      MetaStrut *a = l->data;
-      MetaStrut *b = m->data;
+      meta_topic (META_DEBUG_WORKAREA,
+                  "Struts of workspace %d are unchanged, keeping work area",
+                  meta_workspace_index (workspace));
+      workspace->work_areas_invalid = FALSE;
+      return;
+    }
 
-      if (a->side != b->side ||
-          !mtk_rectangle_equal (&a->rect, &b->rect))
-        return FALSE;
+  /* STEP 3: Get the region, work area and edges of the screen, unless
+   *         only the logical monitors changed. Another workspace with
+   *         the same struts already has the results to copy, most of
+   *         the time.
+   */
+  if (struts_changed)
+    {
+      g_clear_pointer (&workspace->screen_region,
+                       meta_rectangle_free_list_and_elements);
+      g_clear_pointer (&workspace->screen_edges,
+                       meta_rectangle_free_list_and_elements);
+      g_clear_pointer (&workspace->monitor_edges,
+                       meta_rectangle_free_list_and_elements);
+
+      if (!monitors_changed &&
+          copy_screen_data_from_other_workspace (workspace, &display_rect))
+        {
+          workspace->work_areas_invalid = FALSE;
+          return;
+        }
+
+      compute_screen_work_area (workspace, &display_rect);
     }
 
-  return l == NULL && m == NULL;
+  /* STEP 4: Cache monitor edges for edge resistance and snapping */
+  g_clear_pointer (&workspace->monitor_edges,
+                   meta_rectangle_free_list_and_elements);
+  compute_monitor_edges (workspace, logical_monitors);
+
+  /* We're all done, YAAY!  Record that everything has been validated. */
+  workspace->work_areas_invalid = FALSE;
 }
 
 /**
@@ -1231,6 +1231,110 @@ test_find_closest_point_to_line (void)
   g_assert_true (fabs (rx - answer_x) < EPSILON && fabs (ry - answer_y) < EPSILON);
 }
 
+#define LARGE_STRUT_SET_N_MONITORS 4
+#define LARGE_STRUT_SET_N_PANELS 16
+#define LARGE_STRUT_SET_N_RUNS 100
+
+/* Four 1920x1080 monitors side by side, each with panels stacked along
+ * every edge, like autohiding docks on a multi-monitor kiosk. */
+static GSList *
+get_large_strut_list (GList **monitor_rects)
+{
+  GSList *struts = NULL;
+  int i, j;
+
+  for (i = 0; i < LARGE_STRUT_SET_N_MONITORS; i++)
+    {
+      int x = i * 1920;
+
+      *monitor_rects = g_list_append (*monitor_rects,
+                                      mtk_rectangle_new (x, 0, 1920, 1080));
+
+      for (j = 0; j < LARGE_STRUT_SET_N_PANELS / 4; j++)
+        {
+          int offset = 100 + j * 400;
+
+          struts = g_slist_prepend (struts,
+                                    new_meta_strut (x + offset, 0,
+                                                    300, 24 + j,
+                                                    META_SIDE_TOP));
+          struts = g_slist_prepend (struts,
+                                    new_meta_strut (x + offset, 1080 - 48 - j,
+                                                    300, 48 + j,
+                                                    META_SIDE_BOTTOM));
+          struts = g_slist_prepend (struts,
+                                    new_meta_strut (x, 60 + j * 240,
+                                                    32 + j, 200,
+                                                    META_SIDE_LEFT));
+          struts = g_slist_prepend (struts,
+                                    new_meta_strut (x + 1920 - 32 - j,
+                                                    60 + j * 240,
+                                                    32 + j, 200,
+                                                    META_SIDE_RIGHT));
+        }
+    }
+
+  return struts;
+}
+
+static void
+test_large_strut_set (void)
+{
+  MtkRectangle screen_rect = { 0, 0, 1920 * LARGE_STRUT_SET_N_MONITORS, 1080 };
+  GList *monitor_rects = NULL;
+  GSList *struts;
+  int n_runs;
+  int i;
+
+  struts = get_large_strut_list (&monitor_rects);
+  n_runs = g_test_perf () ? LARGE_STRUT_SET_N_RUNS : 1;
+
+  g_test_timer_start ();
+
+  for (i = 0; i < n_runs; i++)
+    {
+      GList *screen_region;
+      GList *screen_edges;
+      GList *monitor_edges;
+      GList *l;
+
+      screen_region =
+        meta_rectangle_get_minimal_spanning_set_for_region (&screen_rect,
+                                                            struts);
+      for (l = monitor_rects; l; l = l->next)
+        {
+          GList *monitor_region;
+
+          monitor_region =
+            meta_rectangle_get_minimal_spanning_set_for_region (l->data,
+                                                                struts);
+          g_assert_nonnull (monitor_region);
+          meta_rectangle_free_list_and_elements (monitor_region);
+        }
+
+      screen_edges = meta_rectangle_find_onscreen_edges (&screen_rect, struts);
+      monitor_edges =
+        meta_rectangle_find_nonintersected_monitor_edges (monitor_rects,
+                                                           struts);
+
+      g_assert_nonnull (screen_region);
+      g_assert_nonnull (screen_edges);
+      g_assert_nonnull (monitor_edges);
+
+      meta_rectangle_free_list_and_elements (screen_region);
+      meta_rectangle_free_list_and_elements (screen_edges);
+      meta_rectangle_free_list_and_elements (monitor_edges);
+    }
+
+  g_test_minimized_result (g_test_timer_elapsed () * 1000.0 / n_runs,
+                           "Work areas for %d struts: %.3f ms",
+                           g_slist_length (struts),
+                           g_test_timer_elapsed () * 1000.0 / n_runs);
+
+  g_slist_free_full (struts, g_free);
+  meta_rectangle_free_list_and_elements (monitor_rects);
+}
+
 void
 init_boxes_tests (void)
 {
@@ -1247,6 +1351,7 @@ init_boxes_tests (void)
   g_test_add_func ("/util/boxes/onscreen-edges", test_find_onscreen_edges);
   g_test_add_func ("/util/boxes/nonintersected-monitor-edges",
                    test_find_nonintersected_monitor_edges);
+  g_test_add_func ("/util/boxes/large-strut-set", test_large_strut_set);
 
   /* And now the misfit functions that don't quite fit in anywhere else... */
   g_test_add_func ("/util/boxes/gravity-resize", test_gravity_resize);
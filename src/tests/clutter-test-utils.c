@@ -4,6 +4,7 @@
 #include <glib-object.h>
 #include <clutter/clutter.h>
 
+#include "clutter/clutter-mutter.h"
 #include "backends/meta-monitor-manager-private.h"
 #include "backends/meta-virtual-monitor.h"
 #include "compositor/meta-plugin-manager.h"
@@ -116,6 +117,96 @@ clutter_test_flush_input (void)
   meta_flush_input (test_environ->context);
 }
 
+static void
+on_after_paint (ClutterStage     *stage,
+                ClutterStageView *view,
+                ClutterFrame     *frame,
+                GHashTable       *painted_views)
+{
+  g_hash_table_add (painted_views, view);
+}
+
+/**
+ * clutter_test_paint_stage:
+ * @stage: the stage
+ *
+ * Queues a redraw of @stage and waits until each of its views has been
+ * painted.
+ */
+void
+clutter_test_paint_stage (ClutterActor *stage)
+{
+  g_autoptr (GHashTable) painted_views = NULL;
+  unsigned int n_views;
+  gulong after_paint_handler_id;
+
+  painted_views = g_hash_table_new (NULL, NULL);
+  n_views = g_list_length (clutter_stage_peek_stage_views (CLUTTER_STAGE (stage)));
+
+  after_paint_handler_id =
+    g_signal_connect (stage, "after-paint",
+                      G_CALLBACK (on_after_paint), painted_views);
+
+  clutter_actor_queue_redraw (stage);
+  while (g_hash_table_size (painted_views) < n_views)
+    g_main_context_iteration (NULL, FALSE);
+
+  g_signal_handler_disconnect (stage, after_paint_handler_id);
+}
+
+/**
+ * clutter_test_add_virtual_monitor:
+ * @width: the width of the monitor
+ * @height: the height of the monitor
+ *
+ * Adds a virtual monitor, and with it a stage view, to the test backend.
+ * The monitor goes away again when the returned object is unreferenced
+ * and the monitor configuration is reloaded.
+ *
+ * Return value: (transfer full): the virtual monitor
+ */
+MetaVirtualMonitor *
+clutter_test_add_virtual_monitor (int width,
+                                  int height)
+{
+  static unsigned int serial = 0x123;
+  MetaBackend *backend = meta_context_get_backend (test_environ->context);
+  MetaMonitorManager *monitor_manager = meta_backend_get_monitor_manager (backend);
+  MetaVirtualMonitor *virtual_monitor;
+  g_autoptr (MetaVirtualMonitorInfo) monitor_info = NULL;
+  g_autoptr (GError) error = NULL;
+  g_autofree char *serial_string = NULL;
+
+  serial_string = g_strdup_printf ("0x%x", serial++);
+  monitor_info = meta_virtual_monitor_info_new_simple (width, height, 10.0,
+                                                       "MetaTestVendor",
+                                                       "ClutterTestMonitor",
+                                                       serial_string);
+  virtual_monitor = meta_monitor_manager_create_virtual_monitor (monitor_manager,
+                                                                 monitor_info,
+                                                                 &error);
+  if (!virtual_monitor)
+    g_error ("Failed to create virtual monitor: %s", error->message);
+
+  meta_monitor_manager_reload (monitor_manager);
+
+  return virtual_monitor;
+}
+
+/**
+ * clutter_test_reload_monitors:
+ *
+ * Reloads the monitor configuration of the test backend, e.g. after a
+ * virtual monitor was removed.
+ */
+void
+clutter_test_reload_monitors (void)
+{
+  MetaBackend *backend = meta_context_get_backend (test_environ->context);
+
+  meta_monitor_manager_reload (meta_backend_get_monitor_manager (backend));
+}
+
 typedef struct {
   gpointer test_func;
   gpointer test_data;
@@ -267,24 +358,10 @@ clutter_test_add_data_full (const char     *test_path,
 int
 clutter_test_run (void)
 {
-  MetaBackend *backend = meta_context_get_backend (test_environ->context);
-  MetaMonitorManager *monitor_manager = meta_backend_get_monitor_manager (backend);
   MetaVirtualMonitor *virtual_monitor;
-  g_autoptr (MetaVirtualMonitorInfo) monitor_info = NULL;
-  g_autoptr (GError) error = NULL;
   int res;
 
-  monitor_info = meta_virtual_monitor_info_new_simple (800, 600, 10.0,
-                                                       "MetaTestVendor",
-                                                       "ClutterTestMonitor",
-                                                       "0x123");
-  virtual_monitor = meta_monitor_manager_create_virtual_monitor (monitor_manager,
-                                                                 monitor_info,
-                                                                 &error);
-  if (!virtual_monitor)
-    g_error ("Failed to create virtual monitor: %s", error->message);
-
-  meta_monitor_manager_reload (monitor_manager);
+  virtual_monitor = clutter_test_add_virtual_monitor (800, 600);
 
   res = g_test_run ();
 
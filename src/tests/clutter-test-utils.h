@@ -27,6 +27,7 @@
 #include "clutter/clutter-actor.h"
 #include "clutter/clutter-event-private.h"
 #include "clutter/clutter-private.h"
+#include "backends/meta-backend-types.h"
 #include "meta/common.h"
 #include "meta-test/meta-context-test.h"
 
@@ -115,6 +116,16 @@ void            clutter_test_add_data_full      (const char     *test_path,
 CLUTTER_EXPORT
 void            clutter_test_flush_input        (void);
 
+CLUTTER_EXPORT
+void            clutter_test_paint_stage        (ClutterActor   *stage);
+
+CLUTTER_EXPORT
+MetaVirtualMonitor * clutter_test_add_virtual_monitor (int width,
+                                                       int height);
+
+CLUTTER_EXPORT
+void            clutter_test_reload_monitors    (void);
+
 CLUTTER_EXPORT
 ClutterActor *  clutter_test_get_stage          (void);
 
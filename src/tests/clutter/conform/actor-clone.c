@@ -5,6 +5,50 @@
 
 #include "tests/clutter-test-utils.h"
 
+#define N_SNAPSHOT_CLONES 3
+#define SNAPSHOT_SOURCE_SIZE 64
+
+typedef struct _PaintCounterActor
+{
+  ClutterActor parent;
+
+  int paint_count;
+} PaintCounterActor;
+
+typedef struct _PaintCounterActorClass
+{
+  ClutterActorClass parent_class;
+} PaintCounterActorClass;
+
+GType paint_counter_actor_get_type (void);
+
+G_DEFINE_TYPE (PaintCounterActor, paint_counter_actor, CLUTTER_TYPE_ACTOR)
+
+static void
+paint_counter_actor_paint (ClutterActor        *actor,
+                           ClutterPaintContext *paint_context)
+{
+  PaintCounterActor *counter_actor = (PaintCounterActor *) actor;
+
+  counter_actor->paint_count++;
+
+  CLUTTER_ACTOR_CLASS (paint_counter_actor_parent_class)->paint (actor,
+                                                                 paint_context);
+}
+
+static void
+paint_counter_actor_class_init (PaintCounterActorClass *klass)
+{
+  ClutterActorClass *actor_class = CLUTTER_ACTOR_CLASS (klass);
+
+  actor_class->paint = paint_counter_actor_paint;
+}
+
+static void
+paint_counter_actor_init (PaintCounterActor *self)
+{
+}
+
 static void
 on_presented (ClutterStage     *stage,
               ClutterStageView *view,
@@ -60,6 +104,178 @@ actor_clone_unmapped (void)
   g_assert_null (container);
 }
 
+static void
+wait_for_presented (ClutterActor *stage)
+{
+  gboolean was_presented = FALSE;
+  gulong presented_handler_id;
+
+  presented_handler_id =
+    g_signal_connect (stage, "presented", G_CALLBACK (on_presented),
+                      &was_presented);
+
+  clutter_actor_queue_redraw (stage);
+  while (!was_presented)
+    g_main_context_iteration (NULL, FALSE);
+
+  g_signal_handler_disconnect (stage, presented_handler_id);
+}
+
+static void
+actor_clone_snapshot (void)
+{
+  ClutterActor *stage;
+  PaintCounterActor *source;
+  ClutterActor *clones[N_SNAPSHOT_CLONES];
+  int i;
+
+  stage = clutter_test_get_stage ();
+
+  source = g_object_new (paint_counter_actor_get_type (), NULL);
+  clutter_actor_set_background_color (CLUTTER_ACTOR (source),
+                                      &COGL_COLOR_INIT (255, 0, 0, 255));
+  clutter_actor_set_size (CLUTTER_ACTOR (source), 50, 50);
+  clutter_actor_hide (CLUTTER_ACTOR (source));
+  clutter_actor_add_child (stage, CLUTTER_ACTOR (source));
+
+  for (i = 0; i < N_SNAPSHOT_CLONES; i++)
+    {
+      clones[i] = clutter_clone_new (CLUTTER_ACTOR (source));
+      clutter_clone_set_use_snapshot (CLUTTER_CLONE (clones[i]), TRUE);
+      clutter_actor_set_position (clones[i], i * 30, 0);
+      clutter_actor_set_size (clones[i], 25, 25);
+      clutter_actor_add_child (stage, clones[i]);
+    }
+
+  clutter_actor_show (stage);
+
+  /* All clones sample one snapshot of the source */
+  wait_for_presented (stage);
+  g_assert_cmpint (source->paint_count, ==, 1);
+
+  /* The snapshot is reused as long as the source doesn't change */
+  wait_for_presented (stage);
+  g_assert_cmpint (source->paint_count, ==, 1);
+
+  clutter_actor_queue_redraw (CLUTTER_ACTOR (source));
+  wait_for_presented (stage);
+  g_assert_cmpint (source->paint_count, ==, 2);
+
+  for (i = 0; i < N_SNAPSHOT_CLONES; i++)
+    clutter_clone_set_use_snapshot (CLUTTER_CLONE (clones[i]), FALSE);
+
+  wait_for_presented (stage);
+  g_assert_cmpint (source->paint_count, ==, 2 + N_SNAPSHOT_CLONES);
+
+  for (i = 0; i < N_SNAPSHOT_CLONES; i++)
+    clutter_actor_destroy (clones[i]);
+  clutter_actor_destroy (CLUTTER_ACTOR (source));
+}
+
+static ClutterActor *
+create_quadrants_source (ClutterActor *stage)
+{
+  static const CoglColor colors[] = {
+    COGL_COLOR_INIT (255, 0, 0, 255),
+    COGL_COLOR_INIT (0, 255, 0, 255),
+    COGL_COLOR_INIT (0, 0, 255, 255),
+    COGL_COLOR_INIT (255, 255, 0, 255),
+  };
+  ClutterActor *source;
+  int half_size = SNAPSHOT_SOURCE_SIZE / 2;
+  size_t i;
+
+  source = clutter_actor_new ();
+  clutter_actor_set_size (source, SNAPSHOT_SOURCE_SIZE, SNAPSHOT_SOURCE_SIZE);
+  clutter_actor_hide (source);
+  clutter_actor_add_child (stage, source);
+
+  for (i = 0; i < G_N_ELEMENTS (colors); i++)
+    {
+      ClutterActor *quadrant;
+
+      quadrant = clutter_actor_new ();
+      clutter_actor_set_background_color (quadrant, &colors[i]);
+      clutter_actor_set_position (quadrant,
+                                  (i % 2) * half_size,
+                                  (i / 2) * half_size);
+      clutter_actor_set_size (quadrant, half_size, half_size);
+      clutter_actor_add_child (source, quadrant);
+    }
+
+  return source;
+}
+
+static void
+assert_clones_match (ClutterActor *stage,
+                     ClutterActor *source,
+                     int           size)
+{
+  ClutterActor *live_clone;
+  ClutterActor *snapshot_clone;
+  g_autofree uint8_t *live_pixels = NULL;
+  g_autofree uint8_t *snapshot_pixels = NULL;
+  int i;
+
+  live_clone = clutter_clone_new (source);
+  clutter_actor_set_size (live_clone, size, size);
+  clutter_actor_add_child (stage, live_clone);
+
+  snapshot_clone = clutter_clone_new (source);
+  clutter_clone_set_use_snapshot (CLUTTER_CLONE (snapshot_clone), TRUE);
+  clutter_actor_set_position (snapshot_clone, SNAPSHOT_SOURCE_SIZE * 2, 0);
+  clutter_actor_set_size (snapshot_clone, size, size);
+  clutter_actor_add_child (stage, snapshot_clone);
+
+  live_pixels = clutter_stage_read_pixels (CLUTTER_STAGE (stage),
+                                           0, 0, size, size);
+  snapshot_pixels = clutter_stage_read_pixels (CLUTTER_STAGE (stage),
+                                               SNAPSHOT_SOURCE_SIZE * 2, 0,
+                                               size, size);
+
+  for (i = 0; i < size * size * 4; i++)
+    {
+      if (ABS (live_pixels[i] - snapshot_pixels[i]) > 2)
+        {
+          g_error ("Snapshot pixel %d,%d of a %dx%d clone differs "
+                   "from the source: %d != %d",
+                   (i / 4) % size, (i / 4) / size, size, size,
+                   snapshot_pixels[i], live_pixels[i]);
+        }
+    }
+
+  clutter_actor_destroy (live_clone);
+  clutter_actor_destroy (snapshot_clone);
+}
+
+static void
+actor_clone_snapshot_pixels (void)
+{
+  ClutterActor *stage;
+  ClutterActor *source;
+  ClutterActor *child;
+
+  stage = clutter_test_get_stage ();
+  clutter_actor_show (stage);
+
+  source = create_quadrants_source (stage);
+
+  assert_clones_match (stage, source, SNAPSHOT_SOURCE_SIZE);
+  assert_clones_match (stage, source, SNAPSHOT_SOURCE_SIZE / 2);
+
+  /* A child rotated in 3D gets its perspective from the stage, which the
+   * snapshot can't reproduce, so the source is painted directly */
+  child = clutter_actor_get_first_child (source);
+  clutter_actor_set_pivot_point (child, 0.5f, 0.5f);
+  clutter_actor_set_rotation_angle (child, CLUTTER_Y_AXIS, 60.0);
+
+  assert_clones_match (stage, source, SNAPSHOT_SOURCE_SIZE);
+
+  clutter_actor_destroy (source);
+}
+
 CLUTTER_TEST_SUITE (
   CLUTTER_TEST_UNIT ("/actor/clone/unmapped", actor_clone_unmapped)
+  CLUTTER_TEST_UNIT ("/actor/clone/snapshot", actor_clone_snapshot)
+  CLUTTER_TEST_UNIT ("/actor/clone/snapshot-pixels", actor_clone_snapshot_pixels)
 )
@@ -0,0 +1,81 @@
+#include <clutter/clutter.h>
+
+#include "clutter/clutter-paint-node-private.h"
+#include "tests/clutter-test-utils.h"
+
+#define N_ACTORS 64
+
+static unsigned int
+paint_and_count_allocations (ClutterActor *stage)
+{
+  clutter_test_paint_stage (stage);
+
+  return clutter_paint_node_get_n_frame_allocations ();
+}
+
+static void
+actor_retained_paint_nodes (void)
+{
+  ClutterActor *stage;
+  ClutterActor *container;
+  ClutterActor *actors[N_ACTORS];
+  unsigned int n_first_allocations;
+  unsigned int n_retained_allocations;
+  unsigned int n_allocations;
+  int i;
+
+  stage = clutter_test_get_stage ();
+
+  container = clutter_actor_new ();
+  clutter_actor_add_child (stage, container);
+
+  for (i = 0; i < N_ACTORS; i++)
+    {
+      actors[i] = clutter_actor_new ();
+      clutter_actor_set_background_color (actors[i],
+                                          &COGL_COLOR_INIT (0, 255, i * 4, 255));
+      clutter_actor_set_position (actors[i], (i % 8) * 10, (i / 8) * 10);
+      clutter_actor_set_size (actors[i], 10, 10);
+      clutter_actor_add_child (container, actors[i]);
+    }
+
+  clutter_actor_show (stage);
+
+  n_first_allocations = paint_and_count_allocations (stage);
+
+  /* Nothing changed, so the background nodes of every actor are reused,
+   * and only the per-frame root, actor and transform nodes are built. */
+  n_retained_allocations = paint_and_count_allocations (stage);
+  g_assert_cmpuint (n_retained_allocations, <=,
+                    n_first_allocations - N_ACTORS);
+
+  n_allocations = paint_and_count_allocations (stage);
+  g_assert_cmpuint (n_allocations, ==, n_retained_allocations);
+
+  /* Changing the background of an actor queues a redraw on it, which
+   * drops its retained nodes. */
+  clutter_actor_set_background_color (actors[0],
+                                      &COGL_COLOR_INIT (255, 0, 0, 255));
+  n_allocations = paint_and_count_allocations (stage);
+  g_assert_cmpuint (n_allocations, >, n_retained_allocations);
+
+  n_allocations = paint_and_count_allocations (stage);
+  g_assert_cmpuint (n_allocations, ==, n_retained_allocations);
+
+  /* So does a change of its size. */
+  clutter_actor_set_size (actors[1], 5, 5);
+  n_allocations = paint_and_count_allocations (stage);
+  g_assert_cmpuint (n_allocations, >, n_retained_allocations);
+
+  /* The nodes depend on the paint opacity, which changes with the
+   * opacity of the parent without queueing a redraw on the children. */
+  clutter_actor_set_opacity (container, 128);
+  n_allocations = paint_and_count_allocations (stage);
+  g_assert_cmpuint (n_allocations, >=, n_retained_allocations + N_ACTORS);
+
+  clutter_actor_destroy_all_children (stage);
+}
+
+CLUTTER_TEST_SUITE (
+  CLUTTER_TEST_UNIT ("/actor/retained-paint-nodes", actor_retained_paint_nodes)
+)
@@ -0,0 +1,110 @@
+#include <clutter/clutter.h>
+
+#include "clutter/clutter-mutter.h"
+#include "clutter/clutter-paint-node-private.h"
+#include "tests/clutter-test-utils.h"
+
+#define N_ACTORS 64
+
+static unsigned int
+paint_and_count_allocations (ClutterActor *stage)
+{
+  clutter_test_paint_stage (stage);
+
+  return clutter_paint_node_get_n_frame_allocations ();
+}
+
+static void
+paint_node_pool_reuse (void)
+{
+  ClutterActor *stage;
+  unsigned int n_first_allocations;
+  unsigned int n_allocations;
+  int i;
+
+  stage = clutter_test_get_stage ();
+
+  for (i = 0; i < N_ACTORS; i++)
+    {
+      ClutterActor *actor;
+
+      actor = clutter_actor_new ();
+      clutter_actor_set_background_color (actor,
+                                          &COGL_COLOR_INIT (255, i * 4, 0, 255));
+      clutter_actor_set_position (actor, (i % 8) * 10, (i / 8) * 10);
+      clutter_actor_set_size (actor, 10, 10);
+      clutter_actor_add_child (stage, actor);
+    }
+
+  clutter_actor_show (stage);
+
+  n_first_allocations = paint_and_count_allocations (stage);
+  g_assert_cmpuint (n_first_allocations, >=, 2 * N_ACTORS);
+
+  /* The paint nodes themselves are allocated each frame, but their
+   * operation arrays come from the pool filled by the previous frame. */
+  for (i = 0; i < 3; i++)
+    {
+      n_allocations = paint_and_count_allocations (stage);
+      g_assert_cmpuint (n_allocations, <=, n_first_allocations - N_ACTORS);
+    }
+
+  clutter_actor_destroy_all_children (stage);
+}
+
+static void
+paint_node_pool_reuse_two_views (void)
+{
+  MetaVirtualMonitor *virtual_monitor;
+  ClutterActor *stage;
+  ClutterActor *actor;
+  unsigned int n_first_allocations;
+  unsigned int n_allocations;
+  int i;
+
+  virtual_monitor = clutter_test_add_virtual_monitor (800, 600);
+
+  stage = clutter_test_get_stage ();
+  g_assert_cmpuint (g_list_length (clutter_stage_peek_stage_views (CLUTTER_STAGE (stage))),
+                    ==, 2);
+
+  /* Many actors on the first view, a single one on the second view, so
+   * that trimming the pool to the view painted last would throw away
+   * most of what the first view needs. */
+  for (i = 0; i < N_ACTORS; i++)
+    {
+      actor = clutter_actor_new ();
+      clutter_actor_set_background_color (actor,
+                                          &COGL_COLOR_INIT (255, i * 4, 0, 255));
+      clutter_actor_set_position (actor, (i % 8) * 10, (i / 8) * 10);
+      clutter_actor_set_size (actor, 10, 10);
+      clutter_actor_add_child (stage, actor);
+    }
+
+  actor = clutter_actor_new ();
+  clutter_actor_set_background_color (actor, &COGL_COLOR_INIT (0, 255, 0, 255));
+  clutter_actor_set_position (actor, 810, 10);
+  clutter_actor_set_size (actor, 10, 10);
+  clutter_actor_add_child (stage, actor);
+
+  clutter_actor_show (stage);
+
+  n_first_allocations = paint_and_count_allocations (stage);
+  g_assert_cmpuint (n_first_allocations, >=, 2 * N_ACTORS);
+
+  for (i = 0; i < 3; i++)
+    {
+      n_allocations = paint_and_count_allocations (stage);
+      g_assert_cmpuint (n_allocations, <=, n_first_allocations - N_ACTORS);
+    }
+
+  clutter_actor_destroy_all_children (stage);
+
+  g_object_unref (virtual_monitor);
+  clutter_test_reload_monitors ();
+}
+
+CLUTTER_TEST_SUITE (
+  CLUTTER_TEST_UNIT ("/paint-node/pool/reuse", paint_node_pool_reuse)
+  CLUTTER_TEST_UNIT ("/paint-node/pool/reuse-two-views", paint_node_pool_reuse_two_views)
+)
@@ -4,6 +4,7 @@
 #include <clutter/clutter-pango.h>
 #include <string.h>
 
+#include "clutter/pango/clutter-text-layout-cache.h"
 #include "tests/clutter-test-utils.h"
 
 typedef struct {
@@ -576,6 +577,131 @@ text_idempotent_use_markup (void)
   g_object_unref (text);
 }
 
+static ClutterText *
+create_layout_cache_text (const char *contents)
+{
+  ClutterText *text;
+
+  text = CLUTTER_TEXT (clutter_text_new_with_text ("Sans 10", contents));
+  g_object_ref_sink (text);
+
+  return text;
+}
+
+static void
+text_layout_cache (void)
+{
+  ClutterContext *context = clutter_test_get_context ();
+  ClutterTextLayoutCacheStats stats;
+  ClutterText *text_a;
+  ClutterText *text_b;
+  ClutterText *text_c;
+  ClutterText *text_d;
+  PangoLanguage *language;
+  PangoLayout *layout_a;
+  PangoLayout *layout_d;
+  unsigned int n_hits;
+
+  clutter_context_clear_text_layout_cache (context);
+  clutter_context_get_text_layout_cache_stats (context, &stats);
+  g_assert_cmpuint (stats.n_layouts, ==, 0);
+  n_hits = stats.hits;
+
+  /* Actors showing the same text share the shaped layout, while each
+   * of them still gets a layout of its own */
+  text_a = create_layout_cache_text ("Shared layout");
+  text_b = create_layout_cache_text ("Shared layout");
+
+  layout_a = clutter_text_get_layout (text_a);
+  g_assert_true (clutter_text_get_layout (text_b) != layout_a);
+
+  clutter_context_get_text_layout_cache_stats (context, &stats);
+  g_assert_cmpuint (stats.hits, >, n_hits);
+  g_assert_cmpuint (stats.n_layouts, >, 0);
+
+  /* Changing the contents of one doesn't affect the other */
+  clutter_text_set_text (text_b, "Another layout");
+  g_assert_true (clutter_text_get_layout (text_b) != layout_a);
+  g_assert_cmpstr (pango_layout_get_text (layout_a), ==, "Shared layout");
+
+  /* Editable actors are never shared */
+  clutter_context_get_text_layout_cache_stats (context, &stats);
+  n_hits = stats.hits;
+
+  text_c = create_layout_cache_text ("Shared layout");
+  clutter_text_set_editable (text_c, TRUE);
+  clutter_text_get_layout (text_c);
+
+  clutter_context_get_text_layout_cache_stats (context, &stats);
+  g_assert_cmpuint (stats.hits, ==, n_hits);
+
+  /* Neither are actors with a customised PangoContext */
+  text_d = create_layout_cache_text ("Shared layout");
+  language = pango_language_from_string ("ja");
+  pango_context_set_language (clutter_actor_get_pango_context (CLUTTER_ACTOR (text_d)),
+                              language);
+  layout_d = clutter_text_get_layout (text_d);
+  g_assert_true (layout_d != layout_a);
+  g_assert_true (pango_context_get_language (pango_layout_get_context (layout_d)) ==
+                 language);
+
+  clutter_actor_destroy (CLUTTER_ACTOR (text_a));
+  g_object_unref (text_a);
+  clutter_actor_destroy (CLUTTER_ACTOR (text_b));
+  g_object_unref (text_b);
+  clutter_actor_destroy (CLUTTER_ACTOR (text_c));
+  g_object_unref (text_c);
+  clutter_actor_destroy (CLUTTER_ACTOR (text_d));
+  g_object_unref (text_d);
+
+  /* Cached layouts outlive the actors they were created for */
+  clutter_context_get_text_layout_cache_stats (context, &stats);
+  g_assert_cmpuint (stats.n_layouts, >, 0);
+
+  clutter_context_clear_text_layout_cache (context);
+  clutter_context_get_text_layout_cache_stats (context, &stats);
+  g_assert_cmpuint (stats.n_layouts, ==, 0);
+  g_assert_cmpuint (stats.size, ==, 0);
+}
+
+static void
+text_layout_private (void)
+{
+  ClutterText *text_a;
+  ClutterText *text_b;
+  PangoLayout *layout_a;
+  PangoLayout *layout_b;
+  int width;
+
+  text_a = create_layout_cache_text ("Shared layout");
+  text_b = create_layout_cache_text ("Shared layout");
+
+  /* The layout is created with the context of the actor, and kept until
+   * the contents change */
+  layout_a = clutter_text_get_layout (text_a);
+  g_assert_true (pango_layout_get_context (layout_a) ==
+                 clutter_actor_get_pango_context (CLUTTER_ACTOR (text_a)));
+  g_assert_true (clutter_text_get_layout (text_a) == layout_a);
+
+  /* Changing it doesn't affect another label showing the same text */
+  width = pango_layout_get_width (layout_a);
+  pango_layout_set_text (layout_a, "Changed layout", -1);
+  pango_layout_set_width (layout_a, width + 10 * PANGO_SCALE);
+
+  layout_b = clutter_text_get_layout (text_b);
+  g_assert_cmpstr (pango_layout_get_text (layout_b), ==, "Shared layout");
+  g_assert_cmpint (pango_layout_get_width (layout_b), ==, width);
+
+  clutter_text_set_text (text_a, "Another layout");
+  g_assert_cmpstr (pango_layout_get_text (clutter_text_get_layout (text_a)),
+                   ==, "Another layout");
+
+  clutter_actor_destroy (CLUTTER_ACTOR (text_a));
+  g_object_unref (text_a);
+  clutter_actor_destroy (CLUTTER_ACTOR (text_b));
+  g_object_unref (text_b);
+}
+
 CLUTTER_TEST_SUITE (
   CLUTTER_TEST_UNIT ("/text/utf8-validation", text_utf8_validation)
   CLUTTER_TEST_UNIT ("/text/set-empty", text_set_empty)
@@ -590,4 +716,6 @@ CLUTTER_TEST_SUITE (
   CLUTTER_TEST_UNIT ("/text/cursor", text_cursor)
   CLUTTER_TEST_UNIT ("/text/event", text_event)
   CLUTTER_TEST_UNIT ("/text/idempotent-use-markup", text_idempotent_use_markup)
+  CLUTTER_TEST_UNIT ("/text/layout-cache", text_layout_cache)
+  CLUTTER_TEST_UNIT ("/text/layout-private", text_layout_private)
 )
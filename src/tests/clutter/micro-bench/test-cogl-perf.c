@@ -15,6 +15,10 @@ typedef struct _TestState
 {
   ClutterActor *stage;
   int current_test;
+  int n_quads;
+  int64_t n_flushed_quads;
+  int64_t flush_time_us;
+  GTimer *timer;
 } TestState;
 
 typedef void (*TestCallback) (TestState           *state,
@@ -75,6 +79,7 @@ test_rectangles (TestState           *state,
           cogl_framebuffer_draw_rectangle (framebuffer, pipeline,
                                            0, 0, RECT_WIDTH, RECT_HEIGHT);
           cogl_framebuffer_pop_matrix (framebuffer);
+          state->n_quads++;
         }
     }
 
@@ -94,13 +99,69 @@ test_rectangles (TestState           *state,
           cogl_framebuffer_draw_rectangle (framebuffer, pipeline,
                                            0, 0, RECT_WIDTH, RECT_HEIGHT);
           cogl_framebuffer_pop_matrix (framebuffer);
+          state->n_quads++;
         }
     }
 }
 
+/* Draws runs of small textured rectangles sharing a modelview, the way
+ * glyphs of a text are drawn, so that the journal flush is dominated by
+ * the expansion and transformation of the logged quads. */
+static void
+test_glyph_runs (TestState           *state,
+                 ClutterPaintContext *paint_context)
+{
+#define GLYPH_WIDTH 4
+#define GLYPH_HEIGHT 6
+#define GLYPHS_PER_RUN 40
+  CoglFramebuffer *framebuffer =
+    clutter_paint_context_get_framebuffer (paint_context);
+  CoglContext *ctx = cogl_framebuffer_get_context (framebuffer);
+  static CoglTexture *texture = NULL;
+  CoglPipeline *pipeline;
+  int x;
+  int y;
+
+  if (!texture)
+    texture = cogl_texture_2d_new_with_size (ctx, 64, 64);
+
+  pipeline = cogl_pipeline_new (ctx);
+  cogl_pipeline_set_layer_texture (pipeline, 0, texture);
+
+  for (y = 0; y < STAGE_HEIGHT; y += GLYPH_HEIGHT)
+    {
+      for (x = 0; x < STAGE_WIDTH; x += GLYPH_WIDTH * GLYPHS_PER_RUN)
+        {
+          int i;
+
+          cogl_framebuffer_push_matrix (framebuffer);
+          cogl_framebuffer_translate (framebuffer, x, y, 0);
+          cogl_framebuffer_scale (framebuffer, 0.99f, 0.99f, 1);
+
+          for (i = 0; i < GLYPHS_PER_RUN; i++)
+            {
+              float s = (i % 16) / 16.0f;
+
+              cogl_framebuffer_draw_textured_rectangle (framebuffer, pipeline,
+                                                        i * GLYPH_WIDTH, 0,
+                                                        (i + 1) * GLYPH_WIDTH,
+                                                        GLYPH_HEIGHT,
+                                                        s, 0,
+                                                        s + 1.0f / 16, 1);
+              state->n_quads++;
+            }
+
+          cogl_framebuffer_pop_matrix (framebuffer);
+        }
+    }
+
+  g_object_unref (pipeline);
+}
+
 TestCallback tests[] =
 {
-  test_rectangles
+  test_rectangles,
+  test_glyph_runs,
 };
 
 static void
@@ -108,7 +169,32 @@ on_paint (ClutterActor        *actor,
           ClutterPaintContext *paint_context,
           TestState           *state)
 {
+  CoglFramebuffer *framebuffer =
+    clutter_paint_context_get_framebuffer (paint_context);
+  CoglContext *ctx = cogl_framebuffer_get_context (framebuffer);
+  int64_t flush_time_us;
+
+  /* Flush what was drawn before so that only the quads of the test are
+   * accounted for */
+  cogl_framebuffer_flush (framebuffer);
+  flush_time_us = cogl_context_get_journal_flush_time (ctx);
+
+  state->n_quads = 0;
   tests[state->current_test] (state, paint_context);
+  cogl_framebuffer_flush (framebuffer);
+
+  state->n_flushed_quads += state->n_quads;
+  state->flush_time_us +=
+    cogl_context_get_journal_flush_time (ctx) - flush_time_us;
+
+  if (g_timer_elapsed (state->timer, NULL) >= 1 && state->flush_time_us > 0)
+    {
+      g_print ("journal flush: quads/ms=%.1f\n",
+               state->n_flushed_quads * 1000.0 / state->flush_time_us);
+      g_timer_start (state->timer);
+      state->n_flushed_quads = 0;
+      state->flush_time_us = 0;
+    }
 }
 
 static gboolean
@@ -131,7 +217,16 @@ main (int argc, char *argv[])
 
   clutter_test_init (&argc, &argv);
 
-  state.current_test = 0;
+  state = (TestState) { 0 };
+  if (argc > 1)
+    state.current_test = atoi (argv[1]);
+  if (state.current_test < 0 ||
+      state.current_test >= (int) G_N_ELEMENTS (tests))
+    {
+      g_printerr ("Usage: test-cogl-perf [TEST_INDEX]\n");
+      return EXIT_FAILURE;
+    }
+  state.timer = g_timer_new ();
 
   state.stage = stage = clutter_test_get_stage ();
   actor = g_object_new (CLUTTER_TYPE_TEST_ACTOR, NULL);
@@ -151,6 +246,7 @@ main (int argc, char *argv[])
   clutter_test_main ();
 
   clutter_actor_destroy (stage);
+  g_timer_destroy (state.timer);
 
   return 0;
 }
@@ -8,17 +8,48 @@
 #define N_ACTORS 100
 #define N_EVENTS 5
 
+/* How often the pick rate is reported, in microseconds */
+#define REPORT_INTERVAL_US G_USEC_PER_SEC
+
+static int64_t report_start_us = 0;
+static int64_t pick_time_us = 0;
+static int n_picks = 0;
+
 static gboolean
 motion_event_cb (ClutterActor *actor, ClutterEvent *event, gpointer user_data)
 {
   return FALSE;
 }
 
+static void
+report_pick_rate (void)
+{
+  int64_t now_us = g_get_monotonic_time ();
+
+  if (report_start_us == 0)
+    report_start_us = now_us;
+
+  if (now_us - report_start_us < REPORT_INTERVAL_US || pick_time_us == 0)
+    return;
+
+  printf ("%d picks in %.3f ms: %.0f picks/s\n",
+          n_picks,
+          pick_time_us / 1000.0,
+          n_picks * (double) G_USEC_PER_SEC / pick_time_us);
+
+  report_start_us = now_us;
+  pick_time_us = 0;
+  n_picks = 0;
+}
+
 static void
 do_events (ClutterActor *stage)
 {
   glong i;
   static gdouble angle = 0;
+  int64_t start_us;
+
+  start_us = g_get_monotonic_time ();
 
   for (i = 0; i < N_EVENTS; i++)
     {
@@ -34,6 +65,12 @@ do_events (ClutterActor *stage)
 				      (float) (256.0 + 206.0 * cos (angle)),
 				      (float) (256.0 + 206.0 * sin (angle)));
     }
+
+  /* Only the picks themselves are timed, not painting the stage */
+  pick_time_us += g_get_monotonic_time () - start_us;
+  n_picks += N_EVENTS;
+
+  report_pick_rate ();
 }
 
 static void
@@ -4,6 +4,7 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "clutter/pango/clutter-text-layout-cache.h"
 #include "tests/clutter-test-utils.h"
 
 #define STAGE_WIDTH  800
@@ -11,7 +12,9 @@
 
 static int font_size;
 static int n_chars;
+static int n_widths;
 static int rows, cols;
+static float label_width;
 
 static void
 on_after_paint (ClutterActor        *actor,
@@ -21,6 +24,7 @@ on_after_paint (ClutterActor        *actor,
 {
   static GTimer *timer = NULL;
   static int fps = 0;
+  static ClutterTextLayoutCacheStats last_stats = { 0 };
 
   if (!timer)
     {
@@ -30,20 +34,62 @@ on_after_paint (ClutterActor        *actor,
 
   if (g_timer_elapsed (timer, NULL) >= 1)
     {
-      printf ("fps=%d, strings/sec=%d, chars/sec=%d\n",
+      ClutterTextLayoutCacheStats stats;
+      unsigned int hits, misses;
+
+      clutter_context_get_text_layout_cache_stats (clutter_test_get_context (),
+                                                   &stats);
+      hits = stats.hits - last_stats.hits;
+      misses = stats.misses - last_stats.misses;
+
+      printf ("fps=%d, strings/sec=%d, chars/sec=%d, "
+              "layout cache hits=%u, misses=%u, hit rate=%.1f%%, "
+              "layouts=%u, size=%zu\n",
 	      fps,
 	      fps * rows * cols,
-	      fps * rows * cols * n_chars);
+	      fps * rows * cols * n_chars,
+              hits, misses,
+              hits + misses > 0 ? 100.0 * hits / (hits + misses) : 0.0,
+              stats.n_layouts, stats.size);
       g_timer_start (timer);
       fps = 0;
+      last_stats = stats;
     }
 
   ++fps;
 }
 
+static void
+measure_labels (ClutterActor *stage)
+{
+  static int frame = 0;
+  ClutterActor *label;
+  int i;
+
+  /* Measure the labels at several widths each frame, like flow and box
+   * layouts negotiating the size of wrapped labels do */
+  for (label = clutter_actor_get_first_child (stage);
+       label != NULL;
+       label = clutter_actor_get_next_sibling (label))
+    {
+      for (i = 0; i < n_widths; i++)
+        {
+          float for_width;
+
+          for_width = label_width * (1 + (frame + i) % n_widths) / n_widths;
+          clutter_actor_get_preferred_height (label, for_width, NULL, NULL);
+        }
+    }
+
+  frame++;
+}
+
 static gboolean
 queue_redraw (gpointer stage)
 {
+  if (n_widths > 0)
+    measure_labels (CLUTTER_ACTOR (stage));
+
   clutter_actor_queue_redraw (CLUTTER_ACTOR (stage));
 
   return G_SOURCE_CONTINUE;
@@ -101,6 +147,9 @@ create_label (void)
   label = clutter_text_new_with_text (font_name, str->str);
   clutter_text_set_color (CLUTTER_TEXT (label), &label_color);
 
+  if (n_widths > 0)
+    clutter_text_set_line_wrap (CLUTTER_TEXT (label), TRUE);
+
   g_free (font_name);
   g_string_free (str, TRUE);
 
@@ -121,16 +170,20 @@ main (int argc, char *argv[])
 
   clutter_test_init (&argc, &argv);
 
-  if (argc != 3)
+  if (argc != 3 && argc != 4)
     {
-      g_printerr ("Usage test-text-perf FONT_SIZE N_CHARS\n");
+      g_printerr ("Usage test-text-perf FONT_SIZE N_CHARS [N_WIDTHS]\n");
       exit (1);
     }
 
   font_size = atoi (argv[1]);
   n_chars = atoi (argv[2]);
+  if (argc == 4)
+    n_widths = atoi (argv[3]);
 
   g_print ("Monospace %dpx, string length = %d\n", font_size, n_chars);
+  if (n_widths > 0)
+    g_print ("Measuring at %d widths per frame\n", n_widths);
 
   stage = clutter_test_get_stage ();
   clutter_actor_set_size (stage, STAGE_WIDTH, STAGE_HEIGHT);
@@ -142,6 +195,7 @@ main (int argc, char *argv[])
   label = create_label ();
   w = (int) clutter_actor_get_width (label);
   h = (int) clutter_actor_get_height (label);
+  label_width = w;
 
   /* If the label is too big to fit on the stage then scale it so that
      it will fit */
@@ -0,0 +1,263 @@
+#include "config.h"
+
+#include "cogl/cogl.h"
+#include "cogl/cogl-bitmap-private.h"
+#include "cogl/cogl-cpu-caps.h"
+#include "tests/cogl-test-utils.h"
+
+#define TEST_WIDTH 67
+#define TEST_HEIGHT 3
+
+#define BENCHMARK_WIDTH 1920
+#define BENCHMARK_HEIGHT 1080
+#define BENCHMARK_SECONDS 0.5
+
+typedef struct
+{
+  CoglPixelFormat src_format;
+  CoglPixelFormat dst_format;
+} FormatPair;
+
+static const FormatPair format_pairs[] = {
+  { COGL_PIXEL_FORMAT_BGRA_8888_PRE, COGL_PIXEL_FORMAT_RGBA_8888_PRE },
+  { COGL_PIXEL_FORMAT_RGBA_8888_PRE, COGL_PIXEL_FORMAT_BGRA_8888_PRE },
+  { COGL_PIXEL_FORMAT_XRGB_8888, COGL_PIXEL_FORMAT_RGBA_8888 },
+  { COGL_PIXEL_FORMAT_ARGB_8888, COGL_PIXEL_FORMAT_XBGR_8888 },
+  { COGL_PIXEL_FORMAT_BGRA_8888, COGL_PIXEL_FORMAT_RGBA_8888_PRE },
+  { COGL_PIXEL_FORMAT_ARGB_8888_PRE, COGL_PIXEL_FORMAT_ABGR_8888 },
+  { COGL_PIXEL_FORMAT_RGBA_8888, COGL_PIXEL_FORMAT_RGBA_8888_PRE },
+  { COGL_PIXEL_FORMAT_RGBA_8888_PRE, COGL_PIXEL_FORMAT_RGBA_8888 },
+  { COGL_PIXEL_FORMAT_XRGB_2101010, COGL_PIXEL_FORMAT_XRGB_8888 },
+  { COGL_PIXEL_FORMAT_ABGR_2101010_PRE, COGL_PIXEL_FORMAT_RGBA_8888_PRE },
+  { COGL_PIXEL_FORMAT_RGBA_1010102, COGL_PIXEL_FORMAT_BGRA_8888_PRE },
+  { COGL_PIXEL_FORMAT_RGBA_FP_16161616_PRE,
+    COGL_PIXEL_FORMAT_RGBA_FP_32323232_PRE },
+  { COGL_PIXEL_FORMAT_RGBA_FP_32323232_PRE,
+    COGL_PIXEL_FORMAT_RGBA_FP_16161616_PRE },
+};
+
+static void
+fill_random (uint8_t         *data,
+             CoglPixelFormat  format,
+             size_t           n_pixels)
+{
+  size_t i;
+
+  if (format == COGL_PIXEL_FORMAT_RGBA_FP_32323232_PRE)
+    {
+      float *floats = (float *) data;
+
+      for (i = 0; i < n_pixels * 4; i++)
+        floats[i] = (float) g_test_rand_double_range (-0.5, 1.5);
+    }
+  else if (format == COGL_PIXEL_FORMAT_RGBA_FP_16161616_PRE)
+    {
+      uint16_t *halves = (uint16_t *) data;
+
+      /* Keep clear of NaNs and infinities */
+      for (i = 0; i < n_pixels * 4; i++)
+        halves[i] = g_test_rand_int_range (0, 0x7c00);
+    }
+  else
+    {
+      size_t bpp = cogl_pixel_format_get_bytes_per_pixel (format, 0);
+
+      for (i = 0; i < n_pixels * bpp; i++)
+        data[i] = g_test_rand_int_range (0, 256);
+    }
+}
+
+static void
+convert (CoglPixelFormat  src_format,
+         uint8_t         *src_data,
+         CoglPixelFormat  dst_format,
+         uint8_t         *dst_data,
+         int              width,
+         int              height)
+{
+  g_autoptr (CoglBitmap) src_bitmap = NULL;
+  g_autoptr (CoglBitmap) dst_bitmap = NULL;
+  g_autoptr (GError) error = NULL;
+
+  src_bitmap = cogl_bitmap_new_for_data (test_ctx, width, height,
+                                         src_format, 0, src_data);
+  dst_bitmap = cogl_bitmap_new_for_data (test_ctx, width, height,
+                                         dst_format, 0, dst_data);
+
+  g_assert_true (_cogl_bitmap_convert_into_bitmap (src_bitmap, dst_bitmap,
+                                                   &error));
+  g_assert_no_error (error);
+}
+
+static void
+test_bitmap_conversion_kernels (void)
+{
+  CoglCpuCaps cpu_caps = cogl_cpu_caps;
+  int i;
+
+  /* The dispatched kernels must give exactly the same results as the
+   * plain C ones, including for the pixels left over at the end of each
+   * row. */
+  for (i = 0; i < G_N_ELEMENTS (format_pairs); i++)
+    {
+      CoglPixelFormat src_format = format_pairs[i].src_format;
+      CoglPixelFormat dst_format = format_pairs[i].dst_format;
+      int src_bpp = cogl_pixel_format_get_bytes_per_pixel (src_format, 0);
+      int dst_bpp = cogl_pixel_format_get_bytes_per_pixel (dst_format, 0);
+      g_autofree uint8_t *src_data = NULL;
+      g_autofree uint8_t *expected = NULL;
+      g_autofree uint8_t *result = NULL;
+      size_t dst_size = TEST_WIDTH * TEST_HEIGHT * dst_bpp;
+
+      src_data = g_malloc (TEST_WIDTH * TEST_HEIGHT * src_bpp);
+      expected = g_malloc (dst_size);
+      result = g_malloc (dst_size);
+
+      fill_random (src_data, src_format, TEST_WIDTH * TEST_HEIGHT);
+
+      cogl_cpu_caps = 0;
+      convert (src_format, src_data, dst_format, expected,
+               TEST_WIDTH, TEST_HEIGHT);
+
+      cogl_cpu_caps = cpu_caps;
+      convert (src_format, src_data, dst_format, result,
+               TEST_WIDTH, TEST_HEIGHT);
+
+      g_test_message ("%s -> %s",
+                      cogl_pixel_format_to_string (src_format),
+                      cogl_pixel_format_to_string (dst_format));
+      g_assert_cmpmem (result, dst_size, expected, dst_size);
+    }
+}
+
+static void
+test_bitmap_conversion_values (void)
+{
+  uint32_t argb_2101010[] = {
+    0xffffffff,
+    0xa0080000,
+    0x40000000 | (0x3ff << 20),
+    0x00000000,
+  };
+  uint8_t bgra_8888[] = {
+    0x10, 0x20, 0x30, 0x40,
+    0x00, 0x00, 0xff, 0x00,
+    0x80, 0x80, 0x80, 0xff,
+    0xff, 0xff, 0xff, 0x80,
+  };
+  uint8_t result[4 * 4];
+
+  /* 10-bit components are rounded to the nearest 8-bit value and 2-bit
+   * alpha spans the whole range */
+  convert (COGL_PIXEL_FORMAT_ARGB_2101010, (uint8_t *) argb_2101010,
+           COGL_PIXEL_FORMAT_RGBA_8888, result,
+           4, 1);
+  g_assert_cmpmem (result, 4,
+                   ((uint8_t []) { 0xff, 0xff, 0xff, 0xff }), 4);
+  g_assert_cmpmem (result + 4, 4,
+                   ((uint8_t []) { 0x80, 0x80, 0x00, 0xaa }), 4);
+  g_assert_cmpmem (result + 8, 4,
+                   ((uint8_t []) { 0xff, 0x00, 0x00, 0x55 }), 4);
+  g_assert_cmpmem (result + 12, 4,
+                   ((uint8_t []) { 0x00, 0x00, 0x00, 0x00 }), 4);
+
+  convert (COGL_PIXEL_FORMAT_BGRA_8888, bgra_8888,
+           COGL_PIXEL_FORMAT_XRGB_8888, result,
+           4, 1);
+  g_assert_cmpmem (result, 4,
+                   ((uint8_t []) { 0xff, 0x30, 0x20, 0x10 }), 4);
+  g_assert_cmpmem (result + 4, 4,
+                   ((uint8_t []) { 0xff, 0xff, 0x00, 0x00 }), 4);
+
+  convert (COGL_PIXEL_FORMAT_BGRA_8888, bgra_8888,
+           COGL_PIXEL_FORMAT_RGBA_8888_PRE, result,
+           4, 1);
+  g_assert_cmpmem (result, 4,
+                   ((uint8_t []) { 0x0c, 0x08, 0x04, 0x40 }), 4);
+  g_assert_cmpmem (result + 4, 4,
+                   ((uint8_t []) { 0x00, 0x00, 0x00, 0x00 }), 4);
+  g_assert_cmpmem (result + 8, 4,
+                   ((uint8_t []) { 0x80, 0x80, 0x80, 0xff }), 4);
+  g_assert_cmpmem (result + 12, 4,
+                   ((uint8_t []) { 0x80, 0x80, 0x80, 0x80 }), 4);
+}
+
+static double
+measure_throughput (CoglPixelFormat  src_format,
+                    uint8_t         *src_data,
+                    CoglPixelFormat  dst_format,
+                    uint8_t         *dst_data)
+{
+  size_t n_bytes;
+  g_autoptr (GTimer) timer = NULL;
+  int n_iterations = 0;
+
+  n_bytes = ((size_t) BENCHMARK_WIDTH * BENCHMARK_HEIGHT *
+             cogl_pixel_format_get_bytes_per_pixel (src_format, 0));
+
+  timer = g_timer_new ();
+  do
+    {
+      convert (src_format, src_data, dst_format, dst_data,
+               BENCHMARK_WIDTH, BENCHMARK_HEIGHT);
+      n_iterations++;
+    }
+  while (g_timer_elapsed (timer, NULL) < BENCHMARK_SECONDS);
+
+  return (n_bytes * n_iterations) / g_timer_elapsed (timer, NULL) / 1e6;
+}
+
+static void
+test_bitmap_conversion_benchmark (void)
+{
+  CoglCpuCaps cpu_caps = cogl_cpu_caps;
+  int i;
+
+  if (!g_test_perf ())
+    {
+      g_test_skip ("Benchmarks only run in perf mode");
+      return;
+    }
+
+  for (i = 0; i < G_N_ELEMENTS (format_pairs); i++)
+    {
+      CoglPixelFormat src_format = format_pairs[i].src_format;
+      CoglPixelFormat dst_format = format_pairs[i].dst_format;
+      size_t n_pixels = BENCHMARK_WIDTH * BENCHMARK_HEIGHT;
+      g_autofree uint8_t *src_data = NULL;
+      g_autofree uint8_t *dst_data = NULL;
+      double scalar_mb_s, dispatched_mb_s;
+
+      src_data =
+        g_malloc (n_pixels *
+                  cogl_pixel_format_get_bytes_per_pixel (src_format, 0));
+      dst_data =
+        g_malloc (n_pixels *
+                  cogl_pixel_format_get_bytes_per_pixel (dst_format, 0));
+      fill_random (src_data, src_format, n_pixels);
+
+      cogl_cpu_caps = 0;
+      scalar_mb_s = measure_throughput (src_format, src_data,
+                                        dst_format, dst_data);
+      cogl_cpu_caps = cpu_caps;
+      dispatched_mb_s = measure_throughput (src_format, src_data,
+                                            dst_format, dst_data);
+
+      g_test_maximized_result (dispatched_mb_s,
+                               "%s -> %s: %.1f MB/s (%.1f MB/s without "
+                               "SIMD dispatch)",
+                               cogl_pixel_format_to_string (src_format),
+                               cogl_pixel_format_to_string (dst_format),
+                               dispatched_mb_s,
+                               scalar_mb_s);
+    }
+}
+
+COGL_TEST_SUITE (
+  g_test_add_func ("/bitmap-conversion/kernels",
+                   test_bitmap_conversion_kernels);
+  g_test_add_func ("/bitmap-conversion/values",
+                   test_bitmap_conversion_values);
+  g_test_add_func ("/bitmap-conversion/benchmark",
+                   test_bitmap_conversion_benchmark);
+)
@@ -0,0 +1,149 @@
+#include "config.h"
+
+#include "cogl/cogl.h"
+#include "cogl/cogl-journal-private.h"
+#include "tests/cogl-test-utils.h"
+
+#define N_MATRICES 64
+#define N_QUADS 37
+#define MAX_LAYERS 3
+
+/* The scalar kernel may be compiled with fused multiply-adds, which the
+ * vector kernels don't use, so allow for a few units in the last place of
+ * the largest intermediate values, which stay below 32768 */
+#define MAX_ERROR 0.01f
+
+/* The vector kernels store four floats per vertex, so leave room for the
+ * color after the position, as the journal does */
+#define VB_STRIDE_FOR_N_LAYERS(n_layers) (3 + 1 + 2 * MAX (n_layers, 2))
+#define ARRAY_STRIDE_FOR_N_LAYERS(n_layers) (2 + 2 * (n_layers))
+
+static void
+init_random_matrix (graphene_matrix_t *matrix)
+{
+  float m[16];
+  int i;
+
+  for (i = 0; i < 16; i++)
+    m[i] = (float) g_test_rand_double_range (-4.0, 4.0);
+
+  /* Include translations in the range of typical stage coordinates */
+  for (i = 12; i < 15; i++)
+    m[i] = (float) g_test_rand_double_range (-4096.0, 4096.0);
+
+  graphene_matrix_init_from_float (matrix, m);
+}
+
+static void
+fill_random_quads (float *vin,
+                   int    n_layers,
+                   int    n_quads)
+{
+  size_t array_stride = ARRAY_STRIDE_FOR_N_LAYERS (n_layers);
+  size_t in_stride = 1 + array_stride * 2;
+  int i;
+
+  for (i = 0; i < (int) in_stride * n_quads; i++)
+    vin[i] = (float) g_test_rand_double_range (-2048.0, 2048.0);
+}
+
+static void
+test_journal_transform_kernels (void)
+{
+  int n_layers;
+  int i;
+
+  for (n_layers = 0; n_layers <= MAX_LAYERS; n_layers++)
+    {
+      size_t array_stride = ARRAY_STRIDE_FOR_N_LAYERS (n_layers);
+      size_t in_stride = 1 + array_stride * 2;
+      size_t vb_stride = VB_STRIDE_FOR_N_LAYERS (n_layers);
+      size_t out_len = vb_stride * 4 * N_QUADS;
+      g_autofree float *vin = NULL;
+      g_autofree float *expected = NULL;
+      g_autofree float *result = NULL;
+
+      vin = g_new (float, in_stride * N_QUADS);
+      expected = g_new0 (float, out_len);
+      result = g_new0 (float, out_len);
+
+      for (i = 0; i < N_MATRICES; i++)
+        {
+          graphene_matrix_t matrix;
+          int n_quads;
+          int j;
+
+          init_random_matrix (&matrix);
+          fill_random_quads (vin, n_layers, N_QUADS);
+
+          /* Cover runs of every length up to N_QUADS */
+          n_quads = 1 + i % N_QUADS;
+
+          /* The positions start after the color of the first quad */
+          _cogl_journal_transform_quads_scalar (&matrix,
+                                                vin + 1,
+                                                in_stride, array_stride,
+                                                expected, vb_stride,
+                                                n_quads);
+          _cogl_journal_transform_quads (&matrix,
+                                         vin + 1,
+                                         in_stride, array_stride,
+                                         result, vb_stride,
+                                         n_quads);
+
+          for (j = 0; j < n_quads * 4; j++)
+            {
+              int k;
+
+              for (k = 0; k < 3; k++)
+                {
+                  g_assert_cmpfloat_with_epsilon (result[vb_stride * j + k],
+                                                  expected[vb_stride * j + k],
+                                                  MAX_ERROR);
+                }
+            }
+        }
+    }
+}
+
+static void
+test_journal_transform_values (void)
+{
+  graphene_matrix_t matrix;
+  /* Color, top left and bottom right corners of a quad without layers */
+  float vin[] = { 0.0f, 10.0f, 20.0f, 30.0f, 50.0f };
+  float expected[][3] = {
+    { 110.0f, 270.0f, 0.0f },
+    { 110.0f, 360.0f, 0.0f },
+    { 130.0f, 360.0f, 0.0f },
+    { 130.0f, 270.0f, 0.0f },
+  };
+  size_t vb_stride = VB_STRIDE_FOR_N_LAYERS (0);
+  float vout[VB_STRIDE_FOR_N_LAYERS (0) * 4] = { 0 };
+  int i, k;
+
+  /* Scale y by 3 and translate by (100, 210) */
+  graphene_matrix_init_scale (&matrix, 1.0f, 3.0f, 1.0f);
+  graphene_matrix_translate (&matrix,
+                             &GRAPHENE_POINT3D_INIT (100.0f, 210.0f, 0.0f));
+
+  _cogl_journal_transform_quads (&matrix,
+                                 vin + 1,
+                                 1 + ARRAY_STRIDE_FOR_N_LAYERS (0) * 2,
+                                 ARRAY_STRIDE_FOR_N_LAYERS (0),
+                                 vout, vb_stride,
+                                 1);
+
+  for (i = 0; i < 4; i++)
+    {
+      for (k = 0; k < 3; k++)
+        g_assert_cmpfloat (vout[vb_stride * i + k], ==, expected[i][k]);
+    }
+}
+
+COGL_TEST_SUITE (
+  g_test_add_func ("/journal-transform/kernels",
+                   test_journal_transform_kernels);
+  g_test_add_func ("/journal-transform/values",
+                   test_journal_transform_values);
+)
@@ -42,7 +42,54 @@ test_pipeline_opengl_blend_enable (void)
   g_object_unref (pipeline);
 }
 
+/* Depending on the state of the program binary cache, a program is
+ * either built or loaded */
+static unsigned int
+get_n_programs (void)
+{
+  return cogl_context_get_n_built_programs (test_ctx) +
+         cogl_context_get_n_loaded_programs (test_ctx);
+}
+
+static void
+test_pipeline_opengl_precompile (void)
+{
+  CoglPipeline *pipeline;
+  CoglPipeline *copy;
+  CoglSnippet *snippet;
+  CoglColor color;
+  unsigned int n_programs;
+
+  pipeline = cogl_pipeline_new (test_ctx);
+  snippet = cogl_snippet_new (COGL_SNIPPET_HOOK_FRAGMENT,
+                              NULL,
+                              "cogl_color_out.g = 0.5;");
+  cogl_pipeline_add_snippet (pipeline, snippet);
+  g_object_unref (snippet);
+
+  n_programs = get_n_programs ();
+
+  /* Precompiling should build or load exactly one program */
+  cogl_framebuffer_precompile_pipeline (test_fb, pipeline);
+  g_assert_cmpuint (get_n_programs (), ==, n_programs + 1);
+
+  /* A different pipeline generating the same code should then be able
+   * to draw without building or loading another one */
+  copy = cogl_pipeline_copy (pipeline);
+  cogl_color_init_from_4f (&color, 1.0, 0.0, 0.0, 1.0);
+  cogl_pipeline_set_color (copy, &color);
+  cogl_framebuffer_draw_rectangle (test_fb, copy, 0, 0, 1, 1);
+  _cogl_framebuffer_flush_journal (test_fb);
+
+  g_assert_cmpuint (get_n_programs (), ==, n_programs + 1);
+
+  g_object_unref (copy);
+  g_object_unref (pipeline);
+}
+
 COGL_TEST_SUITE (
   g_test_add_func ("/pipeline/opengl/blend-enable",
                    test_pipeline_opengl_blend_enable);
+  g_test_add_func ("/pipeline/opengl/precompile",
+                   test_pipeline_opengl_precompile);
 )
@@ -0,0 +1,233 @@
+/*
+ * Copyright (C) 2026 Red Hat Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * X11 frame mask benchmark. For a range of window sizes up to 4K, the
+ * shape region and mask texture of a decorated X11 window are rebuilt the
+ * way a reshape does, for a client without a shape and for a shaped
+ * client. The results are written as JSON to the file named by
+ * MUTTER_BENCHMARK_OUTPUT, or to stdout when it is unset.
+ *
+ * MUTTER_FRAME_MASK_BENCHMARK_ITERATIONS overrides the number of reshapes
+ * per window size and scenario.
+ */
+
+#include "config.h"
+
+#include "compositor/meta-window-actor-x11.h"
+#include "meta-test/meta-context-test.h"
+#include "tests/meta-benchmark-utils.h"
+
+#define DEFAULT_N_ITERATIONS 100
+#define FRAME_BORDER_WIDTH 1
+#define FRAME_TITLEBAR_HEIGHT 37
+#define SHAPE_CUTOUT_SIZE 16
+
+typedef struct _WindowSize
+{
+  int width;
+  int height;
+} WindowSize;
+
+typedef struct _Scenario
+{
+  const char *name;
+  gboolean shaped;
+} Scenario;
+
+static const WindowSize window_sizes[] = {
+  { 1280, 720 },
+  { 1920, 1080 },
+  { 2560, 1440 },
+  { 3840, 2160 },
+};
+
+static const Scenario scenarios[] = {
+  { "unshaped", FALSE },
+  { "shaped", TRUE },
+};
+
+static MetaContext *test_context;
+
+static MtkRegion *
+create_client_shape (const MtkRectangle *client_area,
+                     gboolean            shaped)
+{
+  MtkRegion *region;
+  MtkRectangle cutout;
+  int x, y;
+
+  region = mtk_region_create_rectangle (client_area);
+  if (!shaped)
+    return region;
+
+  /* Cut a checkerboard of holes along the edges, similar to what shaped
+   * clients with irregular outlines end up with. */
+  for (x = 0; x < client_area->width; x += 2 * SHAPE_CUTOUT_SIZE)
+    {
+      cutout = (MtkRectangle) {
+        .x = client_area->x + x,
+        .y = client_area->y,
+        .width = SHAPE_CUTOUT_SIZE,
+        .height = SHAPE_CUTOUT_SIZE,
+      };
+      mtk_region_subtract_rectangle (region, &cutout);
+
+      cutout.y = client_area->y + client_area->height - SHAPE_CUTOUT_SIZE;
+      mtk_region_subtract_rectangle (region, &cutout);
+    }
+
+  for (y = 0; y < client_area->height; y += 2 * SHAPE_CUTOUT_SIZE)
+    {
+      cutout = (MtkRectangle) {
+        .x = client_area->x,
+        .y = client_area->y + y,
+        .width = SHAPE_CUTOUT_SIZE,
+        .height = SHAPE_CUTOUT_SIZE,
+      };
+      mtk_region_subtract_rectangle (region, &cutout);
+
+      cutout.x = client_area->x + client_area->width - SHAPE_CUTOUT_SIZE;
+      mtk_region_subtract_rectangle (region, &cutout);
+    }
+
+  return region;
+}
+
+static void
+append_result (GString          *result,
+               const Scenario   *scenario,
+               const WindowSize *window_size,
+               int64_t          *values,
+               int               n_values)
+{
+  MetaBenchmarkStatistics statistics;
+
+  meta_benchmark_compute_statistics (values, n_values, &statistics);
+
+  g_string_append_printf (result,
+                          "{ \"scenario\": \"%s\", "
+                          "\"width\": %d, \"height\": %d, "
+                          "\"iterations\": %d, \"unit\": \"us\", ",
+                          scenario->name,
+                          window_size->width, window_size->height,
+                          n_values);
+  meta_benchmark_append_statistics (result, &statistics);
+  g_string_append_printf (result,
+                          ", \"reshapes_per_second\": %.1f }",
+                          statistics.mean > 0.0 ? 1000000.0 / statistics.mean
+                                                : 0.0);
+}
+
+static void
+run_benchmark (void)
+{
+  MetaBackend *backend = meta_context_get_backend (test_context);
+  ClutterBackend *clutter_backend =
+    meta_backend_get_clutter_backend (backend);
+  CoglContext *cogl_context =
+    clutter_backend_get_cogl_context (clutter_backend);
+  g_autoptr (MetaBenchmarkReport) report = NULL;
+  g_autofree int64_t *values = NULL;
+  g_autoptr (GError) error = NULL;
+  int n_iterations;
+  size_t i, j;
+
+  n_iterations =
+    meta_benchmark_get_env_count ("MUTTER_FRAME_MASK_BENCHMARK_ITERATIONS",
+                                  DEFAULT_N_ITERATIONS);
+  values = g_new0 (int64_t, n_iterations);
+
+  report = meta_benchmark_report_new ();
+
+  for (i = 0; i < G_N_ELEMENTS (scenarios); i++)
+    {
+      for (j = 0; j < G_N_ELEMENTS (window_sizes); j++)
+        {
+          const WindowSize *window_size = &window_sizes[j];
+          MtkRectangle frame_area = {
+            .width = window_size->width,
+            .height = window_size->height,
+          };
+          MtkRectangle client_area = {
+            .x = FRAME_BORDER_WIDTH,
+            .y = FRAME_TITLEBAR_HEIGHT,
+            .width = window_size->width - 2 * FRAME_BORDER_WIDTH,
+            .height = (window_size->height - FRAME_TITLEBAR_HEIGHT -
+                       FRAME_BORDER_WIDTH),
+          };
+          g_autoptr (MtkRegion) client_shape = NULL;
+          int k;
+
+          client_shape = create_client_shape (&client_area,
+                                              scenarios[i].shaped);
+
+          for (k = 0; k < n_iterations; k++)
+            {
+              g_autoptr (MtkRegion) shape_region = NULL;
+              g_autoptr (CoglTexture) mask_texture = NULL;
+              int64_t start_time_us;
+
+              start_time_us = g_get_monotonic_time ();
+
+              shape_region = mtk_region_copy (client_shape);
+              mask_texture =
+                meta_window_actor_x11_build_frame_mask (cogl_context,
+                                                        shape_region,
+                                                        window_size->width,
+                                                        window_size->height,
+                                                        &client_area,
+                                                        &frame_area,
+                                                        &error);
+              g_assert_no_error (error);
+
+              values[k] = g_get_monotonic_time () - start_time_us;
+            }
+
+          append_result (meta_benchmark_report_add_result (report),
+                         &scenarios[i], window_size,
+                         values, n_iterations);
+        }
+    }
+
+  if (!meta_benchmark_report_write (report, &error))
+    g_error ("Failed to write benchmark results: %s", error->message);
+}
+
+static void
+init_tests (void)
+{
+  g_test_add_func ("/benchmark/x11/frame-mask", run_benchmark);
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  g_autoptr (MetaContext) context = NULL;
+
+  context = meta_create_test_context (META_CONTEXT_TEST_TYPE_HEADLESS,
+                                      META_CONTEXT_TEST_FLAG_NO_X11);
+  g_assert_true (meta_context_configure (context, &argc, &argv, NULL));
+
+  test_context = context;
+
+  init_tests ();
+
+  return meta_context_test_run_tests (META_CONTEXT_TEST (context),
+                                      META_TEST_RUN_FLAG_NONE);
+}
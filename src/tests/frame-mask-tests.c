@@ -0,0 +1,289 @@
+/*
+ * Copyright (C) 2026 Red Hat Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include "compositor/meta-window-actor-x11.h"
+#include "meta-test/meta-context-test.h"
+
+#define FRAME_BORDER_WIDTH 2
+#define FRAME_TITLEBAR_HEIGHT 30
+
+static MetaContext *test_context;
+
+static CoglContext *
+get_cogl_context (void)
+{
+  MetaBackend *backend = meta_context_get_backend (test_context);
+  ClutterBackend *clutter_backend =
+    meta_backend_get_clutter_backend (backend);
+
+  return clutter_backend_get_cogl_context (clutter_backend);
+}
+
+static void
+get_frame_geometry (int           width,
+                    int           height,
+                    MtkRectangle *client_area,
+                    MtkRectangle *frame_area)
+{
+  *frame_area = (MtkRectangle) {
+    .width = width,
+    .height = height,
+  };
+  *client_area = (MtkRectangle) {
+    .x = FRAME_BORDER_WIDTH,
+    .y = FRAME_TITLEBAR_HEIGHT,
+    .width = width - 2 * FRAME_BORDER_WIDTH,
+    .height = height - FRAME_TITLEBAR_HEIGHT - FRAME_BORDER_WIDTH,
+  };
+}
+
+/* Which pixels are visible, computed pixel by pixel the way the cairo
+ * based implementation used to */
+static gboolean
+is_pixel_visible (MtkRegion          *client_shape,
+                  const MtkRectangle *client_area,
+                  const MtkRectangle *frame_area,
+                  int                 x,
+                  int                 y)
+{
+  MtkRectangle pixel = { x, y, 1, 1 };
+
+  if (mtk_region_contains_point (client_shape, x, y))
+    return TRUE;
+
+  if (!frame_area)
+    return FALSE;
+
+  return (mtk_rectangle_contains_rect (frame_area, &pixel) &&
+          !mtk_rectangle_contains_rect (client_area, &pixel));
+}
+
+static void
+assert_frame_mask (MtkRegion          *client_shape,
+                   int                 width,
+                   int                 height,
+                   const MtkRectangle *client_area,
+                   const MtkRectangle *frame_area)
+{
+  g_autoptr (MtkRegion) shape_region = NULL;
+  g_autoptr (CoglTexture) mask_texture = NULL;
+  g_autoptr (GError) error = NULL;
+  g_autofree uint8_t *mask_data = NULL;
+  int x, y;
+
+  shape_region = mtk_region_copy (client_shape);
+  mask_texture =
+    meta_window_actor_x11_build_frame_mask (get_cogl_context (),
+                                            shape_region,
+                                            width, height,
+                                            client_area,
+                                            frame_area,
+                                            &error);
+  g_assert_no_error (error);
+
+  mask_data = g_malloc (width * height);
+  if (mask_texture)
+    {
+      g_assert_cmpint (cogl_texture_get_width (mask_texture), ==, width);
+      g_assert_cmpint (cogl_texture_get_height (mask_texture), ==, height);
+
+      cogl_texture_get_data (mask_texture, COGL_PIXEL_FORMAT_A_8,
+                             width, mask_data);
+    }
+  else
+    {
+      /* No mask means the whole surface is visible */
+      memset (mask_data, 255, width * height);
+    }
+
+  for (y = 0; y < height; y++)
+    {
+      for (x = 0; x < width; x++)
+        {
+          gboolean visible;
+
+          visible = is_pixel_visible (client_shape, client_area, frame_area,
+                                      x, y);
+
+          if (mask_data[y * width + x] != (visible ? 255 : 0))
+            {
+              g_error ("Mask pixel %d,%d of %dx%d surface is %d, expected %d",
+                       x, y, width, height,
+                       mask_data[y * width + x], visible ? 255 : 0);
+            }
+
+          /* The visible frame is also added to the shape region */
+          g_assert_cmpint (mtk_region_contains_point (shape_region, x, y),
+                           ==,
+                           visible);
+        }
+    }
+}
+
+static MtkRegion *
+create_notched_shape (const MtkRectangle *client_area,
+                      int                 notch_size)
+{
+  MtkRegion *region;
+  MtkRectangle notch;
+
+  region = mtk_region_create_rectangle (client_area);
+
+  notch = (MtkRectangle) {
+    .x = client_area->x,
+    .y = client_area->y,
+    .width = notch_size,
+    .height = notch_size,
+  };
+  mtk_region_subtract_rectangle (region, &notch);
+
+  notch.x = client_area->x + client_area->width - notch_size;
+  notch.y = client_area->y + client_area->height - notch_size;
+  mtk_region_subtract_rectangle (region, &notch);
+
+  return region;
+}
+
+static void
+meta_test_frame_mask_resize (void)
+{
+  static const struct {
+    int width;
+    int height;
+  } sizes[] = {
+    { 100, 80 },
+    { 160, 80 },
+    { 160, 120 },
+    { 64, 48 },
+  };
+  size_t i;
+
+  for (i = 0; i < G_N_ELEMENTS (sizes); i++)
+    {
+      MtkRectangle client_area;
+      MtkRectangle frame_area;
+      g_autoptr (MtkRegion) unshaped = NULL;
+      g_autoptr (MtkRegion) shaped = NULL;
+
+      get_frame_geometry (sizes[i].width, sizes[i].height,
+                          &client_area, &frame_area);
+
+      unshaped = mtk_region_create_rectangle (&client_area);
+      assert_frame_mask (unshaped, sizes[i].width, sizes[i].height,
+                         &client_area, &frame_area);
+
+      shaped = create_notched_shape (&client_area, 8);
+      assert_frame_mask (shaped, sizes[i].width, sizes[i].height,
+                         &client_area, &frame_area);
+    }
+}
+
+static void
+meta_test_frame_mask_shape_change (void)
+{
+  MtkRectangle client_area;
+  MtkRectangle frame_area;
+  MtkRectangle bounds = { 0, 0, 120, 90 };
+  MtkRectangle hole = { 30, 40, 20, 10 };
+  int notch_size;
+
+  get_frame_geometry (bounds.width, bounds.height,
+                      &client_area, &frame_area);
+
+  for (notch_size = 0; notch_size <= 16; notch_size += 4)
+    {
+      g_autoptr (MtkRegion) shape = NULL;
+
+      shape = create_notched_shape (&client_area, notch_size);
+      assert_frame_mask (shape, bounds.width, bounds.height,
+                         &client_area, &frame_area);
+
+      /* A hole in the middle of the client */
+      mtk_region_subtract_rectangle (shape, &hole);
+      assert_frame_mask (shape, bounds.width, bounds.height,
+                         &client_area, &frame_area);
+    }
+}
+
+static void
+meta_test_frame_mask_frame_overlap (void)
+{
+  MtkRectangle client_area;
+  MtkRectangle frame_area;
+  g_autoptr (MtkRegion) shape = NULL;
+
+  get_frame_geometry (100, 80, &client_area, &frame_area);
+
+  /* A client shape extending into the frame, and a frame smaller than
+   * the surface, as while a resize is pending */
+  client_area.y -= 4;
+  client_area.height += 4;
+  shape = create_notched_shape (&client_area, 6);
+  frame_area.width -= 10;
+  frame_area.height -= 10;
+
+  assert_frame_mask (shape, 100, 80, &client_area, &frame_area);
+}
+
+static void
+meta_test_frame_mask_no_frame (void)
+{
+  MtkRectangle bounds = { 0, 0, 90, 70 };
+  g_autoptr (MtkRegion) unshaped = NULL;
+  g_autoptr (MtkRegion) shaped = NULL;
+
+  unshaped = mtk_region_create_rectangle (&bounds);
+  assert_frame_mask (unshaped, bounds.width, bounds.height, NULL, NULL);
+
+  shaped = create_notched_shape (&bounds, 10);
+  assert_frame_mask (shaped, bounds.width, bounds.height, NULL, NULL);
+}
+
+static void
+init_tests (void)
+{
+  g_test_add_func ("/x11/frame-mask/resize",
+                   meta_test_frame_mask_resize);
+  g_test_add_func ("/x11/frame-mask/shape-change",
+                   meta_test_frame_mask_shape_change);
+  g_test_add_func ("/x11/frame-mask/frame-overlap",
+                   meta_test_frame_mask_frame_overlap);
+  g_test_add_func ("/x11/frame-mask/no-frame",
+                   meta_test_frame_mask_no_frame);
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  g_autoptr (MetaContext) context = NULL;
+
+  context = meta_create_test_context (META_CONTEXT_TEST_TYPE_HEADLESS,
+                                      META_CONTEXT_TEST_FLAG_NO_X11);
+  g_assert_true (meta_context_configure (context, &argc, &argv, NULL));
+
+  test_context = context;
+
+  init_tests ();
+
+  return meta_context_test_run_tests (META_CONTEXT_TEST (context),
+                                      META_TEST_RUN_FLAG_NONE);
+}
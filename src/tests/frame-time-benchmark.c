@@ -0,0 +1,352 @@
+/*
+ * Copyright (C) 2026 Red Hat Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Headless frame time benchmark. Each test case runs the frame-time-client
+ * Wayland test client in one scenario on a virtual monitor, and records the
+ * CPU time spent in each phase of the stage updates that painted. The
+ * results are written as JSON to the file named by MUTTER_BENCHMARK_OUTPUT,
+ * or to stdout when it is unset.
+ *
+ * MUTTER_FRAME_TIME_BENCHMARK_FRAMES overrides the number of measured
+ * frames. Scenarios using DMA buffers need a render node, passed with
+ * MUTTER_FRAME_TIME_BENCHMARK_RENDER_NODE, and are skipped otherwise.
+ */
+
+#include "config.h"
+
+#include "backends/meta-virtual-monitor.h"
+#include "clutter/clutter-frame-private.h"
+#include "meta-test/meta-context-test.h"
+#include "tests/meta-benchmark-utils.h"
+#include "tests/meta-test-utils.h"
+#include "tests/meta-wayland-test-driver.h"
+#include "tests/meta-wayland-test-utils.h"
+
+#define DEFAULT_N_FRAMES 300
+#define N_WARMUP_FRAMES 30
+#define SCENARIO_TIMEOUT_S 60
+
+typedef enum _BenchmarkBufferType
+{
+  BENCHMARK_BUFFER_TYPE_ANY,
+  BENCHMARK_BUFFER_TYPE_DMA_BUF,
+} BenchmarkBufferType;
+
+typedef struct _BenchmarkScenario
+{
+  const char *name;
+  const char *count;
+  BenchmarkBufferType buffer_type;
+} BenchmarkScenario;
+
+typedef struct _FrameSample
+{
+  int64_t phase_time_us[CLUTTER_N_FRAME_PHASES];
+  int64_t update_time_us;
+} FrameSample;
+
+typedef struct _FrameRecorder
+{
+  GArray *samples;
+  int n_frames;
+  int n_skipped;
+  gboolean painted;
+  int64_t update_start_time_us;
+} FrameRecorder;
+
+static const BenchmarkScenario scenarios[] = {
+  { "shm-windows", "16", BENCHMARK_BUFFER_TYPE_ANY },
+  { "dma-buf-windows", "16", BENCHMARK_BUFFER_TYPE_DMA_BUF },
+  { "subsurfaces", "96", BENCHMARK_BUFFER_TYPE_ANY },
+  { "fullscreen-video", "1", BENCHMARK_BUFFER_TYPE_ANY },
+};
+
+static const char *phase_names[] = {
+  [CLUTTER_FRAME_PHASE_LAYOUT] = "layout",
+  [CLUTTER_FRAME_PHASE_CULL] = "cull",
+  [CLUTTER_FRAME_PHASE_PAINT] = "paint",
+  [CLUTTER_FRAME_PHASE_FLUSH] = "journal-flush",
+  [CLUTTER_FRAME_PHASE_SWAP] = "swap",
+};
+
+G_STATIC_ASSERT (G_N_ELEMENTS (phase_names) == CLUTTER_N_FRAME_PHASES);
+
+static MetaContext *test_context;
+static MetaWaylandTestDriver *test_driver;
+static MetaVirtualMonitor *virtual_monitor;
+static MetaBenchmarkReport *report;
+
+static void
+on_before_update (ClutterStage     *stage,
+                  ClutterStageView *view,
+                  ClutterFrame     *frame,
+                  FrameRecorder    *recorder)
+{
+  recorder->painted = FALSE;
+  recorder->update_start_time_us = g_get_monotonic_time ();
+}
+
+static void
+on_after_paint (ClutterStage     *stage,
+                ClutterStageView *view,
+                ClutterFrame     *frame,
+                FrameRecorder    *recorder)
+{
+  recorder->painted = TRUE;
+}
+
+static void
+on_after_update (ClutterStage     *stage,
+                 ClutterStageView *view,
+                 ClutterFrame     *frame,
+                 FrameRecorder    *recorder)
+{
+  FrameSample sample = { 0 };
+  int i;
+
+  if (!recorder->painted)
+    return;
+
+  if (recorder->n_skipped < N_WARMUP_FRAMES)
+    {
+      recorder->n_skipped++;
+      return;
+    }
+
+  if ((int) recorder->samples->len >= recorder->n_frames)
+    return;
+
+  for (i = 0; i < CLUTTER_N_FRAME_PHASES; i++)
+    sample.phase_time_us[i] = clutter_frame_get_phase_time (frame, i);
+  sample.update_time_us =
+    g_get_monotonic_time () - recorder->update_start_time_us;
+
+  g_array_append_val (recorder->samples, sample);
+}
+
+static gboolean
+on_scenario_timeout (gpointer user_data)
+{
+  gboolean *timed_out = user_data;
+
+  *timed_out = TRUE;
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+append_statistics (GString *string,
+                   int64_t *values,
+                   int      n_values)
+{
+  MetaBenchmarkStatistics statistics;
+
+  meta_benchmark_compute_statistics (values, n_values, &statistics);
+
+  g_string_append (string, "{ ");
+  meta_benchmark_append_statistics (string, &statistics);
+  g_string_append (string, " }");
+}
+
+static void
+report_scenario (const BenchmarkScenario *scenario,
+                 GArray                  *samples)
+{
+  int n_samples = samples->len;
+  g_autofree int64_t *values = NULL;
+  GString *result;
+  int phase;
+  int i;
+
+  values = g_new0 (int64_t, n_samples);
+
+  result = meta_benchmark_report_add_result (report);
+  g_string_append_printf (result,
+                          "{\n"
+                          "      \"name\": \"%s\",\n"
+                          "      \"count\": %s,\n"
+                          "      \"frames\": %d,\n"
+                          "      \"unit\": \"us\",\n"
+                          "      \"phases\": {\n",
+                          scenario->name, scenario->count, n_samples);
+
+  for (phase = 0; phase < CLUTTER_N_FRAME_PHASES; phase++)
+    {
+      for (i = 0; i < n_samples; i++)
+        {
+          FrameSample *sample = &g_array_index (samples, FrameSample, i);
+
+          values[i] = sample->phase_time_us[phase];
+        }
+
+      g_string_append_printf (result, "        \"%s\": ",
+                              phase_names[phase]);
+      append_statistics (result, values, n_samples);
+      g_string_append (result, ",\n");
+    }
+
+  for (i = 0; i < n_samples; i++)
+    {
+      FrameSample *sample = &g_array_index (samples, FrameSample, i);
+
+      values[i] = sample->update_time_us;
+    }
+
+  g_string_append (result, "        \"update\": ");
+  append_statistics (result, values, n_samples);
+  g_string_append (result, "\n      }\n    }");
+}
+
+static void
+run_scenario (gconstpointer user_data)
+{
+  const BenchmarkScenario *scenario = user_data;
+  MetaBackend *backend = meta_context_get_backend (test_context);
+  ClutterActor *stage = meta_backend_get_stage (backend);
+  MetaWaylandTestClient *wayland_test_client;
+  g_autoptr (GArray) samples = NULL;
+  FrameRecorder recorder;
+  gulong before_update_handler_id;
+  gulong after_paint_handler_id;
+  gulong after_update_handler_id;
+  gboolean timed_out = FALSE;
+  unsigned int timeout_id;
+
+  if (scenario->buffer_type == BENCHMARK_BUFFER_TYPE_DMA_BUF &&
+      !g_getenv ("MUTTER_FRAME_TIME_BENCHMARK_RENDER_NODE"))
+    {
+      g_test_skip ("No render node to allocate DMA buffers from");
+      return;
+    }
+
+  wayland_test_client =
+    meta_wayland_test_client_new_with_args (test_context,
+                                            "frame-time-client",
+                                            scenario->name,
+                                            scenario->count,
+                                            NULL);
+  meta_wayland_test_driver_wait_for_sync_point (test_driver, 0);
+
+  samples = g_array_new (FALSE, FALSE, sizeof (FrameSample));
+  recorder = (FrameRecorder) {
+    .samples = samples,
+    .n_frames = meta_benchmark_get_env_count ("MUTTER_FRAME_TIME_BENCHMARK_FRAMES",
+                                              DEFAULT_N_FRAMES),
+  };
+
+  before_update_handler_id =
+    g_signal_connect (stage, "before-update",
+                      G_CALLBACK (on_before_update), &recorder);
+  after_paint_handler_id =
+    g_signal_connect (stage, "after-paint",
+                      G_CALLBACK (on_after_paint), &recorder);
+  after_update_handler_id =
+    g_signal_connect (stage, "after-update",
+                      G_CALLBACK (on_after_update), &recorder);
+
+  timeout_id = g_timeout_add_seconds (SCENARIO_TIMEOUT_S,
+                                      on_scenario_timeout, &timed_out);
+  while ((int) samples->len < recorder.n_frames && !timed_out)
+    g_main_context_iteration (NULL, TRUE);
+  g_clear_handle_id (&timeout_id, g_source_remove);
+
+  if (timed_out)
+    {
+      g_test_fail_printf ("Scenario '%s' timed out after %u of %d frames",
+                          scenario->name, samples->len, recorder.n_frames);
+    }
+
+  g_signal_handler_disconnect (stage, before_update_handler_id);
+  g_signal_handler_disconnect (stage, after_paint_handler_id);
+  g_signal_handler_disconnect (stage, after_update_handler_id);
+
+  meta_wayland_test_driver_emit_sync_event (test_driver, 0);
+  meta_wayland_test_client_finish (wayland_test_client);
+
+  report_scenario (scenario, samples);
+}
+
+static void
+on_before_tests (void)
+{
+  MetaWaylandCompositor *compositor =
+    meta_context_get_wayland_compositor (test_context);
+  const char *render_node;
+
+  test_driver = meta_wayland_test_driver_new (compositor);
+
+  render_node = g_getenv ("MUTTER_FRAME_TIME_BENCHMARK_RENDER_NODE");
+  if (render_node)
+    meta_wayland_test_driver_set_property (test_driver,
+                                           "gpu-path", render_node);
+
+  virtual_monitor = meta_create_test_monitor (test_context,
+                                              1920, 1080, 60.0f);
+
+  report = meta_benchmark_report_new ();
+}
+
+static void
+on_after_tests (void)
+{
+  g_autoptr (GError) error = NULL;
+
+  if (!meta_benchmark_report_write (report, &error))
+    g_error ("Failed to write benchmark results: %s", error->message);
+
+  g_clear_pointer (&report, meta_benchmark_report_free);
+  g_clear_object (&virtual_monitor);
+  g_clear_object (&test_driver);
+}
+
+static void
+init_tests (void)
+{
+  size_t i;
+
+  for (i = 0; i < G_N_ELEMENTS (scenarios); i++)
+    {
+      g_autofree char *path = NULL;
+
+      path = g_strdup_printf ("/benchmark/frame-time/%s", scenarios[i].name);
+      g_test_add_data_func (path, &scenarios[i], run_scenario);
+    }
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  g_autoptr (MetaContext) context = NULL;
+
+  context = meta_create_test_context (META_CONTEXT_TEST_TYPE_HEADLESS,
+                                      META_CONTEXT_TEST_FLAG_NO_X11);
+  g_assert_true (meta_context_configure (context, &argc, &argv, NULL));
+
+  test_context = context;
+
+  init_tests ();
+
+  g_signal_connect (context, "before-tests",
+                    G_CALLBACK (on_before_tests), NULL);
+  g_signal_connect (context, "after-tests",
+                    G_CALLBACK (on_after_tests), NULL);
+
+  return meta_context_test_run_tests (META_CONTEXT_TEST (context),
+                                      META_TEST_RUN_FLAG_CAN_SKIP);
+}
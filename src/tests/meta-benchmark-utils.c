@@ -0,0 +1,176 @@
+/*
+ * Copyright (C) 2026 Red Hat Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Shared scaffolding of the benchmarks run with 'meson test --benchmark'.
+ * Each benchmark adds one JSON object per result to a report, which ends
+ * up as
+ *
+ *   { "results": [ { ... }, { ... } ] }
+ */
+
+#include "config.h"
+
+#include "tests/meta-benchmark-utils.h"
+
+#include <stdlib.h>
+
+struct _MetaBenchmarkReport
+{
+  GString *string;
+  int n_results;
+};
+
+/*
+ * Returns the positive count in the environment variable @name, or
+ * @default_value if it is unset.
+ */
+int
+meta_benchmark_get_env_count (const char *name,
+                              int         default_value)
+{
+  const char *count_string;
+  int count;
+
+  count_string = g_getenv (name);
+  if (!count_string)
+    return default_value;
+
+  count = atoi (count_string);
+  if (count <= 0)
+    g_error ("Invalid count '%s' in %s", count_string, name);
+
+  return count;
+}
+
+static int
+compare_int64 (gconstpointer a,
+               gconstpointer b)
+{
+  int64_t value_a = *(const int64_t *) a;
+  int64_t value_b = *(const int64_t *) b;
+
+  return (value_a > value_b) - (value_a < value_b);
+}
+
+/*
+ * Sorts @values in place and computes their statistics.
+ */
+void
+meta_benchmark_compute_statistics (int64_t                 *values,
+                                   int                      n_values,
+                                   MetaBenchmarkStatistics *statistics)
+{
+  int64_t sum = 0;
+  int i;
+
+  *statistics = (MetaBenchmarkStatistics) {
+    .n_values = n_values,
+  };
+
+  if (n_values == 0)
+    return;
+
+  qsort (values, n_values, sizeof (int64_t), compare_int64);
+
+  for (i = 0; i < n_values; i++)
+    sum += values[i];
+
+  statistics->mean = (double) sum / n_values;
+  statistics->median = values[n_values / 2];
+  statistics->p95 = values[(n_values * 95) / 100];
+  statistics->max = values[n_values - 1];
+}
+
+/*
+ * Appends the statistics as JSON members, without the enclosing braces,
+ * so that they can be part of a larger result object.
+ */
+void
+meta_benchmark_append_statistics (GString                       *string,
+                                  const MetaBenchmarkStatistics *statistics)
+{
+  if (statistics->n_values == 0)
+    {
+      g_string_append (string,
+                       "\"mean\": null, \"median\": null, "
+                       "\"p95\": null, \"max\": null");
+      return;
+    }
+
+  g_string_append_printf (string,
+                          "\"mean\": %.1f, \"median\": %" G_GINT64_FORMAT
+                          ", \"p95\": %" G_GINT64_FORMAT
+                          ", \"max\": %" G_GINT64_FORMAT,
+                          statistics->mean,
+                          statistics->median,
+                          statistics->p95,
+                          statistics->max);
+}
+
+MetaBenchmarkReport *
+meta_benchmark_report_new (void)
+{
+  MetaBenchmarkReport *report;
+
+  report = g_new0 (MetaBenchmarkReport, 1);
+  report->string = g_string_new ("{\n  \"results\": [\n");
+
+  return report;
+}
+
+/*
+ * Starts a new result in the report. The returned string is owned by the
+ * report, and the caller appends a single JSON object to it.
+ */
+GString *
+meta_benchmark_report_add_result (MetaBenchmarkReport *report)
+{
+  if (report->n_results++ > 0)
+    g_string_append (report->string, ",\n");
+
+  g_string_append (report->string, "    ");
+
+  return report->string;
+}
+
+gboolean
+meta_benchmark_report_write (MetaBenchmarkReport  *report,
+                             GError              **error)
+{
+  g_autoptr (GString) string = NULL;
+  const char *output_path;
+
+  string = g_string_new (report->string->str);
+  g_string_append (string, "\n  ]\n}\n");
+
+  output_path = g_getenv (META_BENCHMARK_OUTPUT_ENV);
+  if (!output_path)
+    {
+      g_print ("%s", string->str);
+      return TRUE;
+    }
+
+  return g_file_set_contents (output_path, string->str, string->len, error);
+}
+
+void
+meta_benchmark_report_free (MetaBenchmarkReport *report)
+{
+  g_string_free (report->string, TRUE);
+  g_free (report);
+}
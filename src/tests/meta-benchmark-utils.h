@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2026 Red Hat Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <glib.h>
+#include <stdint.h>
+
+/* Benchmark results are written as JSON to the file named by this
+ * variable, or to stdout when it is unset */
+#define META_BENCHMARK_OUTPUT_ENV "MUTTER_BENCHMARK_OUTPUT"
+
+typedef struct _MetaBenchmarkStatistics
+{
+  int n_values;
+  double mean;
+  int64_t median;
+  int64_t p95;
+  int64_t max;
+} MetaBenchmarkStatistics;
+
+typedef struct _MetaBenchmarkReport MetaBenchmarkReport;
+
+int meta_benchmark_get_env_count (const char *name,
+                                  int         default_value);
+
+void meta_benchmark_compute_statistics (int64_t                 *values,
+                                        int                      n_values,
+                                        MetaBenchmarkStatistics *statistics);
+
+void meta_benchmark_append_statistics (GString                       *string,
+                                       const MetaBenchmarkStatistics *statistics);
+
+MetaBenchmarkReport * meta_benchmark_report_new (void);
+
+GString * meta_benchmark_report_add_result (MetaBenchmarkReport *report);
+
+gboolean meta_benchmark_report_write (MetaBenchmarkReport  *report,
+                                      GError              **error);
+
+void meta_benchmark_report_free (MetaBenchmarkReport *report);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (MetaBenchmarkReport, meta_benchmark_report_free)
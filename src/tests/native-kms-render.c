@@ -18,12 +18,14 @@
 
 #include "config.h"
 
+#include <drm_fourcc.h>
 #include <xf86drmMode.h>
 
+#include "backends/meta-stage-view.h"
 #include "backends/native/meta-backend-native-private.h"
 #include "backends/native/meta-crtc-kms.h"
 #include "backends/native/meta-device-pool.h"
-#include "backends/native/meta-drm-buffer.h"
+#include "backends/native/meta-drm-buffer-private.h"
 #include "backends/native/meta-frame-native.h"
 #include "backends/native/meta-onscreen-native.h"
 #include "backends/native/meta-renderer-native-private.h"
@@ -31,6 +33,9 @@
 #include "backends/native/meta-kms-device.h"
 #include "backends/native/meta-kms-device-private.h"
 #include "backends/native/meta-kms-impl-device-atomic.h"
+#include "backends/native/meta-kms-plane.h"
+#include "compositor/meta-surface-actor.h"
+#include "compositor/meta-window-actor-private.h"
 #include "core/display-private.h"
 #include "meta/meta-backend.h"
 #include "meta-test/meta-context-test.h"
@@ -59,8 +64,37 @@ typedef struct
     guint repaint_guard_id;
     ClutterStageView *scanout_failed_view;
   } scanout_fallback;
+
+  struct {
+    gboolean expect_overlay;
+    MetaSurfaceActor *surface_actor;
+    MetaStageView *inhibited_view;
+    int n_frames_left;
+    gboolean flip_sabotaged;
+    gboolean flip_failed;
+    gboolean fallback_painted;
+    guint repaint_guard_id;
+  } overlay;
 } KmsRenderingTest;
 
+#define META_TYPE_TEST_LAYOUT_BUFFER (meta_test_layout_buffer_get_type ())
+G_DECLARE_FINAL_TYPE (MetaTestLayoutBuffer, meta_test_layout_buffer,
+                      META, TEST_LAYOUT_BUFFER,
+                      MetaDrmBuffer)
+
+struct _MetaTestLayoutBuffer
+{
+  MetaDrmBuffer parent;
+
+  int width;
+  int height;
+  int stride;
+  int offset;
+};
+
+G_DEFINE_TYPE (MetaTestLayoutBuffer, meta_test_layout_buffer,
+               META_TYPE_DRM_BUFFER)
+
 static MetaContext *test_context;
 
 static gboolean
@@ -647,6 +681,617 @@ meta_test_kms_render_client_scanout_hotplug (void)
   g_main_loop_unref (test.loop);
 }
 
+static MetaKmsPlane *
+get_overlay_plane (ClutterStageView *stage_view)
+{
+  CoglFramebuffer *fb;
+  MetaCrtc *crtc;
+
+  fb = clutter_stage_view_get_onscreen (stage_view);
+  crtc = meta_onscreen_native_get_crtc (META_ONSCREEN_NATIVE (fb));
+
+  return meta_crtc_kms_get_assigned_overlay_plane (META_CRTC_KMS (crtc));
+}
+
+static gboolean
+is_overlay_plane_lit (ClutterStageView *stage_view)
+{
+  MetaBackend *backend = meta_context_get_backend (test_context);
+  MetaBackendNative *backend_native = META_BACKEND_NATIVE (backend);
+  MetaDevicePool *device_pool;
+  MetaKmsPlane *kms_plane;
+  MetaKmsDevice *kms_device;
+  MetaDeviceFile *device_file;
+  GError *error = NULL;
+  drmModePlane *drm_plane;
+  gboolean has_overlay;
+
+  device_pool = meta_backend_native_get_device_pool (backend_native);
+
+  kms_plane = get_overlay_plane (stage_view);
+  g_assert_nonnull (kms_plane);
+  kms_device = meta_kms_plane_get_device (kms_plane);
+
+  device_file = meta_device_pool_open (device_pool,
+                                       meta_kms_device_get_path (kms_device),
+                                       META_DEVICE_FILE_FLAG_TAKE_CONTROL,
+                                       &error);
+  if (!device_file)
+    g_error ("Failed to open KMS device: %s", error->message);
+
+  drm_plane = drmModeGetPlane (meta_device_file_get_fd (device_file),
+                               meta_kms_plane_get_id (kms_plane));
+  g_assert_nonnull (drm_plane);
+  has_overlay = drm_plane->fb_id != 0;
+  drmModeFreePlane (drm_plane);
+
+  meta_device_file_release (device_file);
+
+  return has_overlay;
+}
+
+static void
+on_overlay_presented (ClutterStage     *stage,
+                      ClutterStageView *stage_view,
+                      ClutterFrameInfo *frame_info,
+                      KmsRenderingTest *test)
+{
+  if (is_overlay_plane_lit (stage_view) == test->overlay.expect_overlay)
+    g_main_loop_quit (test->loop);
+  else
+    clutter_actor_queue_redraw (CLUTTER_ACTOR (stage));
+}
+
+static gboolean
+can_test_overlay_planes (ClutterStage  *stage,
+                         MetaKmsDevice *kms_device)
+{
+  if (!is_atomic_mode_setting (kms_device))
+    {
+      g_test_skip ("Overlay planes are only used with atomic mode setting");
+      return FALSE;
+    }
+
+  g_assert_cmpuint (g_list_length (clutter_stage_peek_stage_views (stage)),
+                    ==,
+                    1);
+
+  if (!get_overlay_plane (clutter_stage_peek_stage_views (stage)->data))
+    {
+      g_test_skip ("No overlay plane available");
+      return FALSE;
+    }
+
+  return TRUE;
+}
+
+static MetaWaylandTestClient *
+start_windowed_scanout_client (MetaWaylandTestDriver  *test_driver,
+                               MetaWindow            **out_window)
+{
+  MetaWaylandTestClient *wayland_test_client;
+  MetaWindow *window;
+
+  wayland_test_client =
+    meta_wayland_test_client_new_with_args (test_context,
+                                            "dma-buf-scanout",
+                                            "windowed",
+                                            NULL);
+  g_assert_nonnull (wayland_test_client);
+
+  meta_wayland_test_driver_wait_for_sync_point (test_driver,
+                                                SCANOUT_WINDOW_STATE_NONE);
+  window = meta_find_window_from_title (test_context, "dma-buf-scanout-test");
+  g_assert_false (meta_window_is_fullscreen (window));
+  meta_wait_for_window_shown (window);
+  meta_wait_for_effects (window);
+
+  *out_window = window;
+  return wayland_test_client;
+}
+
+static void
+meta_test_kms_render_client_overlay_scanout (void)
+{
+  MetaBackend *backend = meta_context_get_backend (test_context);
+  MetaWaylandCompositor *wayland_compositor =
+    meta_context_get_wayland_compositor (test_context);
+  ClutterStage *stage = CLUTTER_STAGE (meta_backend_get_stage (backend));
+  MetaKms *kms = meta_backend_native_get_kms (META_BACKEND_NATIVE (backend));
+  MetaKmsDevice *kms_device = meta_kms_get_devices (kms)->data;
+  KmsRenderingTest test;
+  MetaWaylandTestClient *wayland_test_client;
+  g_autoptr (MetaWaylandTestDriver) test_driver = NULL;
+  gulong presented_handler_id;
+  MetaWindow *window;
+
+  if (!can_test_overlay_planes (stage, kms_device))
+    return;
+
+  test_driver = meta_wayland_test_driver_new (wayland_compositor);
+  meta_wayland_test_driver_set_property (test_driver,
+                                         "gpu-path",
+                                         meta_kms_device_get_path (kms_device));
+
+  wayland_test_client = start_windowed_scanout_client (test_driver, &window);
+
+  test = (KmsRenderingTest) {
+    .loop = g_main_loop_new (NULL, FALSE),
+    .overlay.expect_overlay = TRUE,
+  };
+
+  presented_handler_id =
+    g_signal_connect (stage, "presented",
+                      G_CALLBACK (on_overlay_presented), &test);
+
+  g_debug ("Wait for overlay plane to be used");
+  clutter_actor_queue_redraw (CLUTTER_ACTOR (stage));
+  g_main_loop_run (test.loop);
+
+  g_debug ("Wait for overlay plane to be disabled");
+  meta_wayland_test_driver_emit_sync_event (test_driver, 0);
+  meta_wayland_test_client_finish (wayland_test_client);
+
+  test.overlay.expect_overlay = FALSE;
+  clutter_actor_queue_redraw (CLUTTER_ACTOR (stage));
+  g_main_loop_run (test.loop);
+
+  g_signal_handler_disconnect (stage, presented_handler_id);
+  g_main_loop_unref (test.loop);
+}
+
+static void
+on_overlay_test_rejected_before_update (ClutterStage     *stage,
+                                        ClutterStageView *stage_view,
+                                        ClutterFrame     *frame,
+                                        KmsRenderingTest *test)
+{
+  if (!test->overlay.inhibited_view)
+    return;
+
+  /* The first commit of this frame is the TEST_ONLY update validating the
+   * overlay plane placement, done before painting */
+  drm_mock_queue_error (DRM_MOCK_CALL_ATOMIC_COMMIT, EINVAL);
+  meta_stage_view_uninhibit_overlay_planes (test->overlay.inhibited_view);
+  test->overlay.inhibited_view = NULL;
+}
+
+static void
+on_overlay_test_rejected_paint_view (ClutterStage     *stage,
+                                     ClutterStageView *stage_view,
+                                     MtkRegion        *region,
+                                     ClutterFrame     *frame,
+                                     KmsRenderingTest *test)
+{
+  g_assert_false (meta_surface_actor_is_on_overlay_plane (test->overlay.surface_actor,
+                                                          stage_view));
+}
+
+static void
+on_overlay_test_rejected_presented (ClutterStage     *stage,
+                                    ClutterStageView *stage_view,
+                                    ClutterFrameInfo *frame_info,
+                                    KmsRenderingTest *test)
+{
+  if (test->overlay.inhibited_view)
+    return;
+
+  g_assert_false (is_overlay_plane_lit (stage_view));
+
+  if (--test->overlay.n_frames_left == 0)
+    g_main_loop_quit (test->loop);
+  else
+    clutter_actor_queue_redraw (CLUTTER_ACTOR (stage));
+}
+
+static void
+meta_test_kms_render_client_overlay_test_rejected (void)
+{
+  MetaBackend *backend = meta_context_get_backend (test_context);
+  MetaWaylandCompositor *wayland_compositor =
+    meta_context_get_wayland_compositor (test_context);
+  ClutterStage *stage = CLUTTER_STAGE (meta_backend_get_stage (backend));
+  MetaKms *kms = meta_backend_native_get_kms (META_BACKEND_NATIVE (backend));
+  MetaKmsDevice *kms_device = meta_kms_get_devices (kms)->data;
+  KmsRenderingTest test;
+  MetaWaylandTestClient *wayland_test_client;
+  g_autoptr (MetaWaylandTestDriver) test_driver = NULL;
+  MetaStageView *view;
+  gulong before_update_handler_id;
+  gulong paint_view_handler_id;
+  gulong presented_handler_id;
+  MetaWindow *window;
+
+  if (!can_test_overlay_planes (stage, kms_device))
+    return;
+
+  view = META_STAGE_VIEW (clutter_stage_peek_stage_views (stage)->data);
+
+  test_driver = meta_wayland_test_driver_new (wayland_compositor);
+  meta_wayland_test_driver_set_property (test_driver,
+                                         "gpu-path",
+                                         meta_kms_device_get_path (kms_device));
+
+  /* Keep the surface composited until the failure has been queued, so that
+   * the placement isn't already validated when the window is shown */
+  meta_stage_view_inhibit_overlay_planes (view);
+
+  wayland_test_client = start_windowed_scanout_client (test_driver, &window);
+
+  test = (KmsRenderingTest) {
+    .loop = g_main_loop_new (NULL, FALSE),
+    .overlay.surface_actor =
+      meta_window_actor_get_surface (meta_window_actor_from_window (window)),
+    .overlay.inhibited_view = view,
+    .overlay.n_frames_left = 5,
+  };
+
+  before_update_handler_id =
+    g_signal_connect (stage, "before-update",
+                      G_CALLBACK (on_overlay_test_rejected_before_update),
+                      &test);
+  paint_view_handler_id =
+    g_signal_connect (stage, "paint-view",
+                      G_CALLBACK (on_overlay_test_rejected_paint_view),
+                      &test);
+  presented_handler_id =
+    g_signal_connect (stage, "presented",
+                      G_CALLBACK (on_overlay_test_rejected_presented),
+                      &test);
+
+  clutter_actor_queue_redraw (CLUTTER_ACTOR (stage));
+  g_main_loop_run (test.loop);
+  g_main_loop_unref (test.loop);
+
+  g_signal_handler_disconnect (stage, before_update_handler_id);
+  g_signal_handler_disconnect (stage, paint_view_handler_id);
+  g_signal_handler_disconnect (stage, presented_handler_id);
+
+  meta_wayland_test_driver_emit_sync_event (test_driver, 0);
+  meta_wayland_test_client_finish (wayland_test_client);
+}
+
+static void
+overlay_fallback_result_feedback (const MetaKmsFeedback *kms_feedback,
+                                  gpointer               user_data)
+{
+  KmsRenderingTest *test = user_data;
+
+  g_assert_nonnull (meta_kms_feedback_get_error (kms_feedback));
+  g_assert_cmpuint (test->overlay.repaint_guard_id, ==, 0);
+
+  test->overlay.flip_failed = TRUE;
+  test->overlay.repaint_guard_id =
+    g_idle_add_full (G_PRIORITY_LOW, needs_repainted_guard, test, NULL);
+}
+
+static const MetaKmsResultListenerVtable overlay_fallback_result_listener_vtable = {
+  .feedback = overlay_fallback_result_feedback,
+};
+
+static void
+on_overlay_fallback_before_paint (ClutterStage     *stage,
+                                  ClutterStageView *stage_view,
+                                  ClutterFrame     *frame,
+                                  KmsRenderingTest *test)
+{
+  MetaRendererView *view = META_RENDERER_VIEW (stage_view);
+  MetaCrtc *crtc = meta_renderer_view_get_crtc (view);
+  MetaKmsCrtc *kms_crtc = meta_crtc_kms_get_kms_crtc (META_CRTC_KMS (crtc));
+  MetaKmsDevice *kms_device = meta_kms_crtc_get_device (kms_crtc);
+  MetaFrameNative *frame_native = meta_frame_native_from_frame (frame);
+  MetaKmsUpdate *kms_update;
+
+  if (test->overlay.flip_sabotaged)
+    return;
+
+  /* The compositor assigns the overlay plane before this handler runs, so
+   * only the page flip carrying it is left to fail */
+  if (!meta_surface_actor_is_on_overlay_plane (test->overlay.surface_actor,
+                                               stage_view))
+    return;
+
+  drm_mock_queue_error (DRM_MOCK_CALL_ATOMIC_COMMIT, EINVAL);
+  test->overlay.flip_sabotaged = TRUE;
+
+  kms_update = meta_frame_native_ensure_kms_update (frame_native, kms_device);
+  meta_kms_update_add_result_listener (kms_update,
+                                       &overlay_fallback_result_listener_vtable,
+                                       NULL,
+                                       test,
+                                       NULL);
+}
+
+static void
+on_overlay_fallback_paint_view (ClutterStage     *stage,
+                                ClutterStageView *stage_view,
+                                MtkRegion        *region,
+                                ClutterFrame     *frame,
+                                KmsRenderingTest *test)
+{
+  ClutterActorBox actor_box;
+  MtkRectangle actor_rect;
+
+  if (!test->overlay.flip_failed || test->overlay.fallback_painted)
+    return;
+
+  /* Only the area of the surface that was left out needs painting */
+  g_assert_true (clutter_actor_get_paint_box (CLUTTER_ACTOR (test->overlay.surface_actor),
+                                              &actor_box));
+  actor_rect = (MtkRectangle) {
+    .x = (int) actor_box.x1,
+    .y = (int) actor_box.y1,
+    .width = (int) (actor_box.x2 - actor_box.x1),
+    .height = (int) (actor_box.y2 - actor_box.y1),
+  };
+  g_assert_nonnull (region);
+  g_assert_cmpint (mtk_region_contains_rectangle (region, &actor_rect),
+                   ==,
+                   MTK_REGION_OVERLAP_IN);
+
+  g_assert_cmpuint (test->overlay.repaint_guard_id, !=, 0);
+  g_clear_handle_id (&test->overlay.repaint_guard_id, g_source_remove);
+  test->overlay.fallback_painted = TRUE;
+}
+
+static void
+on_overlay_fallback_presented (ClutterStage     *stage,
+                               ClutterStageView *stage_view,
+                               ClutterFrameInfo *frame_info,
+                               KmsRenderingTest *test)
+{
+  if (test->overlay.fallback_painted)
+    g_main_loop_quit (test->loop);
+  else
+    clutter_actor_queue_redraw (CLUTTER_ACTOR (stage));
+}
+
+static void
+meta_test_kms_render_client_overlay_fallback (void)
+{
+  MetaBackend *backend = meta_context_get_backend (test_context);
+  MetaWaylandCompositor *wayland_compositor =
+    meta_context_get_wayland_compositor (test_context);
+  ClutterStage *stage = CLUTTER_STAGE (meta_backend_get_stage (backend));
+  MetaKms *kms = meta_backend_native_get_kms (META_BACKEND_NATIVE (backend));
+  MetaKmsDevice *kms_device = meta_kms_get_devices (kms)->data;
+  KmsRenderingTest test;
+  MetaWaylandTestClient *wayland_test_client;
+  g_autoptr (MetaWaylandTestDriver) test_driver = NULL;
+  gulong before_paint_handler_id;
+  gulong paint_view_handler_id;
+  gulong presented_handler_id;
+  MetaWindow *window;
+
+  if (!can_test_overlay_planes (stage, kms_device))
+    return;
+
+  test_driver = meta_wayland_test_driver_new (wayland_compositor);
+  meta_wayland_test_driver_set_property (test_driver,
+                                         "gpu-path",
+                                         meta_kms_device_get_path (kms_device));
+
+  wayland_test_client = start_windowed_scanout_client (test_driver, &window);
+
+  test = (KmsRenderingTest) {
+    .loop = g_main_loop_new (NULL, FALSE),
+    .overlay.surface_actor =
+      meta_window_actor_get_surface (meta_window_actor_from_window (window)),
+  };
+
+  before_paint_handler_id =
+    g_signal_connect (stage, "before-paint",
+                      G_CALLBACK (on_overlay_fallback_before_paint), &test);
+  paint_view_handler_id =
+    g_signal_connect (stage, "paint-view",
+                      G_CALLBACK (on_overlay_fallback_paint_view), &test);
+  presented_handler_id =
+    g_signal_connect (stage, "presented",
+                      G_CALLBACK (on_overlay_fallback_presented), &test);
+
+  g_test_expect_message ("libmutter", G_LOG_LEVEL_WARNING,
+                         "*Page flip failed*");
+
+  clutter_actor_queue_redraw (CLUTTER_ACTOR (stage));
+  g_main_loop_run (test.loop);
+  g_main_loop_unref (test.loop);
+
+  g_test_assert_expected_messages ();
+
+  g_signal_handler_disconnect (stage, before_paint_handler_id);
+  g_signal_handler_disconnect (stage, paint_view_handler_id);
+  g_signal_handler_disconnect (stage, presented_handler_id);
+
+  meta_wayland_test_driver_emit_sync_event (test_driver, 0);
+  meta_wayland_test_client_finish (wayland_test_client);
+}
+
+static int
+meta_test_layout_buffer_get_width (MetaDrmBuffer *buffer)
+{
+  return META_TEST_LAYOUT_BUFFER (buffer)->width;
+}
+
+static int
+meta_test_layout_buffer_get_height (MetaDrmBuffer *buffer)
+{
+  return META_TEST_LAYOUT_BUFFER (buffer)->height;
+}
+
+static int
+meta_test_layout_buffer_get_n_planes (MetaDrmBuffer *buffer)
+{
+  return 1;
+}
+
+static int
+meta_test_layout_buffer_get_stride (MetaDrmBuffer *buffer)
+{
+  return META_TEST_LAYOUT_BUFFER (buffer)->stride;
+}
+
+static int
+meta_test_layout_buffer_get_stride_for_plane (MetaDrmBuffer *buffer,
+                                              int            plane)
+{
+  g_assert_cmpint (plane, ==, 0);
+
+  return META_TEST_LAYOUT_BUFFER (buffer)->stride;
+}
+
+static int
+meta_test_layout_buffer_get_bpp (MetaDrmBuffer *buffer)
+{
+  return 32;
+}
+
+static uint32_t
+meta_test_layout_buffer_get_format (MetaDrmBuffer *buffer)
+{
+  return DRM_FORMAT_XRGB8888;
+}
+
+static int
+meta_test_layout_buffer_get_offset_for_plane (MetaDrmBuffer *buffer,
+                                              int            plane)
+{
+  g_assert_cmpint (plane, ==, 0);
+
+  return META_TEST_LAYOUT_BUFFER (buffer)->offset;
+}
+
+static uint64_t
+meta_test_layout_buffer_get_modifier (MetaDrmBuffer *buffer)
+{
+  return DRM_FORMAT_MOD_LINEAR;
+}
+
+static void
+meta_test_layout_buffer_class_init (MetaTestLayoutBufferClass *klass)
+{
+  MetaDrmBufferClass *buffer_class = META_DRM_BUFFER_CLASS (klass);
+
+  buffer_class->get_width = meta_test_layout_buffer_get_width;
+  buffer_class->get_height = meta_test_layout_buffer_get_height;
+  buffer_class->get_n_planes = meta_test_layout_buffer_get_n_planes;
+  buffer_class->get_stride = meta_test_layout_buffer_get_stride;
+  buffer_class->get_stride_for_plane =
+    meta_test_layout_buffer_get_stride_for_plane;
+  buffer_class->get_bpp = meta_test_layout_buffer_get_bpp;
+  buffer_class->get_format = meta_test_layout_buffer_get_format;
+  buffer_class->get_offset_for_plane =
+    meta_test_layout_buffer_get_offset_for_plane;
+  buffer_class->get_modifier = meta_test_layout_buffer_get_modifier;
+}
+
+static void
+meta_test_layout_buffer_init (MetaTestLayoutBuffer *buffer)
+{
+}
+
+static MetaDrmBuffer *
+create_layout_buffer (MetaDeviceFile *device_file,
+                      int             stride,
+                      int             offset)
+{
+  MetaTestLayoutBuffer *buffer;
+
+  buffer = g_object_new (META_TYPE_TEST_LAYOUT_BUFFER,
+                         "device-file", device_file,
+                         NULL);
+  buffer->width = 256;
+  buffer->height = 256;
+  buffer->stride = stride;
+  buffer->offset = offset;
+
+  return META_DRM_BUFFER (buffer);
+}
+
+static void
+meta_test_kms_render_plane_test_cache (void)
+{
+  MetaBackend *backend = meta_context_get_backend (test_context);
+  MetaBackendNative *backend_native = META_BACKEND_NATIVE (backend);
+  MetaDevicePool *device_pool =
+    meta_backend_native_get_device_pool (backend_native);
+  ClutterActor *stage = meta_backend_get_stage (backend);
+  ClutterStageView *stage_view;
+  CoglFramebuffer *fb;
+  MetaCrtcKms *crtc_kms;
+  MetaKmsPlane *kms_plane;
+  MetaKmsDevice *kms_device;
+  MetaDeviceFile *device_file;
+  g_autoptr (MetaDrmBuffer) buffer = NULL;
+  g_autoptr (MetaDrmBuffer) other_stride_buffer = NULL;
+  g_autoptr (MetaDrmBuffer) other_offset_buffer = NULL;
+  graphene_rect_t src_rect = GRAPHENE_RECT_INIT (0, 0, 256, 256);
+  MtkRectangle dst_rect = MTK_RECTANGLE_INIT (0, 0, 256, 256);
+  GError *error = NULL;
+  gboolean passed;
+  int i;
+
+  stage_view = clutter_stage_peek_stage_views (CLUTTER_STAGE (stage))->data;
+  fb = clutter_stage_view_get_onscreen (stage_view);
+  crtc_kms =
+    META_CRTC_KMS (meta_onscreen_native_get_crtc (META_ONSCREEN_NATIVE (fb)));
+  kms_plane = meta_crtc_kms_get_assigned_primary_plane (crtc_kms);
+  kms_device = meta_kms_plane_get_device (kms_plane);
+
+  device_file = meta_device_pool_open (device_pool,
+                                       meta_kms_device_get_path (kms_device),
+                                       META_DEVICE_FILE_FLAG_TAKE_CONTROL,
+                                       &error);
+  if (!device_file)
+    g_error ("Failed to open KMS device: %s", error->message);
+
+  buffer = create_layout_buffer (device_file, 256 * 4, 0);
+  other_stride_buffer = create_layout_buffer (device_file, 512 * 4, 0);
+  other_offset_buffer = create_layout_buffer (device_file, 256 * 4, 4096);
+  meta_device_file_release (device_file);
+
+  meta_crtc_kms_invalidate_plane_tests (crtc_kms);
+  meta_crtc_kms_notify_plane_frame (crtc_kms, FALSE);
+
+  g_assert_false (meta_crtc_kms_lookup_plane_test (crtc_kms, kms_plane, buffer,
+                                                   &src_rect, &dst_rect,
+                                                   &passed));
+  meta_crtc_kms_store_plane_test (crtc_kms, kms_plane, buffer,
+                                  &src_rect, &dst_rect, TRUE);
+  g_assert_true (meta_crtc_kms_lookup_plane_test (crtc_kms, kms_plane, buffer,
+                                                  &src_rect, &dst_rect,
+                                                  &passed));
+  g_assert_true (passed);
+
+  /* Same size, format and modifier, but a different memory layout */
+  g_assert_false (meta_crtc_kms_lookup_plane_test (crtc_kms, kms_plane,
+                                                   other_stride_buffer,
+                                                   &src_rect, &dst_rect,
+                                                   &passed));
+  g_assert_false (meta_crtc_kms_lookup_plane_test (crtc_kms, kms_plane,
+                                                   other_offset_buffer,
+                                                   &src_rect, &dst_rect,
+                                                   &passed));
+
+  /* The result was obtained without the overlay plane in use */
+  meta_crtc_kms_notify_plane_frame (crtc_kms, TRUE);
+  g_assert_false (meta_crtc_kms_lookup_plane_test (crtc_kms, kms_plane, buffer,
+                                                   &src_rect, &dst_rect,
+                                                   &passed));
+  meta_crtc_kms_notify_plane_frame (crtc_kms, FALSE);
+  g_assert_true (meta_crtc_kms_lookup_plane_test (crtc_kms, kms_plane, buffer,
+                                                  &src_rect, &dst_rect,
+                                                  &passed));
+
+  /* Results expire after a while */
+  for (i = 0; i < 10000; i++)
+    meta_crtc_kms_notify_plane_frame (crtc_kms, FALSE);
+  g_assert_false (meta_crtc_kms_lookup_plane_test (crtc_kms, kms_plane, buffer,
+                                                   &src_rect, &dst_rect,
+                                                   &passed));
+
+  meta_crtc_kms_invalidate_plane_tests (crtc_kms);
+}
+
 static void
 meta_test_kms_render_empty_config (void)
 {
@@ -688,6 +1333,14 @@ init_tests (void)
                    meta_test_kms_render_client_scanout_hotplug);
   g_test_add_func ("/backends/native/kms/render/client-scanout-inhibit",
                    meta_test_kms_render_client_scanout_inhibit);
+  g_test_add_func ("/backends/native/kms/render/client-overlay-scanout",
+                   meta_test_kms_render_client_overlay_scanout);
+  g_test_add_func ("/backends/native/kms/render/client-overlay-test-rejected",
+                   meta_test_kms_render_client_overlay_test_rejected);
+  g_test_add_func ("/backends/native/kms/render/client-overlay-fallback",
+                   meta_test_kms_render_client_overlay_fallback);
+  g_test_add_func ("/backends/native/kms/render/plane-test-cache",
+                   meta_test_kms_render_plane_test_cache);
   g_test_add_func ("/backends/native/kms/render/empty-config",
                    meta_test_kms_render_empty_config);
 }
@@ -0,0 +1,227 @@
+/*
+ * Copyright (C) 2026 Red Hat Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Shadow generation benchmark. For a range of shadow radii, a shadow is
+ * generated for a rounded window shape with the CPU and the GPU blur
+ * paths of MetaShadowFactory, and painted once into an offscreen that is
+ * then waited on, so that GPU work is accounted for. The results are
+ * written as JSON to the file named by MUTTER_BENCHMARK_OUTPUT, or to
+ * stdout when it is unset.
+ *
+ * MUTTER_SHADOW_BENCHMARK_ITERATIONS overrides the number of shadows
+ * generated per radius and blur mode.
+ */
+
+#include "config.h"
+
+#include <math.h>
+
+#include "meta-test/meta-context-test.h"
+#include "tests/meta-benchmark-utils.h"
+#include "x11/meta-shadow-factory.h"
+
+#define DEFAULT_N_ITERATIONS 50
+#define SHAPE_WIDTH 640
+#define SHAPE_HEIGHT 480
+#define SHAPE_CORNER_RADIUS 12
+#define BENCHMARK_CLASS_NAME "benchmark"
+
+typedef struct _BlurModeInfo
+{
+  const char *name;
+  MetaShadowBlurMode blur_mode;
+} BlurModeInfo;
+
+static const int radii[] = { 2, 4, 8, 12, 16, 24, 32, 48, 64 };
+
+static const BlurModeInfo blur_modes[] = {
+  { "cpu", META_SHADOW_BLUR_MODE_CPU },
+  { "gpu", META_SHADOW_BLUR_MODE_GPU },
+};
+
+static MetaContext *test_context;
+
+static MtkRegion *
+create_rounded_region (int width,
+                       int height,
+                       int corner_radius)
+{
+  MtkRegionBuilder builder;
+  int y;
+
+  mtk_region_builder_init (&builder);
+
+  for (y = 0; y < corner_radius; y++)
+    {
+      int dy = corner_radius - y;
+      int inset;
+
+      inset = corner_radius -
+              (int) sqrt (corner_radius * corner_radius - dy * dy);
+
+      mtk_region_builder_add_rectangle (&builder,
+                                        inset, y,
+                                        width - 2 * inset, 1);
+      mtk_region_builder_add_rectangle (&builder,
+                                        inset, height - y - 1,
+                                        width - 2 * inset, 1);
+    }
+
+  mtk_region_builder_add_rectangle (&builder,
+                                    0, corner_radius,
+                                    width, height - 2 * corner_radius);
+
+  return mtk_region_builder_finish (&builder);
+}
+
+static void
+append_result (GString            *result,
+               const BlurModeInfo *blur_mode_info,
+               int                 radius,
+               int64_t            *values,
+               int                 n_values)
+{
+  MetaBenchmarkStatistics statistics;
+
+  meta_benchmark_compute_statistics (values, n_values, &statistics);
+
+  g_string_append_printf (result,
+                          "{ \"mode\": \"%s\", \"radius\": %d, "
+                          "\"iterations\": %d, \"unit\": \"us\", ",
+                          blur_mode_info->name, radius, n_values);
+  meta_benchmark_append_statistics (result, &statistics);
+  g_string_append (result, " }");
+}
+
+static void
+run_benchmark (void)
+{
+  MetaBackend *backend = meta_context_get_backend (test_context);
+  ClutterBackend *clutter_backend =
+    meta_backend_get_clutter_backend (backend);
+  CoglContext *cogl_context =
+    clutter_backend_get_cogl_context (clutter_backend);
+  MetaShadowFactory *factory = meta_shadow_factory_get_default ();
+  g_autoptr (MtkRegion) region = NULL;
+  g_autoptr (CoglTexture) texture = NULL;
+  g_autoptr (CoglFramebuffer) framebuffer = NULL;
+  g_autoptr (MetaBenchmarkReport) report = NULL;
+  g_autofree int64_t *values = NULL;
+  g_autoptr (GError) error = NULL;
+  MetaWindowShape *shape;
+  int n_iterations;
+  size_t i, j;
+
+  n_iterations =
+    meta_benchmark_get_env_count ("MUTTER_SHADOW_BENCHMARK_ITERATIONS",
+                                  DEFAULT_N_ITERATIONS);
+  values = g_new0 (int64_t, n_iterations);
+
+  region = create_rounded_region (SHAPE_WIDTH, SHAPE_HEIGHT,
+                                  SHAPE_CORNER_RADIUS);
+  shape = meta_window_shape_new (region);
+
+  texture = cogl_texture_2d_new_with_size (cogl_context,
+                                           SHAPE_WIDTH * 2,
+                                           SHAPE_HEIGHT * 2);
+  framebuffer = COGL_FRAMEBUFFER (cogl_offscreen_new_with_texture (texture));
+  if (!cogl_framebuffer_allocate (framebuffer, &error))
+    g_error ("Failed to allocate offscreen: %s", error->message);
+  cogl_framebuffer_orthographic (framebuffer, 0, 0,
+                                 SHAPE_WIDTH * 2, SHAPE_HEIGHT * 2,
+                                 -1.0, 1.0);
+
+  report = meta_benchmark_report_new ();
+
+  for (i = 0; i < G_N_ELEMENTS (blur_modes); i++)
+    {
+      meta_shadow_factory_set_blur_mode (factory, blur_modes[i].blur_mode);
+
+      for (j = 0; j < G_N_ELEMENTS (radii); j++)
+        {
+          MetaShadowParams params = {
+            .radius = radii[j],
+            .top_fade = -1,
+            .opacity = 255,
+          };
+          int k;
+
+          meta_shadow_factory_set_params (factory, BENCHMARK_CLASS_NAME,
+                                          TRUE, &params);
+
+          for (k = 0; k < n_iterations; k++)
+            {
+              MetaShadow *shadow;
+              int64_t start_time_us;
+
+              start_time_us = g_get_monotonic_time ();
+
+              /* Shadows are only cached while referenced, so each
+               * iteration generates a new one. */
+              shadow = meta_shadow_factory_get_shadow (factory, shape,
+                                                       SHAPE_WIDTH,
+                                                       SHAPE_HEIGHT,
+                                                       BENCHMARK_CLASS_NAME,
+                                                       TRUE,
+                                                       cogl_context);
+              meta_shadow_paint (shadow, framebuffer,
+                                 SHAPE_WIDTH / 2, SHAPE_HEIGHT / 2,
+                                 SHAPE_WIDTH, SHAPE_HEIGHT,
+                                 255, NULL, FALSE);
+              cogl_framebuffer_finish (framebuffer);
+              meta_shadow_unref (shadow);
+
+              values[k] = g_get_monotonic_time () - start_time_us;
+            }
+
+          append_result (meta_benchmark_report_add_result (report),
+                         &blur_modes[i], radii[j],
+                         values, n_iterations);
+        }
+    }
+
+  meta_shadow_factory_set_blur_mode (factory, META_SHADOW_BLUR_MODE_AUTO);
+  meta_window_shape_unref (shape);
+
+  if (!meta_benchmark_report_write (report, &error))
+    g_error ("Failed to write benchmark results: %s", error->message);
+}
+
+static void
+init_tests (void)
+{
+  g_test_add_func ("/benchmark/shadow/generation", run_benchmark);
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  g_autoptr (MetaContext) context = NULL;
+
+  context = meta_create_test_context (META_CONTEXT_TEST_TYPE_HEADLESS,
+                                      META_CONTEXT_TEST_FLAG_NO_X11);
+  g_assert_true (meta_context_configure (context, &argc, &argv, NULL));
+
+  test_context = context;
+
+  init_tests ();
+
+  return meta_context_test_run_tests (META_CONTEXT_TEST (context),
+                                      META_TEST_RUN_FLAG_NONE);
+}
@@ -0,0 +1,190 @@
+/*
+ * Copyright (C) 2026 Red Hat Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "config.h"
+
+#include "meta-test/meta-context-test.h"
+#include "x11/meta-shadow-factory.h"
+
+#define SHAPE_WIDTH 200
+#define SHAPE_HEIGHT 150
+#define TEST_CLASS_NAME "test"
+
+/* The GPU path blurs a downscaled texture with a gaussian kernel, while
+ * the CPU path approximates a gaussian with three box blurs, so the
+ * results are only expected to be close, not identical. */
+#define MAX_ALPHA_DIFFERENCE 24
+#define MAX_MEAN_ALPHA_DIFFERENCE 2.0
+
+static MetaContext *test_context;
+
+static MtkRegion *
+create_notched_region (void)
+{
+  MtkRegionBuilder builder;
+
+  mtk_region_builder_init (&builder);
+  mtk_region_builder_add_rectangle (&builder,
+                                    0, 0,
+                                    SHAPE_WIDTH, SHAPE_HEIGHT - 40);
+  mtk_region_builder_add_rectangle (&builder,
+                                    40, SHAPE_HEIGHT - 40,
+                                    SHAPE_WIDTH - 40, 40);
+
+  return mtk_region_builder_finish (&builder);
+}
+
+static uint8_t *
+paint_shadow (MetaShadowBlurMode  blur_mode,
+              MetaWindowShape    *shape,
+              int                 padding)
+{
+  MetaBackend *backend = meta_context_get_backend (test_context);
+  ClutterBackend *clutter_backend =
+    meta_backend_get_clutter_backend (backend);
+  CoglContext *cogl_context =
+    clutter_backend_get_cogl_context (clutter_backend);
+  MetaShadowFactory *factory = meta_shadow_factory_get_default ();
+  g_autoptr (CoglTexture) texture = NULL;
+  g_autoptr (CoglFramebuffer) framebuffer = NULL;
+  g_autoptr (GError) error = NULL;
+  MetaShadow *shadow;
+  int width = SHAPE_WIDTH + 2 * padding;
+  int height = SHAPE_HEIGHT + 2 * padding;
+  uint8_t *pixels;
+
+  texture = cogl_texture_2d_new_with_size (cogl_context, width, height);
+  framebuffer = COGL_FRAMEBUFFER (cogl_offscreen_new_with_texture (texture));
+  if (!cogl_framebuffer_allocate (framebuffer, &error))
+    g_error ("Failed to allocate offscreen: %s", error->message);
+  cogl_framebuffer_orthographic (framebuffer, 0, 0, width, height,
+                                 -1.0, 1.0);
+  cogl_framebuffer_clear4f (framebuffer, COGL_BUFFER_BIT_COLOR,
+                            0.0, 0.0, 0.0, 0.0);
+
+  meta_shadow_factory_set_blur_mode (factory, blur_mode);
+  shadow = meta_shadow_factory_get_shadow (factory, shape,
+                                           SHAPE_WIDTH, SHAPE_HEIGHT,
+                                           TEST_CLASS_NAME, TRUE,
+                                           cogl_context);
+  meta_shadow_paint (shadow, framebuffer,
+                     padding, padding,
+                     SHAPE_WIDTH, SHAPE_HEIGHT,
+                     255, NULL, FALSE);
+  meta_shadow_unref (shadow);
+  meta_shadow_factory_set_blur_mode (factory, META_SHADOW_BLUR_MODE_AUTO);
+
+  pixels = g_malloc (width * height * 4);
+  cogl_framebuffer_read_pixels (framebuffer, 0, 0, width, height,
+                                COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                                pixels);
+
+  return pixels;
+}
+
+static void
+compare_blur_modes (int radius,
+                    int top_fade)
+{
+  MetaShadowFactory *factory = meta_shadow_factory_get_default ();
+  MetaShadowParams params = {
+    .radius = radius,
+    .top_fade = top_fade,
+    .opacity = 255,
+  };
+  g_autoptr (MtkRegion) region = NULL;
+  g_autofree uint8_t *cpu_pixels = NULL;
+  g_autofree uint8_t *gpu_pixels = NULL;
+  MetaWindowShape *shape;
+  int padding = 4 * radius;
+  int n_pixels;
+  int max_difference = 0;
+  int64_t sum_difference = 0;
+  double mean_difference;
+  int i;
+
+  meta_shadow_factory_set_params (factory, TEST_CLASS_NAME, TRUE, &params);
+
+  region = create_notched_region ();
+  shape = meta_window_shape_new (region);
+
+  cpu_pixels = paint_shadow (META_SHADOW_BLUR_MODE_CPU, shape, padding);
+  gpu_pixels = paint_shadow (META_SHADOW_BLUR_MODE_GPU, shape, padding);
+
+  meta_window_shape_unref (shape);
+
+  n_pixels = (SHAPE_WIDTH + 2 * padding) * (SHAPE_HEIGHT + 2 * padding);
+  for (i = 0; i < n_pixels; i++)
+    {
+      int difference = ABS (cpu_pixels[i * 4 + 3] - gpu_pixels[i * 4 + 3]);
+
+      max_difference = MAX (max_difference, difference);
+      sum_difference += difference;
+    }
+
+  mean_difference = (double) sum_difference / n_pixels;
+
+  g_debug ("Radius %d, top fade %d: max difference %d, mean difference %.2f",
+           radius, top_fade, max_difference, mean_difference);
+
+  g_assert_cmpint (max_difference, <=, MAX_ALPHA_DIFFERENCE);
+  g_assert_cmpfloat (mean_difference, <=, MAX_MEAN_ALPHA_DIFFERENCE);
+}
+
+static void
+meta_test_shadow_blur_modes (void)
+{
+  static const int radii[] = { 4, 11, 12, 24, 48 };
+  size_t i;
+
+  for (i = 0; i < G_N_ELEMENTS (radii); i++)
+    compare_blur_modes (radii[i], -1);
+}
+
+static void
+meta_test_shadow_blur_modes_top_fade (void)
+{
+  compare_blur_modes (12, 20);
+  compare_blur_modes (24, 20);
+}
+
+static void
+init_tests (void)
+{
+  g_test_add_func ("/x11/shadow-factory/blur-modes",
+                   meta_test_shadow_blur_modes);
+  g_test_add_func ("/x11/shadow-factory/blur-modes-top-fade",
+                   meta_test_shadow_blur_modes_top_fade);
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  g_autoptr (MetaContext) context = NULL;
+
+  context = meta_create_test_context (META_CONTEXT_TEST_TYPE_HEADLESS,
+                                      META_CONTEXT_TEST_FLAG_NO_X11);
+  g_assert_true (meta_context_configure (context, &argc, &argv, NULL));
+
+  test_context = context;
+
+  init_tests ();
+
+  return meta_context_test_run_tests (META_CONTEXT_TEST (context),
+                                      META_TEST_RUN_FLAG_NONE);
+}
@@ -1642,6 +1642,97 @@ meta_test_stage_views_offscreen_effect_resource_scale (void)
   meta_monitor_manager_test_emulate_hotplug (monitor_manager_test, test_setup);
 }
 
+static int
+count_shadowfb_blitted_pixels (ClutterStageView *view,
+                               const MtkRegion  *swap_region,
+                               int               buffer_age)
+{
+  CoglFramebuffer *onscreen = clutter_stage_view_get_onscreen (view);
+  CoglFramebuffer *shadowfb = clutter_stage_view_get_framebuffer (view);
+  int width = cogl_framebuffer_get_width (onscreen);
+  int height = cogl_framebuffer_get_height (onscreen);
+  g_autofree uint8_t *pixels = NULL;
+  int n_blitted = 0;
+  int i;
+
+  cogl_framebuffer_clear4f (onscreen, COGL_BUFFER_BIT_COLOR,
+                            0.0f, 0.0f, 0.0f, 1.0f);
+  cogl_framebuffer_clear4f (shadowfb, COGL_BUFFER_BIT_COLOR,
+                            1.0f, 1.0f, 1.0f, 1.0f);
+
+  clutter_stage_view_before_swap_buffer (view, swap_region, buffer_age);
+
+  pixels = g_malloc0 (width * height * 4);
+  cogl_framebuffer_read_pixels (onscreen, 0, 0, width, height,
+                                COGL_PIXEL_FORMAT_RGBA_8888, pixels);
+
+  for (i = 0; i < width * height; i++)
+    {
+      if (pixels[i * 4] == 0xff)
+        n_blitted++;
+    }
+
+  return n_blitted;
+}
+
+static void
+meta_test_stage_views_shadowfb_damage (void)
+{
+  ClutterActor *stage = meta_backend_get_stage (test_backend);
+  ClutterBackend *clutter_backend = meta_backend_get_clutter_backend (test_backend);
+  CoglContext *cogl_context = clutter_backend_get_cogl_context (clutter_backend);
+  MtkRectangle view_rect = { .width = 64, .height = 64 };
+  MtkRectangle rect_a = { .x = 0, .y = 0, .width = 8, .height = 8 };
+  MtkRectangle rect_b = { .x = 32, .y = 32, .width = 8, .height = 8 };
+  g_autoptr (MtkRegion) empty_region = NULL;
+  g_autoptr (MtkRegion) region_a = NULL;
+  g_autoptr (MtkRegion) region_b = NULL;
+  g_autoptr (CoglOffscreen) offscreen = NULL;
+  g_autoptr (CoglTexture) texture = NULL;
+  g_autoptr (ClutterStageView) view = NULL;
+  g_autoptr (GError) error = NULL;
+
+  texture = cogl_texture_2d_new_with_size (cogl_context, 64, 64);
+  offscreen = cogl_offscreen_new_with_texture (texture);
+  g_assert_true (cogl_framebuffer_allocate (COGL_FRAMEBUFFER (offscreen),
+                                            &error));
+  g_assert_no_error (error);
+
+  view = g_object_new (CLUTTER_TYPE_STAGE_VIEW,
+                       "name", "shadowfb-test",
+                       "stage", stage,
+                       "layout", &view_rect,
+                       "framebuffer", offscreen,
+                       "use-shadowfb", TRUE,
+                       NULL);
+  g_assert_true (clutter_stage_view_has_shadowfb (view));
+
+  empty_region = mtk_region_create ();
+  region_a = mtk_region_create_rectangle (&rect_a);
+  region_b = mtk_region_create_rectangle (&rect_b);
+
+  /* No history yet, so the whole back buffer is stale. */
+  g_assert_cmpint (count_shadowfb_blitted_pixels (view, region_a, 0),
+                   ==, 64 * 64);
+  /* The back buffer holds the previous frame. */
+  g_assert_cmpint (count_shadowfb_blitted_pixels (view, region_a, 1),
+                   ==, 8 * 8);
+  /* The back buffer misses the damage of the previous frame. */
+  g_assert_cmpint (count_shadowfb_blitted_pixels (view, region_b, 2),
+                   ==, 8 * 8 * 2);
+  /* Same damage as two frames ago, so nothing extra is stale. */
+  g_assert_cmpint (count_shadowfb_blitted_pixels (view, region_a, 3),
+                   ==, 8 * 8 * 2);
+  /* Older than the history that has been recorded. */
+  g_assert_cmpint (count_shadowfb_blitted_pixels (view, region_a, 8),
+                   ==, 64 * 64);
+  /* An empty swap region means a full redraw. */
+  g_assert_cmpint (count_shadowfb_blitted_pixels (view, empty_region, 1),
+                   ==, 64 * 64);
+  g_assert_cmpint (count_shadowfb_blitted_pixels (view, region_b, 2),
+                   ==, 64 * 64);
+}
+
 static void
 on_before_tests (MetaContext *context)
 {
@@ -1685,6 +1776,8 @@ init_tests (void)
                    meta_test_stage_views_offscreen_effect_resource_scale);
   g_test_add_func ("/stage-views/fractional-position",
                    meta_test_stage_views_fractional_position);
+  g_test_add_func ("/stage-views/shadowfb-damage",
+                   meta_test_stage_views_shadowfb_damage);
 }
 
 int
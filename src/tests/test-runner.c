@@ -39,6 +39,7 @@
 #include "meta-test/meta-context-test.h"
 #include "meta/util.h"
 #include "meta/window.h"
+#include "tests/meta-benchmark-utils.h"
 #include "tests/meta-test-utils.h"
 #include "wayland/meta-wayland-keyboard.h"
 #include "wayland/meta-wayland-pointer.h"
@@ -1298,6 +1299,21 @@ parse_barrier_flags (const char        *flags_string,
   return TRUE;
 }
 
+static gboolean
+test_case_do_line (TestCase    *test,
+                   const char  *filename,
+                   int          line_no,
+                   const char  *line,
+                   GError     **error)
+{
+  g_auto (GStrv) argv = NULL;
+
+  argv = g_strsplit (line, " ", -1);
+
+  return test_case_do (test, filename, line_no,
+                       g_strv_length (argv), argv, error);
+}
+
 static gboolean
 test_case_do (TestCase    *test,
               const char  *filename,
@@ -1649,6 +1665,162 @@ test_case_do (TestCase    *test,
 
       meta_window_drag_end (window_drag);
     }
+  else if (strcmp (argv[0], "create_grid") == 0)
+    {
+      int columns, rows, width, height, spacing;
+      int i;
+
+      if (argc != 7)
+        BAD_COMMAND ("usage: %s <client-id> <columns> <rows> <width> <height> <spacing>",
+                     argv[0]);
+
+      columns = atoi (argv[2]);
+      rows = atoi (argv[3]);
+      width = atoi (argv[4]);
+      height = atoi (argv[5]);
+      spacing = atoi (argv[6]);
+      if (columns <= 0 || rows <= 0 || width <= 0 || height <= 0 || spacing < 0)
+        BAD_COMMAND ("Invalid grid '%s'", command);
+
+      /* Windows <client-id>/1 to <client-id>/<columns * rows> are laid out
+       * row by row, each <spacing> pixels away from its neighbours and
+       * from the top left corner of the monitor. */
+      for (i = 0; i < columns * rows; i++)
+        {
+          g_autofree char *create = NULL;
+          g_autofree char *resize = NULL;
+          g_autofree char *show = NULL;
+
+          create = g_strdup_printf ("create %s/%d csd", argv[1], i + 1);
+          resize = g_strdup_printf ("resize %s/%d %d %d",
+                                    argv[1], i + 1, width, height);
+          show = g_strdup_printf ("show %s/%d", argv[1], i + 1);
+
+          if (!test_case_do_line (test, filename, line_no, create, error) ||
+              !test_case_do_line (test, filename, line_no, resize, error) ||
+              !test_case_do_line (test, filename, line_no, show, error))
+            return FALSE;
+        }
+
+      if (!test_case_do_line (test, filename, line_no, "wait", error))
+        return FALSE;
+
+      for (i = 0; i < columns * rows; i++)
+        {
+          g_autofree char *move = NULL;
+
+          move = g_strdup_printf ("move %s/%d %d %d", argv[1], i + 1,
+                                  spacing + (i % columns) * (width + spacing),
+                                  spacing + (i / columns) * (height + spacing));
+
+          if (!test_case_do_line (test, filename, line_no, move, error))
+            return FALSE;
+        }
+    }
+  else if (strcmp (argv[0], "benchmark_drag") == 0)
+    {
+      MetaBackend *backend = meta_context_get_backend (test->context);
+      ClutterBackend *clutter_backend =
+        meta_backend_get_clutter_backend (backend);
+      ClutterStage *stage = CLUTTER_STAGE (meta_backend_get_stage (backend));
+      ClutterSprite *sprite;
+      MetaTestClient *client;
+      const char *window_id;
+      MetaWindow *window;
+      MtkRectangle rect;
+      gboolean ret;
+      graphene_point_t grab_origin;
+      MetaWindowDrag *window_drag;
+      g_autoptr (MetaBenchmarkReport) report = NULL;
+      g_autofree int64_t *motion_times_us = NULL;
+      MetaBenchmarkStatistics statistics;
+      GString *result;
+      int64_t start_time_us, elapsed_us;
+      int n_motions;
+      int i;
+
+      if (argc != 3)
+        BAD_COMMAND ("usage: %s <client-id>/<window-id> <n-motions>", argv[0]);
+
+      if (!test_case_parse_window_id (test, argv[1], &client, &window_id, error))
+        return FALSE;
+
+      window = meta_test_client_find_window (client, window_id, error);
+      if (!window)
+        return FALSE;
+
+      n_motions = atoi (argv[2]);
+      if (n_motions <= 0)
+        BAD_COMMAND ("Invalid motion count '%s'", argv[2]);
+
+      meta_window_get_frame_rect (window, &rect);
+      grab_origin = GRAPHENE_POINT_INIT (rect.x + rect.width / 2.0f,
+                                         rect.y + rect.height / 2.0f);
+
+      if (!warp_pointer_to (test, grab_origin.x, grab_origin.y, error))
+        return FALSE;
+
+      sprite = clutter_backend_get_pointer_sprite (clutter_backend, stage);
+      ret = meta_window_begin_grab_op (window,
+                                       META_GRAB_OP_MOVING,
+                                       sprite,
+                                       meta_display_get_current_time_roundtrip (window->display),
+                                       &grab_origin);
+      g_assert_true (ret);
+
+      window_drag =
+        meta_compositor_get_current_window_drag (window->display->compositor);
+      g_assert_nonnull (window_drag);
+
+      /* Sweep the window back and forth across the other windows, so that
+       * every motion goes through edge resistance and snapping. */
+      motion_times_us = g_new0 (int64_t, n_motions);
+      elapsed_us = 0;
+
+      for (i = 0; i < n_motions; i++)
+        {
+          float delta_x = (i % 200) * 4.0f - 400.0f;
+          float delta_y = ((i / 200) % 2 ? -1.0f : 1.0f) * (i % 100) * 2.0f;
+
+          start_time_us = g_get_monotonic_time ();
+
+          clutter_virtual_input_device_notify_absolute_motion (test->pointer,
+                                                               CLUTTER_CURRENT_TIME,
+                                                               grab_origin.x + delta_x,
+                                                               grab_origin.y + delta_y);
+          meta_flush_input (test->context);
+          while (g_main_context_iteration (NULL, FALSE));
+
+          motion_times_us[i] = g_get_monotonic_time () - start_time_us;
+          elapsed_us += motion_times_us[i];
+        }
+
+      elapsed_us = MAX (elapsed_us, 1);
+
+      meta_window_drag_end (window_drag);
+
+      meta_benchmark_compute_statistics (motion_times_us, n_motions,
+                                         &statistics);
+
+      report = meta_benchmark_report_new ();
+      result = meta_benchmark_report_add_result (report);
+      g_string_append_printf (result,
+                              "{ \"scenario\": \"drag\", "
+                              "\"motions\": %d, "
+                              "\"time_us\": %" G_GINT64_FORMAT ", "
+                              "\"unit\": \"us\", ",
+                              n_motions, elapsed_us);
+      meta_benchmark_append_statistics (result, &statistics);
+      g_string_append_printf (result,
+                              ", \"motions_per_second\": %.1f }",
+                              n_motions * (double) G_USEC_PER_SEC / elapsed_us);
+
+      if (!meta_benchmark_report_write (report, error))
+        return FALSE;
+
+      if (!test_case_dispatch (test, error))
+        return FALSE;
+    }
   else if (strcmp (argv[0], "recompute_drag_position") == 0)
     {
       MetaTestClient *client;
@@ -27,8 +27,11 @@
 #include <meta/main.h>
 #include <meta/util.h>
 
+#include "backends/meta-logical-monitor-private.h"
+#include "backends/meta-monitor-manager-private.h"
 #include "core/boxes-private.h"
 #include "core/display-private.h"
+#include "core/workspace-private.h"
 #include "meta-test/meta-context-test.h"
 #include "meta/compositor.h"
 #include "meta/meta-context.h"
@@ -199,12 +202,232 @@ meta_test_util_later_schedule_from_later (void)
   g_assert_cmpint (data.state, ==, META_TEST_LATER_FINISHED);
 }
 
+static void
+assert_rect_lists_equal (GList *rects,
+                         GList *expected_rects)
+{
+  GList *l;
+
+  g_assert_cmpuint (g_list_length (rects), ==, g_list_length (expected_rects));
+
+  for (l = expected_rects; l; l = l->next)
+    {
+      MtkRectangle *expected_rect = l->data;
+      GList *k;
+
+      for (k = rects; k; k = k->next)
+        {
+          if (mtk_rectangle_equal (k->data, expected_rect))
+            break;
+        }
+
+      if (!k)
+        {
+          g_error ("Missing rectangle %d,%d %dx%d",
+                   expected_rect->x, expected_rect->y,
+                   expected_rect->width, expected_rect->height);
+        }
+    }
+}
+
+static void
+assert_edge_lists_equal (GList *edges,
+                         GList *expected_edges)
+{
+  GList *l;
+
+  g_assert_cmpuint (g_list_length (edges), ==, g_list_length (expected_edges));
+
+  for (l = expected_edges; l; l = l->next)
+    {
+      MetaEdge *expected_edge = l->data;
+      GList *k;
+
+      for (k = edges; k; k = k->next)
+        {
+          MetaEdge *edge = k->data;
+
+          if (mtk_rectangle_equal (&edge->rect, &expected_edge->rect) &&
+              edge->side_type == expected_edge->side_type &&
+              edge->edge_type == expected_edge->edge_type)
+            break;
+        }
+
+      if (!k)
+        {
+          g_error ("Missing edge %d,%d %dx%d",
+                   expected_edge->rect.x, expected_edge->rect.y,
+                   expected_edge->rect.width, expected_edge->rect.height);
+        }
+    }
+}
+
+/* Computes the work areas of a workspace from scratch, the way they were
+ * computed before they were updated incrementally, and compares them with
+ * what the workspace has. Only builtin struts are used in these tests. */
+static void
+assert_work_areas_match_full_computation (MetaWorkspace *workspace)
+{
+  MetaBackend *backend = meta_context_get_backend (test_context);
+  MetaMonitorManager *monitor_manager =
+    meta_backend_get_monitor_manager (backend);
+  MetaDisplay *display = meta_context_get_display (test_context);
+  MtkRectangle display_rect = { 0 };
+  MtkRectangle work_area;
+  MtkRectangle expected_work_area;
+  GList *logical_monitors;
+  GList *monitor_rects = NULL;
+  GList *expected_region;
+  GList *expected_edges;
+  GSList *struts;
+  GList *l;
+
+  meta_display_get_size (display, &display_rect.width, &display_rect.height);
+  struts = meta_workspace_get_builtin_struts (workspace);
+
+  meta_workspace_ensure_work_areas_validated (workspace);
+
+  logical_monitors =
+    meta_monitor_manager_get_logical_monitors (monitor_manager);
+  for (l = logical_monitors; l; l = l->next)
+    {
+      MetaLogicalMonitor *logical_monitor = l->data;
+      MtkRectangle layout = meta_logical_monitor_get_layout (logical_monitor);
+
+      expected_region =
+        meta_rectangle_get_minimal_spanning_set_for_region (&layout, struts);
+      assert_rect_lists_equal (meta_workspace_get_onmonitor_region (workspace,
+                                                                    logical_monitor),
+                               expected_region);
+
+      expected_work_area = layout;
+      meta_rectangle_clip_to_region (expected_region,
+                                     FIXED_DIRECTION_NONE,
+                                     &expected_work_area);
+      meta_workspace_get_work_area_for_logical_monitor (workspace,
+                                                        logical_monitor,
+                                                        &work_area);
+      g_assert_true (mtk_rectangle_equal (&work_area, &expected_work_area));
+
+      meta_rectangle_free_list_and_elements (expected_region);
+
+      monitor_rects = g_list_prepend (monitor_rects, &logical_monitor->rect);
+    }
+
+  expected_region =
+    meta_rectangle_get_minimal_spanning_set_for_region (&display_rect, struts);
+  assert_rect_lists_equal (meta_workspace_get_onscreen_region (workspace),
+                           expected_region);
+
+  expected_work_area = display_rect;
+  meta_rectangle_clip_to_region (expected_region,
+                                 FIXED_DIRECTION_NONE,
+                                 &expected_work_area);
+  meta_workspace_get_work_area_all_monitors (workspace, &work_area);
+  g_assert_true (mtk_rectangle_equal (&work_area, &expected_work_area));
+  meta_rectangle_free_list_and_elements (expected_region);
+
+  expected_edges = meta_rectangle_find_onscreen_edges (&display_rect, struts);
+  assert_edge_lists_equal (workspace->screen_edges, expected_edges);
+  meta_rectangle_free_list_and_elements (expected_edges);
+
+  expected_edges =
+    meta_rectangle_find_nonintersected_monitor_edges (monitor_rects, struts);
+  assert_edge_lists_equal (workspace->monitor_edges, expected_edges);
+  meta_rectangle_free_list_and_elements (expected_edges);
+
+  g_list_free (monitor_rects);
+  g_slist_free_full (struts, g_free);
+}
+
+static void
+set_workspace_struts (MetaWorkspace *workspace,
+                      MtkRectangle  *rects,
+                      MetaSide      *sides,
+                      int            n_struts)
+{
+  MetaStrut *struts;
+  GSList *strut_list = NULL;
+  int i;
+
+  struts = g_new0 (MetaStrut, n_struts);
+  for (i = n_struts - 1; i >= 0; i--)
+    {
+      struts[i] = (MetaStrut) { .rect = rects[i], .side = sides[i] };
+      strut_list = g_slist_prepend (strut_list, &struts[i]);
+    }
+
+  meta_workspace_set_builtin_struts (workspace, strut_list);
+
+  g_slist_free (strut_list);
+  g_free (struts);
+}
+
+static void
+meta_test_workspace_incremental_work_areas (void)
+{
+  MetaDisplay *display = meta_context_get_display (test_context);
+  MetaWorkspaceManager *workspace_manager =
+    meta_display_get_workspace_manager (display);
+  MtkRectangle display_rect = { 0 };
+  MetaWorkspace *workspaces[2];
+  GList *l;
+  int step;
+
+  meta_display_get_size (display, &display_rect.width, &display_rect.height);
+
+  while (meta_workspace_manager_get_n_workspaces (workspace_manager) < 2)
+    meta_workspace_manager_append_new_workspace (workspace_manager, FALSE, 0);
+  workspaces[0] = meta_workspace_manager_get_workspace_by_index (workspace_manager, 0);
+  workspaces[1] = meta_workspace_manager_get_workspace_by_index (workspace_manager, 1);
+
+  /* Grow, move and shrink a set of panels one strut at a time, on one
+   * or both workspaces, validating after each step so that each step
+   * starts from the previous incremental result. */
+  for (step = 0; step < 12; step++)
+    {
+      MtkRectangle rects[] = {
+        { 0, 0, display_rect.width, 20 + step },
+        { 0, display_rect.height - 40, display_rect.width / 2, 40 },
+        { 0, 100 + step * 10, 30 + step, 200 },
+        { display_rect.width - 50, 0, 50, display_rect.height / 2 },
+      };
+      MetaSide sides[] = {
+        META_SIDE_TOP,
+        META_SIDE_BOTTOM,
+        META_SIDE_LEFT,
+        META_SIDE_RIGHT,
+      };
+      int n_struts = 1 + (step % G_N_ELEMENTS (rects));
+
+      set_workspace_struts (workspaces[0], rects, sides, n_struts);
+      if (step % 3 != 0)
+        set_workspace_struts (workspaces[1], rects, sides, n_struts);
+
+      /* Invalidating without changing the struts keeps the previous
+       * results */
+      if (step % 4 == 0)
+        meta_workspace_invalidate_work_area (workspaces[1]);
+
+      assert_work_areas_match_full_computation (workspaces[0]);
+      assert_work_areas_match_full_computation (workspaces[1]);
+    }
+
+  for (l = meta_workspace_manager_get_workspaces (workspace_manager); l; l = l->next)
+    {
+      meta_workspace_set_builtin_struts (l->data, NULL);
+      assert_work_areas_match_full_computation (l->data);
+    }
+}
+
 static void
 init_tests (void)
 {
   g_test_add_func ("/util/meta-later/order", meta_test_util_later_order);
   g_test_add_func ("/util/meta-later/schedule-from-later",
                    meta_test_util_later_schedule_from_later);
+  g_test_add_func ("/core/workspace/incremental-work-areas",
+                   meta_test_workspace_incremental_work_areas);
 
   init_monitor_store_tests ();
   init_boxes_tests ();
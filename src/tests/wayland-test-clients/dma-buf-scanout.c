@@ -49,6 +49,9 @@
 
 #include "wayland-test-client-utils.h"
 
+#define WINDOWED_WIDTH 256
+#define WINDOWED_HEIGHT 256
+
 typedef enum
 {
   WINDOW_STATE_NONE,
@@ -64,6 +67,7 @@ static int prev_height;
 static WindowState window_state;
 
 static gboolean reuse_buffer;
+static gboolean windowed;
 static WaylandBuffer *reused_buffer;
 
 static gboolean running;
@@ -86,7 +90,8 @@ static void
 init_surface (struct xdg_toplevel *xdg_toplevel)
 {
   xdg_toplevel_set_title (xdg_toplevel, "dma-buf-scanout-test");
-  xdg_toplevel_set_fullscreen (xdg_toplevel, NULL);
+  if (!windowed)
+    xdg_toplevel_set_fullscreen (xdg_toplevel, NULL);
   wl_surface_commit (surface);
 }
 
@@ -256,6 +261,14 @@ main (int    argc,
       strcmp (argv[1], "reuse-buffer") == 0)
     reuse_buffer = TRUE;
 
+  if (argc == 2 &&
+      strcmp (argv[1], "windowed") == 0)
+    {
+      windowed = TRUE;
+      prev_width = WINDOWED_WIDTH;
+      prev_height = WINDOWED_HEIGHT;
+    }
+
   display = wayland_display_new (WAYLAND_DISPLAY_CAPABILITY_TEST_DRIVER);
   g_signal_connect (display, "sync-event", G_CALLBACK (on_sync_event), NULL);
   wl_display_roundtrip (display->display);
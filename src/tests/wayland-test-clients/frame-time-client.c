@@ -0,0 +1,318 @@
+/*
+ * Copyright (C) 2026 Red Hat Inc.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Client for the frame time benchmark. Depending on the scenario passed on
+ * the command line, it maps a number of windows or subsurfaces, or a
+ * fullscreen video-like surface, and submits a new buffer for each of them
+ * every time the compositor sends a frame callback. Once everything is
+ * mapped, sync point 0 is reached; the client keeps drawing until sync
+ * event 0 is received.
+ */
+
+#include "config.h"
+
+#include <glib.h>
+#include <stdlib.h>
+#include <wayland-client.h>
+
+#include "wayland-test-client-utils.h"
+
+#define WINDOW_WIDTH 256
+#define WINDOW_HEIGHT 192
+#define SUBSURFACE_SIZE 48
+#define SUBSURFACE_COLUMNS 12
+#define VIDEO_WIDTH 1280
+#define VIDEO_HEIGHT 720
+
+typedef struct _AnimatedSurface
+{
+  WaylandDisplay *display;
+  struct wl_surface *wl_surface;
+  int width;
+  int height;
+  gboolean is_video;
+  unsigned int n_frames;
+} AnimatedSurface;
+
+static const uint32_t colors[] = {
+  0xff3465a4,
+  0xff73d216,
+  0xfff57900,
+  0xff75507b,
+  0xffcc0000,
+  0xffedd400,
+};
+
+static gboolean running;
+
+static void draw_animated_surface (AnimatedSurface *animated);
+
+static void
+handle_frame_callback (void               *user_data,
+                       struct wl_callback *callback,
+                       uint32_t            time)
+{
+  AnimatedSurface *animated = user_data;
+
+  wl_callback_destroy (callback);
+
+  if (!running)
+    return;
+
+  draw_animated_surface (animated);
+}
+
+static const struct wl_callback_listener frame_listener = {
+  handle_frame_callback,
+};
+
+static void
+draw_animated_surface (AnimatedSurface *animated)
+{
+  uint32_t color;
+  struct wl_callback *callback;
+
+  color = colors[animated->n_frames++ % G_N_ELEMENTS (colors)];
+
+  callback = wl_surface_frame (animated->wl_surface);
+  wl_callback_add_listener (callback, &frame_listener, animated);
+
+  if (animated->is_video)
+    {
+      WaylandBuffer *buffer;
+
+      buffer = wayland_buffer_create (animated->display, NULL,
+                                      VIDEO_WIDTH, VIDEO_HEIGHT,
+                                      DRM_FORMAT_XRGB8888,
+                                      NULL, 0,
+                                      GBM_BO_USE_LINEAR);
+      if (!buffer)
+        g_error ("Failed to create video buffer");
+
+      wayland_buffer_fill_color (buffer, color);
+
+      wl_surface_attach (animated->wl_surface,
+                         wayland_buffer_get_wl_buffer (buffer),
+                         0, 0);
+      wl_surface_damage_buffer (animated->wl_surface,
+                                0, 0, VIDEO_WIDTH, VIDEO_HEIGHT);
+    }
+  else
+    {
+      draw_surface (animated->display, animated->wl_surface,
+                    animated->width, animated->height,
+                    color);
+    }
+
+  wl_surface_commit (animated->wl_surface);
+}
+
+static AnimatedSurface *
+animated_surface_new (WaylandDisplay    *display,
+                      struct wl_surface *wl_surface,
+                      int                width,
+                      int                height)
+{
+  AnimatedSurface *animated;
+
+  animated = g_new0 (AnimatedSurface, 1);
+  animated->display = display;
+  animated->wl_surface = wl_surface;
+  animated->width = width;
+  animated->height = height;
+
+  return animated;
+}
+
+static void
+run_windows (WaylandDisplay *display,
+             int             n_windows,
+             GPtrArray      *surfaces,
+             GPtrArray      *animated_surfaces)
+{
+  int i;
+
+  for (i = 0; i < n_windows; i++)
+    {
+      g_autofree char *title = NULL;
+      WaylandSurface *surface;
+
+      title = g_strdup_printf ("frame-time-window-%d", i);
+      surface = wayland_surface_new (display, title,
+                                     WINDOW_WIDTH, WINDOW_HEIGHT,
+                                     colors[i % G_N_ELEMENTS (colors)]);
+      wayland_surface_fixate_size (surface);
+      wl_surface_commit (surface->wl_surface);
+      wait_for_window_configured (display, surface);
+
+      g_ptr_array_add (surfaces, surface);
+      g_ptr_array_add (animated_surfaces,
+                       animated_surface_new (display, surface->wl_surface,
+                                             WINDOW_WIDTH, WINDOW_HEIGHT));
+    }
+}
+
+static void
+run_subsurfaces (WaylandDisplay *display,
+                 int             n_subsurfaces,
+                 GPtrArray      *surfaces,
+                 GPtrArray      *animated_surfaces)
+{
+  WaylandSurface *toplevel;
+  int n_rows;
+  int i;
+
+  n_rows = (n_subsurfaces + SUBSURFACE_COLUMNS - 1) / SUBSURFACE_COLUMNS;
+
+  toplevel = wayland_surface_new (display, "frame-time-subsurfaces",
+                                  SUBSURFACE_COLUMNS * SUBSURFACE_SIZE,
+                                  MAX (n_rows, 1) * SUBSURFACE_SIZE,
+                                  0xff2e3436);
+  wayland_surface_fixate_size (toplevel);
+  wl_surface_commit (toplevel->wl_surface);
+  wait_for_window_configured (display, toplevel);
+  g_ptr_array_add (surfaces, toplevel);
+
+  for (i = 0; i < n_subsurfaces; i++)
+    {
+      struct wl_surface *wl_surface;
+      struct wl_subsurface *wl_subsurface;
+
+      wl_surface = wl_compositor_create_surface (display->compositor);
+      wl_subsurface = wl_subcompositor_get_subsurface (display->subcompositor,
+                                                       wl_surface,
+                                                       toplevel->wl_surface);
+      wl_subsurface_set_position (wl_subsurface,
+                                  (i % SUBSURFACE_COLUMNS) * SUBSURFACE_SIZE,
+                                  (i / SUBSURFACE_COLUMNS) * SUBSURFACE_SIZE);
+      wl_subsurface_set_desync (wl_subsurface);
+
+      draw_surface (display, wl_surface,
+                    SUBSURFACE_SIZE, SUBSURFACE_SIZE,
+                    colors[i % G_N_ELEMENTS (colors)]);
+      wl_surface_commit (wl_surface);
+
+      g_ptr_array_add (animated_surfaces,
+                       animated_surface_new (display, wl_surface,
+                                             SUBSURFACE_SIZE,
+                                             SUBSURFACE_SIZE));
+    }
+
+  wl_surface_commit (toplevel->wl_surface);
+}
+
+static void
+on_video_configure (WaylandSurface *surface,
+                    gpointer        user_data)
+{
+  struct wp_viewport *viewport = user_data;
+
+  wp_viewport_set_destination (viewport, surface->width, surface->height);
+  wayland_surface_commit (surface);
+}
+
+static void
+run_fullscreen_video (WaylandDisplay *display,
+                      GPtrArray      *surfaces,
+                      GPtrArray      *animated_surfaces)
+{
+  WaylandSurface *surface;
+  struct wp_viewport *viewport;
+  AnimatedSurface *animated;
+
+  surface = wayland_surface_new (display, "frame-time-fullscreen-video",
+                                 VIDEO_WIDTH, VIDEO_HEIGHT,
+                                 0xff000000);
+  surface->manual_paint = TRUE;
+  viewport = wp_viewporter_get_viewport (display->viewporter,
+                                         surface->wl_surface);
+  g_signal_connect (surface, "configure",
+                    G_CALLBACK (on_video_configure), viewport);
+  xdg_toplevel_set_fullscreen (surface->xdg_toplevel, NULL);
+  wl_surface_commit (surface->wl_surface);
+
+  while (!wayland_surface_has_state (surface, XDG_TOPLEVEL_STATE_FULLSCREEN))
+    wait_for_window_configured (display, surface);
+
+  g_ptr_array_add (surfaces, surface);
+
+  animated = animated_surface_new (display, surface->wl_surface,
+                                   VIDEO_WIDTH, VIDEO_HEIGHT);
+  animated->is_video = TRUE;
+  g_ptr_array_add (animated_surfaces, animated);
+}
+
+static void
+on_sync_event (WaylandDisplay *display,
+               uint32_t        serial)
+{
+  g_assert_cmpint (serial, ==, 0);
+  running = FALSE;
+}
+
+int
+main (int    argc,
+      char **argv)
+{
+  g_autoptr (WaylandDisplay) display = NULL;
+  g_autoptr (GPtrArray) surfaces = NULL;
+  g_autoptr (GPtrArray) animated_surfaces = NULL;
+  const char *scenario;
+  int count;
+  unsigned int i;
+
+  g_assert_cmpint (argc, >=, 2);
+  scenario = argv[1];
+  count = argc > 2 ? atoi (argv[2]) : 1;
+
+  display = wayland_display_new (WAYLAND_DISPLAY_CAPABILITY_TEST_DRIVER);
+  g_signal_connect (display, "sync-event", G_CALLBACK (on_sync_event), NULL);
+
+  /* Buffers are allocated from the GBM device whenever there is one, so drop
+   * it to get SHM buffers. */
+  if (g_str_has_prefix (scenario, "shm-"))
+    g_clear_pointer (&display->gbm_device, gbm_device_destroy);
+  else if (g_str_has_prefix (scenario, "dma-buf-"))
+    g_assert_nonnull (display->gbm_device);
+
+  surfaces = g_ptr_array_new_with_free_func (g_object_unref);
+  animated_surfaces = g_ptr_array_new_with_free_func (g_free);
+
+  if (g_str_has_suffix (scenario, "-windows"))
+    run_windows (display, count, surfaces, animated_surfaces);
+  else if (g_str_equal (scenario, "subsurfaces"))
+    run_subsurfaces (display, count, surfaces, animated_surfaces);
+  else if (g_str_equal (scenario, "fullscreen-video"))
+    run_fullscreen_video (display, surfaces, animated_surfaces);
+  else
+    g_error ("Unknown scenario '%s'", scenario);
+
+  running = TRUE;
+
+  for (i = 0; i < animated_surfaces->len; i++)
+    draw_animated_surface (g_ptr_array_index (animated_surfaces, i));
+
+  test_driver_sync_point (display->test_driver, 0, NULL);
+
+  while (running)
+    wayland_display_dispatch (display);
+
+  g_assert_cmpint (wl_display_roundtrip (display->display), !=, -1);
+
+  return EXIT_SUCCESS;
+}
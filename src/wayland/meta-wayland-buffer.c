@@ -57,6 +57,7 @@
 #include "meta/util.h"
 #include "wayland/meta-wayland-dma-buf.h"
 #include "wayland/meta-wayland-private.h"
+#include "wayland/meta-wayland-shm-uploader.h"
 #include "common/meta-cogl-drm-formats.h"
 #include "common/meta-drm-format-helpers.h"
 #include "common/meta-drm-timeline.h"
@@ -716,10 +717,13 @@ process_shm_buffer_damage (MetaWaylandBuffer *buffer,
                            MtkRegion         *region,
                            GError           **error)
 {
+  MetaWaylandShmUploader *uploader =
+    meta_wayland_compositor_get_shm_uploader (buffer->compositor);
   const MetaFormatInfo *format_info;
   MetaMultiTextureFormat multi_format;
   const MetaMultiTextureFormatInfo *mt_format_info;
   struct wl_shm_buffer *shm_buffer;
+  gboolean ret;
   int shm_offset[3] = { 0 };
   int shm_stride[3] = { 0 };
   const uint8_t *data;
@@ -773,25 +777,21 @@ process_shm_buffer_damage (MetaWaylandBuffer *buffer,
           rect_data = plane_data + (rect.x * bpp / horizontal_factor) +
                       (rect.y * plane_stride);
 
-          if (!_cogl_texture_set_region (cogl_texture,
-                                         rect.width / horizontal_factor,
-                                         rect.height / vertical_factor,
-                                         subformat,
-                                         plane_stride,
-                                         rect_data,
-                                         rect.x, rect.y,
-                                         0,
-                                         error))
-            goto fail;
+          meta_wayland_shm_uploader_add_span (uploader,
+                                              cogl_texture,
+                                              subformat,
+                                              rect_data,
+                                              plane_stride,
+                                              rect.width / horizontal_factor,
+                                              rect.height / vertical_factor,
+                                              rect.x, rect.y);
         }
     }
 
-  wl_shm_buffer_end_access (shm_buffer);
-  return TRUE;
+  ret = meta_wayland_shm_uploader_flush (uploader, error);
 
-fail:
   wl_shm_buffer_end_access (shm_buffer);
-  return FALSE;
+  return ret;
 }
 
 void
@@ -889,11 +889,12 @@ scanout_buffer_disposed (gpointer  data,
 }
 
 CoglScanout *
-meta_wayland_buffer_try_acquire_scanout (MetaWaylandBuffer     *buffer,
-                                         CoglOnscreen          *onscreen,
-                                         ClutterStageView      *stage_view,
-                                         const graphene_rect_t *src_rect,
-                                         const MtkRectangle    *dst_rect)
+meta_wayland_buffer_try_acquire_scanout (MetaWaylandBuffer       *buffer,
+                                         CoglOnscreen            *onscreen,
+                                         ClutterStageView        *stage_view,
+                                         MetaWaylandScanoutPlane  scanout_plane,
+                                         const graphene_rect_t   *src_rect,
+                                         const MtkRectangle      *dst_rect)
 {
   CoglScanout *scanout = NULL;
   CoglScanoutBuffer *scanout_buffer;
@@ -916,6 +917,12 @@ meta_wayland_buffer_try_acquire_scanout (MetaWaylandBuffer     *buffer,
                   "Buffer type not scanout compatible");
       return NULL;
     case META_WAYLAND_BUFFER_TYPE_EGL_IMAGE:
+      if (scanout_plane != META_WAYLAND_SCANOUT_PLANE_PRIMARY)
+        {
+          meta_topic (META_DEBUG_RENDER,
+                      "Buffer type not overlay plane compatible");
+          return NULL;
+        }
       if (src_rect || dst_rect)
         {
           meta_topic (META_DEBUG_RENDER,
@@ -932,6 +939,7 @@ meta_wayland_buffer_try_acquire_scanout (MetaWaylandBuffer     *buffer,
         scanout = meta_wayland_dma_buf_try_acquire_scanout (buffer,
                                                             onscreen,
                                                             stage_view,
+                                                            scanout_plane,
                                                             src_rect,
                                                             dst_rect);
         break;
@@ -94,10 +94,11 @@ gboolean                meta_wayland_buffer_is_y_inverted       (MetaWaylandBuff
 void                    meta_wayland_buffer_process_damage      (MetaWaylandBuffer     *buffer,
                                                                  MetaMultiTexture      *texture,
                                                                  MtkRegion             *region);
-CoglScanout *           meta_wayland_buffer_try_acquire_scanout (MetaWaylandBuffer     *buffer,
-                                                                 CoglOnscreen          *onscreen,
-                                                                 ClutterStageView      *stage_view,
-                                                                 const graphene_rect_t *src_rect,
-                                                                 const MtkRectangle    *dst_rect);
+CoglScanout *           meta_wayland_buffer_try_acquire_scanout (MetaWaylandBuffer       *buffer,
+                                                                 CoglOnscreen            *onscreen,
+                                                                 ClutterStageView        *stage_view,
+                                                                 MetaWaylandScanoutPlane  scanout_plane,
+                                                                 const graphene_rect_t   *src_rect,
+                                                                 const MtkRectangle      *dst_rect);
 
 void meta_wayland_init_shm (MetaWaylandCompositor *compositor);
@@ -616,12 +616,11 @@ has_modifier (GArray   *modifiers,
 }
 
 static gboolean
-crtc_supports_modifier (MetaCrtcKms *crtc_kms,
-                        uint32_t     drm_format,
-                        uint64_t     drm_modifier)
+plane_supports_modifier (MetaKmsPlane *plane,
+                         uint32_t      drm_format,
+                         uint64_t      drm_modifier)
 {
-  MetaKmsPlane *plane = meta_crtc_kms_get_assigned_primary_plane (crtc_kms);
-  GArray *crtc_modifiers;
+  GArray *plane_modifiers;
 
   g_return_val_if_fail (plane, FALSE);
 
@@ -631,24 +630,37 @@ crtc_supports_modifier (MetaCrtcKms *crtc_kms,
   if (drm_modifier == DRM_FORMAT_MOD_INVALID)
     return TRUE;
 
-  crtc_modifiers = meta_kms_plane_get_modifiers_for_format (plane, drm_format);
-  if (!crtc_modifiers)
+  plane_modifiers = meta_kms_plane_get_modifiers_for_format (plane, drm_format);
+  if (!plane_modifiers)
     return FALSE;
 
-  return has_modifier (crtc_modifiers, drm_modifier);
+  return has_modifier (plane_modifiers, drm_modifier);
+}
+
+static gboolean
+crtc_supports_modifier (MetaCrtcKms *crtc_kms,
+                        uint32_t     drm_format,
+                        uint64_t     drm_modifier)
+{
+  MetaKmsPlane *plane = meta_crtc_kms_get_assigned_primary_plane (crtc_kms);
+
+  return plane_supports_modifier (plane, drm_format, drm_modifier);
 }
 
 CoglScanout *
-meta_wayland_dma_buf_try_acquire_scanout (MetaWaylandBuffer     *buffer,
-                                          CoglOnscreen          *onscreen,
-                                          ClutterStageView      *stage_view,
-                                          const graphene_rect_t *src_rect,
-                                          const MtkRectangle    *dst_rect)
+meta_wayland_dma_buf_try_acquire_scanout (MetaWaylandBuffer       *buffer,
+                                          CoglOnscreen            *onscreen,
+                                          ClutterStageView        *stage_view,
+                                          MetaWaylandScanoutPlane  scanout_plane,
+                                          const graphene_rect_t   *src_rect,
+                                          const MtkRectangle      *dst_rect)
 {
   MetaWaylandDmaBufBuffer *dma_buf;
   MetaRendererView *renderer_view = META_RENDERER_VIEW (stage_view);
   MetaCrtc *crtc;
   MetaCrtcKms *crtc_kms;
+  MetaKmsPlane *kms_plane;
+  gboolean is_compatible;
   MetaContext *context;
   MetaBackend *backend;
   MetaRenderer *renderer;
@@ -673,28 +685,47 @@ meta_wayland_dma_buf_try_acquire_scanout (MetaWaylandBuffer     *buffer,
   g_return_val_if_fail (META_IS_CRTC_KMS (crtc), NULL);
   crtc_kms = META_CRTC_KMS (crtc);
 
+  switch (scanout_plane)
+    {
+    case META_WAYLAND_SCANOUT_PLANE_PRIMARY:
+      kms_plane = meta_crtc_kms_get_assigned_primary_plane (crtc_kms);
+      break;
+    case META_WAYLAND_SCANOUT_PLANE_OVERLAY:
+      kms_plane = meta_crtc_kms_get_assigned_overlay_plane (crtc_kms);
+      break;
+    default:
+      g_assert_not_reached ();
+    }
+
+  if (!kms_plane)
+    {
+      meta_topic (META_DEBUG_RENDER, "CRTC has no plane to scan out from");
+      return NULL;
+    }
+
   format_info = meta_format_info_from_drm_format (dma_buf->drm_format);
   g_assert (format_info);
 
   if (format_info->opaque_substitute != DRM_FORMAT_INVALID &&
-      crtc_supports_modifier (crtc_kms,
-                              format_info->opaque_substitute,
-                              dma_buf->drm_modifier))
+      plane_supports_modifier (kms_plane,
+                               format_info->opaque_substitute,
+                               dma_buf->drm_modifier))
     {
       drm_format = format_info->opaque_substitute;
     }
-  else if (crtc_supports_modifier (crtc_kms,
-                                   dma_buf->drm_format,
-                                   dma_buf->drm_modifier))
+  else if (plane_supports_modifier (kms_plane,
+                                    dma_buf->drm_format,
+                                    dma_buf->drm_modifier))
     {
       drm_format = dma_buf->drm_format;
     }
   else
     {
       meta_topic (META_DEBUG_RENDER,
-                  "DRM format 0x%x (0x%lx) not supported by primary plane",
+                  "DRM format 0x%x (0x%lx) not supported by %s plane",
                   dma_buf->drm_format,
-                  dma_buf->drm_modifier);
+                  dma_buf->drm_modifier,
+                  meta_kms_plane_type_to_string (meta_kms_plane_get_plane_type (kms_plane)));
       return NULL;
     }
 
@@ -741,7 +772,21 @@ meta_wayland_dma_buf_try_acquire_scanout (MetaWaylandBuffer     *buffer,
                               dst_rect);
   cogl_scanout_set_src_rect (scanout, src_rect);
 
-  if (!meta_onscreen_native_is_buffer_scanout_compatible (onscreen, scanout))
+  switch (scanout_plane)
+    {
+    case META_WAYLAND_SCANOUT_PLANE_PRIMARY:
+      is_compatible =
+        meta_onscreen_native_is_buffer_scanout_compatible (onscreen, scanout);
+      break;
+    case META_WAYLAND_SCANOUT_PLANE_OVERLAY:
+      is_compatible =
+        meta_onscreen_native_is_buffer_overlay_compatible (onscreen, scanout);
+      break;
+    default:
+      g_assert_not_reached ();
+    }
+
+  if (!is_compatible)
     {
       meta_topic (META_DEBUG_RENDER,
                   "Buffer not scanout compatible (see also KMS debug topic)");
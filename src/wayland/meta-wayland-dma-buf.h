@@ -71,8 +71,9 @@ meta_wayland_drm_syncobj_create_source (MetaWaylandBuffer                *buffer
                                         gpointer                          user_data);
 
 CoglScanout *
-meta_wayland_dma_buf_try_acquire_scanout (MetaWaylandBuffer     *buffer,
-                                          CoglOnscreen          *onscreen,
-                                          ClutterStageView      *stage_view,
-                                          const graphene_rect_t *src_rect,
-                                          const MtkRectangle    *dst_rect);
+meta_wayland_dma_buf_try_acquire_scanout (MetaWaylandBuffer       *buffer,
+                                          CoglOnscreen            *onscreen,
+                                          ClutterStageView        *stage_view,
+                                          MetaWaylandScanoutPlane  scanout_plane,
+                                          const graphene_rect_t   *src_rect,
+                                          const MtkRectangle      *dst_rect);
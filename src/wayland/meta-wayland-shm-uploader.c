@@ -0,0 +1,299 @@
+/*
+ * Copyright 2026 Red Hat
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Uploads damaged spans of SHM buffers to textures.
+ *
+ * Small updates are uploaded directly from the client memory. Larger ones
+ * are first packed into a staging pixel buffer object, which is mapped with
+ * the discard hint so that the driver never has to wait for a previous
+ * upload to finish, and then uploaded from the pixel buffer, letting the
+ * GPU pull the data asynchronously instead of the driver copying it during
+ * the commit.
+ */
+
+#include "config.h"
+
+#include "wayland/meta-wayland-shm-uploader.h"
+
+#include "backends/meta-backend-private.h"
+#include "cogl/cogl-texture-private.h"
+#include "wayland/meta-wayland-private.h"
+
+#define N_STAGING_BUFFERS 3
+
+/* Below this, the staging copy costs more than it saves */
+#define MIN_STAGED_UPLOAD_SIZE (64 * 1024)
+
+typedef struct _MetaWaylandShmSpan
+{
+  CoglTexture *texture;
+  CoglPixelFormat format;
+  const uint8_t *data;
+  int stride;
+  int width;
+  int height;
+  int dst_x;
+  int dst_y;
+} MetaWaylandShmSpan;
+
+struct _MetaWaylandShmUploader
+{
+  MetaWaylandCompositor *compositor;
+
+  GArray *spans;
+
+  CoglPixelBuffer *staging_buffers[N_STAGING_BUFFERS];
+  int next_staging_buffer;
+};
+
+static void
+clear_span (MetaWaylandShmSpan *span)
+{
+  g_clear_object (&span->texture);
+}
+
+MetaWaylandShmUploader *
+meta_wayland_shm_uploader_new (MetaWaylandCompositor *compositor)
+{
+  MetaWaylandShmUploader *uploader;
+
+  uploader = g_new0 (MetaWaylandShmUploader, 1);
+  uploader->compositor = compositor;
+  uploader->spans = g_array_new (FALSE, FALSE, sizeof (MetaWaylandShmSpan));
+  g_array_set_clear_func (uploader->spans, (GDestroyNotify) clear_span);
+
+  return uploader;
+}
+
+void
+meta_wayland_shm_uploader_free (MetaWaylandShmUploader *uploader)
+{
+  int i;
+
+  for (i = 0; i < N_STAGING_BUFFERS; i++)
+    g_clear_object (&uploader->staging_buffers[i]);
+  g_array_unref (uploader->spans);
+  g_free (uploader);
+}
+
+void
+meta_wayland_shm_uploader_add_span (MetaWaylandShmUploader *uploader,
+                                    CoglTexture            *texture,
+                                    CoglPixelFormat         format,
+                                    const uint8_t          *data,
+                                    int                     stride,
+                                    int                     width,
+                                    int                     height,
+                                    int                     dst_x,
+                                    int                     dst_y)
+{
+  MetaWaylandShmSpan span;
+
+  if (width <= 0 || height <= 0)
+    return;
+
+  span = (MetaWaylandShmSpan) {
+    .texture = g_object_ref (texture),
+    .format = format,
+    .data = data,
+    .stride = stride,
+    .width = width,
+    .height = height,
+    .dst_x = dst_x,
+    .dst_y = dst_y,
+  };
+  g_array_append_val (uploader->spans, span);
+}
+
+static size_t
+get_span_row_size (const MetaWaylandShmSpan *span)
+{
+  return (size_t) span->width *
+         cogl_pixel_format_get_bytes_per_pixel (span->format, 0);
+}
+
+static CoglPixelBuffer *
+ensure_staging_buffer (MetaWaylandShmUploader *uploader,
+                       CoglContext            *cogl_context,
+                       size_t                  size)
+{
+  CoglPixelBuffer **staging_buffer;
+
+  staging_buffer = &uploader->staging_buffers[uploader->next_staging_buffer];
+  uploader->next_staging_buffer =
+    (uploader->next_staging_buffer + 1) % N_STAGING_BUFFERS;
+
+  if (*staging_buffer &&
+      cogl_buffer_get_size (COGL_BUFFER (*staging_buffer)) < size)
+    g_clear_object (staging_buffer);
+
+  if (!*staging_buffer)
+    {
+      *staging_buffer = cogl_pixel_buffer_new (cogl_context, size, NULL);
+      cogl_buffer_set_update_hint (COGL_BUFFER (*staging_buffer),
+                                   COGL_BUFFER_UPDATE_HINT_STREAM);
+    }
+
+  return *staging_buffer;
+}
+
+static gboolean
+upload_spans_directly (MetaWaylandShmUploader  *uploader,
+                       GError                 **error)
+{
+  unsigned int i;
+
+  for (i = 0; i < uploader->spans->len; i++)
+    {
+      MetaWaylandShmSpan *span =
+        &g_array_index (uploader->spans, MetaWaylandShmSpan, i);
+
+      if (!_cogl_texture_set_region (span->texture,
+                                     span->width,
+                                     span->height,
+                                     span->format,
+                                     span->stride,
+                                     span->data,
+                                     span->dst_x, span->dst_y,
+                                     0,
+                                     error))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+static gboolean
+upload_spans_staged (MetaWaylandShmUploader  *uploader,
+                     CoglContext             *cogl_context,
+                     size_t                   size,
+                     GError                 **error)
+{
+  CoglPixelBuffer *staging_buffer;
+  uint8_t *staging_data;
+  size_t offset;
+  unsigned int i;
+
+  staging_buffer = ensure_staging_buffer (uploader, cogl_context, size);
+  staging_data = cogl_buffer_map_range (COGL_BUFFER (staging_buffer),
+                                        0, size,
+                                        COGL_BUFFER_ACCESS_WRITE,
+                                        COGL_BUFFER_MAP_HINT_DISCARD,
+                                        error);
+  if (!staging_data)
+    return FALSE;
+
+  offset = 0;
+  for (i = 0; i < uploader->spans->len; i++)
+    {
+      MetaWaylandShmSpan *span =
+        &g_array_index (uploader->spans, MetaWaylandShmSpan, i);
+      size_t row_size = get_span_row_size (span);
+      int y;
+
+      for (y = 0; y < span->height; y++)
+        {
+          memcpy (staging_data + offset + y * row_size,
+                  span->data + y * span->stride,
+                  row_size);
+        }
+
+      offset += row_size * span->height;
+    }
+
+  cogl_buffer_unmap (COGL_BUFFER (staging_buffer));
+
+  offset = 0;
+  for (i = 0; i < uploader->spans->len; i++)
+    {
+      MetaWaylandShmSpan *span =
+        &g_array_index (uploader->spans, MetaWaylandShmSpan, i);
+      size_t row_size = get_span_row_size (span);
+      g_autoptr (CoglBitmap) bitmap = NULL;
+
+      bitmap = cogl_bitmap_new_from_buffer (COGL_BUFFER (staging_buffer),
+                                            span->format,
+                                            span->width,
+                                            span->height,
+                                            row_size,
+                                            offset);
+
+      if (!cogl_texture_set_region_from_bitmap (span->texture,
+                                                0, 0,
+                                                span->dst_x, span->dst_y,
+                                                span->width, span->height,
+                                                bitmap))
+        {
+          g_set_error (error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                       "Failed to upload %dx%d span from staging buffer",
+                       span->width, span->height);
+          return FALSE;
+        }
+
+      offset += row_size * span->height;
+    }
+
+  return TRUE;
+}
+
+/*
+ * Uploads all spans added since the last flush. Must be called while the
+ * SHM buffer memory the spans point to is still accessible.
+ */
+gboolean
+meta_wayland_shm_uploader_flush (MetaWaylandShmUploader  *uploader,
+                                 GError                 **error)
+{
+  MetaContext *context =
+    meta_wayland_compositor_get_context (uploader->compositor);
+  MetaBackend *backend = meta_context_get_backend (context);
+  ClutterBackend *clutter_backend = meta_backend_get_clutter_backend (backend);
+  CoglContext *cogl_context =
+    clutter_backend_get_cogl_context (clutter_backend);
+  CoglDriver *cogl_driver = cogl_context_get_driver (cogl_context);
+  size_t size = 0;
+  unsigned int i;
+  gboolean ret;
+
+  COGL_TRACE_BEGIN_SCOPED (ShmUpload,
+                           "Meta::WaylandShmUploader::flush()");
+  COGL_TRACE_DEFINE_COUNTER_INT (ShmUploadBytes,
+                                 "ShmUploadBytes",
+                                 "the number of bytes of SHM buffer data "
+                                 "uploaded by a commit");
+
+  for (i = 0; i < uploader->spans->len; i++)
+    {
+      MetaWaylandShmSpan *span =
+        &g_array_index (uploader->spans, MetaWaylandShmSpan, i);
+
+      size += get_span_row_size (span) * span->height;
+    }
+
+  if (size >= MIN_STAGED_UPLOAD_SIZE &&
+      cogl_driver_has_feature (cogl_driver, COGL_FEATURE_ID_PBOS))
+    ret = upload_spans_staged (uploader, cogl_context, size, error);
+  else
+    ret = upload_spans_directly (uploader, error);
+
+  COGL_TRACE_SET_COUNTER_INT (ShmUploadBytes, size);
+
+  g_array_set_size (uploader->spans, 0);
+
+  return ret;
+}
@@ -0,0 +1,40 @@
+/*
+ * Copyright 2026 Red Hat
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; either version 2 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <glib.h>
+
+#include "cogl/cogl.h"
+#include "wayland/meta-wayland-types.h"
+
+MetaWaylandShmUploader * meta_wayland_shm_uploader_new (MetaWaylandCompositor *compositor);
+
+void meta_wayland_shm_uploader_free (MetaWaylandShmUploader *uploader);
+
+void meta_wayland_shm_uploader_add_span (MetaWaylandShmUploader *uploader,
+                                         CoglTexture            *texture,
+                                         CoglPixelFormat         format,
+                                         const uint8_t          *data,
+                                         int                     stride,
+                                         int                     width,
+                                         int                     height,
+                                         int                     dst_x,
+                                         int                     dst_y);
+
+gboolean meta_wayland_shm_uploader_flush (MetaWaylandShmUploader  *uploader,
+                                          GError                 **error);
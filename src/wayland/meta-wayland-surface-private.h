@@ -426,9 +426,10 @@ int                 meta_wayland_surface_get_buffer_width (MetaWaylandSurface *s
 META_EXPORT_TEST
 int                 meta_wayland_surface_get_buffer_height (MetaWaylandSurface *surface);
 
-CoglScanout *       meta_wayland_surface_try_acquire_scanout (MetaWaylandSurface *surface,
-                                                              CoglOnscreen       *onscreen,
-                                                              ClutterStageView   *stage_view);
+CoglScanout *       meta_wayland_surface_try_acquire_scanout (MetaWaylandSurface      *surface,
+                                                              CoglOnscreen            *onscreen,
+                                                              ClutterStageView        *stage_view,
+                                                              MetaWaylandScanoutPlane  scanout_plane);
 
 MetaCrtc * meta_wayland_surface_get_scanout_candidate (MetaWaylandSurface *surface);
 
@@ -2578,9 +2578,10 @@ meta_wayland_surface_get_buffer_height (MetaWaylandSurface *surface)
 }
 
 CoglScanout *
-meta_wayland_surface_try_acquire_scanout (MetaWaylandSurface *surface,
-                                          CoglOnscreen       *onscreen,
-                                          ClutterStageView   *stage_view)
+meta_wayland_surface_try_acquire_scanout (MetaWaylandSurface      *surface,
+                                          CoglOnscreen            *onscreen,
+                                          ClutterStageView        *stage_view,
+                                          MetaWaylandScanoutPlane  scanout_plane)
 {
   MetaSurfaceActor *surface_actor;
   MtkMonitorTransform view_transform;
@@ -2658,6 +2659,7 @@ meta_wayland_surface_try_acquire_scanout (MetaWaylandSurface *surface,
   return meta_wayland_buffer_try_acquire_scanout (surface->buffer,
                                                   onscreen,
                                                   stage_view,
+                                                  scanout_plane,
                                                   src_rect_ptr,
                                                   &crtc_dst_rect);
 }
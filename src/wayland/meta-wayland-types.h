@@ -71,6 +71,8 @@ typedef struct _MetaWaylandXdgForeign MetaWaylandXdgForeign;
 
 typedef struct _MetaWaylandFilterManager MetaWaylandFilterManager;
 
+typedef struct _MetaWaylandShmUploader MetaWaylandShmUploader;
+
 typedef struct _MetaWaylandClient MetaWaylandClient;
 
 typedef struct _MetaWaylandDrmLeaseManager MetaWaylandDrmLeaseManager;
@@ -78,3 +80,9 @@ typedef struct _MetaWaylandDrmLeaseManager MetaWaylandDrmLeaseManager;
 typedef struct _MetaWaylandXdgSessionManager MetaWaylandXdgSessionManager;
 
 typedef struct _MetaWaylandToplevelDrag MetaWaylandToplevelDrag;
+
+typedef enum _MetaWaylandScanoutPlane
+{
+  META_WAYLAND_SCANOUT_PLANE_PRIMARY,
+  META_WAYLAND_SCANOUT_PLANE_OVERLAY,
+} MetaWaylandScanoutPlane;
@@ -61,6 +61,7 @@
 #include "wayland/meta-wayland-private.h"
 #include "wayland/meta-wayland-region.h"
 #include "wayland/meta-wayland-seat.h"
+#include "wayland/meta-wayland-shm-uploader.h"
 #include "wayland/meta-wayland-subsurface.h"
 #include "wayland/meta-wayland-system-bell.h"
 #include "wayland/meta-wayland-tablet-manager.h"
@@ -97,6 +98,7 @@ typedef struct _MetaWaylandCompositorPrivate
   gboolean is_wayland_egl_display_bound;
 
   MetaWaylandFilterManager *filter_manager;
+  MetaWaylandShmUploader *shm_uploader;
   GHashTable *frame_callback_sources;
 } MetaWaylandCompositorPrivate;
 
@@ -816,6 +818,7 @@ meta_wayland_compositor_finalize (GObject *object)
   meta_wayland_tablet_manager_finalize (compositor);
 
   g_clear_pointer (&priv->filter_manager, meta_wayland_filter_manager_free);
+  g_clear_pointer (&priv->shm_uploader, meta_wayland_shm_uploader_free);
   g_clear_pointer (&priv->frame_callback_sources, g_hash_table_destroy);
 
   g_clear_pointer (&compositor->display_name, g_free);
@@ -846,6 +849,7 @@ meta_wayland_compositor_init (MetaWaylandCompositor *compositor)
                                           &compositor->client_created_listener);
 
   priv->filter_manager = meta_wayland_filter_manager_new (compositor);
+  priv->shm_uploader = meta_wayland_shm_uploader_new (compositor);
   priv->frame_callback_sources =
     g_hash_table_new_full (NULL, NULL, NULL,
                            (GDestroyNotify) g_source_destroy);
@@ -1237,6 +1241,15 @@ meta_wayland_compositor_get_filter_manager (MetaWaylandCompositor *compositor)
   return priv->filter_manager;
 }
 
+MetaWaylandShmUploader *
+meta_wayland_compositor_get_shm_uploader (MetaWaylandCompositor *compositor)
+{
+  MetaWaylandCompositorPrivate *priv =
+    meta_wayland_compositor_get_instance_private (compositor);
+
+  return priv->shm_uploader;
+}
+
 MetaWaylandTextInput *
 meta_wayland_compositor_get_text_input (MetaWaylandCompositor *compositor)
 {
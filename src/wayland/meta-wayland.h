@@ -104,6 +104,8 @@ MetaContext * meta_wayland_compositor_get_context (MetaWaylandCompositor *compos
 META_EXPORT_TEST
 MetaWaylandFilterManager * meta_wayland_compositor_get_filter_manager (MetaWaylandCompositor *compositor);
 
+MetaWaylandShmUploader * meta_wayland_compositor_get_shm_uploader (MetaWaylandCompositor *compositor);
+
 void meta_wayland_compositor_sync_focus (MetaWaylandCompositor *compositor);
 
 ClutterCursor * meta_wayland_compositor_get_cursor (MetaWaylandCompositor *compositor,
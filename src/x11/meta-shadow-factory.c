@@ -23,6 +23,7 @@
 
 #include "x11/meta-shadow-factory.h"
 
+#include "clutter/clutter-mutter.h"
 #include "compositor/cogl-utils.h"
 #include "meta/util.h"
 
@@ -44,6 +45,11 @@
  *   in blocks, blur rows again, and then transpose back.
  *
  * - We approximate the 1D gaussian blur as 3 successive box filters.
+ *
+ * - For large radii, the shape is instead painted into an offscreen
+ *   texture and blurred on the GPU using ClutterBlur, which downscales
+ *   the texture and does the two passes in a shader. Only the resulting
+ *   9-slice texture is kept.
  */
 
 typedef struct _MetaShadowCacheKey  MetaShadowCacheKey;
@@ -98,8 +104,30 @@ struct _MetaShadowFactory
 
   /* class name => MetaShadowClassInfo */
   GHashTable *shadow_classes;
+
+  MetaShadowBlurMode blur_mode;
 };
 
+/* Below this radius, blurring on the CPU is expected to be cheaper than
+ * the round trip through offscreen framebuffers. This depends on the
+ * hardware; compare with 'meson test --benchmark shadow' when changing
+ * it. Both paths are checked to give the same result within a tolerance
+ * on either side of it by the shadow-factory tests. */
+#define GPU_BLUR_MIN_RADIUS 12
+
+#define TOP_FADE_VERTEX_SHADER_DECLARATIONS                             \
+"varying float fade_position;\n"                                        \
+
+#define TOP_FADE_VERTEX_SHADER_CODE                                     \
+"fade_position = cogl_position_in.y;\n"                                 \
+
+#define TOP_FADE_FRAGMENT_SHADER_DECLARATIONS                           \
+"uniform float top_fade;\n"                                             \
+"varying float fade_position;\n"                                        \
+
+#define TOP_FADE_FRAGMENT_SHADER_CODE                                   \
+"cogl_color_out *= min (fade_position / top_fade, 1.0);\n"              \
+
 /* The first element in this array also defines the default parameters
  * for newly created classes */
 MetaShadowClassInfo default_shadow_classes[] = {
@@ -817,12 +845,13 @@ make_border_region (MtkRegion *region,
   return g_steal_pointer (&border_region);
 }
 
-static void
-make_shadow (MetaShadow  *shadow,
-             CoglContext *cogl_context,
-             MtkRegion   *region)
+static CoglTexture *
+make_shadow_texture_cpu (MetaShadow  *shadow,
+                         CoglContext *cogl_context,
+                         MtkRegion   *region)
 {
   g_autoptr (GError) error = NULL;
+  CoglTexture *texture;
   int d = get_box_filter_size (shadow->key.radius);
   int spread = get_shadow_spread (shadow->key.radius);
   MtkRectangle extents;
@@ -912,21 +941,206 @@ make_shadow (MetaShadow  *shadow,
    * in the case of top_fade >= 0. We also account for padding at the left for symmetry
    * though that doesn't currently occur.
    */
-  shadow->texture = cogl_texture_2d_new_from_data (cogl_context,
-                                                   shadow->outer_border_left + extents.width + shadow->outer_border_right,
-                                                   shadow->outer_border_top + extents.height + shadow->outer_border_bottom,
-                                                   COGL_PIXEL_FORMAT_A_8,
-                                                   buffer_width,
-                                                   (buffer +
-                                                    (y_offset - shadow->outer_border_top) * buffer_width +
-                                                    (x_offset - shadow->outer_border_left)),
-                                                   &error);
+  texture = cogl_texture_2d_new_from_data (cogl_context,
+                                           shadow->outer_border_left + extents.width + shadow->outer_border_right,
+                                           shadow->outer_border_top + extents.height + shadow->outer_border_bottom,
+                                           COGL_PIXEL_FORMAT_A_8,
+                                           buffer_width,
+                                           (buffer +
+                                            (y_offset - shadow->outer_border_top) * buffer_width +
+                                            (x_offset - shadow->outer_border_left)),
+                                           &error);
 
   if (error)
     g_warning ("Failed to allocate shadow texture: %s", error->message);
 
   g_free (buffer);
 
+  return texture;
+}
+
+static CoglFramebuffer *
+create_shadow_framebuffer (CoglTexture  *texture,
+                           GError      **error)
+{
+  g_autoptr (CoglFramebuffer) framebuffer = NULL;
+
+  framebuffer = COGL_FRAMEBUFFER (cogl_offscreen_new_with_texture (texture));
+  if (!cogl_framebuffer_allocate (framebuffer, error))
+    return NULL;
+
+  cogl_framebuffer_orthographic (framebuffer, 0, 0,
+                                 cogl_texture_get_width (texture),
+                                 cogl_texture_get_height (texture),
+                                 -1.0, 1.0);
+
+  return g_steal_pointer (&framebuffer);
+}
+
+static void
+add_top_fade (CoglPipeline *pipeline,
+              int           top_fade)
+{
+  static CoglSnippet *top_fade_vertex_snippet;
+  static CoglSnippet *top_fade_fragment_snippet;
+  int top_fade_location;
+
+  if (!top_fade_vertex_snippet)
+    top_fade_vertex_snippet = cogl_snippet_new (COGL_SNIPPET_HOOK_VERTEX,
+                                                TOP_FADE_VERTEX_SHADER_DECLARATIONS,
+                                                TOP_FADE_VERTEX_SHADER_CODE);
+  cogl_pipeline_add_snippet (pipeline, top_fade_vertex_snippet);
+
+  if (!top_fade_fragment_snippet)
+    top_fade_fragment_snippet = cogl_snippet_new (COGL_SNIPPET_HOOK_FRAGMENT,
+                                                  TOP_FADE_FRAGMENT_SHADER_DECLARATIONS,
+                                                  TOP_FADE_FRAGMENT_SHADER_CODE);
+  cogl_pipeline_add_snippet (pipeline, top_fade_fragment_snippet);
+
+  top_fade_location = cogl_pipeline_get_uniform_location (pipeline, "top_fade");
+  cogl_pipeline_set_uniform_1f (pipeline, top_fade_location, top_fade);
+}
+
+/* Same result as make_shadow_texture_cpu(), but the shape is painted into
+ * an offscreen texture with padding for the spread on all sides, blurred
+ * on the GPU, and then the part that the 9-slice texture needs is copied
+ * out, applying the top fade on the way.
+ */
+static CoglTexture *
+make_shadow_texture_gpu (MetaShadow  *shadow,
+                         CoglContext *cogl_context,
+                         MtkRegion   *region)
+{
+  g_autoptr (GError) error = NULL;
+  int spread = get_shadow_spread (shadow->key.radius);
+  MtkRectangle extents;
+  g_autoptr (CoglTexture) mask_texture = NULL;
+  g_autoptr (CoglFramebuffer) mask_framebuffer = NULL;
+  g_autoptr (CoglTexture) texture = NULL;
+  g_autoptr (CoglFramebuffer) framebuffer = NULL;
+  g_autoptr (CoglPipeline) pipeline = NULL;
+  g_autoptr (ClutterBlur) blur = NULL;
+  g_autofree float *coordinates = NULL;
+  int mask_width, mask_height;
+  int texture_width, texture_height;
+  float src_x1, src_y1, src_x2, src_y2;
+  int n_rectangles, k;
+
+  extents = mtk_region_get_extents (region);
+
+  mask_width = extents.width + 2 * spread;
+  mask_height = extents.height + 2 * spread;
+
+  mask_texture = cogl_texture_2d_new_with_size (cogl_context,
+                                                mask_width, mask_height);
+  mask_framebuffer = create_shadow_framebuffer (mask_texture, &error);
+  if (!mask_framebuffer)
+    {
+      g_warning ("Failed to allocate shadow mask: %s", error->message);
+      return NULL;
+    }
+
+  cogl_framebuffer_clear4f (mask_framebuffer, COGL_BUFFER_BIT_COLOR,
+                            0.0, 0.0, 0.0, 0.0);
+
+  n_rectangles = mtk_region_num_rectangles (region);
+  coordinates = g_new (float, n_rectangles * 4);
+  for (k = 0; k < n_rectangles; k++)
+    {
+      MtkRectangle rect;
+
+      rect = mtk_region_get_rectangle (region, k);
+      coordinates[k * 4 + 0] = spread + rect.x;
+      coordinates[k * 4 + 1] = spread + rect.y;
+      coordinates[k * 4 + 2] = spread + rect.x + rect.width;
+      coordinates[k * 4 + 3] = spread + rect.y + rect.height;
+    }
+
+  pipeline = cogl_pipeline_new (cogl_context);
+  cogl_pipeline_set_static_name (pipeline, "MetaShadowFactory (mask)");
+  cogl_pipeline_set_color4f (pipeline, 0.0, 0.0, 0.0, 1.0);
+  cogl_framebuffer_draw_rectangles (mask_framebuffer, pipeline,
+                                    coordinates, n_rectangles);
+  g_clear_object (&pipeline);
+
+  /* ClutterBlur takes a radius of twice the standard deviation */
+  blur = clutter_blur_new (mask_texture, shadow->key.radius * 2.0f);
+  if (!blur)
+    return NULL;
+
+  clutter_blur_apply (blur);
+
+  texture_width = (shadow->outer_border_left + extents.width +
+                   shadow->outer_border_right);
+  texture_height = (shadow->outer_border_top + extents.height +
+                    shadow->outer_border_bottom);
+
+  texture = cogl_texture_2d_new_with_size (cogl_context,
+                                           texture_width, texture_height);
+  framebuffer = create_shadow_framebuffer (texture, &error);
+  if (!framebuffer)
+    {
+      g_warning ("Failed to allocate shadow texture: %s", error->message);
+      return NULL;
+    }
+
+  pipeline = cogl_pipeline_new (cogl_context);
+  cogl_pipeline_set_static_name (pipeline, "MetaShadowFactory (copy)");
+  cogl_pipeline_set_layer_texture (pipeline, 0,
+                                   clutter_blur_get_texture (blur));
+  cogl_pipeline_set_layer_filters (pipeline, 0,
+                                   COGL_PIPELINE_FILTER_LINEAR,
+                                   COGL_PIPELINE_FILTER_LINEAR);
+  cogl_pipeline_set_blend (pipeline, "RGBA = ADD (SRC_COLOR, 0)", NULL);
+  if (shadow->key.top_fade > 0)
+    add_top_fade (pipeline, shadow->key.top_fade);
+
+  src_x1 = (float) (spread - shadow->outer_border_left) / mask_width;
+  src_y1 = (float) (spread - shadow->outer_border_top) / mask_height;
+  src_x2 = src_x1 + (float) texture_width / mask_width;
+  src_y2 = src_y1 + (float) texture_height / mask_height;
+
+  cogl_framebuffer_draw_textured_rectangle (framebuffer, pipeline,
+                                            0, 0,
+                                            texture_width, texture_height,
+                                            src_x1, src_y1,
+                                            src_x2, src_y2);
+
+  return g_steal_pointer (&texture);
+}
+
+static gboolean
+should_blur_on_gpu (MetaShadowFactory *factory,
+                    int                radius)
+{
+  if (radius == 0)
+    return FALSE;
+
+  switch (factory->blur_mode)
+    {
+    case META_SHADOW_BLUR_MODE_AUTO:
+      return radius >= GPU_BLUR_MIN_RADIUS;
+    case META_SHADOW_BLUR_MODE_CPU:
+      return FALSE;
+    case META_SHADOW_BLUR_MODE_GPU:
+      return TRUE;
+    }
+
+  g_assert_not_reached ();
+}
+
+static void
+make_shadow (MetaShadowFactory *factory,
+             MetaShadow        *shadow,
+             CoglContext       *cogl_context,
+             MtkRegion         *region)
+{
+  if (should_blur_on_gpu (factory, shadow->key.radius))
+    shadow->texture = make_shadow_texture_gpu (shadow, cogl_context, region);
+
+  if (!shadow->texture)
+    shadow->texture = make_shadow_texture_cpu (shadow, cogl_context, region);
+
   shadow->pipeline = meta_create_texture_pipeline (cogl_context, shadow->texture);
   cogl_pipeline_set_static_name (shadow->pipeline, "MetaShadowFactory");
 }
@@ -1093,7 +1307,7 @@ meta_shadow_factory_get_shadow (MetaShadowFactory *factory,
   g_assert (center_width >= 0 && center_height >= 0);
 
   region = meta_window_shape_to_region (shape, center_width, center_height);
-  make_shadow (shadow, cogl_context, region);
+  make_shadow (factory, shadow, cogl_context, region);
 
   if (cacheable)
     g_hash_table_insert (factory->shadows, &shadow->key, shadow);
@@ -1101,6 +1315,57 @@ meta_shadow_factory_get_shadow (MetaShadowFactory *factory,
   return shadow;
 }
 
+/**
+ * meta_shadow_factory_set_blur_mode:
+ * @factory: a #MetaShadowFactory
+ * @blur_mode: how to blur shadows
+ *
+ * Sets how new shadow textures are generated. Shadows that already exist
+ * are not regenerated.
+ */
+void
+meta_shadow_factory_set_blur_mode (MetaShadowFactory  *factory,
+                                   MetaShadowBlurMode  blur_mode)
+{
+  g_return_if_fail (META_IS_SHADOW_FACTORY (factory));
+
+  factory->blur_mode = blur_mode;
+}
+
+/**
+ * meta_shadow_factory_set_params:
+ * @factory: a #MetaShadowFactory
+ * @class_name: name of the class of shadow to set the params for.
+ *  the following standard names are defined: "normal", "dialog",
+ *  "modal_dialog", "utility", "border", "menu", "popup-menu",
+ *  "dropdown-menu", "attached"; other names are allowed as well
+ * @focused: whether the shadow is for a focused window
+ * @params: new parameter values
+ *
+ * Updates the shadow parameters for a particular class of shadows
+ * for either the focused or unfocused state. If the class name
+ * does not name an existing class, a new class will be created
+ * (the other focus state for that class will have default values
+ * assigned to it.)
+ */
+void
+meta_shadow_factory_set_params (MetaShadowFactory *factory,
+                                const char        *class_name,
+                                gboolean           focused,
+                                MetaShadowParams  *params)
+{
+  MetaShadowParams *stored_params;
+
+  g_return_if_fail (META_IS_SHADOW_FACTORY (factory));
+  g_return_if_fail (class_name != NULL);
+  g_return_if_fail (params != NULL);
+  g_return_if_fail (params->radius >= 0);
+
+  stored_params = get_shadow_params (factory, class_name, focused, TRUE);
+
+  *stored_params = *params;
+}
+
 /**
  * meta_shadow_factory_get_params:
  * @factory: a #MetaShadowFactory
@@ -24,6 +24,7 @@
 
 #include "clutter/clutter.h"
 #include "cogl/cogl.h"
+#include "core/util-private.h"
 #include "x11/meta-window-shape.h"
 
 GType meta_shadow_get_type (void);
@@ -53,6 +54,22 @@ struct _MetaShadowParams
   guint8 opacity;
 };
 
+/**
+ * MetaShadowBlurMode:
+ * @META_SHADOW_BLUR_MODE_AUTO: blur on the GPU for large radii, on the
+ *  CPU otherwise
+ * @META_SHADOW_BLUR_MODE_CPU: always blur on the CPU
+ * @META_SHADOW_BLUR_MODE_GPU: blur on the GPU whenever possible
+ *
+ * How shadow textures are generated.
+ */
+typedef enum _MetaShadowBlurMode
+{
+  META_SHADOW_BLUR_MODE_AUTO,
+  META_SHADOW_BLUR_MODE_CPU,
+  META_SHADOW_BLUR_MODE_GPU,
+} MetaShadowBlurMode;
+
 #define META_TYPE_SHADOW_FACTORY (meta_shadow_factory_get_type ())
 
 G_DECLARE_FINAL_TYPE (MetaShadowFactory,
@@ -68,8 +85,19 @@ G_DECLARE_FINAL_TYPE (MetaShadowFactory,
  * It caches shadows internally so that multiple shadows created for
  * the same shape with the same radius will share the same [struct@Meta.Shadow].
  */
+META_EXPORT_TEST
 MetaShadowFactory *meta_shadow_factory_get_default (void);
 
+META_EXPORT_TEST
+void meta_shadow_factory_set_blur_mode (MetaShadowFactory  *factory,
+                                        MetaShadowBlurMode  blur_mode);
+
+META_EXPORT_TEST
+void meta_shadow_factory_set_params (MetaShadowFactory *factory,
+                                     const char        *class_name,
+                                     gboolean           focused,
+                                     MetaShadowParams  *params);
+
 void meta_shadow_factory_get_params (MetaShadowFactory *factory,
                                      const char        *class_name,
                                      gboolean           focused,
@@ -88,8 +116,10 @@ typedef struct _MetaShadow MetaShadow;
 
 MetaShadow *meta_shadow_ref         (MetaShadow            *shadow);
 
+META_EXPORT_TEST
 void        meta_shadow_unref       (MetaShadow            *shadow);
 
+META_EXPORT_TEST
 void        meta_shadow_paint       (MetaShadow      *shadow,
                                      CoglFramebuffer *framebuffer,
                                      int              window_x,
@@ -107,6 +137,7 @@ void        meta_shadow_get_bounds  (MetaShadow   *shadow,
                                      int           window_height,
                                      MtkRectangle *bounds);
 
+META_EXPORT_TEST
 MetaShadow *meta_shadow_factory_get_shadow (MetaShadowFactory *factory,
                                             MetaWindowShape   *shape,
                                             int                width,
@@ -24,6 +24,7 @@
 
 #include <glib-object.h>
 
+#include "core/util-private.h"
 #include "meta/common.h"
 
 GType meta_window_shape_get_type (void);
@@ -42,10 +43,12 @@ GType meta_window_shape_get_type (void);
  */
 typedef struct _MetaWindowShape MetaWindowShape;
 
+META_EXPORT_TEST
 MetaWindowShape *  meta_window_shape_new         (MtkRegion  *region);
 
 MetaWindowShape *  meta_window_shape_ref         (MetaWindowShape *shape);
 
+META_EXPORT_TEST
 void               meta_window_shape_unref       (MetaWindowShape *shape);
 
 guint              meta_window_shape_hash        (MetaWindowShape *shape);